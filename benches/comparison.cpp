@@ -2,6 +2,8 @@
 #include <vector>
 #include <chrono>
 #include <atomic>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <thread>
 #include <type_traits> // 追加
@@ -60,6 +62,142 @@ public:
     }
 };
 
+// =========================================================
+// 1c. Manual COM + per-CPU (sharded) refcount
+// - Shards absorb AddRef/Release; Reconcile() folds them into one exact count.
+// =========================================================
+
+class ShardedComImpl : public IMyAsyncOp {
+    static constexpr size_t kShards = 16;
+    static constexpr long long kBias = 1LL << 40;
+    static constexpr long long kReconciled = INT64_MIN / 2;
+    static constexpr long long kLiveMin = kReconciled / 2;
+
+    struct alignas(64) Shard {
+        std::atomic<long long> value{0};
+    };
+
+    std::atomic<long long> shared_{kBias + 1};
+    std::atomic<bool> reconciling_{false};
+    Shard shards_[kShards];
+
+    static size_t CurrentShard() {
+        return std::hash<std::thread::id>{}(std::this_thread::get_id()) % kShards;
+    }
+
+    static unsigned long SharedCount(long long count) {
+        return count >= kBias / 2 ? 1 : static_cast<unsigned long>(count);
+    }
+
+public:
+    unsigned long STDMETHODCALLTYPE AddRef() override {
+        if (shards_[CurrentShard()].value.fetch_add(1, std::memory_order_relaxed) > kLiveMin) {
+            return 2;
+        }
+        return SharedCount(shared_.fetch_add(1, std::memory_order_relaxed) + 1);
+    }
+
+    unsigned long STDMETHODCALLTYPE Release() override {
+        if (shards_[CurrentShard()].value.fetch_sub(1, std::memory_order_release) > kLiveMin) {
+            return 1;
+        }
+        long long count = shared_.fetch_sub(1, std::memory_order_release) - 1;
+        if (count == 0) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            delete this;
+        }
+        return SharedCount(count);
+    }
+
+    void Reconcile() {
+        if (reconciling_.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        long long folded = 0;
+        for (auto& shard : shards_) {
+            folded += shard.value.exchange(kReconciled, std::memory_order_acq_rel);
+        }
+        shared_.fetch_add(folded - kBias, std::memory_order_acq_rel);
+    }
+
+    NOINLINE int STDMETHODCALLTYPE GetStatus(int* status) override {
+        *status = 1;
+        return 0;
+    }
+};
+
+// =========================================================
+// 1b. Manual COM + per-class pool (bounded slot cache)
+// =========================================================
+
+template <typename T, size_t N>
+class SlotPool {
+    std::atomic<void*> slots_[N] = {};
+
+public:
+    void* Allocate() {
+        for (auto& slot : slots_) {
+            if (slot.load(std::memory_order_relaxed) == nullptr) {
+                continue;
+            }
+            void* block = slot.exchange(nullptr, std::memory_order_acquire);
+            if (block != nullptr) {
+                return block;
+            }
+        }
+        return ::operator new(sizeof(T));
+    }
+
+    void Free(void* block) {
+        for (auto& slot : slots_) {
+            void* expected = nullptr;
+            if (slot.compare_exchange_strong(expected, block, std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        ::operator delete(block);
+    }
+
+    ~SlotPool() {
+        for (auto& slot : slots_) {
+            ::operator delete(slot.exchange(nullptr));
+        }
+    }
+};
+
+class PooledComImpl;
+static SlotPool<PooledComImpl, 64> g_pooled_com_pool;
+
+class PooledComImpl : public IMyAsyncOp {
+    std::atomic<unsigned long> ref_count_;
+    int result_;
+
+public:
+    PooledComImpl() : ref_count_(1), result_(0) {}
+
+    static void* operator new(size_t) { return g_pooled_com_pool.Allocate(); }
+    static void operator delete(void* block) { g_pooled_com_pool.Free(block); }
+
+    unsigned long STDMETHODCALLTYPE AddRef() override {
+        return ref_count_.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    unsigned long STDMETHODCALLTYPE Release() override {
+        unsigned long count = ref_count_.fetch_sub(1, std::memory_order_release) - 1;
+        if (count == 0) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            delete this;
+        }
+        return count;
+    }
+
+    NOINLINE int STDMETHODCALLTYPE GetStatus(int* status) override {
+        *status = 1;
+        return 0;
+    }
+};
+
 // =========================================================
 // 2. Modern C++ Implementation (std::shared_ptr)
 // =========================================================
@@ -112,6 +250,35 @@ double measure_ns(const char* name, int iterations, double baseline, Func func)
     return adj;
 }
 
+static constexpr int CONTENDED_THREADS = 4;
+
+// AddRef + Release from CONTENDED_THREADS threads at once on one object.
+double measure_contended_ns(const char* name, int iterations, IMyAsyncOp* obj) {
+    auto run = [obj](int count) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < CONTENDED_THREADS; ++t) {
+            threads.emplace_back([obj, count]() {
+                for (int i = 0; i < count; ++i) {
+                    obj->AddRef();
+                    do_not_optimize(obj->Release());
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    };
+    run(WARMUP_ITERATIONS);
+    auto start = std::chrono::high_resolution_clock::now();
+    run(iterations);
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    double avg = static_cast<double>(duration) / iterations;
+    std::cout << "[" << name << "] Average: " << avg << " ns"
+              << " (" << CONTENDED_THREADS << " threads)" << std::endl;
+    return avg;
+}
+
 int main() {
     const int ITERATIONS = 10000000; // 10M loops
 
@@ -129,6 +296,12 @@ int main() {
         obj->Release(); 
     });
 
+    // 1b. Manual COM: new from a per-class pool (Corresponds to Rust_kcom_Pool_New)
+    measure_ns("Cpp_Pooled_New", ITERATIONS, baseline, []() {
+        IMyAsyncOp* obj = new PooledComImpl();
+        obj->Release();
+    });
+
     // 2. Modern C++: new (Single Allocation)
     measure_ns("Cpp_New_Ready", ITERATIONS, baseline, []() {
         auto ptr = new ModernImpl();
@@ -154,6 +327,14 @@ int main() {
         do_not_optimize(status);
     });
 
+    // 3b. AddRef + Release contended across threads, atomic vs per-CPU shards
+    measure_contended_ns("Cpp_Contended_AddRef_Release", ITERATIONS / 4, raw_obj);
+
+    ShardedComImpl* sharded = new ShardedComImpl();
+    measure_contended_ns("Cpp_PerCpu_Contended_AddRef_Release", ITERATIONS / 4, sharded);
+    sharded->Reconcile();
+    sharded->Release();
+
     raw_obj->Release();
 
     // 4. Native direct call
@@ -1,10 +1,13 @@
 use kcom::{
-    declare_com_interface, impl_com_interface, impl_com_object, ComObject, GUID, IUnknownVtbl,
-    NTSTATUS, STATUS_SUCCESS,
+    declare_com_interface, impl_com_interface, impl_com_interface_multiple, impl_com_object,
+    AtomicComRc, ComObject, ComObjectN, ComRc, ComRef, GUID, GlobalAllocator, HandleTable,
+    IUnknownVtbl, LocalRefCount, ObjectPool, PerCpuRefCount, PoolAllocator,
+    ThreadAffineComInterface, ThreadSafeComInterface, NTSTATUS, STATUS_SUCCESS,
 };
+use std::collections::HashMap;
 use std::hint::black_box;
 use std::sync::Arc;
-use std::sync::atomic::{compiler_fence, Ordering};
+use std::sync::atomic::{compiler_fence, AtomicU32, Ordering};
 use std::time::Instant;
 
 // =========================================================
@@ -22,6 +25,8 @@ declare_com_interface! {
     }
 }
 
+unsafe impl ThreadSafeComInterface for IMyAsyncOpRaw {}
+
 // =========================================================
 // 2. kcom Implementation (Corresponds to ManualComImpl)
 // =========================================================
@@ -45,6 +50,185 @@ impl_com_interface! {
 
 impl_com_object!(MyImpl, IMyAsyncOpVtbl);
 
+// Same object, recycled through a per-type pool (Corresponds to PooledComImpl)
+struct PooledImpl;
+
+impl IMyAsyncOp for PooledImpl {
+    #[inline(never)]
+    fn get_status(&self, status: &mut i32) -> NTSTATUS {
+        *status = 1;
+        STATUS_SUCCESS
+    }
+}
+
+type PooledAlloc = PoolAllocator<64>;
+type PooledObject = ComObject<PooledImpl, IMyAsyncOpVtbl, PooledAlloc>;
+
+impl_com_interface! {
+    impl PooledImpl: IMyAsyncOp {
+        parent = IUnknownVtbl,
+        allocator = PooledAlloc,
+        methods = [get_status],
+    }
+}
+
+static POOLED_IMPL_POOL: ObjectPool<64> =
+    ObjectPool::new(core::alloc::Layout::new::<PooledObject>());
+
+// Same object, counted with plain (non-atomic) increments on one thread.
+// LocalRefCount only admits thread-affine interfaces, hence the twin interface.
+declare_com_interface! {
+    pub trait IMyLocalOp: IUnknown {
+        const IID: GUID = GUID {
+            data1: 0x1111_2222, data2: 0x3333, data3: 0x4445,
+            data4: [0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC],
+        };
+        fn get_status(&self, status: &mut i32) -> NTSTATUS;
+    }
+}
+
+unsafe impl ThreadAffineComInterface for IMyLocalOpRaw {}
+
+struct LocalImpl;
+
+impl IMyLocalOp for LocalImpl {
+    #[inline(never)]
+    fn get_status(&self, status: &mut i32) -> NTSTATUS {
+        *status = 1;
+        STATUS_SUCCESS
+    }
+}
+
+type LocalObject = ComObject<LocalImpl, IMyLocalOpVtbl, GlobalAllocator, LocalRefCount>;
+
+impl_com_interface! {
+    impl LocalImpl: IMyLocalOp {
+        parent = IUnknownVtbl,
+        refcount = LocalRefCount,
+        methods = [get_status],
+    }
+}
+
+// Same object, counted in per-CPU shards for heavy cross-CPU sharing
+struct ShardedImpl;
+
+impl IMyAsyncOp for ShardedImpl {
+    #[inline(never)]
+    fn get_status(&self, status: &mut i32) -> NTSTATUS {
+        *status = 1;
+        STATUS_SUCCESS
+    }
+}
+
+type ShardedObject = ComObject<ShardedImpl, IMyAsyncOpVtbl, GlobalAllocator, PerCpuRefCount>;
+
+impl_com_interface! {
+    impl ShardedImpl: IMyAsyncOp {
+        parent = IUnknownVtbl,
+        refcount = PerCpuRefCount,
+        methods = [get_status],
+    }
+}
+
+// Object exposing one primary and eight secondary interfaces (QueryInterface dispatch)
+macro_rules! qi_interface {
+    ($name:ident, $tag:expr, $method:ident) => {
+        declare_com_interface! {
+            pub trait $name: IUnknown {
+                const IID: GUID = GUID {
+                    data1: 0x5149_0000 | $tag, data2: 0x0008, data3: 0x0000,
+                    data4: [0x9A, 0x1B, 0x2C, 0x3D, 0x4E, 0x5F, 0x60, $tag as u8],
+                };
+                fn $method(&self) -> u32;
+            }
+        }
+
+        impl $name for WideImpl {
+            fn $method(&self) -> u32 {
+                $tag
+            }
+        }
+    };
+}
+
+struct WideImpl;
+
+qi_interface!(IWide, 0x00, wide);
+qi_interface!(IWide1, 0x01, wide1);
+qi_interface!(IWide2, 0x02, wide2);
+qi_interface!(IWide3, 0x03, wide3);
+qi_interface!(IWide4, 0x04, wide4);
+qi_interface!(IWide5, 0x05, wide5);
+qi_interface!(IWide6, 0x06, wide6);
+qi_interface!(IWide7, 0x07, wide7);
+qi_interface!(IWide8, 0x08, wide8);
+
+impl_com_interface! {
+    impl WideImpl: IWide {
+        parent = IUnknownVtbl,
+        secondaries = (IWide1, IWide2, IWide3, IWide4, IWide5, IWide6, IWide7, IWide8),
+        methods = [wide],
+    }
+}
+
+macro_rules! qi_secondary {
+    ($name:ident, $index:expr, $method:ident) => {
+        impl_com_interface_multiple! {
+            impl WideImpl: $name {
+                parent = IUnknownVtbl,
+                primary = IWide,
+                index = $index,
+                secondaries = (IWide1, IWide2, IWide3, IWide4, IWide5, IWide6, IWide7, IWide8),
+                methods = [$method],
+            }
+        }
+    };
+}
+
+qi_secondary!(IWide1, 0, wide1);
+qi_secondary!(IWide2, 1, wide2);
+qi_secondary!(IWide3, 2, wide3);
+qi_secondary!(IWide4, 3, wide4);
+qi_secondary!(IWide5, 4, wide5);
+qi_secondary!(IWide6, 5, wide6);
+qi_secondary!(IWide7, 6, wide7);
+qi_secondary!(IWide8, 7, wide8);
+
+type WideObject = ComObjectN<
+    WideImpl,
+    IWideVtbl,
+    (
+        IWide1Vtbl,
+        IWide2Vtbl,
+        IWide3Vtbl,
+        IWide4Vtbl,
+        IWide5Vtbl,
+        IWide6Vtbl,
+        IWide7Vtbl,
+        IWide8Vtbl,
+    ),
+>;
+
+const WIDE_MISS_IID: GUID = GUID {
+    data1: 0x5149_00FF, data2: 0x0008, data3: 0x0000,
+    data4: [0x9A, 0x1B, 0x2C, 0x3D, 0x4E, 0x5F, 0x60, 0xFF],
+};
+
+/// Field-by-field IID chain, as `QueryInterface` matched before the dispatch table.
+#[inline(never)]
+fn linear_field_match(iids: &[GUID; 8], riid: &GUID) -> Option<usize> {
+    for (index, iid) in iids.iter().enumerate() {
+        if iid.data1 == riid.data1
+            && iid.data2 == riid.data2
+            && iid.data3 == riid.data3
+            && iid.data4 == riid.data4
+        {
+            return Some(index);
+        }
+    }
+    None
+}
+
 // =========================================================
 // 3. Standard Rust Implementation (Corresponds to ModernImpl)
 // =========================================================
@@ -115,6 +299,93 @@ where
     adj
 }
 
+const CONTENDED_THREADS: usize = 4;
+
+/// AddRef + Release through the vtable from `CONTENDED_THREADS` threads at once
+/// on one object. Reports wall time per pair as seen by each thread.
+fn measure_contended_ns(name: &str, iterations: u64, object: *mut core::ffi::c_void) -> f64 {
+    let addr = object as usize;
+    measure_contended_with(name, iterations, move || unsafe {
+        let object = addr as *mut core::ffi::c_void;
+        let vtbl = *(object as *mut *mut IUnknownVtbl);
+        ((*vtbl).AddRef)(object);
+        black_box(((*vtbl).Release)(object));
+    })
+}
+
+fn measure_contended_with<F: Fn() + Sync>(name: &str, iterations: u64, op: F) -> f64 {
+    let run = |iterations: u64| {
+        std::thread::scope(|scope| {
+            for _ in 0..CONTENDED_THREADS {
+                scope.spawn(|| {
+                    for _ in 0..iterations {
+                        op();
+                    }
+                });
+            }
+        });
+    };
+    run(WARMUP_ITERATIONS);
+    let start = Instant::now();
+    run(iterations);
+    let avg = start.elapsed().as_nanos() as f64 / iterations as f64;
+    println!("[{}] Average: {:.5} ns ({} threads)", name, avg, CONTENDED_THREADS);
+    avg
+}
+
+/// The task header's counters before they were packed into `TaskState`: one
+/// atomic each for the reference count and the scheduling flags.
+#[derive(Default)]
+struct LegacyTaskState {
+    ref_count: AtomicU32,
+    scheduled: AtomicU32,
+    completed: AtomicU32,
+    #[allow(dead_code)]
+    cancel_requested: AtomicU32,
+}
+
+impl LegacyTaskState {
+    #[inline(never)]
+    fn wake(&self) -> bool {
+        if self.completed.load(Ordering::Acquire) != 0 {
+            return false;
+        }
+        if self
+            .scheduled
+            .compare_exchange(0, 1, Ordering::AcqRel, Ordering::Acquire)
+            .is_err()
+        {
+            return false;
+        }
+        self.ref_count.fetch_add(1, Ordering::Relaxed);
+        true
+    }
+
+    /// Wake, then the DPC run: clear `scheduled`, check `completed`, take and
+    /// drop the waker's reference around a pending poll, drop the DPC's.
+    #[inline(never)]
+    fn wake_run(&self) -> bool {
+        if !self.wake() {
+            return false;
+        }
+        self.scheduled.store(0, Ordering::Release);
+        if self.completed.load(Ordering::Acquire) != 0 {
+            return false;
+        }
+        self.ref_count.fetch_add(1, Ordering::Relaxed);
+        let woken = self.scheduled.load(Ordering::Acquire) != 0;
+        self.ref_count.fetch_sub(1, Ordering::Release);
+        self.ref_count.fetch_sub(1, Ordering::Release);
+        woken
+    }
+}
+
+fn print_wakes_per_sec(name: &str, ns: f64) {
+    if ns > 0.0 {
+        println!("[{}] {:.1} M wakes/s", name, 1e3 / ns);
+    }
+}
+
 fn main() {
     const ITERATIONS: u64 = 10_000_000; // 10M loops
 
@@ -138,6 +409,15 @@ fn main() {
         }
     });
 
+    // 1b. kcom: new from a per-type pool (Corresponds to Cpp_Pooled_New)
+    measure_ns("Rust_kcom_Pool_New", ITERATIONS, baseline, || {
+        let ptr = PooledObject::new_in(PooledImpl, PoolAllocator::new(&POOLED_IMPL_POOL)).unwrap();
+        unsafe {
+            PooledObject::shim_release(ptr);
+        }
+    });
+    POOLED_IMPL_POOL.drain();
+
     #[derive(Debug)]
     struct ReadyValue {
         value: i32,
@@ -179,6 +459,200 @@ fn main() {
         }
     });
 
+    // 3a. Same call after a checked downcast to the Rust implementation (no shim)
+    let direct = unsafe { ComRef::from_raw(raw_ptr) }
+        .and_then(|com| com.downcast_impl::<MyImpl>())
+        .unwrap();
+    measure_ns("Rust_kcom_Downcast_Call", ITERATIONS, baseline, || {
+        let mut status = 0;
+        let _ret = IMyAsyncOp::get_status(black_box(direct), &mut status);
+        black_box(status);
+    });
+
+    // 3b. AddRef + Release through the vtable, atomic vs thread-affine policy
+    measure_ns("Rust_kcom_AddRef_Release", ITERATIONS, baseline, || unsafe {
+        let vtbl = *(raw_void as *mut *mut IUnknownVtbl);
+        ((*vtbl).AddRef)(raw_void);
+        black_box(((*vtbl).Release)(raw_void));
+    });
+
+    let local_void =
+        LocalObject::new_rc::<IMyLocalOpRaw>(LocalImpl).unwrap().into_raw() as *mut core::ffi::c_void;
+    measure_ns("Rust_kcom_Local_AddRef_Release", ITERATIONS, baseline, || unsafe {
+        let vtbl = *(local_void as *mut *mut IUnknownVtbl);
+        ((*vtbl).AddRef)(local_void);
+        black_box(((*vtbl).Release)(local_void));
+    });
+    unsafe {
+        LocalObject::shim_release(local_void);
+    }
+
+    // 3c. AddRef + Release contended across threads, atomic vs per-CPU policy
+    // (Corresponds to Cpp_Contended_AddRef_Release)
+    measure_contended_ns("Rust_kcom_Contended_AddRef_Release", ITERATIONS / 4, raw_void);
+
+    let sharded_void = ShardedObject::new(ShardedImpl).unwrap();
+    measure_contended_ns("Rust_kcom_PerCpu_Contended_AddRef_Release", ITERATIONS / 4, sharded_void);
+    unsafe {
+        ShardedObject::from_ptr(sharded_void).reconcile_ref_count();
+        ShardedObject::shim_release(sharded_void);
+    }
+
+    // 3d. Lock-free reader protection: epoch pin vs AddRef/Release around a call
+    measure_ns("Rust_kcom_Epoch_Pin", ITERATIONS, baseline, || {
+        let guard = kcom::epoch::pin();
+        black_box(&guard);
+    });
+    let shared_addr = raw_void as usize;
+    measure_contended_with("Rust_kcom_Contended_AddRef_Call", ITERATIONS / 4, || unsafe {
+        let object = shared_addr as *mut IMyAsyncOpRaw;
+        let vtbl = *(object as *mut *mut IUnknownVtbl);
+        ((*vtbl).AddRef)(object as *mut core::ffi::c_void);
+        let mut status = 0;
+        ((*(*object).lpVtbl).get_status)(object as *mut core::ffi::c_void, &mut status);
+        black_box(status);
+        black_box(((*vtbl).Release)(object as *mut core::ffi::c_void));
+    });
+    measure_contended_with("Rust_kcom_Contended_Epoch_Call", ITERATIONS / 4, || unsafe {
+        let guard = kcom::epoch::pin();
+        let object = shared_addr as *mut IMyAsyncOpRaw;
+        let mut status = 0;
+        ((*(*object).lpVtbl).get_status)(object as *mut core::ffi::c_void, &mut status);
+        black_box(status);
+        drop(guard);
+    });
+
+    // 3e. QueryInterface on an object with eight secondaries (last one, and a miss)
+    let wide_void = WideObject::new(WideImpl).unwrap();
+    let wide_last = <IWide8Interface as kcom::ComInterfaceInfo>::IID;
+    measure_ns("Rust_kcom_QI_8_Secondaries", ITERATIONS, baseline, || unsafe {
+        let vtbl = *(wide_void as *mut *mut IUnknownVtbl);
+        let mut out = core::ptr::null_mut();
+        ((*vtbl).QueryInterface)(wide_void, black_box(&wide_last), &mut out);
+        let out_vtbl = *(out as *mut *mut IUnknownVtbl);
+        ((*out_vtbl).Release)(black_box(out));
+    });
+    measure_ns("Rust_kcom_QI_8_Secondaries_Miss", ITERATIONS, baseline, || unsafe {
+        let vtbl = *(wide_void as *mut *mut IUnknownVtbl);
+        let mut out = core::ptr::null_mut();
+        black_box(((*vtbl).QueryInterface)(wide_void, black_box(&WIDE_MISS_IID), &mut out));
+    });
+    unsafe {
+        WideObject::shim_release(wide_void);
+    }
+
+    let wide_iids = [
+        <IWide1Interface as kcom::ComInterfaceInfo>::IID,
+        <IWide2Interface as kcom::ComInterfaceInfo>::IID,
+        <IWide3Interface as kcom::ComInterfaceInfo>::IID,
+        <IWide4Interface as kcom::ComInterfaceInfo>::IID,
+        <IWide5Interface as kcom::ComInterfaceInfo>::IID,
+        <IWide6Interface as kcom::ComInterfaceInfo>::IID,
+        <IWide7Interface as kcom::ComInterfaceInfo>::IID,
+        wide_last,
+    ];
+    measure_ns("Rust_Linear_IID_Match_8", ITERATIONS, baseline, || {
+        black_box(linear_field_match(black_box(&wide_iids), black_box(&wide_last)));
+    });
+
+    // 3f. Reader side of a swappable shared pointer: lock-free vs spinlock + AddRef
+    let shared = AtomicComRc::new(unsafe { ComRc::from_raw_addref(raw_ptr) });
+    measure_ns("Rust_kcom_AtomicComRc_Load", ITERATIONS, baseline, || {
+        black_box(shared.load());
+    });
+    measure_ns("Rust_kcom_AtomicComRc_LoadRef", ITERATIONS, baseline, || {
+        let guard = kcom::epoch::pin();
+        black_box(shared.load_ref(&guard).map(ComRef::as_ptr));
+    });
+    {
+        let guard = kcom::epoch::pin();
+        measure_ns("Rust_kcom_AtomicComRc_LoadRef_Pinned", ITERATIONS, baseline, || {
+            black_box(shared.load_ref(&guard).map(ComRef::as_ptr));
+        });
+    }
+    let locked = kcom::SpinLock::new(unsafe { ComRc::from_raw_addref(raw_ptr) });
+    measure_ns("Rust_SpinLock_ComRc_Load", ITERATIONS, baseline, || {
+        black_box(locked.lock().clone());
+    });
+    measure_ns("Rust_SpinLock_ComRc_Peek", ITERATIONS, baseline, || {
+        black_box(locked.lock().as_ref().map(ComRc::as_ptr));
+    });
+    measure_contended_with("Rust_kcom_Contended_AtomicComRc_LoadRef", ITERATIONS / 4, || {
+        let guard = kcom::epoch::pin();
+        black_box(shared.load_ref(&guard).map(ComRef::as_ptr));
+    });
+    measure_contended_with("Rust_SpinLock_Contended_ComRc_Peek", ITERATIONS / 4, || {
+        black_box(locked.lock().as_ref().map(ComRc::as_ptr));
+    });
+    drop(shared);
+    drop(locked);
+
+    // 3g. Resolving an integer handle: HandleTable vs spinlock-protected map + AddRef
+    let table = HandleTable::<IMyAsyncOpRaw>::new();
+    let mut map = HashMap::new();
+    let mut handles = Vec::new();
+    for id in 0..256u64 {
+        let rc = unsafe { ComRc::from_raw_addref(raw_ptr) }.unwrap();
+        handles.push(table.insert(rc.clone()).unwrap());
+        map.insert(id, rc);
+    }
+    let handle = handles[black_box(200)];
+    measure_ns("Rust_kcom_HandleTable_Lookup", ITERATIONS, baseline, || {
+        let guard = kcom::epoch::pin();
+        black_box(table.lookup(black_box(handle), &guard).map(|r| r.as_ptr()));
+    });
+    measure_ns("Rust_kcom_HandleTable_Get", ITERATIONS, baseline, || {
+        black_box(table.get(black_box(handle)));
+    });
+    let locked_map = kcom::SpinLock::new(map);
+    measure_ns("Rust_SpinLock_Map_Get", ITERATIONS, baseline, || {
+        black_box(locked_map.lock().get(&black_box(200)).cloned());
+    });
+    drop(table);
+    drop(locked_map);
+
+    // 3h. Lock contention: test-and-set vs queued vs reader/writer spin lock
+    let spin = kcom::SpinLock::new(0u64);
+    measure_contended_with("Rust_kcom_Contended_SpinLock", ITERATIONS / 40, || {
+        *spin.lock() += 1;
+    });
+    let queued = kcom::QueuedSpinLock::new(0u64);
+    measure_contended_with("Rust_kcom_Contended_QueuedSpinLock", ITERATIONS / 40, || {
+        let mut node = kcom::LockQueueNode::new();
+        *queued.lock(&mut node) += 1;
+    });
+    let rw = kcom::RwSpinLock::new(0u64);
+    measure_contended_with("Rust_kcom_Contended_RwSpinLock_Read", ITERATIONS / 40, || {
+        black_box(*rw.read());
+    });
+    measure_contended_with("Rust_kcom_Contended_RwSpinLock_Write", ITERATIONS / 40, || {
+        *rw.write() += 1;
+    });
+
+    // 3i. Task wake + run cycle: four separate counters vs one packed state word
+    let legacy = LegacyTaskState::default();
+    let legacy_ns = measure_ns("Rust_Legacy_Task_Wake_Run", ITERATIONS, baseline, || {
+        black_box(legacy.wake_run());
+    });
+    let state = kcom::TaskState::new();
+    let packed_ns = measure_ns("Rust_kcom_TaskState_Wake_Run", ITERATIONS, baseline, || {
+        if state.transition_to_notified() && state.transition_to_running() {
+            black_box(state.transition_to_idle());
+            black_box(state.ref_dec());
+        }
+    });
+    print_wakes_per_sec("Rust_Legacy_Task_Wake_Run", legacy_ns);
+    print_wakes_per_sec("Rust_kcom_TaskState_Wake_Run", packed_ns);
+    // Wakes racing on a task whose run is already queued.
+    legacy.scheduled.store(1, Ordering::Relaxed);
+    measure_contended_with("Rust_Legacy_Contended_Task_Wake", ITERATIONS / 4, || {
+        black_box(legacy.wake());
+    });
+    assert!(state.transition_to_notified());
+    measure_contended_with("Rust_kcom_Contended_TaskState_Wake", ITERATIONS / 4, || {
+        black_box(state.transition_to_notified());
+    });
+
     // 4. Native direct call
     let native = ModernImpl;
     measure_ns("Rust_Native_Call", ITERATIONS, baseline, || {
@@ -193,3 +667,4 @@ fn main() {
         ComObject::<MyImpl, IMyAsyncOpVtbl>::shim_release(raw_void);
     }
 }
+
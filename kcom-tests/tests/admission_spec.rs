@@ -0,0 +1,225 @@
+// tests/admission_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Admission (in-flight task and byte limits) specification tests (host mode).
+
+mod common;
+
+use core::future::Future;
+use core::pin::pin;
+use core::task::{Context, Poll};
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::Arc;
+
+use common::count_waker;
+use kcom::{Admission, AdmissionLimits, STATUS_INVALID_PARAMETER};
+
+#[test]
+fn try_acquire_enforces_task_and_byte_limits() {
+    let admission = Admission::new(AdmissionLimits {
+        max_tasks: 2,
+        max_bytes: 100,
+    });
+
+    let a = admission.try_acquire(60).unwrap();
+    assert!(admission.try_acquire(60).is_none(), "bytes over the limit");
+    let b = admission.try_acquire(40).unwrap();
+    assert_eq!(admission.in_flight(), (2, 100));
+    drop(a);
+    assert_eq!(admission.in_flight(), (1, 40));
+
+    let c = admission.try_acquire(10).unwrap();
+    assert!(admission.try_acquire(0).is_none(), "tasks over the limit");
+    drop((b, c));
+    assert_eq!(admission.in_flight(), (0, 0));
+}
+
+#[test]
+fn unlimited_admission_admits_everything_without_counting() {
+    let admission = Admission::new(AdmissionLimits::default());
+    let permits: Vec<_> = (0..1000)
+        .map(|_| admission.try_acquire(usize::MAX / 2).unwrap())
+        .collect();
+    assert_eq!(admission.in_flight(), (0, 0));
+    drop(permits);
+}
+
+#[test]
+fn acquire_waits_for_capacity_and_is_woken_on_release() {
+    let admission = Admission::new(AdmissionLimits {
+        max_tasks: 1,
+        max_bytes: 64,
+    });
+    let held = admission.try_acquire(64).unwrap();
+
+    let (wakes, waker) = count_waker();
+    let mut cx = Context::from_waker(&waker);
+    let mut reserve = pin!(admission.acquire(32));
+    assert!(reserve.as_mut().poll(&mut cx).is_pending());
+    assert_eq!(wakes.0.load(Ordering::SeqCst), 0);
+
+    drop(held);
+    assert_eq!(wakes.0.load(Ordering::SeqCst), 1);
+    let permit = match reserve.as_mut().poll(&mut cx) {
+        Poll::Ready(Ok(permit)) => permit,
+        _ => panic!("capacity was released"),
+    };
+    assert_eq!(permit.bytes(), 32);
+    assert_eq!(admission.in_flight(), (1, 32));
+}
+
+#[test]
+fn dropping_a_waiting_reserve_unlinks_it() {
+    let admission = Admission::new(AdmissionLimits {
+        max_tasks: 1,
+        max_bytes: usize::MAX - 1,
+    });
+    let held = admission.try_acquire(1).unwrap();
+
+    let (wakes, waker) = count_waker();
+    let mut cx = Context::from_waker(&waker);
+    {
+        let mut first = pin!(admission.acquire(1));
+        let mut second = pin!(admission.acquire(1));
+        assert!(first.as_mut().poll(&mut cx).is_pending());
+        assert!(second.as_mut().poll(&mut cx).is_pending());
+    }
+    drop(held);
+    assert_eq!(wakes.0.load(Ordering::SeqCst), 0);
+    assert_eq!(admission.in_flight(), (0, 0));
+}
+
+#[test]
+fn release_wakes_waiters_in_order_and_only_as_many_as_fit() {
+    let admission = Admission::new(AdmissionLimits {
+        max_tasks: 2,
+        max_bytes: 100,
+    });
+    let a = admission.try_acquire(50).unwrap();
+    let b = admission.try_acquire(50).unwrap();
+
+    let wakers: Vec<_> = (0..3).map(|_| count_waker()).collect();
+    let wakes = |i: usize| wakers[i].0.0.load(Ordering::SeqCst);
+    let mut first = Box::pin(admission.acquire(30));
+    let mut second = Box::pin(admission.acquire(30));
+    let mut third = Box::pin(admission.acquire(30));
+    for (reserve, (_, waker)) in [first.as_mut(), second.as_mut(), third.as_mut()]
+        .into_iter()
+        .zip(&wakers)
+    {
+        assert!(reserve.poll(&mut Context::from_waker(waker)).is_pending());
+    }
+
+    // One task slot freed: only the oldest waiter is woken.
+    drop(a);
+    assert_eq!((wakes(0), wakes(1), wakes(2)), (1, 0, 0));
+    let permit = match first.as_mut().poll(&mut Context::from_waker(&wakers[0].1)) {
+        Poll::Ready(Ok(permit)) => permit,
+        _ => panic!("capacity was released"),
+    };
+
+    drop(b);
+    assert_eq!((wakes(0), wakes(1), wakes(2)), (1, 1, 0));
+
+    // A woken waiter that goes away hands the wake to the next one.
+    drop(second);
+    assert_eq!(wakes(2), 1);
+    assert!(matches!(
+        third.as_mut().poll(&mut Context::from_waker(&wakers[2].1)),
+        Poll::Ready(Ok(_))
+    ));
+    drop(permit);
+}
+
+#[test]
+fn new_callers_queue_behind_a_large_waiter_that_does_not_fit_yet() {
+    let admission = Admission::new(AdmissionLimits {
+        max_tasks: 4,
+        max_bytes: 100,
+    });
+    let held = admission.try_acquire(60).unwrap();
+
+    let (large_wakes, large_waker) = count_waker();
+    let (small_wakes, small_waker) = count_waker();
+    let mut large_cx = Context::from_waker(&large_waker);
+    let mut small_cx = Context::from_waker(&small_waker);
+    let mut large = Box::pin(admission.acquire(80));
+    let mut small = Box::pin(admission.acquire(10));
+    assert!(large.as_mut().poll(&mut large_cx).is_pending());
+    // Would fit, but queues behind the large waiter.
+    assert!(small.as_mut().poll(&mut small_cx).is_pending());
+
+    // A stream of small callers does not take capacity ahead of either.
+    for _ in 0..16 {
+        assert!(admission.try_acquire(10).is_none());
+    }
+    assert_eq!(admission.in_flight(), (1, 60));
+
+    // The release is charged to both waiters before they run.
+    drop(held);
+    assert_eq!(large_wakes.0.load(Ordering::SeqCst), 1);
+    assert_eq!(small_wakes.0.load(Ordering::SeqCst), 1);
+    assert_eq!(admission.in_flight(), (2, 90));
+    assert!(admission.try_acquire(20).is_none());
+
+    let large = match large.as_mut().poll(&mut large_cx) {
+        Poll::Ready(Ok(permit)) => permit,
+        _ => panic!("capacity was charged to the waiter"),
+    };
+    let small = match small.as_mut().poll(&mut small_cx) {
+        Poll::Ready(Ok(permit)) => permit,
+        _ => panic!("capacity was charged to the waiter"),
+    };
+    assert_eq!((large.bytes(), small.bytes()), (80, 10));
+    let extra = admission.try_acquire(10).unwrap();
+    assert_eq!(admission.in_flight(), (3, 100));
+    drop((large, small, extra));
+    assert_eq!(admission.in_flight(), (0, 0));
+}
+
+#[test]
+fn acquire_rejects_requests_that_can_never_fit() {
+    let admission = Admission::new(AdmissionLimits {
+        max_tasks: 4,
+        max_bytes: 16,
+    });
+    let (_wakes, waker) = count_waker();
+    let mut cx = Context::from_waker(&waker);
+    let mut reserve = pin!(admission.acquire(17));
+    assert!(matches!(
+        reserve.as_mut().poll(&mut cx),
+        Poll::Ready(Err(s)) if s == STATUS_INVALID_PARAMETER
+    ));
+}
+
+#[test]
+fn contended_permits_never_exceed_the_limits() {
+    let admission = Arc::new(Admission::new(AdmissionLimits {
+        max_tasks: 3,
+        max_bytes: 1000,
+    }));
+    let peak = Arc::new(AtomicUsize::new(0));
+    let live = Arc::new(AtomicUsize::new(0));
+    let threads: Vec<_> = (0..8)
+        .map(|_| {
+            let (admission, peak, live) = (admission.clone(), peak.clone(), live.clone());
+            std::thread::spawn(move || {
+                for _ in 0..2000 {
+                    if let Some(permit) = admission.try_acquire(300) {
+                        let now = live.fetch_add(1, Ordering::SeqCst) + 1;
+                        peak.fetch_max(now, Ordering::SeqCst);
+                        live.fetch_sub(1, Ordering::SeqCst);
+                        drop(permit);
+                    }
+                }
+            })
+        })
+        .collect();
+    for thread in threads {
+        thread.join().unwrap();
+    }
+    assert!(peak.load(Ordering::SeqCst) <= 3);
+    assert_eq!(admission.in_flight(), (0, 0));
+}
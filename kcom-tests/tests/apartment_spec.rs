@@ -0,0 +1,278 @@
+// tests/apartment_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Apartment (serialized calls into non-Sync state) specification tests (host mode).
+
+mod common;
+
+use core::cell::Cell;
+use core::future::Future;
+use core::pin::pin;
+use core::task::{Context, Poll};
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+use std::sync::{mpsc, Arc};
+
+use common::count_waker;
+use kcom::Apartment;
+
+fn spin_on<F: Future>(future: F) -> F::Output {
+    let (_wakes, waker) = count_waker();
+    let mut cx = Context::from_waker(&waker);
+    let mut future = pin!(future);
+    loop {
+        if let Poll::Ready(output) = future.as_mut().poll(&mut cx) {
+            return output;
+        }
+        std::thread::yield_now();
+    }
+}
+
+#[derive(Default)]
+struct Counter {
+    // Deliberately not Sync: the apartment is what serializes access.
+    busy: Cell<bool>,
+    value: u64,
+}
+
+fn assert_sync<T: Sync>() {}
+
+#[test]
+fn apartment_is_sync_for_send_state() {
+    assert_sync::<Apartment<Counter>>();
+}
+
+#[test]
+fn call_runs_on_the_runner_and_returns_its_result() {
+    let apartment = Apartment::new(Counter::default());
+    let (wakes, waker) = count_waker();
+    let mut cx = Context::from_waker(&waker);
+    {
+        let mut runner = pin!(apartment.run());
+        let mut call = pin!(apartment.call(|state: &mut Counter| {
+            state.value += 5;
+            state.value * 2
+        }));
+        // Posting only queues the call.
+        assert!(call.as_mut().poll(&mut cx).is_pending());
+        assert_eq!(wakes.0.load(Ordering::SeqCst), 0);
+
+        assert!(runner.as_mut().poll(&mut cx).is_pending());
+        assert_eq!(wakes.0.load(Ordering::SeqCst), 1);
+        assert_eq!(call.as_mut().poll(&mut cx), Poll::Ready(10));
+    }
+    assert_eq!(apartment.into_inner().value, 5);
+}
+
+#[test]
+fn posting_wakes_an_idle_runner() {
+    let apartment = Apartment::new(Counter::default());
+    let (runner_wakes, runner_waker) = count_waker();
+    let (_call_wakes, call_waker) = count_waker();
+    let mut runner = pin!(apartment.run());
+    assert!(runner
+        .as_mut()
+        .poll(&mut Context::from_waker(&runner_waker))
+        .is_pending());
+    assert_eq!(runner_wakes.0.load(Ordering::SeqCst), 0);
+
+    let mut call = pin!(apartment.call(|state: &mut Counter| state.value += 1));
+    assert!(call
+        .as_mut()
+        .poll(&mut Context::from_waker(&call_waker))
+        .is_pending());
+    assert_eq!(runner_wakes.0.load(Ordering::SeqCst), 1);
+}
+
+#[test]
+fn calls_from_many_threads_never_overlap() {
+    const THREADS: usize = 8;
+    const CALLS: usize = 2000;
+    let apartment = Arc::new(Apartment::new(Counter::default()));
+    let stop = Arc::new(AtomicBool::new(false));
+    let runner = {
+        let (apartment, stop) = (apartment.clone(), stop.clone());
+        std::thread::spawn(move || {
+            let (_wakes, waker) = count_waker();
+            let mut cx = Context::from_waker(&waker);
+            let mut runner = pin!(apartment.run());
+            while !stop.load(Ordering::SeqCst) {
+                assert!(runner.as_mut().poll(&mut cx).is_pending());
+                std::thread::yield_now();
+            }
+        })
+    };
+    let threads: Vec<_> = (0..THREADS)
+        .map(|_| {
+            let apartment = apartment.clone();
+            std::thread::spawn(move || {
+                for _ in 0..CALLS {
+                    spin_on(apartment.call(|state: &mut Counter| {
+                        assert!(!state.busy.replace(true), "calls overlapped");
+                        state.value += 1;
+                        state.busy.set(false);
+                    }));
+                }
+            })
+        })
+        .collect();
+    for thread in threads {
+        thread.join().unwrap();
+    }
+    stop.store(true, Ordering::SeqCst);
+    runner.join().unwrap();
+    let apartment = Arc::try_unwrap(apartment).ok().unwrap();
+    assert_eq!(apartment.into_inner().value, (THREADS * CALLS) as u64);
+}
+
+#[test]
+fn queued_calls_run_in_posting_order_and_wake_their_callers() {
+    let apartment = Apartment::new(Vec::<u32>::new());
+    let (wakes, waker) = count_waker();
+    let mut cx = Context::from_waker(&waker);
+    let mut runner = pin!(apartment.run());
+    let mut first = pin!(apartment.call(|log: &mut Vec<u32>| {
+        log.push(1);
+        1
+    }));
+    let mut second = pin!(apartment.call(|log: &mut Vec<u32>| {
+        log.push(2);
+        2
+    }));
+    assert!(first.as_mut().poll(&mut cx).is_pending());
+    assert!(second.as_mut().poll(&mut cx).is_pending());
+
+    assert!(runner.as_mut().poll(&mut cx).is_pending());
+    assert_eq!(wakes.0.load(Ordering::SeqCst), 2);
+    assert_eq!(first.as_mut().poll(&mut cx), Poll::Ready(1));
+    assert_eq!(second.as_mut().poll(&mut cx), Poll::Ready(2));
+
+    let mut log = pin!(apartment.call(|log: &mut Vec<u32>| log.clone()));
+    assert!(log.as_mut().poll(&mut cx).is_pending());
+    assert!(runner.as_mut().poll(&mut cx).is_pending());
+    assert_eq!(log.as_mut().poll(&mut cx), Poll::Ready(vec![1, 2]));
+}
+
+#[test]
+fn runner_yields_after_a_bounded_number_of_calls() {
+    const CALLS: usize = 100;
+    let apartment = Apartment::new(0usize);
+    let (_call_wakes, call_waker) = count_waker();
+    let mut call_cx = Context::from_waker(&call_waker);
+    let mut calls: Vec<_> = (0..CALLS)
+        .map(|_| Box::pin(apartment.call(|count: &mut usize| *count += 1)))
+        .collect();
+    for call in &mut calls {
+        assert!(call.as_mut().poll(&mut call_cx).is_pending());
+    }
+
+    let (runner_wakes, runner_waker) = count_waker();
+    let mut runner_cx = Context::from_waker(&runner_waker);
+    let mut runner = Box::pin(apartment.run());
+    assert!(runner.as_mut().poll(&mut runner_cx).is_pending());
+    assert_eq!(
+        runner_wakes.0.load(Ordering::SeqCst),
+        1,
+        "a busy runner wakes itself"
+    );
+    let done = calls
+        .iter_mut()
+        .map(|call| call.as_mut().poll(&mut call_cx))
+        .filter(Poll::is_ready)
+        .count();
+    assert!(done > 0 && done < CALLS);
+
+    while runner_wakes.0.load(Ordering::SeqCst) > 0 {
+        runner_wakes.0.store(0, Ordering::SeqCst);
+        assert!(runner.as_mut().poll(&mut runner_cx).is_pending());
+    }
+    drop(calls);
+    drop(runner);
+    assert_eq!(apartment.into_inner(), CALLS);
+}
+
+#[test]
+fn dropping_a_queued_call_cancels_it() {
+    let apartment = Apartment::new(Vec::<u32>::new());
+    let (_wakes, waker) = count_waker();
+    let mut cx = Context::from_waker(&waker);
+    let mut runner = pin!(apartment.run());
+    let mut dropped = Box::pin(apartment.call(|log: &mut Vec<u32>| log.push(7)));
+    let mut kept = pin!(apartment.call(|log: &mut Vec<u32>| {
+        log.push(8);
+        log.clone()
+    }));
+    assert!(dropped.as_mut().poll(&mut cx).is_pending());
+    assert!(kept.as_mut().poll(&mut cx).is_pending());
+    drop(dropped);
+
+    assert!(runner.as_mut().poll(&mut cx).is_pending());
+    assert_eq!(kept.as_mut().poll(&mut cx), Poll::Ready(vec![8]));
+}
+
+struct CountDrop(Arc<AtomicUsize>);
+
+impl Drop for CountDrop {
+    fn drop(&mut self) {
+        self.0.fetch_add(1, Ordering::SeqCst);
+    }
+}
+
+#[test]
+fn dropping_a_running_call_returns_at_once_and_the_runner_drops_the_result() {
+    let apartment = Arc::new(Apartment::new(Vec::<u32>::new()));
+    let drops = Arc::new(AtomicUsize::new(0));
+    let (entered_tx, entered_rx) = mpsc::channel();
+    let (release_tx, release_rx) = mpsc::channel::<()>();
+
+    let (_wakes, waker) = count_waker();
+    let mut cx = Context::from_waker(&waker);
+    // Everything the closure reads is moved into it, so dropping the call
+    // while the closure runs leaves it nothing dangling.
+    let captured = vec![7u32; 64];
+    let mut call = Box::pin(apartment.call({
+        let drops = drops.clone();
+        move |log: &mut Vec<u32>| {
+            entered_tx.send(()).unwrap();
+            release_rx.recv().unwrap();
+            log.push(captured.iter().sum::<u32>() / 64);
+            CountDrop(drops)
+        }
+    }));
+    assert!(call.as_mut().poll(&mut cx).is_pending());
+
+    let runner = {
+        let apartment = apartment.clone();
+        std::thread::spawn(move || {
+            let (_wakes, waker) = count_waker();
+            let mut runner = pin!(apartment.run());
+            assert!(runner
+                .as_mut()
+                .poll(&mut Context::from_waker(&waker))
+                .is_pending());
+        })
+    };
+    entered_rx.recv().unwrap();
+    // The closure is blocked on `release`: a drop that waited would hang here.
+    drop(call);
+    assert_eq!(drops.load(Ordering::SeqCst), 0);
+
+    release_tx.send(()).unwrap();
+    runner.join().unwrap();
+    assert_eq!(drops.load(Ordering::SeqCst), 1);
+    let apartment = Arc::try_unwrap(apartment).ok().unwrap();
+    assert_eq!(apartment.into_inner(), [7]);
+}
+
+#[test]
+#[should_panic(expected = "already has a runner")]
+fn a_second_runner_panics() {
+    let apartment = Apartment::new(());
+    let (_wakes, waker) = count_waker();
+    let mut cx = Context::from_waker(&waker);
+    let mut first = pin!(apartment.run());
+    let mut second = pin!(apartment.run());
+    let _ = first.as_mut().poll(&mut cx);
+    let _ = second.as_mut().poll(&mut cx);
+}
@@ -0,0 +1,146 @@
+// tests/atomic_com_rc_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// AtomicComRc (lock-free swappable interface pointer) specification tests.
+
+mod common;
+
+use core::ffi::c_void;
+use core::sync::atomic::{AtomicBool, Ordering};
+
+use common::*;
+use kcom::*;
+
+fn ref_count(rc: &ComRc<ITestNodeRaw>) -> u32 {
+    let this = rc.as_ptr() as *mut c_void;
+    let vtbl = unsafe { *(this as *mut *mut IUnknownVtbl) };
+    unsafe { ((*vtbl).AddRef)(this) };
+    unsafe { ((*vtbl).Release)(this) }
+}
+
+#[test]
+fn load_store_swap_and_compare_exchange() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    reset_counts();
+
+    let current = AtomicComRc::<ITestNodeRaw>::empty();
+    assert!(current.load().is_none());
+
+    assert!(current.store(Some(node(1))).is_ok());
+    let first = current.load().unwrap();
+    assert_eq!(id_of(first.as_ptr()), 1);
+    // One reference held by `current`, one by `first`.
+    assert_eq!(ref_count(&first), 2);
+
+    let Ok(Some(previous)) = current.swap(Some(node(2))) else {
+        panic!("swap failed");
+    };
+    assert_eq!(previous.as_ptr(), first.as_ptr());
+    drop(previous);
+    // No reader is pinned: the reference `current` held is released at once.
+    assert_eq!(ref_count(&first), 1);
+    assert_eq!(id_of(current.load().unwrap().as_ptr()), 2);
+
+    // A stale expected value leaves the pointer alone and hands `new` back.
+    let Err(rejected) = current.compare_exchange(Some(&first), Some(node(3))) else {
+        panic!("compare_exchange succeeded against a stale value");
+    };
+    assert_eq!(id_of(rejected.as_ref().unwrap().as_ptr()), 3);
+    drop(rejected);
+    assert_eq!(id_of(current.load().unwrap().as_ptr()), 2);
+
+    let second = current.load().unwrap();
+    let Ok(Some(replaced)) = current.compare_exchange(Some(&second), None) else {
+        panic!("compare_exchange failed against the current value");
+    };
+    assert_eq!(replaced.as_ptr(), second.as_ptr());
+    assert!(current.load().is_none());
+
+    drop((first, second, replaced, current));
+    epoch::collect();
+    assert_eq!(DROPPED.load(Ordering::Relaxed), CREATED.load(Ordering::Relaxed));
+}
+
+#[test]
+fn load_ref_stays_valid_under_its_guard_after_a_store() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    reset_counts();
+
+    let current = AtomicComRc::new(Some(node(1)));
+    {
+        let guard = epoch::pin();
+        let borrowed = current.load_ref(&guard).unwrap();
+        assert!(current.store(Some(node(2))).is_ok());
+        // Still pinned: the replaced backend must not be released.
+        assert_eq!(epoch::collect(), 0);
+        assert_eq!(unsafe { ((*borrowed.lpVtbl).id)(borrowed.as_ptr() as *mut c_void) }, 1);
+        assert_eq!(DROPPED.load(Ordering::Relaxed), 0);
+    }
+    assert_eq!(epoch::collect(), 1);
+    assert_eq!(DROPPED.load(Ordering::Relaxed), 1);
+    drop(current);
+    assert_eq!(DROPPED.load(Ordering::Relaxed), 2);
+}
+
+#[test]
+fn a_store_with_no_reader_pinned_releases_the_old_value_at_once() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    reset_counts();
+
+    let current = AtomicComRc::new(Some(node(1)));
+    assert!(current.store(Some(node(2))).is_ok());
+    assert_eq!(DROPPED.load(Ordering::Relaxed), 1);
+    assert!(!epoch::has_deferred());
+    drop(current);
+    assert_eq!(DROPPED.load(Ordering::Relaxed), 2);
+}
+
+#[test]
+fn dropping_the_atomic_releases_its_reference() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    reset_counts();
+
+    let current = AtomicComRc::new(Some(node(7)));
+    let reader = current.load().unwrap();
+    drop(current);
+    assert_eq!(ref_count(&reader), 1);
+    drop(reader);
+    assert_eq!(DROPPED.load(Ordering::Relaxed), 1);
+}
+
+#[test]
+fn readers_never_observe_a_freed_backend_while_it_is_swapped() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    reset_counts();
+
+    static CURRENT: AtomicComRc<ITestNodeRaw> = AtomicComRc::empty();
+    assert!(CURRENT.store(Some(node(0))).is_ok());
+    let stop = AtomicBool::new(false);
+
+    std::thread::scope(|scope| {
+        for _ in 0..3 {
+            scope.spawn(|| {
+                let mut last = 0;
+                while !stop.load(Ordering::Relaxed) {
+                    let rc = CURRENT.load().unwrap();
+                    let id = id_of(rc.as_ptr());
+                    assert!(id >= last, "went back from {last} to {id}");
+                    last = id;
+                }
+            });
+        }
+        scope.spawn(|| {
+            for id in 1..=2_000 {
+                assert!(CURRENT.store(Some(node(id))).is_ok());
+            }
+            stop.store(true, Ordering::Relaxed);
+        });
+    });
+
+    assert!(CURRENT.store(None).is_ok());
+    epoch::collect();
+    assert_eq!(CREATED.load(Ordering::Relaxed), 2_001);
+    assert_eq!(DROPPED.load(Ordering::Relaxed), 2_001);
+}
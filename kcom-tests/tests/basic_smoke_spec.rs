@@ -251,7 +251,10 @@ fn basic_comrc_drop_after_all_refs() {
 #[cfg(feature = "async-com")]
 mod async_smoke {
     use super::*;
-    use kcom::{pin_init, AsyncOperationRaw, AsyncStatus, GlobalAllocator, InitBox, InitBoxTrait};
+    use kcom::{
+        pin_init, AsyncOperationRaw, AsyncStatus, GlobalAllocator, InitBox, InitBoxTrait, KBox,
+        KBoxError,
+    };
 
     declare_com_interface! {
         pub trait IAsyncPing: IUnknown {
@@ -286,6 +289,40 @@ mod async_smoke {
 
     impl_com_object!(AsyncFoo, IAsyncPingVtbl);
 
+    /// Initializer from outside the crate that only implements `try_pin`.
+    struct BoxedOnly(NTSTATUS);
+
+    impl InitBoxTrait<core::future::Ready<NTSTATUS>, GlobalAllocator, NTSTATUS> for BoxedOnly {
+        fn try_pin(
+            self,
+        ) -> Result<
+            core::pin::Pin<KBox<core::future::Ready<NTSTATUS>, GlobalAllocator>>,
+            KBoxError<NTSTATUS>,
+        > {
+            InitBox::new(GlobalAllocator, pin_init!(core::future::ready(self.0))).try_pin()
+        }
+    }
+
+    struct AsyncBar;
+
+    unsafe impl IAsyncPing for AsyncBar {
+        type PingAsyncFuture = core::future::Ready<NTSTATUS>;
+        type Allocator = GlobalAllocator;
+
+        fn ping_async(&self) -> impl InitBoxTrait<Self::PingAsyncFuture, Self::Allocator, NTSTATUS> {
+            BoxedOnly(STATUS_SUCCESS)
+        }
+    }
+
+    impl_com_interface! {
+        impl AsyncBar: IAsyncPing {
+            parent = IUnknownVtbl,
+            methods = [ping_async],
+        }
+    }
+
+    impl_com_object!(AsyncBar, IAsyncPingVtbl);
+
     #[test]
     fn basic_async_interface_call() {
         let _guard = TEST_LOCK.lock().unwrap();
@@ -297,11 +334,9 @@ mod async_smoke {
             assert!(!op.is_null());
 
             let op = kcom::ComRc::<AsyncOperationRaw<NTSTATUS>>::from_raw_unchecked(op);
-            let status = AsyncOperationRaw::<NTSTATUS>::get_status_raw(op.as_ptr())
-                .expect("get status");
+            let status = op.get_status().expect("get status");
             assert_eq!(status, AsyncStatus::Completed);
-            let result = AsyncOperationRaw::<NTSTATUS>::get_result_raw(op.as_ptr())
-                .expect("get result");
+            let result = op.get_result().expect("get result");
             assert_eq!(result, STATUS_SUCCESS);
         }
 
@@ -309,4 +344,24 @@ mod async_smoke {
             let _ = ComObject::<AsyncFoo, IAsyncPingVtbl>::shim_release(ptr);
         }
     }
+
+    #[test]
+    fn async_interface_call_boxes_an_initializer_without_into_pin_init() {
+        let _guard = TEST_LOCK.lock().unwrap();
+        let ptr = AsyncBar::new_com(AsyncBar).unwrap();
+
+        unsafe {
+            let vtbl = *(ptr as *mut *mut IAsyncPingVtbl);
+            let op = ((*vtbl).ping_async)(ptr as *mut core::ffi::c_void);
+            assert!(!op.is_null());
+
+            let op = kcom::ComRc::<AsyncOperationRaw<NTSTATUS>>::from_raw_unchecked(op);
+            assert_eq!(op.get_status().expect("get status"), AsyncStatus::Completed);
+            assert_eq!(op.get_result().expect("get result"), STATUS_SUCCESS);
+        }
+
+        unsafe {
+            let _ = ComObject::<AsyncBar, IAsyncPingVtbl>::shim_release(ptr);
+        }
+    }
 }
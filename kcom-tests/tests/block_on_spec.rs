@@ -0,0 +1,100 @@
+// tests/block_on_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// block_on (synchronous bridge to futures) specification tests (host mode).
+
+use core::future::Future;
+use core::pin::Pin;
+use core::task::{Context, Poll, Waker};
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex};
+use std::time::Duration;
+
+use kcom::{block_on, Apartment};
+
+/// Completes once another thread sets `done` and wakes the stored waker.
+struct Signal {
+    done: AtomicBool,
+    waker: Mutex<Option<Waker>>,
+    polls: AtomicUsize,
+}
+
+struct WaitSignal(Arc<Signal>);
+
+impl Future for WaitSignal {
+    type Output = u32;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<u32> {
+        self.0.polls.fetch_add(1, Ordering::SeqCst);
+        *self.0.waker.lock().unwrap() = Some(cx.waker().clone());
+        if self.0.done.load(Ordering::SeqCst) {
+            Poll::Ready(42)
+        } else {
+            Poll::Pending
+        }
+    }
+}
+
+#[test]
+fn block_on_returns_a_ready_output() {
+    assert_eq!(block_on(async { 7 }), 7);
+}
+
+#[test]
+fn block_on_sleeps_until_woken_from_another_thread() {
+    let signal = Arc::new(Signal {
+        done: AtomicBool::new(false),
+        waker: Mutex::new(None),
+        polls: AtomicUsize::new(0),
+    });
+    let waker_thread = {
+        let signal = signal.clone();
+        std::thread::spawn(move || {
+            std::thread::sleep(Duration::from_millis(50));
+            signal.done.store(true, Ordering::SeqCst);
+            let waker = signal.waker.lock().unwrap().take();
+            waker.unwrap().wake();
+        })
+    };
+    assert_eq!(block_on(WaitSignal(signal.clone())), 42);
+    waker_thread.join().unwrap();
+    // Parked, not spinning: one poll up front and one after the wake (plus
+    // the odd spurious unpark).
+    assert!(signal.polls.load(Ordering::SeqCst) <= 4);
+}
+
+#[test]
+fn a_waker_that_outlives_block_on_is_harmless() {
+    let signal = Arc::new(Signal {
+        done: AtomicBool::new(true),
+        waker: Mutex::new(None),
+        polls: AtomicUsize::new(0),
+    });
+    assert_eq!(block_on(WaitSignal(signal.clone())), 42);
+    let waker = signal.waker.lock().unwrap().take().unwrap();
+    waker.wake();
+}
+
+#[test]
+fn block_on_drives_apartment_calls() {
+    let apartment = Apartment::new(0u64);
+    let stop = AtomicBool::new(false);
+    std::thread::scope(|scope| {
+        // The runner polls on its own thread; each call sleeps until it is woken.
+        scope.spawn(|| {
+            let mut runner = core::pin::pin!(apartment.run());
+            let mut cx = Context::from_waker(Waker::noop());
+            while !stop.load(Ordering::SeqCst) {
+                assert!(runner.as_mut().poll(&mut cx).is_pending());
+                std::thread::yield_now();
+            }
+        });
+        for _ in 0..10 {
+            block_on(apartment.call(|value: &mut u64| *value += 1));
+        }
+        stop.store(true, Ordering::SeqCst);
+    });
+    assert_eq!(apartment.into_inner(), 10);
+}
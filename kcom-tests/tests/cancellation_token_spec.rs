@@ -0,0 +1,115 @@
+// tests/cancellation_token_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// CancellationToken (hierarchical cancellation) specification tests (host mode).
+
+use core::future::Future;
+use core::pin::Pin;
+use core::task::{Context, Poll};
+
+use kcom::{spawn_dpc_task_cancellable, CancellationToken, NTSTATUS, STATUS_SUCCESS};
+
+#[test]
+fn cancelling_a_parent_cancels_the_whole_tree() {
+    let root = CancellationToken::new().unwrap();
+    let a = root.child().unwrap();
+    let b = root.child().unwrap();
+    let a1 = a.child().unwrap();
+    let a1_clone = a1.clone();
+
+    assert!(!root.is_cancelled() && !a.is_cancelled() && !a1.is_cancelled());
+    root.cancel();
+    for token in [&root, &a, &b, &a1, &a1_clone] {
+        assert!(token.is_cancelled());
+    }
+    // Cancelling again is a no-op.
+    root.cancel();
+}
+
+#[test]
+fn cancelling_a_child_leaves_parent_and_siblings_alone() {
+    let root = CancellationToken::new().unwrap();
+    let a = root.child().unwrap();
+    let b = root.child().unwrap();
+    let a1 = a.child().unwrap();
+
+    a.cancel();
+    assert!(a.is_cancelled() && a1.is_cancelled());
+    assert!(!root.is_cancelled() && !b.is_cancelled());
+}
+
+#[test]
+fn children_of_a_cancelled_token_start_cancelled() {
+    let root = CancellationToken::new().unwrap();
+    root.cancel();
+    let child = root.child().unwrap();
+    assert!(child.is_cancelled());
+    assert!(child.child().unwrap().is_cancelled());
+}
+
+#[test]
+fn dropped_children_are_unlinked_and_keep_their_parent_alive() {
+    let root = CancellationToken::new().unwrap();
+    for _ in 0..100 {
+        drop(root.child().unwrap());
+    }
+    let kept = root.child().unwrap();
+    root.cancel();
+    assert!(kept.is_cancelled());
+
+    // A child outlives the last handle to its parent.
+    let grandchild = {
+        let parent = CancellationToken::new().unwrap();
+        parent.child().unwrap().child().unwrap()
+    };
+    assert!(!grandchild.is_cancelled());
+}
+
+#[test]
+fn cancel_races_with_children_being_created_and_dropped() {
+    for _ in 0..50 {
+        let root = CancellationToken::new().unwrap();
+        std::thread::scope(|scope| {
+            for _ in 0..3 {
+                scope.spawn(|| {
+                    for _ in 0..200 {
+                        let child = root.child().unwrap();
+                        let grandchild = child.child().unwrap();
+                        drop(child);
+                        std::hint::black_box(grandchild.is_cancelled());
+                    }
+                });
+            }
+            scope.spawn(|| root.cancel());
+        });
+        assert!(root.is_cancelled());
+        assert!(root.child().unwrap().is_cancelled());
+    }
+}
+
+struct Pending;
+
+impl Future for Pending {
+    type Output = NTSTATUS;
+
+    fn poll(self: Pin<&mut Self>, _cx: &mut Context<'_>) -> Poll<NTSTATUS> {
+        Poll::Pending
+    }
+}
+
+#[test]
+fn linking_a_task_to_a_cancelled_token_cancels_it() {
+    let token = CancellationToken::new().unwrap();
+    let running = unsafe { spawn_dpc_task_cancellable(Pending) }.unwrap();
+    assert_eq!(running.link(&token), STATUS_SUCCESS);
+    assert!(!running.is_cancelled());
+
+    token.child().unwrap().cancel();
+    assert!(!token.is_cancelled());
+    token.cancel();
+    let late = unsafe { spawn_dpc_task_cancellable(Pending) }.unwrap();
+    assert_eq!(late.link(&token), STATUS_SUCCESS);
+    assert!(late.is_cancelled());
+}
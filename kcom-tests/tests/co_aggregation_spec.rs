@@ -0,0 +1,141 @@
+// tests/co_aggregation_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Co-allocated aggregation (AggregateComObject) specification tests.
+
+use core::ffi::c_void;
+use core::sync::atomic::{AtomicU32, Ordering};
+
+use kcom::*;
+
+declare_com_interface! {
+    pub trait IOuter: IUnknown {
+        const IID: GUID = GUID {
+            data1: 0x4147_4752,
+            data2: 0x0001,
+            data3: 0x0000,
+            data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01],
+        };
+        fn outer_value(&self) -> u32;
+    }
+}
+
+declare_com_interface! {
+    pub trait IInner: IUnknown {
+        const IID: GUID = GUID {
+            data1: 0x4147_4752,
+            data2: 0x0002,
+            data3: 0x0000,
+            data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02],
+        };
+        fn inner_value(&self) -> u32;
+    }
+}
+
+static TEST_LOCK: std::sync::Mutex<()> = std::sync::Mutex::new(());
+static OUTER_DROPS: AtomicU32 = AtomicU32::new(0);
+static INNER_DROPS: AtomicU32 = AtomicU32::new(0);
+
+struct Outer {
+    value: u32,
+}
+
+impl Drop for Outer {
+    fn drop(&mut self) {
+        OUTER_DROPS.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+impl IOuter for Outer {
+    fn outer_value(&self) -> u32 {
+        self.value
+    }
+}
+
+struct Inner {
+    value: u32,
+}
+
+impl Drop for Inner {
+    fn drop(&mut self) {
+        INNER_DROPS.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+impl IInner for Inner {
+    fn inner_value(&self) -> u32 {
+        self.value
+    }
+}
+
+// The inner class stays usable on its own.
+impl_com_interface! {
+    impl Inner: IInner {
+        parent = IUnknownVtbl,
+        methods = [inner_value],
+    }
+}
+
+impl_com_interface! {
+    impl Outer: IOuter {
+        parent = IUnknownVtbl,
+        aggregate = (Inner, IInner),
+        methods = [outer_value],
+    }
+}
+
+type Aggregate = AggregateComObject<Outer, IOuterVtbl, Inner, IInnerVtbl>;
+
+fn count(this: *mut c_void) -> u32 {
+    let vtbl = unsafe { *(this as *mut *mut IUnknownVtbl) };
+    unsafe { ((*vtbl).AddRef)(this) };
+    unsafe { ((*vtbl).Release)(this) }
+}
+
+#[test]
+fn aggregate_shares_one_block_and_one_count() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    OUTER_DROPS.store(0, Ordering::Relaxed);
+    INNER_DROPS.store(0, Ordering::Relaxed);
+
+    let outer = Aggregate::new_rc::<IOuterRaw>(Outer { value: 1 }, Inner { value: 2 }).unwrap();
+    let primary = outer.as_ptr() as *mut c_void;
+    assert_eq!(unsafe { ((*outer.lpVtbl).outer_value)(primary) }, 1);
+
+    let inner = outer.query_interface::<IInnerRaw>().unwrap();
+    let entry = inner.as_ptr() as usize;
+    assert!(entry > primary as usize);
+    assert!(entry < primary as usize + core::mem::size_of::<Aggregate>());
+    assert_eq!(unsafe { ((*inner.lpVtbl).inner_value)(inner.as_ptr() as *mut c_void) }, 2);
+    assert_eq!(count(primary), 2);
+    assert_eq!(count(inner.as_ptr() as *mut c_void), 2);
+
+    // QueryInterface from the inner entry answers with the aggregate's identity.
+    let back = inner.query_interface::<IOuterRaw>().unwrap();
+    assert_eq!(back.as_ptr() as *mut c_void, primary);
+    let this = inner.as_ptr() as *mut c_void;
+    let vtbl = unsafe { *(this as *mut *mut IUnknownVtbl) };
+    let mut unknown = core::ptr::null_mut();
+    assert_eq!(unsafe { ((*vtbl).QueryInterface)(this, &IID_IUNKNOWN, &mut unknown) }, STATUS_SUCCESS);
+    assert_eq!(unknown, primary);
+    let unknown_vtbl = unsafe { *(unknown as *mut *mut IUnknownVtbl) };
+    assert_eq!(unsafe { ((*unknown_vtbl).Release)(unknown) }, 3);
+
+    drop(back);
+    drop(outer);
+    assert_eq!(OUTER_DROPS.load(Ordering::Relaxed), 0);
+    drop(inner);
+    assert_eq!(OUTER_DROPS.load(Ordering::Relaxed), 1);
+    assert_eq!(INNER_DROPS.load(Ordering::Relaxed), 1);
+}
+
+#[test]
+fn aggregate_downcasts_to_the_outer_implementation() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    let outer = Aggregate::new_rc::<IOuterRaw>(Outer { value: 5 }, Inner { value: 6 }).unwrap();
+    assert_eq!(outer.downcast_impl::<Outer>().unwrap().value, 5);
+    let standalone = ComObject::<Inner, IInnerVtbl>::new_rc::<IInnerRaw>(Inner { value: 7 }).unwrap();
+    assert_eq!(unsafe { ((*standalone.lpVtbl).inner_value)(standalone.as_ptr() as *mut c_void) }, 7);
+}
@@ -0,0 +1,270 @@
+// tests/deferred_reclaim_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Deferred destruction (DeferredRefCount / reclaim_deferred) specification tests.
+
+use core::alloc::Layout;
+use core::ffi::c_void;
+use core::sync::atomic::{AtomicU32, Ordering};
+use std::sync::Mutex;
+
+use kcom::*;
+
+declare_com_interface! {
+    pub trait IRetired: IUnknown {
+        const IID: GUID = GUID {
+            data1: 0x5245_4350,
+            data2: 0x0001,
+            data3: 0x0000,
+            data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01],
+        };
+        fn value(&self) -> u32;
+    }
+}
+
+declare_com_interface! {
+    pub trait IRetiredExtra: IUnknown {
+        const IID: GUID = GUID {
+            data1: 0x5245_4350,
+            data2: 0x0002,
+            data3: 0x0000,
+            data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02],
+        };
+        fn extra(&self) -> u32;
+    }
+}
+
+unsafe impl ThreadSafeComInterface for IRetiredRaw {}
+
+static TEST_LOCK: Mutex<()> = Mutex::new(());
+static DROP_COUNT: AtomicU32 = AtomicU32::new(0);
+static HOOK_CALLS: AtomicU32 = AtomicU32::new(0);
+static DROP_TAGS: Mutex<Vec<u32>> = Mutex::new(Vec::new());
+
+fn count_hook() {
+    HOOK_CALLS.fetch_add(1, Ordering::Relaxed);
+}
+
+/// Global-heap allocator that reports a fixed pool tag.
+struct Tagged<const TAG: u32>;
+
+impl<const TAG: u32> Allocator for Tagged<TAG> {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        unsafe { GlobalAllocator.alloc(layout) }
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        unsafe { GlobalAllocator.dealloc(ptr, layout) }
+    }
+
+    fn pool_tag(&self) -> u32 {
+        TAG
+    }
+}
+
+const TAG_A: u32 = u32::from_ne_bytes(*b"RcA_");
+const TAG_B: u32 = u32::from_ne_bytes(*b"RcB_");
+
+struct Retired {
+    value: u32,
+}
+
+impl Drop for Retired {
+    fn drop(&mut self) {
+        DROP_COUNT.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+impl IRetired for Retired {
+    fn value(&self) -> u32 {
+        self.value
+    }
+}
+
+impl_com_interface! {
+    impl Retired: IRetired {
+        parent = IUnknownVtbl,
+        refcount = DeferredRefCount,
+        methods = [value],
+    }
+}
+
+struct RetiredA;
+struct RetiredB;
+
+impl Drop for RetiredA {
+    fn drop(&mut self) {
+        DROP_TAGS.lock().unwrap().push(TAG_A);
+    }
+}
+
+impl Drop for RetiredB {
+    fn drop(&mut self) {
+        DROP_TAGS.lock().unwrap().push(TAG_B);
+    }
+}
+
+impl IRetired for RetiredA {
+    fn value(&self) -> u32 {
+        1
+    }
+}
+
+impl IRetired for RetiredB {
+    fn value(&self) -> u32 {
+        2
+    }
+}
+
+impl_com_interface! {
+    impl RetiredA: IRetired {
+        parent = IUnknownVtbl,
+        allocator = Tagged<TAG_A>,
+        refcount = DeferredRefCount,
+        methods = [value],
+    }
+}
+
+impl_com_interface! {
+    impl RetiredB: IRetired {
+        parent = IUnknownVtbl,
+        allocator = Tagged<TAG_B>,
+        refcount = DeferredRefCount,
+        methods = [value],
+    }
+}
+
+struct RetiredMulti {
+    value: u32,
+}
+
+impl Drop for RetiredMulti {
+    fn drop(&mut self) {
+        DROP_COUNT.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+impl IRetired for RetiredMulti {
+    fn value(&self) -> u32 {
+        self.value
+    }
+}
+
+impl IRetiredExtra for RetiredMulti {
+    fn extra(&self) -> u32 {
+        self.value + 1
+    }
+}
+
+impl_com_interface! {
+    impl RetiredMulti: IRetired {
+        parent = IUnknownVtbl,
+        secondaries = (IRetiredExtra),
+        refcount = DeferredRefCount,
+        methods = [value],
+    }
+}
+
+impl_com_interface_multiple! {
+    impl RetiredMulti: IRetiredExtra {
+        parent = IUnknownVtbl,
+        primary = IRetired,
+        index = 0,
+        secondaries = (IRetiredExtra),
+        refcount = DeferredRefCount,
+        methods = [extra],
+    }
+}
+
+type RetiredObject = ComObject<Retired, IRetiredVtbl, GlobalAllocator, DeferredRefCount>;
+type RetiredObjectA = ComObject<RetiredA, IRetiredVtbl, Tagged<TAG_A>, DeferredRefCount>;
+type RetiredObjectB = ComObject<RetiredB, IRetiredVtbl, Tagged<TAG_B>, DeferredRefCount>;
+type RetiredObjectN =
+    ComObjectN<RetiredMulti, IRetiredVtbl, (IRetiredExtraVtbl,), GlobalAllocator, DeferredRefCount>;
+
+#[test]
+fn final_release_defers_drop_until_reclaim() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    reclaim_deferred();
+    DROP_COUNT.store(0, Ordering::Relaxed);
+    HOOK_CALLS.store(0, Ordering::Relaxed);
+    set_reclaim_hook(count_hook);
+
+    let rc = RetiredObject::new_rc::<IRetiredRaw>(Retired { value: 4 }).unwrap();
+    assert_eq!(unsafe { ((*rc.lpVtbl).value)(rc.as_ptr() as *mut c_void) }, 4);
+    let again = rc.clone();
+    drop(rc);
+    drop(again);
+
+    assert_eq!(DROP_COUNT.load(Ordering::Relaxed), 0);
+    assert_eq!(HOOK_CALLS.load(Ordering::Relaxed), 1);
+    assert!(kcom::reclaim::has_deferred());
+
+    assert_eq!(reclaim_deferred(), 1);
+    assert_eq!(DROP_COUNT.load(Ordering::Relaxed), 1);
+    assert!(!kcom::reclaim::has_deferred());
+    assert_eq!(reclaim_deferred(), 0);
+    clear_reclaim_hook();
+}
+
+#[test]
+fn reclaim_groups_frees_by_pool_tag() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    reclaim_deferred();
+    DROP_TAGS.lock().unwrap().clear();
+
+    for _ in 0..3 {
+        let a = RetiredObjectA::new_rc_in::<IRetiredRaw>(RetiredA, Tagged::<TAG_A>).unwrap();
+        let b = RetiredObjectB::new_rc_in::<IRetiredRaw>(RetiredB, Tagged::<TAG_B>).unwrap();
+        drop(a);
+        drop(b);
+    }
+    assert!(DROP_TAGS.lock().unwrap().is_empty());
+
+    assert_eq!(reclaim_deferred(), 6);
+    let tags = DROP_TAGS.lock().unwrap().clone();
+    assert_eq!(tags.len(), 6);
+    let switches = tags.windows(2).filter(|pair| pair[0] != pair[1]).count();
+    assert_eq!(switches, 1, "frees interleaved across pool tags: {tags:?}");
+}
+
+#[test]
+fn secondary_release_retires_the_whole_object() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    reclaim_deferred();
+    DROP_COUNT.store(0, Ordering::Relaxed);
+
+    let rc = RetiredObjectN::new_rc::<IRetiredRaw>(RetiredMulti { value: 8 }).unwrap();
+    let extra = rc.query_interface::<IRetiredExtraRaw>().unwrap();
+    assert_eq!(unsafe { ((*extra.lpVtbl).extra)(extra.as_ptr() as *mut c_void) }, 9);
+    drop(rc);
+    drop(extra);
+
+    assert_eq!(DROP_COUNT.load(Ordering::Relaxed), 0);
+    assert_eq!(reclaim_deferred(), 1);
+    assert_eq!(DROP_COUNT.load(Ordering::Relaxed), 1);
+}
+
+#[test]
+fn deferred_objects_released_on_other_threads_are_reclaimed() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    reclaim_deferred();
+    DROP_COUNT.store(0, Ordering::Relaxed);
+
+    std::thread::scope(|scope| {
+        for value in 0..4 {
+            scope.spawn(move || {
+                for _ in 0..64 {
+                    let rc = RetiredObject::new_rc::<IRetiredRaw>(Retired { value }).unwrap();
+                    drop(rc);
+                }
+            });
+        }
+    });
+
+    assert_eq!(DROP_COUNT.load(Ordering::Relaxed), 0);
+    assert_eq!(reclaim_deferred(), 256);
+    assert_eq!(DROP_COUNT.load(Ordering::Relaxed), 256);
+}
@@ -0,0 +1,134 @@
+// tests/downcast_impl_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Devirtualized ComRc::downcast_impl specification tests.
+
+use core::ffi::c_void;
+
+use kcom::*;
+
+declare_com_interface! {
+    pub trait ICounter: IUnknown {
+        const IID: GUID = GUID {
+            data1: 0x4443_5354,
+            data2: 0x0001,
+            data3: 0x0000,
+            data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01],
+        };
+        fn value(&self) -> u32;
+    }
+}
+
+declare_com_interface! {
+    pub trait ILabel: IUnknown {
+        const IID: GUID = GUID {
+            data1: 0x4443_5354,
+            data2: 0x0002,
+            data3: 0x0000,
+            data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02],
+        };
+        fn label(&self) -> u32;
+    }
+}
+
+struct Counter {
+    value: u32,
+}
+
+impl ICounter for Counter {
+    fn value(&self) -> u32 {
+        self.value
+    }
+}
+
+impl_com_interface! {
+    impl Counter: ICounter {
+        parent = IUnknownVtbl,
+        methods = [value],
+    }
+}
+
+struct OtherCounter;
+
+impl ICounter for OtherCounter {
+    fn value(&self) -> u32 {
+        0
+    }
+}
+
+impl_com_interface! {
+    impl OtherCounter: ICounter {
+        parent = IUnknownVtbl,
+        lean,
+        methods = [value],
+    }
+}
+
+struct Labeled {
+    value: u32,
+}
+
+impl ICounter for Labeled {
+    fn value(&self) -> u32 {
+        self.value
+    }
+}
+
+impl ILabel for Labeled {
+    fn label(&self) -> u32 {
+        self.value * 10
+    }
+}
+
+impl_com_interface! {
+    impl Labeled: ICounter {
+        parent = IUnknownVtbl,
+        secondaries = (ILabel),
+        methods = [value],
+    }
+}
+
+impl_com_interface_multiple! {
+    impl Labeled: ILabel {
+        parent = IUnknownVtbl,
+        primary = ICounter,
+        index = 0,
+        secondaries = (ILabel),
+        methods = [label],
+    }
+}
+
+#[test]
+fn downcast_reaches_the_implementation() {
+    let rc = ComObject::<Counter, ICounterVtbl>::new_rc::<ICounterRaw>(Counter { value: 9 }).unwrap();
+    let counter = rc.downcast_impl::<Counter>().unwrap();
+    assert_eq!(counter.value(), 9);
+    assert_eq!(rc.as_com_ref().downcast_impl::<Counter>().unwrap().value, 9);
+    assert!(rc.downcast_impl::<OtherCounter>().is_none());
+}
+
+#[test]
+fn downcast_rejects_other_layouts() {
+    let rc = LeanComObject::<OtherCounter, ICounterVtbl>::new_rc::<ICounterRaw>(OtherCounter).unwrap();
+    assert!(rc.downcast_impl::<OtherCounter>().is_some());
+    assert!(rc.downcast_impl::<Counter>().is_none());
+}
+
+#[test]
+fn downcast_from_primary_and_secondary_pointers() {
+    type LabeledObject = ComObjectN<Labeled, ICounterVtbl, (ILabelVtbl,)>;
+
+    let rc = LabeledObject::new_rc::<ICounterRaw>(Labeled { value: 4 }).unwrap();
+    let label = rc.query_interface::<ILabelRaw>().unwrap();
+    assert_eq!(rc.downcast_impl::<Labeled>().unwrap().value(), 4);
+
+    let from_secondary = label.downcast_impl::<Labeled>().unwrap();
+    assert_eq!(from_secondary.label(), 40);
+    assert!(core::ptr::eq(from_secondary, rc.downcast_impl::<Labeled>().unwrap()));
+    assert_eq!(
+        unsafe { ((*label.lpVtbl).label)(label.as_ptr() as *mut c_void) },
+        from_secondary.label()
+    );
+}
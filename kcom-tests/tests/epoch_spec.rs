@@ -0,0 +1,99 @@
+// tests/epoch_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Epoch-based reclamation (epoch::pin / defer_release) specification tests.
+
+mod common;
+
+use core::sync::atomic::{AtomicBool, AtomicPtr, Ordering};
+
+use common::*;
+use kcom::*;
+
+fn reset() {
+    while epoch::has_deferred() {
+        epoch::collect();
+    }
+    reset_counts();
+}
+
+#[test]
+fn release_runs_immediately_when_no_reader_is_pinned() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    reset();
+
+    assert!(defer_release(node(1)).is_ok());
+    assert_eq!(DROPPED.load(Ordering::Relaxed), 0);
+    assert!(epoch::has_deferred());
+
+    assert_eq!(epoch::collect(), 1);
+    assert_eq!(DROPPED.load(Ordering::Relaxed), 1);
+    assert!(!epoch::has_deferred());
+}
+
+#[test]
+fn pinned_reader_holds_back_the_release() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    reset();
+
+    let shared = node(2);
+    let raw = shared.as_ptr();
+    let reader = epoch::pin();
+    // Nested pins are allowed and unpin independently.
+    drop(epoch::pin());
+
+    assert!(defer_release(shared).is_ok());
+    assert_eq!(epoch::collect(), 0);
+    assert_eq!(id_of(raw), 2);
+    assert_eq!(DROPPED.load(Ordering::Relaxed), 0);
+
+    drop(reader);
+    assert_eq!(reclaim_deferred(), 1);
+    assert_eq!(DROPPED.load(Ordering::Relaxed), 1);
+}
+
+#[test]
+fn readers_without_addref_never_observe_a_released_node() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    reset();
+
+    static CURRENT: AtomicPtr<ITestNodeRaw> = AtomicPtr::new(core::ptr::null_mut());
+    CURRENT.store(node(0).into_raw(), Ordering::Release);
+    let stop = AtomicBool::new(false);
+
+    std::thread::scope(|scope| {
+        for _ in 0..3 {
+            scope.spawn(|| {
+                let mut last = 0;
+                while !stop.load(Ordering::Relaxed) {
+                    let guard = epoch::pin();
+                    let id = id_of(CURRENT.load(Ordering::Acquire));
+                    drop(guard);
+                    assert!(id >= last, "went back from {last} to {id}");
+                    last = id;
+                }
+            });
+        }
+        scope.spawn(|| {
+            for id in 1..=2_000 {
+                let old = CURRENT.swap(node(id).into_raw(), Ordering::AcqRel);
+                let old = unsafe { ComRc::from_raw(old) }.unwrap();
+                assert!(defer_release(old).is_ok());
+                if id % 16 == 0 {
+                    epoch::collect();
+                }
+            }
+            stop.store(true, Ordering::Relaxed);
+        });
+    });
+
+    let last = CURRENT.swap(core::ptr::null_mut(), Ordering::AcqRel);
+    drop(unsafe { ComRc::from_raw(last) });
+    while epoch::has_deferred() {
+        epoch::collect();
+    }
+    assert_eq!(CREATED.load(Ordering::Relaxed), 2_001);
+    assert_eq!(DROPPED.load(Ordering::Relaxed), 2_001);
+}
@@ -3,10 +3,22 @@ mod executor_edge_spec {
     use core::future::Future;
     use core::pin::Pin;
     use core::sync::atomic::{AtomicUsize, Ordering};
-    use core::task::{Context, Poll};
+    use core::task::{Context, Poll, Waker};
     use std::sync::Arc;
+    use std::task::Wake;
 
-    use kcom::{spawn_dpc_task_cancellable, spawn_task, NTSTATUS, STATUS_SUCCESS};
+    use kcom::{
+        consume_budget, spawn_dpc_task_cancellable, spawn_dpc_task_cancellable_on, spawn_task,
+        yield_now, TaskPlacement, NTSTATUS, STATUS_SUCCESS,
+    };
+
+    struct CountWaker(AtomicUsize);
+
+    impl Wake for CountWaker {
+        fn wake(self: Arc<Self>) {
+            self.0.fetch_add(1, Ordering::Relaxed);
+        }
+    }
 
     struct CountFuture {
         polls: Arc<AtomicUsize>,
@@ -42,4 +54,40 @@ mod executor_edge_spec {
         handle.cancel();
         assert!(handle.is_cancelled());
     }
+
+    #[test]
+    fn spawn_dpc_task_cancellable_on_ignores_placement_on_host() {
+        let polls = Arc::new(AtomicUsize::new(0));
+        let placements = [
+            TaskPlacement::Any,
+            TaskPlacement::Processor { group: 0, number: 0 },
+            TaskPlacement::Node(0),
+        ];
+        for placement in placements {
+            let fut = CountFuture { polls: polls.clone() };
+            let handle = unsafe { spawn_dpc_task_cancellable_on(placement, fut) }
+                .expect("spawn placed dpc task");
+            assert!(!handle.is_cancelled());
+        }
+        assert_eq!(polls.load(Ordering::Relaxed), placements.len());
+        assert_eq!(TaskPlacement::default(), TaskPlacement::Any);
+    }
+
+    #[test]
+    fn consume_budget_is_unlimited_and_yield_now_yields_once_outside_dpc_tasks() {
+        let wakes = Arc::new(CountWaker(AtomicUsize::new(0)));
+        let waker = Waker::from(wakes.clone());
+        let mut cx = Context::from_waker(&waker);
+
+        for _ in 0..1_000 {
+            let mut budget = core::pin::pin!(consume_budget());
+            assert_eq!(budget.as_mut().poll(&mut cx), Poll::Ready(()));
+        }
+        assert_eq!(wakes.0.load(Ordering::Relaxed), 0);
+
+        let mut yielded = core::pin::pin!(yield_now());
+        assert_eq!(yielded.as_mut().poll(&mut cx), Poll::Pending);
+        assert_eq!(wakes.0.load(Ordering::Relaxed), 1);
+        assert_eq!(yielded.as_mut().poll(&mut cx), Poll::Ready(()));
+    }
 }
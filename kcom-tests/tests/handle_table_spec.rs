@@ -0,0 +1,191 @@
+// tests/handle_table_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// HandleTable (generational handle -> COM object table) specification tests.
+
+mod common;
+
+use core::alloc::Layout;
+use core::sync::atomic::{AtomicBool, AtomicU32, AtomicU64, Ordering};
+
+use common::*;
+use kcom::iunknown::STATUS_INSUFFICIENT_RESOURCES;
+use kcom::*;
+
+static CHUNK_ALLOCS: AtomicU32 = AtomicU32::new(0);
+static CHUNK_FREES: AtomicU32 = AtomicU32::new(0);
+static FAIL_CHUNKS: AtomicBool = AtomicBool::new(false);
+
+/// Global-heap allocator that counts chunk allocations and fails them while
+/// `FAIL_CHUNKS` is set.
+struct Counting;
+
+impl Allocator for Counting {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        if FAIL_CHUNKS.load(Ordering::Relaxed) {
+            return core::ptr::null_mut();
+        }
+        CHUNK_ALLOCS.fetch_add(1, Ordering::Relaxed);
+        unsafe { GlobalAllocator.alloc(layout) }
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        CHUNK_FREES.fetch_add(1, Ordering::Relaxed);
+        unsafe { GlobalAllocator.dealloc(ptr, layout) }
+    }
+}
+
+fn reset() {
+    reset_counts();
+    CHUNK_ALLOCS.store(0, Ordering::Relaxed);
+    CHUNK_FREES.store(0, Ordering::Relaxed);
+    FAIL_CHUNKS.store(false, Ordering::Relaxed);
+}
+
+#[test]
+fn removed_handles_go_stale_and_slots_are_reused() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    reset();
+
+    let table = HandleTable::<ITestNodeRaw>::new();
+    let first = table.insert(node(1)).unwrap();
+    assert_ne!(first.into_raw(), 0);
+    assert_eq!(id_of(table.get(first).unwrap().as_ptr()), 1);
+    {
+        let guard = epoch::pin();
+        assert_eq!(id_of(table.lookup(first, &guard).unwrap().as_ptr()), 1);
+    }
+
+    assert!(table.remove(first));
+    assert!(!table.remove(first));
+    assert!(table.get(first).is_none());
+    assert_eq!(table.collect(), 1);
+    assert_eq!(DROPPED.load(Ordering::Relaxed), 1);
+
+    // The slot comes back with a new generation; the old handle stays stale.
+    let second = table.insert(node(2)).unwrap();
+    assert_eq!(second.into_raw() as u32, first.into_raw() as u32);
+    assert_ne!(second, first);
+    assert!(table.get(first).is_none());
+    assert_eq!(id_of(table.get(second).unwrap().as_ptr()), 2);
+
+    assert!(table.get(ComHandle::from_raw(0)).is_none());
+    assert!(table.get(ComHandle::from_raw(u64::MAX)).is_none());
+
+    drop(table);
+    assert_eq!(DROPPED.load(Ordering::Relaxed), 2);
+}
+
+#[test]
+fn pinned_reader_keeps_a_removed_object_alive() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    reset();
+
+    let table = HandleTable::<ITestNodeRaw>::new();
+    let handle = table.insert(node(5)).unwrap();
+
+    let guard = epoch::pin();
+    let borrowed = table.lookup(handle, &guard).unwrap();
+    assert!(table.remove(handle));
+    assert_eq!(table.collect(), 0);
+    assert_eq!(id_of(borrowed.as_ptr()), 5);
+    drop(guard);
+
+    assert_eq!(table.collect(), 1);
+    assert_eq!(DROPPED.load(Ordering::Relaxed), 1);
+}
+
+#[test]
+fn table_grows_in_chunks_through_its_allocator() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    reset();
+
+    let table = HandleTable::<ITestNodeRaw, Counting>::new_in(Counting);
+    let handles: Vec<_> = (0..200).map(|id| table.insert(node(id)).unwrap()).collect();
+    // 64 + 128 + 256 slots.
+    assert_eq!(CHUNK_ALLOCS.load(Ordering::Relaxed), 3);
+    for (id, handle) in handles.iter().enumerate() {
+        assert_eq!(id_of(table.get(*handle).unwrap().as_ptr()), id as u32);
+    }
+
+    drop(table);
+    assert_eq!(CHUNK_FREES.load(Ordering::Relaxed), 3);
+    assert_eq!(DROPPED.load(Ordering::Relaxed), 200);
+}
+
+#[test]
+fn a_failed_chunk_allocation_does_not_use_up_an_index() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    reset();
+
+    let table = HandleTable::<ITestNodeRaw, Counting>::new_in(Counting);
+    let handles: Vec<_> = (0..64).map(|id| table.insert(node(id)).unwrap()).collect();
+    assert_eq!(CHUNK_ALLOCS.load(Ordering::Relaxed), 1);
+
+    // The second chunk cannot be allocated; the rejected object is released.
+    FAIL_CHUNKS.store(true, Ordering::Relaxed);
+    for id in 64..67 {
+        assert_eq!(table.insert(node(id)), Err(STATUS_INSUFFICIENT_RESOURCES));
+    }
+    assert_eq!(DROPPED.load(Ordering::Relaxed), 3);
+
+    // Once memory is back, the next insert gets the index right after the
+    // first chunk.
+    FAIL_CHUNKS.store(false, Ordering::Relaxed);
+    let next = table.insert(node(64)).unwrap();
+    assert_eq!(next.into_raw() as u32, 64);
+    assert_eq!(id_of(table.get(next).unwrap().as_ptr()), 64);
+    assert_eq!(CHUNK_ALLOCS.load(Ordering::Relaxed), 2);
+
+    drop(handles);
+    drop(table);
+    assert_eq!(DROPPED.load(Ordering::Relaxed), 68);
+}
+
+#[test]
+fn lookups_race_with_removal_and_reuse() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    reset();
+
+    const LIVE: usize = 16;
+    let table = HandleTable::<ITestNodeRaw>::new();
+    let handles: Vec<AtomicU64> = (0..LIVE as u32)
+        .map(|id| AtomicU64::new(table.insert(node(id)).unwrap().into_raw()))
+        .collect();
+    let stop = AtomicBool::new(false);
+
+    std::thread::scope(|scope| {
+        for reader in 0..3 {
+            let (table, handles, stop) = (&table, &handles, &stop);
+            scope.spawn(move || {
+                let mut i = reader;
+                while !stop.load(Ordering::Relaxed) {
+                    let handle = ComHandle::from_raw(handles[i % LIVE].load(Ordering::Acquire));
+                    let guard = epoch::pin();
+                    if let Some(object) = table.lookup(handle, &guard) {
+                        assert_eq!(id_of(object.as_ptr()) as usize % LIVE, i % LIVE);
+                    }
+                    drop(guard);
+                    i += 1;
+                }
+            });
+        }
+        scope.spawn(|| {
+            for round in 1..=200u32 {
+                for (i, slot) in handles.iter().enumerate() {
+                    let id = round * LIVE as u32 + i as u32;
+                    let fresh = table.insert(node(id)).unwrap();
+                    let old = slot.swap(fresh.into_raw(), Ordering::AcqRel);
+                    assert!(table.remove(ComHandle::from_raw(old)));
+                }
+            }
+            stop.store(true, Ordering::Relaxed);
+        });
+    });
+
+    while table.collect() != 0 {}
+    drop(table);
+    assert_eq!(DROPPED.load(Ordering::Relaxed), CREATED.load(Ordering::Relaxed));
+}
@@ -0,0 +1,169 @@
+// tests/iid_dispatch_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// QueryInterface IID dispatch-table specification tests.
+
+use core::ffi::c_void;
+
+use kcom::vtable::IidTable;
+use kcom::*;
+
+macro_rules! wide_interface {
+    ($name:ident, $tag:expr, $method:ident) => {
+        declare_com_interface! {
+            pub trait $name: IUnknown {
+                const IID: GUID = GUID {
+                    data1: 0x5749_4445,
+                    data2: 0x0008,
+                    data3: $tag,
+                    data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, $tag as u8],
+                };
+                fn $method(&self) -> u32;
+            }
+        }
+
+        impl $name for Wide {
+            fn $method(&self) -> u32 {
+                $tag as u32
+            }
+        }
+    };
+}
+
+struct Wide;
+
+wide_interface!(IWide, 0x00, wide);
+wide_interface!(IWide1, 0x01, wide1);
+wide_interface!(IWide2, 0x02, wide2);
+wide_interface!(IWide3, 0x03, wide3);
+wide_interface!(IWide4, 0x04, wide4);
+wide_interface!(IWide5, 0x05, wide5);
+wide_interface!(IWide6, 0x06, wide6);
+wide_interface!(IWide7, 0x07, wide7);
+wide_interface!(IWide8, 0x08, wide8);
+
+impl_com_interface! {
+    impl Wide: IWide {
+        parent = IUnknownVtbl,
+        secondaries = (IWide1, IWide2, IWide3, IWide4, IWide5, IWide6, IWide7, IWide8),
+        methods = [wide],
+    }
+}
+
+macro_rules! wide_secondary {
+    ($name:ident, $index:expr, $method:ident) => {
+        impl_com_interface_multiple! {
+            impl Wide: $name {
+                parent = IUnknownVtbl,
+                primary = IWide,
+                index = $index,
+                secondaries = (IWide1, IWide2, IWide3, IWide4, IWide5, IWide6, IWide7, IWide8),
+                methods = [$method],
+            }
+        }
+    };
+}
+
+wide_secondary!(IWide1, 0, wide1);
+wide_secondary!(IWide2, 1, wide2);
+wide_secondary!(IWide3, 2, wide3);
+wide_secondary!(IWide4, 3, wide4);
+wide_secondary!(IWide5, 4, wide5);
+wide_secondary!(IWide6, 5, wide6);
+wide_secondary!(IWide7, 6, wide7);
+wide_secondary!(IWide8, 7, wide8);
+
+type WideObject = ComObjectN<
+    Wide,
+    IWideVtbl,
+    (
+        IWide1Vtbl,
+        IWide2Vtbl,
+        IWide3Vtbl,
+        IWide4Vtbl,
+        IWide5Vtbl,
+        IWide6Vtbl,
+        IWide7Vtbl,
+        IWide8Vtbl,
+    ),
+>;
+
+const fn iid(data3: u16) -> GUID {
+    GUID {
+        data1: 0x5749_4445,
+        data2: 0x0008,
+        data3,
+        data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, data3 as u8],
+    }
+}
+
+#[test]
+fn guid_equality_compares_every_field() {
+    let base = iid(1);
+    assert_eq!(base, iid(1));
+    assert_ne!(base, iid(2));
+    let mut other = base;
+    other.data4[7] ^= 0x80;
+    assert_ne!(base, other);
+    let mut other = base;
+    other.data2 ^= 1;
+    assert_ne!(base, other);
+    assert_eq!(base.to_words(), iid(1).to_words());
+    assert_ne!(base.to_words(), other.to_words());
+}
+
+#[test]
+fn iid_constants_work_as_match_patterns() {
+    const FIRST: GUID = iid(1);
+    let name = |riid: GUID| match riid {
+        IID_IUNKNOWN => "unknown",
+        FIRST => "first",
+        _ => "other",
+    };
+    assert_eq!(name(IID_IUNKNOWN), "unknown");
+    assert_eq!(name(iid(1)), "first");
+    assert_eq!(name(iid(2)), "other");
+}
+
+#[test]
+fn every_secondary_resolves_through_the_table() {
+    let rc = WideObject::new_rc::<IWideRaw>(Wide).unwrap();
+
+    macro_rules! check {
+        ($raw:ident, $method:ident, $tag:expr) => {{
+            let sec = rc.query_interface::<$raw>().unwrap();
+            assert_eq!(unsafe { ((*sec.lpVtbl).$method)(sec.as_ptr() as *mut c_void) }, $tag);
+            // Querying back from the secondary reaches the same entry.
+            let again = sec.query_interface::<$raw>().unwrap();
+            assert_eq!(again.as_ptr(), sec.as_ptr());
+        }};
+    }
+
+    check!(IWide1Raw, wide1, 1);
+    check!(IWide2Raw, wide2, 2);
+    check!(IWide3Raw, wide3, 3);
+    check!(IWide4Raw, wide4, 4);
+    check!(IWide5Raw, wide5, 5);
+    check!(IWide6Raw, wide6, 6);
+    check!(IWide7Raw, wide7, 7);
+    check!(IWide8Raw, wide8, 8);
+
+    let this = rc.as_ptr() as *mut c_void;
+    let vtbl = unsafe { *(this as *mut *mut IUnknownVtbl) };
+    let mut out = core::ptr::null_mut();
+    let missing = iid(9);
+    let status = unsafe { ((*vtbl).QueryInterface)(this, &missing, &mut out) };
+    assert_eq!(status, STATUS_NOINTERFACE);
+    assert!(out.is_null());
+}
+
+#[test]
+fn table_with_duplicate_iids_falls_back_to_first_match() {
+    let iids = [iid(1), iid(2), iid(3), iid(2), iid(5), iid(6)];
+    let table: IidTable<6, 64> = IidTable::new(&iids, 100, &[0, 8, 16, 24, 32, 40]);
+    assert_eq!(table.lookup(&iid(2)), Some(108));
+    assert_eq!(table.lookup(&iid(6)), Some(140));
+    assert_eq!(table.lookup(&iid(7)), None);
+}
@@ -0,0 +1,81 @@
+// tests/lean_object_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// LeanComObject (non-aggregatable layout) specification tests.
+
+use core::ffi::c_void;
+use core::sync::atomic::{AtomicU32, Ordering};
+
+use kcom::*;
+
+declare_com_interface! {
+    pub trait ILean: IUnknown {
+        const IID: GUID = GUID {
+            data1: 0x4c45_414e,
+            data2: 0x0001,
+            data3: 0x0000,
+            data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01],
+        };
+        fn value(&self) -> u32;
+    }
+}
+
+static DROP_COUNT: AtomicU32 = AtomicU32::new(0);
+
+struct Lean {
+    value: u32,
+}
+
+impl Drop for Lean {
+    fn drop(&mut self) {
+        DROP_COUNT.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+impl ILean for Lean {
+    fn value(&self) -> u32 {
+        self.value
+    }
+}
+
+impl_com_interface! {
+    impl Lean: ILean {
+        parent = IUnknownVtbl,
+        lean,
+        methods = [value],
+    }
+}
+
+#[test]
+fn lean_layout_drops_aggregation_fields() {
+    assert!(
+        core::mem::size_of::<LeanComObject<Lean, ILeanVtbl>>()
+            < core::mem::size_of::<ComObject<Lean, ILeanVtbl>>()
+    );
+}
+
+#[test]
+fn lean_object_dispatches_queries_and_releases() {
+    DROP_COUNT.store(0, Ordering::Relaxed);
+
+    let rc = LeanComObject::<Lean, ILeanVtbl>::new_rc::<ILeanRaw>(Lean { value: 42 }).unwrap();
+    assert_eq!(unsafe { ((*rc.lpVtbl).value)(rc.as_ptr() as *mut c_void) }, 42);
+
+    let again = rc.query_interface::<ILeanRaw>().unwrap();
+    assert_eq!(again.as_ptr(), rc.as_ptr());
+
+    let this = rc.as_ptr() as *mut c_void;
+    let vtbl = unsafe { *(this as *mut *mut IUnknownVtbl) };
+    let mut out = core::ptr::null_mut();
+    let status = unsafe { ((*vtbl).QueryInterface)(this, &IID_IUNKNOWN, &mut out) };
+    assert_eq!(status, STATUS_SUCCESS);
+    assert_eq!(out, this);
+    assert_eq!(unsafe { ((*vtbl).Release)(out) }, 2);
+
+    drop(again);
+    assert_eq!(DROP_COUNT.load(Ordering::Relaxed), 0);
+    drop(rc);
+    assert_eq!(DROP_COUNT.load(Ordering::Relaxed), 1);
+}
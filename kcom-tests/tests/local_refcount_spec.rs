@@ -0,0 +1,145 @@
+// tests/local_refcount_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Thread-affine (LocalRefCount) reference-count policy specification tests.
+
+use core::ffi::c_void;
+use core::sync::atomic::{AtomicU32, Ordering};
+
+use kcom::*;
+
+declare_com_interface! {
+    pub trait ILocal: IUnknown {
+        const IID: GUID = GUID {
+            data1: 0x4c4f_4341,
+            data2: 0x0001,
+            data3: 0x0000,
+            data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01],
+        };
+        fn value(&self) -> u32;
+    }
+}
+
+declare_com_interface! {
+    pub trait ILocalExtra: IUnknown {
+        const IID: GUID = GUID {
+            data1: 0x4c4f_4341,
+            data2: 0x0002,
+            data3: 0x0000,
+            data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02],
+        };
+        fn extra(&self) -> u32;
+    }
+}
+
+unsafe impl ThreadAffineComInterface for ILocalRaw {}
+unsafe impl ThreadAffineComInterface for ILocalExtraRaw {}
+
+static DROP_COUNT: AtomicU32 = AtomicU32::new(0);
+
+struct Local {
+    value: u32,
+}
+
+impl Drop for Local {
+    fn drop(&mut self) {
+        DROP_COUNT.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+impl ILocal for Local {
+    fn value(&self) -> u32 {
+        self.value
+    }
+}
+
+impl_com_interface! {
+    impl Local: ILocal {
+        parent = IUnknownVtbl,
+        refcount = LocalRefCount,
+        methods = [value],
+    }
+}
+
+struct LocalMulti {
+    value: u32,
+}
+
+impl ILocal for LocalMulti {
+    fn value(&self) -> u32 {
+        self.value
+    }
+}
+
+impl ILocalExtra for LocalMulti {
+    fn extra(&self) -> u32 {
+        self.value + 1
+    }
+}
+
+impl_com_interface! {
+    impl LocalMulti: ILocal {
+        parent = IUnknownVtbl,
+        secondaries = (ILocalExtra),
+        refcount = LocalRefCount,
+        methods = [value],
+    }
+}
+
+impl_com_interface_multiple! {
+    impl LocalMulti: ILocalExtra {
+        parent = IUnknownVtbl,
+        primary = ILocal,
+        index = 0,
+        secondaries = (ILocalExtra),
+        refcount = LocalRefCount,
+        methods = [extra],
+    }
+}
+
+type LocalObject = ComObject<Local, ILocalVtbl, GlobalAllocator, LocalRefCount>;
+type LocalObjectN =
+    ComObjectN<LocalMulti, ILocalVtbl, (ILocalExtraVtbl,), GlobalAllocator, LocalRefCount>;
+
+#[test]
+fn local_policy_keeps_object_layout() {
+    assert_eq!(
+        core::mem::size_of::<LocalObject>(),
+        core::mem::size_of::<ComObject<Local, ILocalVtbl>>()
+    );
+}
+
+#[test]
+fn local_object_counts_and_releases() {
+    DROP_COUNT.store(0, Ordering::Relaxed);
+
+    let rc = LocalObject::new_rc::<ILocalRaw>(Local { value: 5 }).unwrap();
+    assert_eq!(unsafe { ((*rc.lpVtbl).value)(rc.as_ptr() as *mut c_void) }, 5);
+
+    let this = rc.as_ptr() as *mut c_void;
+    let vtbl = unsafe { *(this as *mut *mut IUnknownVtbl) };
+    assert_eq!(unsafe { ((*vtbl).AddRef)(this) }, 2);
+    assert_eq!(unsafe { ((*vtbl).AddRef)(this) }, 3);
+    assert_eq!(unsafe { ((*vtbl).Release)(this) }, 2);
+    assert_eq!(unsafe { ((*vtbl).Release)(this) }, 1);
+
+    let again = rc.query_interface::<ILocalRaw>().unwrap();
+    drop(rc);
+    assert_eq!(DROP_COUNT.load(Ordering::Relaxed), 0);
+    drop(again);
+    assert_eq!(DROP_COUNT.load(Ordering::Relaxed), 1);
+}
+
+#[test]
+fn local_multi_object_shares_one_count() {
+    let rc = LocalObjectN::new_rc::<ILocalRaw>(LocalMulti { value: 1 }).unwrap();
+    let extra = rc.query_interface::<ILocalExtraRaw>().unwrap();
+    assert_eq!(unsafe { ((*extra.lpVtbl).extra)(extra.as_ptr() as *mut c_void) }, 2);
+
+    let this = extra.as_ptr() as *mut c_void;
+    let vtbl = unsafe { *(this as *mut *mut IUnknownVtbl) };
+    assert_eq!(unsafe { ((*vtbl).AddRef)(this) }, 3);
+    assert_eq!(unsafe { ((*vtbl).Release)(this) }, 2);
+}
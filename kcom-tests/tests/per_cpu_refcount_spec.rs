@@ -0,0 +1,91 @@
+// tests/per_cpu_refcount_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Per-CPU (PerCpuRefCount) reference-count policy specification tests.
+
+use core::ffi::c_void;
+use core::sync::atomic::{AtomicU32, Ordering};
+
+use kcom::*;
+
+declare_com_interface! {
+    pub trait IShared: IUnknown {
+        const IID: GUID = GUID {
+            data1: 0x5043_5055,
+            data2: 0x0001,
+            data3: 0x0000,
+            data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01],
+        };
+        fn value(&self) -> u32;
+    }
+}
+
+unsafe impl ThreadSafeComInterface for ISharedRaw {}
+
+static DROP_COUNT: AtomicU32 = AtomicU32::new(0);
+
+struct Shared {
+    value: u32,
+}
+
+impl Drop for Shared {
+    fn drop(&mut self) {
+        DROP_COUNT.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+impl IShared for Shared {
+    fn value(&self) -> u32 {
+        self.value
+    }
+}
+
+impl_com_interface! {
+    impl Shared: IShared {
+        parent = IUnknownVtbl,
+        refcount = PerCpuRefCount<8>,
+        methods = [value],
+    }
+}
+
+type SharedObject = ComObject<Shared, ISharedVtbl, GlobalAllocator, PerCpuRefCount<8>>;
+
+#[test]
+fn sharded_object_survives_concurrent_churn_and_frees_after_reconcile() {
+    DROP_COUNT.store(0, Ordering::Relaxed);
+
+    let rc = SharedObject::new_rc::<ISharedRaw>(Shared { value: 3 }).unwrap();
+
+    std::thread::scope(|scope| {
+        for _ in 0..4 {
+            let rc = rc.clone();
+            scope.spawn(move || {
+                for _ in 0..10_000 {
+                    let again = rc.clone();
+                    assert_eq!(unsafe { ((*again.lpVtbl).value)(again.as_ptr() as *mut c_void) }, 3);
+                }
+            });
+        }
+    });
+
+    // References taken on one shard and dropped on another never reach zero.
+    let this = rc.as_ptr() as *mut c_void;
+    let vtbl = unsafe { *(this as *mut *mut IUnknownVtbl) };
+    assert!(unsafe { ((*vtbl).AddRef)(this) } >= 2);
+    assert!(unsafe { ((*vtbl).Release)(this) } >= 1);
+    assert_eq!(DROP_COUNT.load(Ordering::Relaxed), 0);
+
+    let keep = rc.clone();
+    unsafe { SharedObject::from_ptr(this) }.reconcile_ref_count();
+    unsafe { SharedObject::from_ptr(this) }.reconcile_ref_count();
+
+    assert_eq!(unsafe { ((*vtbl).AddRef)(this) }, 3);
+    assert_eq!(unsafe { ((*vtbl).Release)(this) }, 2);
+
+    drop(keep);
+    assert_eq!(DROP_COUNT.load(Ordering::Relaxed), 0);
+    drop(rc);
+    assert_eq!(DROP_COUNT.load(Ordering::Relaxed), 1);
+}
@@ -0,0 +1,94 @@
+// tests/sync_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// SpinLock / QueuedSpinLock / RwSpinLock specification tests (host mode).
+
+use core::sync::atomic::{AtomicBool, AtomicU32, Ordering};
+
+use kcom::sync::{LockQueueNode, QueuedSpinLock, RwSpinLock, SpinLock};
+
+const THREADS: usize = 4;
+const ROUNDS: u64 = 2_000;
+
+#[test]
+fn spin_lock_serializes_updates() {
+    let lock = SpinLock::new(0u64);
+    std::thread::scope(|scope| {
+        for _ in 0..THREADS {
+            scope.spawn(|| {
+                for _ in 0..ROUNDS {
+                    let mut value = lock.lock();
+                    let read = *value;
+                    std::hint::black_box(&mut *value);
+                    *value = read + 1;
+                }
+            });
+        }
+    });
+    assert_eq!(lock.into_inner(), THREADS as u64 * ROUNDS);
+}
+
+#[test]
+fn queued_spin_lock_serializes_updates() {
+    let lock = QueuedSpinLock::new(0u64);
+    let inside = AtomicBool::new(false);
+    std::thread::scope(|scope| {
+        for thread in 0..THREADS {
+            let (lock, inside) = (&lock, &inside);
+            scope.spawn(move || {
+                for round in 0..ROUNDS {
+                    let mut node = LockQueueNode::new();
+                    let mut value = lock.lock(&mut node);
+                    assert!(!inside.swap(true, Ordering::Relaxed), "two holders at once");
+                    *value += 1;
+                    inside.store(false, Ordering::Relaxed);
+                    drop(value);
+                    if (round + thread as u64) % 3 == 0 {
+                        lock.with(|value| *value += 1);
+                    }
+                }
+            });
+        }
+    });
+    let extra: u64 = (0..THREADS as u64)
+        .map(|thread| (0..ROUNDS).filter(|round| (round + thread) % 3 == 0).count() as u64)
+        .sum();
+    assert_eq!(lock.into_inner(), THREADS as u64 * ROUNDS + extra);
+}
+
+#[test]
+fn rw_spin_lock_shares_reads_and_excludes_writes() {
+    let lock = RwSpinLock::new((0u64, 0u64));
+
+    // A second reader gets in while the first still holds the lock.
+    let first = lock.read();
+    std::thread::scope(|scope| {
+        scope.spawn(|| assert_eq!(*lock.read(), (0, 0)));
+    });
+    drop(first);
+
+    let readers_done = AtomicU32::new(0);
+    std::thread::scope(|scope| {
+        for _ in 0..THREADS - 1 {
+            scope.spawn(|| {
+                for _ in 0..ROUNDS {
+                    let pair = lock.read();
+                    assert_eq!(pair.0, pair.1, "read a half-written pair");
+                }
+                readers_done.fetch_add(1, Ordering::Relaxed);
+            });
+        }
+        scope.spawn(|| {
+            for _ in 0..ROUNDS {
+                let mut pair = lock.write();
+                pair.0 += 1;
+                std::hint::black_box(&mut *pair);
+                pair.1 += 1;
+            }
+        });
+    });
+    assert_eq!(readers_done.load(Ordering::Relaxed), THREADS as u32 - 1);
+    assert_eq!(lock.into_inner(), (ROUNDS, ROUNDS));
+}
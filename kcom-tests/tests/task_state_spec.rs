@@ -0,0 +1,122 @@
+// tests/task_state_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Packed task state (refcount + scheduling flags) specification tests (host mode).
+
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::Barrier;
+
+use kcom::TaskState;
+
+#[test]
+fn wake_schedules_once_and_takes_a_reference() {
+    let state = TaskState::new();
+    assert_eq!(state.ref_count(), 1);
+    assert!(state.transition_to_notified());
+    assert_eq!(state.ref_count(), 2);
+    // Already queued: nothing to submit, no reference taken.
+    assert!(!state.transition_to_notified());
+    assert_eq!(state.ref_count(), 2);
+}
+
+#[test]
+fn wake_while_running_notifies_instead_of_scheduling() {
+    let state = TaskState::new();
+    assert!(state.transition_to_notified());
+    assert!(state.transition_to_running());
+
+    assert!(!state.transition_to_notified());
+    assert!(!state.transition_to_notified());
+    assert_eq!(state.ref_count(), 2);
+
+    // The run polls again, then goes idle.
+    assert!(state.transition_to_idle());
+    assert!(!state.transition_to_idle());
+    assert!(state.transition_to_notified());
+}
+
+#[test]
+fn requeue_hands_the_run_over_with_its_own_reference() {
+    let state = TaskState::new();
+    assert!(state.transition_to_notified());
+    assert!(state.transition_to_running());
+    assert!(!state.transition_to_notified());
+    assert!(state.transition_to_idle());
+
+    state.transition_to_requeued();
+    assert_eq!(state.ref_count(), 3);
+    // The old run drops its reference; the queued one starts.
+    assert!(!state.ref_dec());
+    assert!(!state.transition_to_notified());
+    assert!(state.transition_to_running());
+}
+
+#[test]
+fn completed_task_ignores_wakes_and_frees_on_last_release() {
+    let state = TaskState::new();
+    assert!(state.transition_to_notified());
+    assert!(state.transition_to_running());
+    state.transition_to_complete();
+    assert!(state.is_complete());
+
+    assert!(!state.transition_to_notified());
+    assert_eq!(state.request_cancel(), Some(false));
+    assert!(!state.ref_dec());
+    assert!(state.ref_dec());
+    assert!(!state.try_ref_inc());
+}
+
+#[test]
+fn cancellation_wakes_once_and_is_taken_once() {
+    let state = TaskState::new();
+    assert!(!state.is_cancel_requested());
+    assert!(!state.take_cancel());
+
+    assert_eq!(state.request_cancel(), Some(true));
+    assert_eq!(state.request_cancel(), None);
+    assert!(state.is_cancel_requested());
+    assert_eq!(state.ref_count(), 2);
+
+    assert!(state.take_cancel());
+    assert!(!state.take_cancel());
+    assert!(state.is_cancel_requested());
+}
+
+#[test]
+fn cancel_submit_undoes_a_failed_submission() {
+    let state = TaskState::new();
+    assert!(state.transition_to_notified());
+    state.cancel_submit();
+    assert_eq!(state.ref_count(), 1);
+    assert!(state.transition_to_notified());
+}
+
+#[test]
+fn concurrent_wakes_submit_one_run_at_a_time() {
+    const THREADS: usize = 4;
+    const WAKES: usize = 10_000;
+
+    let state = TaskState::new();
+    let submitted = AtomicUsize::new(0);
+    let barrier = Barrier::new(THREADS);
+    std::thread::scope(|scope| {
+        for _ in 0..THREADS {
+            scope.spawn(|| {
+                barrier.wait();
+                for _ in 0..WAKES {
+                    if state.transition_to_notified() {
+                        submitted.fetch_add(1, Ordering::SeqCst);
+                        // Play the queued run: at most one exists at a time.
+                        assert!(state.transition_to_running());
+                        while state.transition_to_idle() {}
+                        assert!(!state.ref_dec());
+                    }
+                }
+            });
+        }
+    });
+    assert!(submitted.load(Ordering::SeqCst) >= 1);
+    assert_eq!(state.ref_count(), 1);
+}
@@ -0,0 +1,409 @@
+// admission.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Admission control: limits on in-flight work, with async waiting for capacity.
+
+use core::cell::UnsafeCell;
+use core::future::Future;
+use core::marker::PhantomPinned;
+use core::pin::Pin;
+use core::ptr::null_mut;
+use core::sync::atomic::{fence, AtomicU32, AtomicUsize, Ordering};
+use core::task::{Context, Poll, Waker};
+
+use crate::iunknown::{NTSTATUS, STATUS_INVALID_PARAMETER};
+use crate::sync::SpinLock;
+
+/// Bounds on the work an [`Admission`] lets in at once.
+#[derive(Copy, Clone, Debug, PartialEq, Eq)]
+pub struct AdmissionLimits {
+    pub max_tasks: u32,
+    pub max_bytes: usize,
+}
+
+impl AdmissionLimits {
+    pub const UNLIMITED: Self = Self {
+        max_tasks: u32::MAX,
+        max_bytes: usize::MAX,
+    };
+}
+
+impl Default for AdmissionLimits {
+    #[inline]
+    fn default() -> Self {
+        Self::UNLIMITED
+    }
+}
+
+/// A waiting [`Reserve`]. Lives inside the pinned future; all fields belong to
+/// the admission's lock.
+struct Waiter {
+    prev: *mut Waiter,
+    next: *mut Waiter,
+    queued: bool,
+    /// Set by a wake that charged the capacity for this waiter.
+    admitted: bool,
+    bytes: usize,
+    waker: Option<Waker>,
+}
+
+/// Waiters in arrival order.
+struct WaiterList {
+    head: *mut Waiter,
+    tail: *mut Waiter,
+}
+
+// Only touched under the admission's lock.
+unsafe impl Send for WaiterList {}
+
+/// Wakers collected per pass of [`Admission::wake_waiters`]; they are called
+/// once the lock is dropped.
+const WAKE_BATCH: usize = 8;
+
+impl WaiterList {
+    unsafe fn push(&mut self, waiter: *mut Waiter) {
+        unsafe {
+            (*waiter).prev = self.tail;
+            (*waiter).next = null_mut();
+            (*waiter).queued = true;
+            if self.tail.is_null() {
+                self.head = waiter;
+            } else {
+                (*self.tail).next = waiter;
+            }
+        }
+        self.tail = waiter;
+    }
+
+    unsafe fn unlink(&mut self, waiter: *mut Waiter) {
+        unsafe {
+            let (prev, next) = ((*waiter).prev, (*waiter).next);
+            if prev.is_null() {
+                self.head = next;
+            } else {
+                (*prev).next = next;
+            }
+            if next.is_null() {
+                self.tail = prev;
+            } else {
+                (*next).prev = prev;
+            }
+            (*waiter).queued = false;
+        }
+    }
+}
+
+/// Counts in-flight tasks and bytes against [`AdmissionLimits`].
+///
+/// Producers either take capacity at once with [`try_acquire`](Self::try_acquire)
+/// or wait for it with [`acquire`](Self::acquire), so load is shed before the
+/// pool runs dry instead of after an allocation fails. Waiters are served in
+/// arrival order: a release charges the freed capacity to waiters from the
+/// head of the queue, under the lock, and stops at the first that does not
+/// fit. A woken waiter already holds its capacity. While anyone is waiting,
+/// new callers queue behind them instead of taking capacity first. The list
+/// is intrusive, so waiting never allocates.
+///
+/// With [`AdmissionLimits::UNLIMITED`] nothing is counted and every request is
+/// admitted without touching shared state.
+pub struct Admission {
+    limits: AdmissionLimits,
+    tasks: AtomicU32,
+    bytes: AtomicUsize,
+    waiting: AtomicUsize,
+    waiters: SpinLock<WaiterList>,
+}
+
+impl Admission {
+    #[inline]
+    pub const fn new(limits: AdmissionLimits) -> Self {
+        Self {
+            limits,
+            tasks: AtomicU32::new(0),
+            bytes: AtomicUsize::new(0),
+            waiting: AtomicUsize::new(0),
+            waiters: SpinLock::new(WaiterList {
+                head: null_mut(),
+                tail: null_mut(),
+            }),
+        }
+    }
+
+    #[inline]
+    pub fn limits(&self) -> AdmissionLimits {
+        self.limits
+    }
+
+    /// Admitted tasks and bytes (a racy snapshot; zero when unlimited).
+    #[inline]
+    pub fn in_flight(&self) -> (u32, usize) {
+        (
+            self.tasks.load(Ordering::Relaxed),
+            self.bytes.load(Ordering::Relaxed),
+        )
+    }
+
+    /// Takes capacity for one task of `bytes`, or returns `None` at once. Fails
+    /// while others are waiting, so it never takes capacity ahead of them.
+    #[inline]
+    pub fn try_acquire(&self, bytes: usize) -> Option<AdmissionPermit<'_>> {
+        // Lazily: a permit built for a failed charge would release it on drop.
+        self.try_charge(bytes).then(|| AdmissionPermit {
+            admission: self,
+            bytes,
+        })
+    }
+
+    /// Waits until one task of `bytes` fits. Fails with `STATUS_INVALID_PARAMETER`
+    /// if it never can.
+    #[inline]
+    pub fn acquire(&self, bytes: usize) -> Reserve<'_> {
+        Reserve {
+            admission: self,
+            bytes,
+            waiter: UnsafeCell::new(Waiter {
+                prev: null_mut(),
+                next: null_mut(),
+                queued: false,
+                admitted: false,
+                bytes,
+                waker: None,
+            }),
+            maybe_queued: false,
+            _pinned: PhantomPinned,
+        }
+    }
+
+    #[inline]
+    fn is_unlimited(&self) -> bool {
+        self.limits == AdmissionLimits::UNLIMITED
+    }
+
+    #[inline]
+    fn can_ever_fit(&self, bytes: usize) -> bool {
+        self.limits.max_tasks != 0 && bytes <= self.limits.max_bytes
+    }
+
+    /// Charges one task of `bytes` unless waiters are queued ahead of it.
+    pub(crate) fn try_charge(&self, bytes: usize) -> bool {
+        if self.is_unlimited() {
+            return true;
+        }
+        if self.waiting.load(Ordering::Acquire) != 0 {
+            return false;
+        }
+        if self.charge(bytes) {
+            return true;
+        }
+        // A task slot taken only for a moment may have turned a waiter away.
+        self.wake_waiters();
+        false
+    }
+
+    fn charge(&self, bytes: usize) -> bool {
+        let max_tasks = self.limits.max_tasks;
+        if self
+            .tasks
+            .fetch_update(Ordering::Acquire, Ordering::Relaxed, |tasks| {
+                (tasks < max_tasks).then_some(tasks + 1)
+            })
+            .is_err()
+        {
+            return false;
+        }
+        let max_bytes = self.limits.max_bytes;
+        if self
+            .bytes
+            .fetch_update(Ordering::Acquire, Ordering::Relaxed, |used| {
+                used.checked_add(bytes).filter(|&total| total <= max_bytes)
+            })
+            .is_err()
+        {
+            self.tasks.fetch_sub(1, Ordering::Release);
+            return false;
+        }
+        true
+    }
+
+    pub(crate) fn release(&self, bytes: usize) {
+        if self.is_unlimited() {
+            return;
+        }
+        self.bytes.fetch_sub(bytes, Ordering::Release);
+        self.tasks.fetch_sub(1, Ordering::Release);
+        self.wake_waiters();
+    }
+
+    /// Charges capacity to waiters from the head while it fits and wakes them.
+    /// The first one that does not fit stops the pass, so a larger request is
+    /// not overtaken by later small ones.
+    fn wake_waiters(&self) {
+        // A waiter runs this too once it has queued, so either the release
+        // sees it queued or its own pass sees the capacity freed.
+        fence(Ordering::SeqCst);
+        if self.waiting.load(Ordering::Acquire) == 0 {
+            return;
+        }
+        loop {
+            let mut wakers: [Option<Waker>; WAKE_BATCH] = [const { None }; WAKE_BATCH];
+            let mut woken = 0;
+            {
+                let mut list = self.waiters.lock();
+                while !list.head.is_null() && woken < WAKE_BATCH {
+                    let waiter = list.head;
+                    if !self.charge(unsafe { (*waiter).bytes }) {
+                        break;
+                    }
+                    unsafe {
+                        list.unlink(waiter);
+                        // The future cannot go away while we hold the lock.
+                        (*waiter).admitted = true;
+                        wakers[woken] = (*waiter).waker.take();
+                    }
+                    woken += 1;
+                    self.waiting.fetch_sub(1, Ordering::Release);
+                }
+            }
+            for waker in wakers.into_iter().flatten() {
+                waker.wake();
+            }
+            if woken < WAKE_BATCH {
+                return;
+            }
+        }
+    }
+}
+
+/// Capacity for one task, returned to its [`Admission`] on drop.
+#[must_use = "the capacity is released as soon as the permit is dropped"]
+pub struct AdmissionPermit<'a> {
+    admission: &'a Admission,
+    bytes: usize,
+}
+
+impl AdmissionPermit<'_> {
+    #[inline]
+    pub fn bytes(&self) -> usize {
+        self.bytes
+    }
+
+    /// Keeps the capacity charged; the caller releases it later.
+    #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+    #[inline]
+    pub(crate) fn into_charge(self) -> usize {
+        let bytes = self.bytes;
+        core::mem::forget(self);
+        bytes
+    }
+}
+
+impl Drop for AdmissionPermit<'_> {
+    #[inline]
+    fn drop(&mut self) {
+        self.admission.release(self.bytes);
+    }
+}
+
+/// Future returned by [`Admission::acquire`].
+#[must_use = "futures do nothing unless awaited"]
+pub struct Reserve<'a> {
+    admission: &'a Admission,
+    bytes: usize,
+    waiter: UnsafeCell<Waiter>,
+    /// Set once the waiter was queued; it may have been dequeued since.
+    maybe_queued: bool,
+    _pinned: PhantomPinned,
+}
+
+unsafe impl Send for Reserve<'_> {}
+
+impl<'a> Reserve<'a> {
+    /// Takes the waiter off the list. Returns true if a wake already charged
+    /// capacity for it; the caller then owns that charge.
+    fn dequeue(&mut self) -> bool {
+        if !self.maybe_queued {
+            return false;
+        }
+        let mut list = self.admission.waiters.lock();
+        let waiter = self.waiter.get();
+        unsafe {
+            if (*waiter).queued {
+                list.unlink(waiter);
+                self.admission.waiting.fetch_sub(1, Ordering::Release);
+            }
+            self.maybe_queued = false;
+            core::mem::replace(&mut (*waiter).admitted, false)
+        }
+    }
+
+    /// Claims the capacity a wake charged for the waiter, if it did.
+    fn take_admission(&mut self) -> bool {
+        let _list = self.admission.waiters.lock();
+        let waiter = self.waiter.get();
+        if !unsafe { core::mem::replace(&mut (*waiter).admitted, false) } {
+            return false;
+        }
+        self.maybe_queued = false;
+        true
+    }
+
+    fn permit(&self) -> Poll<Result<AdmissionPermit<'a>, NTSTATUS>> {
+        Poll::Ready(Ok(AdmissionPermit {
+            admission: self.admission,
+            bytes: self.bytes,
+        }))
+    }
+}
+
+impl<'a> Future for Reserve<'a> {
+    type Output = Result<AdmissionPermit<'a>, NTSTATUS>;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
+        // The waiter is never moved out; `Drop` unlinks it.
+        let this = unsafe { self.get_unchecked_mut() };
+        if !this.admission.can_ever_fit(this.bytes) {
+            return Poll::Ready(Err(STATUS_INVALID_PARAMETER));
+        }
+        if !this.maybe_queued && this.admission.try_charge(this.bytes) {
+            return this.permit();
+        }
+
+        {
+            let mut list = this.admission.waiters.lock();
+            let waiter = this.waiter.get();
+            unsafe {
+                if (*waiter).admitted {
+                    (*waiter).admitted = false;
+                    this.maybe_queued = false;
+                    return this.permit();
+                }
+                match &mut (*waiter).waker {
+                    Some(waker) if waker.will_wake(cx.waker()) => {}
+                    slot => *slot = Some(cx.waker().clone()),
+                }
+                if !(*waiter).queued {
+                    list.push(waiter);
+                    this.admission.waiting.fetch_add(1, Ordering::Release);
+                }
+            }
+            this.maybe_queued = true;
+        }
+        // Capacity freed before we queued found no one to hand it to.
+        this.admission.wake_waiters();
+        if this.take_admission() {
+            return this.permit();
+        }
+        Poll::Pending
+    }
+}
+
+impl Drop for Reserve<'_> {
+    fn drop(&mut self) {
+        // Admitted but never taken: give the capacity to the next waiter.
+        if self.dequeue() {
+            self.admission.release(self.bytes);
+        }
+    }
+}
@@ -9,8 +9,9 @@ use core::ptr::NonNull;
 use core::marker::PhantomData;
 #[cfg(all(feature = "driver", not(miri)))]
 use core::ffi::c_void;
+use core::sync::atomic::{AtomicPtr, Ordering};
 #[cfg(all(feature = "driver", not(miri)))]
-use core::sync::atomic::{AtomicUsize, Ordering};
+use core::sync::atomic::AtomicUsize;
 #[cfg(all(feature = "driver", not(miri)))]
 use wdk_sys::ntddk::{KeGetCurrentIrql, MmGetSystemRoutineAddress};
 #[cfg(all(feature = "driver", not(miri)))]
@@ -37,6 +38,13 @@ pub trait Allocator {
     /// # Safety
     /// `ptr` must have been allocated by this allocator with the same `layout`.
     unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout);
+
+    /// Pool tag of the blocks this allocator hands out, or zero when it has none.
+    /// Deferred reclamation groups frees by this tag.
+    #[inline]
+    fn pool_tag(&self) -> u32 {
+        0
+    }
 }
 
 /// Fallible allocation helper that returns `STATUS_INSUFFICIENT_RESOURCES` on OOM.
@@ -246,6 +254,27 @@ impl<T: ?Sized, A: Allocator> Drop for KBox<T, A> {
 
 pub trait InitBoxTrait<T, A: Allocator, E> {
     fn try_pin(self) -> Result<Pin<KBox<T, A>>, KBoxError<E>>;
+
+    /// Returns the initializer without allocating, so callers that already own
+    /// storage for `T` (e.g. an executor task slot) can construct it in place.
+    ///
+    /// Returns `Err(self)` when `T` can only be built through
+    /// [`try_pin`](Self::try_pin), which is what the default does.
+    fn into_pin_init(self) -> Result<impl PinInit<T, E>, Self>
+    where
+        Self: Sized,
+    {
+        Err::<NoPinInit, Self>(self)
+    }
+}
+
+/// Initializer type of the default [`InitBoxTrait::into_pin_init`]; never built.
+enum NoPinInit {}
+
+impl<T, E> PinInit<T, E> for NoPinInit {
+    unsafe fn init(&mut self, _ptr: *mut T) -> Result<(), E> {
+        match *self {}
+    }
 }
 
 pub struct InitBox<T, A: Allocator, E, I> {
@@ -276,6 +305,11 @@ where
     fn try_pin(self) -> Result<Pin<KBox<T, A>>, KBoxError<E>> {
         KBox::try_pin_init(self.alloc, self.init)
     }
+
+    #[inline]
+    fn into_pin_init(self) -> Result<impl PinInit<T, E>, Self> {
+        Ok(self.init)
+    }
 }
 
 #[cfg(feature = "driver")]
@@ -325,6 +359,265 @@ impl Allocator for GlobalAllocator {
     unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
         WdkAllocator::new(PoolType::NonPagedNx, GLOBAL_POOL_TAG).dealloc(ptr, layout)
     }
+
+    #[inline]
+    fn pool_tag(&self) -> u32 {
+        GLOBAL_POOL_TAG
+    }
+}
+
+/// Bounded, lock-free cache of equally sized blocks for one object type.
+///
+/// Blocks released through the pool are parked in one of the first `high_water` slots
+/// instead of going back to the backing allocator, and the next allocation that fits
+/// reuses them. Requests larger or more aligned than `layout` bypass the cache.
+///
+/// Each slot is claimed with a single-word swap, so there is no ABA window and a
+/// recycle costs one interlocked operation on each side. Blocks that find every slot
+/// taken go straight back to the backing allocator; `trim` hands everything above
+/// `low_water` back on demand.
+///
+/// Pools are meant to live in a `static`. Call `drain` before driver unload so the
+/// cached blocks are returned to the backing allocator.
+pub struct ObjectPool<const N: usize, A: Allocator = GlobalAllocator> {
+    slots: [AtomicPtr<u8>; N],
+    layout: Layout,
+    low_water: usize,
+    high_water: usize,
+    backing: A,
+}
+
+impl<const N: usize> ObjectPool<N, GlobalAllocator> {
+    /// Creates a pool of `layout`-sized blocks backed by `GlobalAllocator`.
+    #[inline]
+    pub const fn new(layout: Layout) -> Self {
+        Self::new_in(layout, GlobalAllocator)
+    }
+}
+
+impl<const N: usize, A: Allocator> ObjectPool<N, A> {
+    /// Creates a pool of `layout`-sized blocks backed by `backing`.
+    ///
+    /// The pool caches up to `N` blocks and keeps none of them across `trim`.
+    #[inline]
+    pub const fn new_in(layout: Layout, backing: A) -> Self {
+        Self {
+            slots: [const { AtomicPtr::new(ptr::null_mut()) }; N],
+            layout,
+            low_water: 0,
+            high_water: N,
+            backing,
+        }
+    }
+
+    /// Sets how many blocks `trim` keeps (`low`) and how many the pool will ever
+    /// cache (`high`). Both are clamped to `N`, and `low` to `high`.
+    #[inline]
+    pub const fn with_water_marks(mut self, low: usize, high: usize) -> Self {
+        let high = if high > N { N } else { high };
+        self.high_water = high;
+        self.low_water = if low > high { high } else { low };
+        self
+    }
+
+    #[inline]
+    pub const fn layout(&self) -> Layout {
+        self.layout
+    }
+
+    #[inline]
+    pub const fn low_water(&self) -> usize {
+        self.low_water
+    }
+
+    #[inline]
+    pub const fn high_water(&self) -> usize {
+        self.high_water
+    }
+
+    /// Number of blocks currently parked in the pool (a racy snapshot).
+    pub fn cached(&self) -> usize {
+        self.active_slots()
+            .iter()
+            .filter(|slot| !slot.load(Ordering::Relaxed).is_null())
+            .count()
+    }
+
+    /// Allocates blocks from the backing allocator until `low_water` are cached.
+    ///
+    /// Returns the number of blocks added. Stops early if the backing allocator fails.
+    pub fn prefill(&self) -> usize {
+        let mut added = 0;
+        while self.cached() < self.low_water {
+            let block = unsafe { self.backing.alloc(self.layout) };
+            if block.is_null() {
+                break;
+            }
+            if !self.push(block) {
+                unsafe { self.backing.dealloc(block, self.layout) };
+                break;
+            }
+            added += 1;
+        }
+        added
+    }
+
+    /// Returns cached blocks to the backing allocator until at most `low_water`
+    /// remain. Intended to be called from low-memory or idle callbacks.
+    ///
+    /// Returns the number of blocks released.
+    #[inline]
+    pub fn trim(&self) -> usize {
+        self.trim_to(self.low_water)
+    }
+
+    /// Returns every cached block to the backing allocator.
+    #[inline]
+    pub fn drain(&self) -> usize {
+        self.trim_to(0)
+    }
+
+    /// Returns cached blocks to the backing allocator until at most `keep` remain.
+    pub fn trim_to(&self, keep: usize) -> usize {
+        let mut excess = self.cached().saturating_sub(keep);
+        let mut released = 0;
+        // Trim from the back so the hot slots at the front stay warm.
+        for slot in self.active_slots().iter().rev() {
+            if excess == 0 {
+                break;
+            }
+            let block = slot.swap(ptr::null_mut(), Ordering::Acquire);
+            if !block.is_null() {
+                unsafe { self.backing.dealloc(block, self.layout) };
+                excess -= 1;
+                released += 1;
+            }
+        }
+        released
+    }
+
+    #[inline]
+    fn active_slots(&self) -> &[AtomicPtr<u8>] {
+        &self.slots[..self.high_water]
+    }
+
+    #[inline]
+    fn fits(&self, layout: Layout) -> bool {
+        layout.size() <= self.layout.size() && layout.align() <= self.layout.align()
+    }
+
+    #[inline]
+    fn pop(&self) -> *mut u8 {
+        for slot in self.active_slots() {
+            if slot.load(Ordering::Relaxed).is_null() {
+                continue;
+            }
+            let block = slot.swap(ptr::null_mut(), Ordering::Acquire);
+            if !block.is_null() {
+                return block;
+            }
+        }
+        ptr::null_mut()
+    }
+
+    #[inline]
+    fn push(&self, block: *mut u8) -> bool {
+        for slot in self.active_slots() {
+            if !slot.load(Ordering::Relaxed).is_null() {
+                continue;
+            }
+            if slot
+                .compare_exchange(ptr::null_mut(), block, Ordering::Release, Ordering::Relaxed)
+                .is_ok()
+            {
+                return true;
+            }
+        }
+        false
+    }
+}
+
+impl<const N: usize, A: Allocator> Allocator for ObjectPool<N, A> {
+    #[inline]
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        if !self.fits(layout) {
+            return unsafe { self.backing.alloc(layout) };
+        }
+        let block = self.pop();
+        if !block.is_null() {
+            return block;
+        }
+        unsafe { self.backing.alloc(self.layout) }
+    }
+
+    #[inline]
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        if !self.fits(layout) {
+            unsafe { self.backing.dealloc(ptr, layout) };
+            return;
+        }
+        if !self.push(ptr) {
+            unsafe { self.backing.dealloc(ptr, self.layout) };
+        }
+    }
+
+    #[inline]
+    fn pool_tag(&self) -> u32 {
+        self.backing.pool_tag()
+    }
+}
+
+impl<const N: usize, A: Allocator> Drop for ObjectPool<N, A> {
+    fn drop(&mut self) {
+        self.drain();
+    }
+}
+
+/// Allocator handle that recycles blocks through a `'static` `ObjectPool`.
+///
+/// The handle is a single pointer, so it is cheap to store inside every `ComObject`.
+/// Use it as the `A` parameter (`allocator = PoolAllocator<N>` in
+/// `impl_com_interface!`) and pass `PoolAllocator::new(&POOL)` to `new_in`.
+pub struct PoolAllocator<const N: usize, A: Allocator + 'static = GlobalAllocator> {
+    pool: &'static ObjectPool<N, A>,
+}
+
+impl<const N: usize, A: Allocator + 'static> PoolAllocator<N, A> {
+    #[inline]
+    pub const fn new(pool: &'static ObjectPool<N, A>) -> Self {
+        Self { pool }
+    }
+
+    #[inline]
+    pub const fn pool(&self) -> &'static ObjectPool<N, A> {
+        self.pool
+    }
+}
+
+impl<const N: usize, A: Allocator + 'static> Clone for PoolAllocator<N, A> {
+    #[inline]
+    fn clone(&self) -> Self {
+        *self
+    }
+}
+
+impl<const N: usize, A: Allocator + 'static> Copy for PoolAllocator<N, A> {}
+
+impl<const N: usize, A: Allocator + 'static> Allocator for PoolAllocator<N, A> {
+    #[inline]
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        unsafe { self.pool.alloc(layout) }
+    }
+
+    #[inline]
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        unsafe { self.pool.dealloc(ptr, layout) }
+    }
+
+    #[inline]
+    fn pool_tag(&self) -> u32 {
+        self.pool.pool_tag()
+    }
 }
 
 #[cfg(feature = "driver")]
@@ -598,6 +891,11 @@ impl Allocator for WdkAllocator {
         }
         unsafe { ExFreePoolWithTag(ptr as _, self.tag) }
     }
+
+    #[inline]
+    fn pool_tag(&self) -> u32 {
+        self.tag
+    }
 }
 
 #[cfg(all(feature = "driver", miri))]
@@ -616,6 +914,114 @@ impl Allocator for WdkAllocator {
     unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
         GlobalAllocator.dealloc(ptr, layout)
     }
+
+    #[inline]
+    fn pool_tag(&self) -> u32 {
+        self.tag
+    }
+}
+
+/// Non-paged or paged pool allocator that prefers memory on one NUMA node.
+///
+/// Uses `ExAllocatePool3` with a preferred-node parameter, so an exhausted node
+/// falls back to any node instead of failing. On systems without
+/// `ExAllocatePool3`, and for over-aligned layouts, it allocates like
+/// [`WdkAllocator`]. Memory is freed the same way by both types, so either can
+/// release it.
+#[cfg(feature = "driver")]
+#[derive(Copy, Clone)]
+pub struct WdkNodeAllocator {
+    pub pool: PoolType,
+    pub tag: u32,
+    pub node: u16,
+}
+
+#[cfg(feature = "driver")]
+impl WdkNodeAllocator {
+    #[inline]
+    pub const fn new(pool: PoolType, tag: u32, node: u16) -> Self {
+        Self { pool, tag, node }
+    }
+
+    #[inline]
+    const fn fallback(&self) -> WdkAllocator {
+        WdkAllocator::new(self.pool, self.tag)
+    }
+}
+
+#[cfg(all(feature = "driver", not(miri)))]
+impl WdkNodeAllocator {
+    #[inline]
+    unsafe fn alloc_on_node(&self, layout: Layout, zeroed: bool) -> *mut u8 {
+        #[cfg(feature = "wdk-alloc-align")]
+        let overaligned = needs_overaligned(layout);
+        #[cfg(not(feature = "wdk-alloc-align"))]
+        let overaligned = layout.align() > WDK_ALLOC_ALIGNMENT;
+        if layout.size() == 0 || overaligned {
+            let fallback = self.fallback();
+            return if zeroed {
+                unsafe { fallback.alloc_zeroed(layout) }
+            } else {
+                unsafe { fallback.alloc_uninitialized(layout) }
+            };
+        }
+        let ptr = unsafe {
+            ex_allocate_pool_on_node(self.pool, layout.size(), self.tag, self.node, zeroed)
+        };
+        ptr as *mut u8
+    }
+
+    /// Allocate memory without zeroing. Caller must fully initialize the buffer.
+    #[inline]
+    pub unsafe fn alloc_uninitialized(&self, layout: Layout) -> *mut u8 {
+        unsafe { self.alloc_on_node(layout, false) }
+    }
+}
+
+#[cfg(all(feature = "driver", miri))]
+impl WdkNodeAllocator {
+    /// Miri stub: use the global allocator.
+    #[inline]
+    pub unsafe fn alloc_uninitialized(&self, layout: Layout) -> *mut u8 {
+        GlobalAllocator.alloc(layout)
+    }
+}
+
+#[cfg(feature = "driver")]
+impl Allocator for WdkNodeAllocator {
+    #[cfg(not(miri))]
+    #[inline]
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        unsafe { self.alloc_on_node(layout, false) }
+    }
+
+    #[cfg(not(miri))]
+    #[inline]
+    unsafe fn alloc_zeroed(&self, layout: Layout) -> *mut u8 {
+        unsafe { self.alloc_on_node(layout, true) }
+    }
+
+    #[cfg(miri)]
+    #[inline]
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        GlobalAllocator.alloc(layout)
+    }
+
+    #[cfg(miri)]
+    #[inline]
+    unsafe fn alloc_zeroed(&self, layout: Layout) -> *mut u8 {
+        GlobalAllocator.alloc_zeroed(layout)
+    }
+
+    #[inline]
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        unsafe { self.fallback().dealloc(ptr, layout) }
+    }
+
+    #[inline]
+    fn pool_tag(&self) -> u32 {
+        self.tag
+    }
 }
 
 #[cfg(all(feature = "driver", not(miri)))]
@@ -633,6 +1039,24 @@ const POOL_TYPE_NON_PAGED_NX: u32 = 512;
 #[cfg(all(feature = "driver", not(miri)))]
 type ExAllocatePool2Fn = unsafe extern "C" fn(u64, usize, u32) -> *mut c_void;
 
+#[cfg(all(feature = "driver", not(miri)))]
+type ExAllocatePool3Fn =
+    unsafe extern "C" fn(u64, usize, u32, *const PoolExtendedParameter, u32) -> *mut c_void;
+
+/// `POOL_EXTENDED_PARAMETER`: the low byte of `header` is the parameter type.
+#[cfg(all(feature = "driver", not(miri)))]
+#[repr(C)]
+struct PoolExtendedParameter {
+    header: u64,
+    value: u64,
+}
+
+#[cfg(all(feature = "driver", not(miri)))]
+const POOL_EXTENDED_PARAMETER_NUMA_NODE: u64 = 3;
+/// Prefer the requested node but take memory from any node rather than fail.
+#[cfg(all(feature = "driver", not(miri)))]
+const MM_ANY_NODE_OK: u64 = 0x8000_0000;
+
 #[cfg(all(feature = "driver", not(miri)))]
 const EX_ALLOCATE_POOL2_NAME: [u16; 16] = [
     b'E' as u16,
@@ -653,6 +1077,13 @@ const EX_ALLOCATE_POOL2_NAME: [u16; 16] = [
     0,
 ];
 
+#[cfg(all(feature = "driver", not(miri)))]
+const EX_ALLOCATE_POOL3_NAME: [u16; 16] = {
+    let mut name = EX_ALLOCATE_POOL2_NAME;
+    name[14] = b'3' as u16;
+    name
+};
+
 #[cfg(all(feature = "driver", not(miri)))]
 const EX_ALLOCATE_POOL2_STATE_UNINIT: usize = 0;
 #[cfg(all(feature = "driver", not(miri)))]
@@ -662,9 +1093,12 @@ const EX_ALLOCATE_POOL2_STATE_READY: usize = 2;
 #[cfg(all(feature = "driver", not(miri)))]
 static EX_ALLOCATE_POOL2_PTR: AtomicUsize = AtomicUsize::new(0);
 #[cfg(all(feature = "driver", not(miri)))]
+static EX_ALLOCATE_POOL3_PTR: AtomicUsize = AtomicUsize::new(0);
+#[cfg(all(feature = "driver", not(miri)))]
 static EX_ALLOCATE_POOL2_STATE: AtomicUsize = AtomicUsize::new(EX_ALLOCATE_POOL2_STATE_UNINIT);
 
-/// Resolve ExAllocatePool2 at PASSIVE_LEVEL (e.g. DriverEntry) and cache it.
+/// Resolve ExAllocatePool2 (and ExAllocatePool3, used by [`WdkNodeAllocator`]) at
+/// PASSIVE_LEVEL (e.g. DriverEntry) and cache them.
 ///
 /// Calling this in DriverEntry ensures ExAllocatePool2 is used even when later
 /// allocations happen at elevated IRQL. Allocations will lazily attempt to
@@ -714,6 +1148,37 @@ unsafe fn ex_allocate_pool_uninitialized(pool: PoolType, size: usize, tag: u32)
     unsafe { ExAllocatePoolWithTag(pool_type, size, tag) }
 }
 
+/// Allocates from `pool`, preferring memory on `node`. Falls back to
+/// [`ex_allocate_pool`] when ExAllocatePool3 is unavailable.
+#[cfg(all(feature = "driver", not(miri)))]
+unsafe fn ex_allocate_pool_on_node(
+    pool: PoolType,
+    size: usize,
+    tag: u32,
+    node: u16,
+    zeroed: bool,
+) -> *mut c_void {
+    let Some(func) = (unsafe { get_ex_allocate_pool3() }) else {
+        return if zeroed {
+            unsafe { ex_allocate_pool(pool, size, tag) }
+        } else {
+            unsafe { ex_allocate_pool_uninitialized(pool, size, tag) }
+        };
+    };
+    let mut flags = match pool {
+        PoolType::NonPagedNx => POOL_FLAG_NON_PAGED,
+        PoolType::Paged => POOL_FLAG_PAGED,
+    };
+    if !zeroed {
+        flags |= POOL_FLAG_UNINITIALIZED;
+    }
+    let parameter = PoolExtendedParameter {
+        header: POOL_EXTENDED_PARAMETER_NUMA_NODE,
+        value: node as u64 | MM_ANY_NODE_OK,
+    };
+    unsafe { func(flags, size, tag, &parameter, 1) }
+}
+
 #[cfg(all(feature = "driver", not(miri)))]
 unsafe fn try_init_ex_allocate_pool2() {
     let irql = unsafe { KeGetCurrentIrql() };
@@ -739,6 +1204,10 @@ unsafe fn try_init_ex_allocate_pool2() {
     };
     let ptr = unsafe { MmGetSystemRoutineAddress(&mut name) };
     EX_ALLOCATE_POOL2_PTR.store(ptr as usize, Ordering::Release);
+
+    name.Buffer = EX_ALLOCATE_POOL3_NAME.as_ptr() as *mut u16;
+    let ptr = unsafe { MmGetSystemRoutineAddress(&mut name) };
+    EX_ALLOCATE_POOL3_PTR.store(ptr as usize, Ordering::Release);
     EX_ALLOCATE_POOL2_STATE.store(EX_ALLOCATE_POOL2_STATE_READY, Ordering::Release);
 }
 
@@ -758,6 +1227,18 @@ unsafe fn get_ex_allocate_pool2() -> Option<ExAllocatePool2Fn> {
     }
 }
 
+#[cfg(all(feature = "driver", not(miri)))]
+unsafe fn get_ex_allocate_pool3() -> Option<ExAllocatePool3Fn> {
+    // Resolved together with ExAllocatePool2.
+    unsafe { get_ex_allocate_pool2() }?;
+    let ptr = EX_ALLOCATE_POOL3_PTR.load(Ordering::Acquire);
+    if ptr == 0 {
+        None
+    } else {
+        Some(unsafe { core::mem::transmute(ptr) })
+    }
+}
+
 #[cfg(all(feature = "driver", not(miri)))]
 unsafe extern "C" {
     fn ExAllocatePoolWithTag(pool_type: u32, number_of_bytes: usize, tag: u32) -> *mut c_void;
@@ -0,0 +1,390 @@
+// apartment.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Apartments: state reached only through calls that run one at a time.
+
+use core::cell::UnsafeCell;
+use core::future::Future;
+use core::marker::PhantomPinned;
+use core::pin::Pin;
+use core::ptr::null_mut;
+use core::sync::atomic::{AtomicBool, AtomicU32, Ordering};
+use core::task::{Context, Poll, Waker};
+
+use crate::executor::{is_cancellation_requested, poll_proceed};
+use crate::sync::{SpinLock, SpinLockGuard};
+
+const CALL_IDLE: u32 = 0;
+const CALL_POSTED: u32 = 1;
+const CALL_RUNNING: u32 = 2;
+const CALL_DONE: u32 = 3;
+const CALL_TAKEN: u32 = 4;
+
+/// Messages a runner handles per poll before it yields.
+const RUN_BUDGET: usize = 32;
+
+/// Mailbox entry embedded in an [`ApartmentCall`]. Everything but the `run`
+/// pointer is only touched under the mailbox lock once the call is posted.
+struct MessageHeader<T> {
+    prev: *mut MessageHeader<T>,
+    next: *mut MessageHeader<T>,
+    /// Written under the lock; the call reads `CALL_IDLE` and `CALL_TAKEN`,
+    /// which only it sets, without it.
+    state: AtomicU32,
+    waker: Option<Waker>,
+    run: unsafe fn(*mut MessageHeader<T>, &Apartment<T>, SpinLockGuard<'_, Mailbox<T>>),
+}
+
+#[repr(C)]
+struct Message<T, C, R> {
+    header: MessageHeader<T>,
+    call: Option<C>,
+    result: Option<R>,
+}
+
+impl<T, C, R> Message<T, C, R>
+where
+    C: FnOnce(&mut T) -> R,
+{
+    /// Runs a message the runner has just unlinked and made current. The lock
+    /// is dropped around the closure, so the call may be dropped meanwhile;
+    /// it then clears `current` and the result goes with the runner.
+    unsafe fn run(
+        header: *mut MessageHeader<T>,
+        apartment: &Apartment<T>,
+        mailbox: SpinLockGuard<'_, Mailbox<T>>,
+    ) {
+        let message = header as *mut Self;
+        let call = unsafe { (*message).call.take() };
+        drop(mailbox);
+        let result = call.map(|call| call(unsafe { &mut *apartment.state.get() }));
+
+        let mut mailbox = apartment.mailbox.lock();
+        if mailbox.current != header {
+            drop(mailbox);
+            drop(result);
+            return;
+        }
+        mailbox.current = null_mut();
+        let waker = unsafe {
+            (*message).result = result;
+            (*header).state.store(CALL_DONE, Ordering::Relaxed);
+            (*header).waker.take()
+        };
+        drop(mailbox);
+        if let Some(waker) = waker {
+            waker.wake();
+        }
+    }
+}
+
+/// FIFO of posted messages, plus what the runner needs to find them.
+struct Mailbox<T> {
+    head: *mut MessageHeader<T>,
+    tail: *mut MessageHeader<T>,
+    /// The message whose closure is running; a drop of its call clears it.
+    current: *mut MessageHeader<T>,
+    /// Set by a runner that found the mailbox empty.
+    runner: Option<Waker>,
+}
+
+// Only touched under the apartment's lock.
+unsafe impl<T> Send for Mailbox<T> {}
+
+impl<T> Mailbox<T> {
+    unsafe fn push(&mut self, message: *mut MessageHeader<T>) {
+        unsafe {
+            (*message).prev = self.tail;
+            (*message).next = null_mut();
+            if self.tail.is_null() {
+                self.head = message;
+            } else {
+                (*self.tail).next = message;
+            }
+        }
+        self.tail = message;
+    }
+
+    unsafe fn unlink(&mut self, message: *mut MessageHeader<T>) {
+        unsafe {
+            let (prev, next) = ((*message).prev, (*message).next);
+            if prev.is_null() {
+                self.head = next;
+            } else {
+                (*prev).next = next;
+            }
+            if next.is_null() {
+                self.tail = prev;
+            } else {
+                (*next).prev = prev;
+            }
+        }
+    }
+}
+
+/// State of type `T` that is only reached through calls run one at a time.
+///
+/// [`call`](Self::call) posts a closure to the apartment's mailbox and returns
+/// a future that resolves to the closure's result. The closure gets `&mut T`,
+/// so the state needs no locks of its own, and `Apartment<T>` is `Sync` for any
+/// `T: Send`. A COM object can keep its mutable state in an apartment and still
+/// satisfy [`ComImpl`](crate::ComImpl).
+///
+/// Closures run only in the apartment's runner, the future returned by
+/// [`run`](Self::run), which the owner spawns as a task of its own: its
+/// executor, and so its IRQL, is where every call runs, whoever posted it. The
+/// runner handles calls in posting order and charges each one to its task's
+/// budget, yielding once the budget or a fixed number of calls per poll is
+/// spent. It resolves when its task is asked to cancel; calls still queued
+/// then wait for the next runner.
+///
+/// ```ignore
+/// struct Queue {
+///     pending: Apartment<RequestList>,
+/// }
+///
+/// // Once, at start-up; the task keeps its `ComRc` to the queue.
+/// let runner = unsafe {
+///     spawn_dpc_task_cancellable(async move {
+///         queue.pending.run().await;
+///         STATUS_SUCCESS
+///     })
+/// }?;
+///
+/// async fn submit(&self, request: Request) -> NTSTATUS {
+///     self.pending.call(move |list| list.push(request)).await
+/// }
+/// ```
+///
+/// The mailbox is an intrusive FIFO: each message lives in its pinned
+/// `ApartmentCall`, so posting never allocates. Dropping a call never waits. A
+/// call still queued is unlinked and its closure never runs; one that is
+/// running is detached, and the runner drops its result.
+pub struct Apartment<T> {
+    mailbox: SpinLock<Mailbox<T>>,
+    has_runner: AtomicBool,
+    state: UnsafeCell<T>,
+}
+
+// Only the runner touches the state, one call at a time.
+unsafe impl<T: Send> Send for Apartment<T> {}
+unsafe impl<T: Send> Sync for Apartment<T> {}
+
+impl<T> Apartment<T> {
+    #[inline]
+    pub const fn new(state: T) -> Self {
+        Self {
+            mailbox: SpinLock::new(Mailbox {
+                head: null_mut(),
+                tail: null_mut(),
+                current: null_mut(),
+                runner: None,
+            }),
+            has_runner: AtomicBool::new(false),
+            state: UnsafeCell::new(state),
+        }
+    }
+
+    /// Runs `call` with exclusive access to the state and resolves to its result.
+    /// Nothing is posted until the future is first polled.
+    ///
+    /// The closure and its result are `'static`: a call dropped while it runs
+    /// is detached, so the closure may outlive the frame that posted it.
+    #[inline]
+    pub fn call<C, R>(&self, call: C) -> ApartmentCall<'_, T, C, R>
+    where
+        C: FnOnce(&mut T) -> R + Send + 'static,
+        R: Send + 'static,
+    {
+        ApartmentCall {
+            apartment: self,
+            message: UnsafeCell::new(Message {
+                header: MessageHeader {
+                    prev: null_mut(),
+                    next: null_mut(),
+                    state: AtomicU32::new(CALL_IDLE),
+                    waker: None,
+                    run: Message::<T, C, R>::run,
+                },
+                call: Some(call),
+                result: None,
+            }),
+            _pinned: PhantomPinned,
+        }
+    }
+
+    /// Returns the future that runs posted calls. An apartment has at most one
+    /// runner at a time; polling a second one panics.
+    #[inline]
+    pub fn run(&self) -> ApartmentRunner<'_, T> {
+        ApartmentRunner {
+            apartment: self,
+            claimed: false,
+        }
+    }
+
+    #[inline]
+    pub fn get_mut(&mut self) -> &mut T {
+        self.state.get_mut()
+    }
+
+    #[inline]
+    pub fn into_inner(self) -> T {
+        self.state.into_inner()
+    }
+}
+
+impl<T: Default> Default for Apartment<T> {
+    #[inline]
+    fn default() -> Self {
+        Self::new(T::default())
+    }
+}
+
+/// Future returned by [`Apartment::run`].
+#[must_use = "futures do nothing unless awaited"]
+pub struct ApartmentRunner<'a, T> {
+    apartment: &'a Apartment<T>,
+    claimed: bool,
+}
+
+impl<T> Future for ApartmentRunner<'_, T> {
+    type Output = ();
+
+    fn poll(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<()> {
+        if !self.claimed {
+            if self.apartment.has_runner.swap(true, Ordering::Acquire) {
+                panic!("`Apartment` already has a runner");
+            }
+            self.claimed = true;
+        }
+        let apartment = self.apartment;
+        for _ in 0..RUN_BUDGET {
+            if is_cancellation_requested() {
+                return Poll::Ready(());
+            }
+            let mut mailbox = apartment.mailbox.lock();
+            let message = mailbox.head;
+            if message.is_null() {
+                if !mailbox
+                    .runner
+                    .as_ref()
+                    .is_some_and(|current| current.will_wake(cx.waker()))
+                {
+                    let stale = mailbox.runner.replace(cx.waker().clone());
+                    drop(mailbox);
+                    drop(stale);
+                }
+                return Poll::Pending;
+            }
+            unsafe {
+                mailbox.unlink(message);
+                (*message).state.store(CALL_RUNNING, Ordering::Relaxed);
+            }
+            mailbox.current = message;
+            unsafe { ((*message).run)(message, apartment, mailbox) };
+            if poll_proceed(cx).is_pending() {
+                return Poll::Pending;
+            }
+        }
+        cx.waker().wake_by_ref();
+        Poll::Pending
+    }
+}
+
+impl<T> Drop for ApartmentRunner<'_, T> {
+    fn drop(&mut self) {
+        if !self.claimed {
+            return;
+        }
+        let waker = self.apartment.mailbox.lock().runner.take();
+        drop(waker);
+        self.apartment.has_runner.store(false, Ordering::Release);
+    }
+}
+
+/// Future returned by [`Apartment::call`].
+#[must_use = "futures do nothing unless awaited"]
+pub struct ApartmentCall<'a, T, C, R> {
+    apartment: &'a Apartment<T>,
+    message: UnsafeCell<Message<T, C, R>>,
+    _pinned: PhantomPinned,
+}
+
+unsafe impl<T: Send, C: Send, R: Send> Send for ApartmentCall<'_, T, C, R> {}
+
+impl<T, C, R> Future for ApartmentCall<'_, T, C, R>
+where
+    C: FnOnce(&mut T) -> R + Send + 'static,
+    R: Send + 'static,
+{
+    type Output = R;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<R> {
+        // The message is never moved out; `Drop` unlinks or detaches it.
+        let this = unsafe { self.get_unchecked_mut() };
+        let message = this.message.get();
+        let header = unsafe { &mut (*message).header as *mut MessageHeader<T> };
+        if unsafe { (*header).state.load(Ordering::Relaxed) } == CALL_TAKEN {
+            panic!("`ApartmentCall` polled after completion");
+        }
+
+        let mut mailbox = this.apartment.mailbox.lock();
+        match unsafe { (*header).state.load(Ordering::Relaxed) } {
+            CALL_IDLE => {
+                unsafe {
+                    (*header).state.store(CALL_POSTED, Ordering::Relaxed);
+                    (*header).waker = Some(cx.waker().clone());
+                    mailbox.push(header);
+                }
+                let runner = mailbox.runner.take();
+                drop(mailbox);
+                if let Some(runner) = runner {
+                    runner.wake();
+                }
+                Poll::Pending
+            }
+            CALL_DONE => {
+                unsafe { (*header).state.store(CALL_TAKEN, Ordering::Relaxed) };
+                drop(mailbox);
+                match unsafe { (*message).result.take() } {
+                    Some(result) => Poll::Ready(result),
+                    None => unreachable!(),
+                }
+            }
+            _ => {
+                let slot = unsafe { &mut (*header).waker };
+                if !slot
+                    .as_ref()
+                    .is_some_and(|current| current.will_wake(cx.waker()))
+                {
+                    let stale = slot.replace(cx.waker().clone());
+                    drop(mailbox);
+                    drop(stale);
+                }
+                Poll::Pending
+            }
+        }
+    }
+}
+
+impl<T, C, R> Drop for ApartmentCall<'_, T, C, R> {
+    fn drop(&mut self) {
+        let header = unsafe { &mut (*self.message.get()).header as *mut MessageHeader<T> };
+        match unsafe { (*header).state.load(Ordering::Relaxed) } {
+            CALL_IDLE | CALL_TAKEN => return,
+            _ => {}
+        }
+        let mut mailbox = self.apartment.mailbox.lock();
+        match unsafe { (*header).state.load(Ordering::Relaxed) } {
+            // Never started: the closure is dropped with the call.
+            CALL_POSTED => unsafe { mailbox.unlink(header) },
+            // The runner took the closure and checks `current` before it
+            // writes the result back.
+            CALL_RUNNING => mailbox.current = null_mut(),
+            _ => {}
+        }
+    }
+}
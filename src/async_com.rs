@@ -3,22 +3,28 @@
 // Copyright (c) 2026 Exveria
 // SPDX-License-Identifier: MIT OR Apache-2.0
 
+use core::alloc::Layout;
 use core::cell::UnsafeCell;
 use core::ffi::c_void;
 use core::future::Future;
 use core::marker::PhantomData;
 use core::mem::MaybeUninit;
-use core::sync::atomic::{AtomicI32, AtomicU32, Ordering};
-#[cfg(test)]
-use core::sync::atomic::AtomicUsize;
+use core::pin::Pin;
+use core::ptr::NonNull;
+use core::sync::atomic::{AtomicI32, AtomicU32, AtomicUsize, Ordering};
+use core::task::{Context, Poll, Waker};
 
-use crate::executor::{spawn_dpc_task_cancellable, CancelHandle};
+use crate::allocator::{
+    try_alloc_layout, Allocator, GlobalAllocator, InitBoxTrait, KBox, KBoxError, PinInit,
+    PinInitOnce,
+};
+use crate::executor::{spawn_dpc_task_cancellable_pin_init, CancelHandle};
 use crate::iunknown::{
-    GUID, IUnknownVtbl, NTSTATUS, STATUS_CANCELLED, STATUS_PENDING, STATUS_SUCCESS,
-    STATUS_UNSUCCESSFUL,
+    GUID, IUnknownVtbl, NTSTATUS, PendingResult, STATUS_CANCELLED, STATUS_DEVICE_BUSY,
+    STATUS_INSUFFICIENT_RESOURCES, STATUS_PENDING, STATUS_SUCCESS, STATUS_UNSUCCESSFUL,
 };
 use crate::GuardPtr;
-use crate::smart_ptr::{ComInterface, ComRc};
+use crate::smart_ptr::{ComInterface, ComRc, ThreadSafeComInterface};
 use crate::traits::ComImpl;
 use crate::vtable::InterfaceVtable;
 use crate::wrapper::{ComObject, PanicGuard};
@@ -53,11 +59,32 @@ pub trait AsyncValueType: Copy + Send + Sync + 'static {}
 
 impl<T> AsyncValueType for T where T: Copy + Send + Sync + 'static {}
 
+/// Callback invoked once when a registered operation leaves `Started`.
+///
+/// It runs on whichever thread completes the operation (DISPATCH_LEVEL for DPC tasks),
+/// so it must not block.
+pub type AsyncCompletionCallback = unsafe extern "system" fn(context: *mut c_void, index: usize);
+
 #[repr(C)]
 pub struct AsyncOperationVtbl<T: AsyncValueType> {
     pub parent: IUnknownVtbl,
     pub get_status: unsafe extern "system" fn(*mut c_void, *mut AsyncStatus) -> NTSTATUS,
     pub get_result: unsafe extern "system" fn(*mut c_void, *mut T) -> NTSTATUS,
+    /// Arms a one-shot completion callback.
+    ///
+    /// Returns `STATUS_PENDING` when armed, `STATUS_SUCCESS` when the operation has
+    /// already finished (the callback is not invoked), and `STATUS_DEVICE_BUSY` when
+    /// another waiter currently owns the slot.
+    pub register_completion: unsafe extern "system" fn(
+        *mut c_void,
+        AsyncCompletionCallback,
+        *mut c_void,
+        usize,
+    ) -> NTSTATUS,
+    /// Disarms a callback armed by `register_completion`.
+    ///
+    /// When this returns, the callback is guaranteed not to be running or to run later.
+    pub unregister_completion: unsafe extern "system" fn(*mut c_void) -> NTSTATUS,
 }
 
 unsafe impl<T: AsyncValueType> InterfaceVtable for AsyncOperationVtbl<T> {}
@@ -71,6 +98,8 @@ impl<T: AsyncValueType> AsyncOperationVtbl<T> {
             parent: IUnknownVtbl::new::<AsyncOperationTask<T, F>, Self>(),
             get_status: AsyncOperationTask::<T, F>::shim_get_status,
             get_result: AsyncOperationTask::<T, F>::shim_get_result,
+            register_completion: AsyncOperationTask::<T, F>::shim_register_completion,
+            unregister_completion: AsyncOperationTask::<T, F>::shim_unregister_completion,
         }
     }
 }
@@ -82,6 +111,8 @@ pub struct AsyncOperationRaw<T: AsyncValueType> {
 }
 
 unsafe impl<T: AsyncValueType> ComInterface for AsyncOperationRaw<T> {}
+// Operation state is atomic and `T: Send + Sync`, so handles may cross threads.
+unsafe impl<T: AsyncValueType> ThreadSafeComInterface for AsyncOperationRaw<T> {}
 
 impl<T: AsyncValueType> AsyncOperationRaw<T> {
     #[inline]
@@ -129,6 +160,65 @@ impl<T: AsyncValueType> AsyncOperationRaw<T> {
             Err(result)
         }
     }
+
+    /// Arms `callback` to run once when the operation finishes.
+    ///
+    /// Returns `Pending` when armed and `Ready` when the operation has already finished.
+    ///
+    /// # Safety
+    /// `context` must stay valid until the callback has run or
+    /// [`unregister_completion_raw`](Self::unregister_completion_raw) has returned.
+    #[inline]
+    pub unsafe fn register_completion_raw(
+        this: *mut Self,
+        callback: AsyncCompletionCallback,
+        context: *mut c_void,
+        index: usize,
+    ) -> Result<PendingResult, NTSTATUS> {
+        if this.is_null() {
+            return Err(STATUS_UNSUCCESSFUL);
+        }
+        let vtbl = unsafe { (*this).lpVtbl };
+        if vtbl.is_null() {
+            return Err(STATUS_UNSUCCESSFUL);
+        }
+        let result =
+            unsafe { ((*vtbl).register_completion)(this as *mut c_void, callback, context, index) };
+        match result {
+            STATUS_PENDING => Ok(PendingResult::Pending),
+            STATUS_SUCCESS => Ok(PendingResult::Ready(())),
+            status => Err(status),
+        }
+    }
+
+    /// Disarms a callback armed with [`register_completion_raw`](Self::register_completion_raw).
+    ///
+    /// # Safety
+    /// `this` must be a valid operation pointer and the caller must own the armed slot.
+    #[inline]
+    pub unsafe fn unregister_completion_raw(this: *mut Self) {
+        if this.is_null() {
+            return;
+        }
+        let vtbl = unsafe { (*this).lpVtbl };
+        if vtbl.is_null() {
+            return;
+        }
+        let _ = unsafe { ((*vtbl).unregister_completion)(this as *mut c_void) };
+    }
+}
+
+const NOTIFY_IDLE: u32 = 0;
+const NOTIFY_ARMING: u32 = 1;
+const NOTIFY_ARMED: u32 = 2;
+const NOTIFY_FIRING: u32 = 3;
+const NOTIFY_DONE: u32 = 4;
+
+#[derive(Clone, Copy)]
+struct CompletionSlot {
+    callback: Option<AsyncCompletionCallback>,
+    context: *mut c_void,
+    index: usize,
 }
 
 pub struct AsyncOperationTask<T, F>
@@ -139,6 +229,8 @@ where
     status: AtomicU32,
     error: AtomicI32,
     result: UnsafeCell<MaybeUninit<T>>,
+    notify: AtomicU32,
+    completion: UnsafeCell<CompletionSlot>,
     _marker: PhantomData<F>,
 }
 
@@ -174,6 +266,12 @@ where
             status: AtomicU32::new(AsyncStatus::Started.as_raw()),
             error: AtomicI32::new(STATUS_UNSUCCESSFUL),
             result: UnsafeCell::new(MaybeUninit::uninit()),
+            notify: AtomicU32::new(NOTIFY_IDLE),
+            completion: UnsafeCell::new(CompletionSlot {
+                callback: None,
+                context: core::ptr::null_mut(),
+                index: 0,
+            }),
             _marker: PhantomData,
         }
     }
@@ -186,6 +284,7 @@ where
         self.error.store(STATUS_SUCCESS, Ordering::Release);
         self.status
             .store(AsyncStatus::Completed.as_raw(), Ordering::Release);
+        self.fire_completion();
     }
 
     #[inline]
@@ -193,6 +292,7 @@ where
         self.error.store(status, Ordering::Release);
         self.status
             .store(AsyncStatus::Error.as_raw(), Ordering::Release);
+        self.fire_completion();
     }
 
     #[inline]
@@ -200,6 +300,76 @@ where
         self.error.store(STATUS_CANCELLED, Ordering::Release);
         self.status
             .store(AsyncStatus::Canceled.as_raw(), Ordering::Release);
+        self.fire_completion();
+    }
+
+    /// Runs the armed completion callback, if any. Called once after the final status store.
+    #[inline]
+    fn fire_completion(&self) {
+        let prev = self.notify.swap(NOTIFY_FIRING, Ordering::AcqRel);
+        if prev == NOTIFY_ARMED {
+            let slot = unsafe { *self.completion.get() };
+            if let Some(callback) = slot.callback {
+                unsafe { callback(slot.context, slot.index) };
+            }
+        }
+        self.notify.store(NOTIFY_DONE, Ordering::Release);
+    }
+
+    fn register_completion(
+        &self,
+        callback: AsyncCompletionCallback,
+        context: *mut c_void,
+        index: usize,
+    ) -> NTSTATUS {
+        if self.load_status() != AsyncStatus::Started {
+            return STATUS_SUCCESS;
+        }
+        match self.notify.compare_exchange(
+            NOTIFY_IDLE,
+            NOTIFY_ARMING,
+            Ordering::Acquire,
+            Ordering::Acquire,
+        ) {
+            Ok(_) => {}
+            Err(NOTIFY_ARMING) | Err(NOTIFY_ARMED) => return STATUS_DEVICE_BUSY,
+            Err(_) => return STATUS_SUCCESS,
+        }
+        unsafe {
+            *self.completion.get() = CompletionSlot {
+                callback: Some(callback),
+                context,
+                index,
+            };
+        }
+        // Completion may have swapped ARMING -> FIRING meanwhile; it then skips the
+        // callback and the caller observes the finished status instead.
+        match self.notify.compare_exchange(
+            NOTIFY_ARMING,
+            NOTIFY_ARMED,
+            Ordering::AcqRel,
+            Ordering::Acquire,
+        ) {
+            Ok(_) => STATUS_PENDING,
+            Err(_) => STATUS_SUCCESS,
+        }
+    }
+
+    fn unregister_completion(&self) -> NTSTATUS {
+        loop {
+            match self.notify.compare_exchange(
+                NOTIFY_ARMED,
+                NOTIFY_IDLE,
+                Ordering::AcqRel,
+                Ordering::Acquire,
+            ) {
+                Ok(_) => return STATUS_SUCCESS,
+                // The callback is short and non-blocking; wait it out so the caller may
+                // free the context as soon as we return.
+                Err(NOTIFY_FIRING) => core::hint::spin_loop(),
+                Err(_) => return STATUS_SUCCESS,
+            }
+        }
     }
 
     #[inline]
@@ -225,60 +395,91 @@ where
     pub fn spawn_raw_cancellable(
         future: F,
     ) -> Result<(*mut AsyncOperationRaw<T>, CancelHandle), NTSTATUS> {
-        let ptr = ComObject::<Self, AsyncOperationVtbl<T>>::new(Self::new_state())?;
+        let init = PinInitOnce::new(move |slot: *mut F| {
+            unsafe { slot.write(future) };
+            Ok::<(), NTSTATUS>(())
+        });
+        Self::spawn_in_place(init, None).map_err(KBoxError::into_status)
+    }
 
-        // Hold a reference while the async task runs.
-        unsafe {
-            ComObject::<Self, AsyncOperationVtbl<T>>::shim_add_ref(ptr);
-        }
+    /// Spawns an operation whose future is pin-initialized inside the executor task.
+    ///
+    /// The future never lives in a separate allocation. Errors follow
+    /// [`InitBoxTrait::try_pin`](crate::allocator::InitBoxTrait::try_pin): `Alloc` when the operation or task cannot be
+    /// allocated, `Init` when `init` fails.
+    pub fn spawn_raw_pin_init<E>(
+        init: impl PinInit<F, E>,
+    ) -> Result<*mut AsyncOperationRaw<T>, KBoxError<E>>
+    where
+        E: From<NTSTATUS>,
+    {
+        let (ptr, _handle) = Self::spawn_in_place(init, None)?;
+        Ok(ptr)
+    }
 
-        struct TaskGuard<T, F>
-        where
-            T: AsyncValueType,
-            F: Future<Output = T> + Send + 'static,
-        {
-            ptr: GuardPtr,
-            _marker: PhantomData<(T, F)>,
-        }
+    /// Like [`spawn_raw_pin_init`](Self::spawn_raw_pin_init), returning a cancellation handle.
+    pub fn spawn_raw_cancellable_pin_init<E>(
+        init: impl PinInit<F, E>,
+    ) -> Result<(*mut AsyncOperationRaw<T>, CancelHandle), KBoxError<E>>
+    where
+        E: From<NTSTATUS>,
+    {
+        Self::spawn_in_place(init, None)
+    }
 
-        impl<T, F> Drop for TaskGuard<T, F>
-        where
-            T: AsyncValueType,
-            F: Future<Output = T> + Send + 'static,
-        {
-            fn drop(&mut self) {
-                unsafe {
-                    ComObject::<AsyncOperationTask<T, F>, AsyncOperationVtbl<T>>::shim_release(
-                        self.ptr.as_ptr(),
-                    );
-                }
-            }
-        }
+    /// Spawns in place and drops `keep_alive` once the future has been dropped.
+    ///
+    /// Used by async interface shims to hold the implementing COM object alive.
+    #[doc(hidden)]
+    pub fn spawn_raw_pin_init_with<E>(
+        init: impl PinInit<F, E>,
+        keep_alive: ReleaseOnDrop,
+    ) -> Result<*mut AsyncOperationRaw<T>, KBoxError<E>>
+    where
+        E: From<NTSTATUS>,
+    {
+        let (ptr, _handle) = Self::spawn_in_place(init, Some(keep_alive))?;
+        Ok(ptr)
+    }
 
-        let task_ptr = GuardPtr::new(ptr);
-        let task = async move {
-            let _guard = TaskGuard::<T, F> {
-                ptr: task_ptr,
-                _marker: PhantomData,
-            };
+    fn spawn_in_place<E>(
+        mut init: impl PinInit<F, E>,
+        keep_alive: Option<ReleaseOnDrop>,
+    ) -> Result<(*mut AsyncOperationRaw<T>, CancelHandle), KBoxError<E>>
+    where
+        E: From<NTSTATUS>,
+    {
+        let ptr = ComObject::<Self, AsyncOperationVtbl<T>>::new(Self::new_state())
+            .map_err(KBoxError::Alloc)?;
 
-            let result = crate::task::try_finally(future, async {}).await;
-            let wrapper = unsafe { ComObject::<Self, AsyncOperationVtbl<T>>::from_ptr(task_ptr.as_ptr()) };
-            match result {
-                Some(value) => wrapper.inner.store_result(value),
-                None => wrapper.inner.store_canceled(),
-            }
-            STATUS_SUCCESS
+        // Hold a reference while the async task runs.
+        unsafe {
+            ComObject::<Self, AsyncOperationVtbl<T>>::shim_add_ref(ptr);
+        }
+        let operation = TaskGuard::<T, F> {
+            ptr: GuardPtr::new(ptr),
+            _marker: PhantomData,
         };
 
-        let handle = match unsafe { spawn_dpc_task_cancellable(task) } {
+        let body = PinInitOnce::new(move |slot: *mut OperationFuture<T, F>| unsafe {
+            crate::task::Cancellable::init_in_place(
+                core::ptr::addr_of_mut!((*slot).body),
+                core::future::ready(()),
+                |main| init.init(main),
+            )?;
+            core::ptr::addr_of_mut!((*slot).keep_alive).write(keep_alive);
+            core::ptr::addr_of_mut!((*slot).operation).write(operation);
+            Ok(())
+        });
+
+        // On failure the initializer (and the task reference it captured) is dropped.
+        let handle = match unsafe { spawn_dpc_task_cancellable_pin_init(body) } {
             Ok(handle) => handle,
-            Err(status) => {
+            Err(err) => {
                 unsafe {
                     ComObject::<Self, AsyncOperationVtbl<T>>::shim_release(ptr);
-                    ComObject::<Self, AsyncOperationVtbl<T>>::shim_release(ptr);
                 }
-                return Err(status);
+                return Err(err);
             }
         };
 
@@ -350,6 +551,125 @@ where
         core::mem::forget(guard);
         result
     }
+
+    /// # Safety
+    /// `this` must be null or point to a live `ComObject` wrapping this operation.
+    #[allow(non_snake_case)]
+    pub unsafe extern "system" fn shim_register_completion(
+        this: *mut c_void,
+        callback: AsyncCompletionCallback,
+        context: *mut c_void,
+        index: usize,
+    ) -> NTSTATUS {
+        if this.is_null() {
+            return STATUS_UNSUCCESSFUL;
+        }
+        let guard = PanicGuard::new();
+        let wrapper = unsafe { &*(this as *const ComObject<Self, AsyncOperationVtbl<T>>) };
+        let result = wrapper.inner.register_completion(callback, context, index);
+        core::mem::forget(guard);
+        result
+    }
+
+    /// # Safety
+    /// `this` must be null or point to a live `ComObject` wrapping this operation.
+    #[allow(non_snake_case)]
+    pub unsafe extern "system" fn shim_unregister_completion(this: *mut c_void) -> NTSTATUS {
+        if this.is_null() {
+            return STATUS_UNSUCCESSFUL;
+        }
+        let guard = PanicGuard::new();
+        let wrapper = unsafe { &*(this as *const ComObject<Self, AsyncOperationVtbl<T>>) };
+        let result = wrapper.inner.unregister_completion();
+        core::mem::forget(guard);
+        result
+    }
+}
+
+/// Releases one COM reference when dropped.
+#[doc(hidden)]
+pub struct ReleaseOnDrop {
+    ptr: GuardPtr,
+    release: unsafe extern "system" fn(*mut c_void) -> u32,
+}
+
+impl ReleaseOnDrop {
+    /// # Safety
+    /// The caller must own one reference on `ptr` that `release` gives back.
+    #[inline]
+    pub unsafe fn new(ptr: GuardPtr, release: unsafe extern "system" fn(*mut c_void) -> u32) -> Self {
+        Self { ptr, release }
+    }
+}
+
+impl Drop for ReleaseOnDrop {
+    fn drop(&mut self) {
+        unsafe { (self.release)(self.ptr.as_ptr()) };
+    }
+}
+
+struct TaskGuard<T, F>
+where
+    T: AsyncValueType,
+    F: Future<Output = T> + Send + 'static,
+{
+    ptr: GuardPtr,
+    _marker: PhantomData<(T, F)>,
+}
+
+impl<T, F> Drop for TaskGuard<T, F>
+where
+    T: AsyncValueType,
+    F: Future<Output = T> + Send + 'static,
+{
+    fn drop(&mut self) {
+        unsafe {
+            ComObject::<AsyncOperationTask<T, F>, AsyncOperationVtbl<T>>::shim_release(
+                self.ptr.as_ptr(),
+            );
+        }
+    }
+}
+
+/// Executor task body: drives the user future in place and publishes its result.
+///
+/// Fields drop in order, so the user future goes away before `keep_alive` releases
+/// the object it may point into.
+struct OperationFuture<T, F>
+where
+    T: AsyncValueType,
+    F: Future<Output = T> + Send + 'static,
+{
+    body: crate::task::Cancellable<F, core::future::Ready<()>>,
+    keep_alive: Option<ReleaseOnDrop>,
+    operation: TaskGuard<T, F>,
+}
+
+impl<T, F> Future for OperationFuture<T, F>
+where
+    T: AsyncValueType,
+    F: Future<Output = T> + Send + 'static,
+{
+    type Output = NTSTATUS;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<NTSTATUS> {
+        let this = unsafe { self.get_unchecked_mut() };
+        let body = unsafe { Pin::new_unchecked(&mut this.body) };
+        let result = match body.poll(cx) {
+            Poll::Ready(result) => result,
+            Poll::Pending => return Poll::Pending,
+        };
+        let wrapper = unsafe {
+            ComObject::<AsyncOperationTask<T, F>, AsyncOperationVtbl<T>>::from_ptr(
+                this.operation.ptr.as_ptr(),
+            )
+        };
+        match result {
+            Some(value) => wrapper.inner.store_result(value),
+            None => wrapper.inner.store_canceled(),
+        }
+        Poll::Ready(STATUS_SUCCESS)
+    }
 }
 
 impl<T, F> ComImpl<AsyncOperationVtbl<T>> for AsyncOperationTask<T, F>
@@ -385,6 +705,54 @@ where
     AsyncOperationTask::<T, F>::spawn_raw_cancellable(future)
 }
 
+/// Spawns an operation whose future is pin-initialized inside the executor task.
+#[inline]
+pub fn spawn_async_operation_raw_pin_init<T, F, E>(
+    init: impl PinInit<F, E>,
+) -> Result<*mut AsyncOperationRaw<T>, KBoxError<E>>
+where
+    T: AsyncValueType,
+    F: Future<Output = T> + Send + 'static,
+    E: From<NTSTATUS>,
+{
+    AsyncOperationTask::<T, F>::spawn_raw_pin_init(init)
+}
+
+/// Spawns the operation behind an async interface method and drops
+/// `keep_alive` once the future has been dropped.
+///
+/// The future is pin-initialized into the executor task when `init` hands out
+/// its initializer ([`InitBoxTrait::into_pin_init`]); otherwise it is boxed
+/// with `try_pin` and the task polls the box. A failed spawn yields an error
+/// operation; null is returned only if that cannot be allocated either.
+#[doc(hidden)]
+pub fn spawn_init_box_raw<T, F, A, I>(init: I, keep_alive: ReleaseOnDrop) -> *mut AsyncOperationRaw<T>
+where
+    T: AsyncValueType,
+    F: Future<Output = T> + Send + 'static,
+    A: Allocator + Send + 'static,
+    I: InitBoxTrait<F, A, NTSTATUS>,
+{
+    let spawned = match init.into_pin_init() {
+        Ok(init) => AsyncOperationTask::<T, F>::spawn_raw_pin_init_with(init, keep_alive),
+        Err(init) => match init.try_pin() {
+            Ok(future) => {
+                let init = PinInitOnce::new(move |slot: *mut Pin<KBox<F, A>>| {
+                    unsafe { slot.write(future) };
+                    Ok::<(), NTSTATUS>(())
+                });
+                AsyncOperationTask::<T, Pin<KBox<F, A>>>::spawn_raw_pin_init_with(init, keep_alive)
+            }
+            Err(err) => Err(err),
+        },
+    };
+    match spawned {
+        Ok(ptr) => ptr,
+        Err(err) => spawn_async_operation_error_raw::<T, F>(err.into_status())
+            .unwrap_or(core::ptr::null_mut()),
+    }
+}
+
 #[inline]
 pub fn spawn_async_operation_error_raw<T, F>(status: NTSTATUS) -> Result<*mut AsyncOperationRaw<T>, NTSTATUS>
 where
@@ -423,6 +791,446 @@ where
     Ok(unsafe { ComRc::from_raw_unchecked(ptr) })
 }
 
+const WAKER_IDLE: u32 = 0;
+const WAKER_REGISTERING: u32 = 1;
+const WAKER_WAKING: u32 = 2;
+
+/// Single-consumer waker cell that completion callbacks can signal without a lock.
+struct WakerSlot {
+    state: AtomicU32,
+    waker: UnsafeCell<Option<Waker>>,
+}
+
+impl WakerSlot {
+    #[inline]
+    const fn new() -> Self {
+        Self {
+            state: AtomicU32::new(WAKER_IDLE),
+            waker: UnsafeCell::new(None),
+        }
+    }
+
+    fn register(&self, waker: &Waker) {
+        match self.state.compare_exchange(
+            WAKER_IDLE,
+            WAKER_REGISTERING,
+            Ordering::Acquire,
+            Ordering::Acquire,
+        ) {
+            Ok(_) => {
+                let slot = unsafe { &mut *self.waker.get() };
+                if !slot.as_ref().is_some_and(|current| current.will_wake(waker)) {
+                    *slot = Some(waker.clone());
+                }
+                if self
+                    .state
+                    .compare_exchange(
+                        WAKER_REGISTERING,
+                        WAKER_IDLE,
+                        Ordering::AcqRel,
+                        Ordering::Acquire,
+                    )
+                    .is_err()
+                {
+                    // A wake raced with registration; deliver it ourselves.
+                    let waker = unsafe { (*self.waker.get()).take() };
+                    self.state.store(WAKER_IDLE, Ordering::Release);
+                    if let Some(waker) = waker {
+                        waker.wake();
+                    }
+                }
+            }
+            Err(state) if state & WAKER_WAKING != 0 => waker.wake_by_ref(),
+            Err(_) => {}
+        }
+    }
+
+    fn wake(&self) {
+        if self.state.fetch_or(WAKER_WAKING, Ordering::AcqRel) == WAKER_IDLE {
+            let waker = unsafe { (*self.waker.get()).take() };
+            self.state.fetch_and(!WAKER_WAKING, Ordering::Release);
+            if let Some(waker) = waker {
+                waker.wake();
+            }
+        }
+    }
+}
+
+const WAIT_BITS: usize = usize::BITS as usize;
+
+/// Shared waiter state. Followed in the same allocation by three bitmaps of
+/// `words` entries each: ready (set by callbacks), armed and reported (owner only).
+#[repr(C)]
+struct WaitCore {
+    completed: AtomicUsize,
+    waker: WakerSlot,
+    #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+    event: UnsafeCell<crate::ntddk::KEVENT>,
+}
+
+impl WaitCore {
+    #[inline]
+    unsafe fn bitmap<'b>(this: *const Self, words: usize, which: usize) -> &'b [AtomicUsize] {
+        // `WaitCore` is at least usize-aligned, so the bitmaps start right after it.
+        let base = unsafe { (this.add(1) as *const AtomicUsize).add(which * words) };
+        unsafe { core::slice::from_raw_parts(base, words) }
+    }
+
+    #[inline]
+    unsafe fn mark_ready(this: *const Self, index: usize) {
+        let ready = unsafe { &*(this.add(1) as *const AtomicUsize).add(index / WAIT_BITS) };
+        ready.fetch_or(1usize << (index % WAIT_BITS), Ordering::Release);
+        let core = unsafe { &*this };
+        core.completed.fetch_add(1, Ordering::Release);
+        core.waker.wake();
+        #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+        unsafe {
+            crate::ntddk::KeSetEvent(core.event.get(), 0, 0);
+        }
+    }
+
+    unsafe extern "system" fn on_complete(context: *mut c_void, index: usize) {
+        unsafe { Self::mark_ready(context as *const Self, index) };
+    }
+}
+
+const WAIT_READY: usize = 0;
+const WAIT_ARMED: usize = 1;
+const WAIT_REPORTED: usize = 2;
+
+/// One waiter registered on many async operations.
+///
+/// Each operation arms a completion callback that records its index in a shared
+/// bitmap, so collecting completions costs work per completion instead of a
+/// `get_status` sweep over every handle. An operation can be watched by at most one
+/// wait set at a time; arming an operation that is already being watched fails with
+/// `STATUS_DEVICE_BUSY`.
+pub struct AsyncWaitSet<'a, T: AsyncValueType> {
+    ops: &'a [ComRc<AsyncOperationRaw<T>>],
+    core: NonNull<WaitCore>,
+    words: usize,
+    layout: Layout,
+    reported: usize,
+}
+
+// The shared core is only touched through atomics (and the waker slot protocol).
+unsafe impl<T: AsyncValueType> Send for AsyncWaitSet<'_, T> {}
+unsafe impl<T: AsyncValueType> Sync for AsyncWaitSet<'_, T> {}
+
+impl<'a, T: AsyncValueType> AsyncWaitSet<'a, T> {
+    /// Registers one shared waiter on every operation in `ops`.
+    pub fn new(ops: &'a [ComRc<AsyncOperationRaw<T>>]) -> Result<Self, NTSTATUS> {
+        let words = ops.len().div_ceil(WAIT_BITS);
+        let bitmaps = Layout::array::<AtomicUsize>(words * 3)
+            .map_err(|_| STATUS_INSUFFICIENT_RESOURCES)?;
+        let (layout, _) = Layout::new::<WaitCore>()
+            .extend(bitmaps)
+            .map_err(|_| STATUS_INSUFFICIENT_RESOURCES)?;
+        let core = try_alloc_layout(&GlobalAllocator, layout)?.cast::<WaitCore>();
+
+        unsafe {
+            core.as_ptr().write(WaitCore {
+                completed: AtomicUsize::new(0),
+                waker: WakerSlot::new(),
+                #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+                event: UnsafeCell::new(core::mem::zeroed()),
+            });
+            #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+            crate::ntddk::KeInitializeEvent(
+                (*core.as_ptr()).event.get(),
+                crate::ntddk::SynchronizationEvent,
+                0,
+            );
+            let bits = core.as_ptr().add(1) as *mut AtomicUsize;
+            for word in 0..words * 3 {
+                bits.add(word).write(AtomicUsize::new(0));
+            }
+        }
+
+        let set = Self {
+            ops,
+            core,
+            words,
+            layout,
+            reported: 0,
+        };
+
+        for (index, op) in ops.iter().enumerate() {
+            let armed = unsafe {
+                AsyncOperationRaw::register_completion_raw(
+                    op.as_ptr(),
+                    WaitCore::on_complete,
+                    core.as_ptr() as *mut c_void,
+                    index,
+                )
+            }?;
+            match armed {
+                PendingResult::Pending => {
+                    set.bitmap(WAIT_ARMED)[index / WAIT_BITS]
+                        .fetch_or(1usize << (index % WAIT_BITS), Ordering::Relaxed);
+                }
+                PendingResult::Ready(()) => unsafe { WaitCore::mark_ready(core.as_ptr(), index) },
+            }
+        }
+
+        Ok(set)
+    }
+
+    #[inline]
+    fn bitmap(&self, which: usize) -> &[AtomicUsize] {
+        unsafe { WaitCore::bitmap(self.core.as_ptr(), self.words, which) }
+    }
+
+    /// Number of watched operations.
+    #[inline]
+    pub fn len(&self) -> usize {
+        self.ops.len()
+    }
+
+    #[inline]
+    pub fn is_empty(&self) -> bool {
+        self.ops.is_empty()
+    }
+
+    /// Number of operations that have finished so far.
+    #[inline]
+    pub fn completed_count(&self) -> usize {
+        unsafe { self.core.as_ref() }.completed.load(Ordering::Acquire)
+    }
+
+    /// Returns true when the operation at `index` has finished.
+    #[inline]
+    pub fn is_completed(&self, index: usize) -> bool {
+        if index >= self.ops.len() {
+            return false;
+        }
+        let word = self.bitmap(WAIT_READY)[index / WAIT_BITS].load(Ordering::Acquire);
+        word & (1usize << (index % WAIT_BITS)) != 0
+    }
+
+    /// Returns the operations this set watches.
+    #[inline]
+    pub fn operations(&self) -> &'a [ComRc<AsyncOperationRaw<T>>] {
+        self.ops
+    }
+
+    /// Returns the index of a finished operation not reported before, without waiting.
+    pub fn try_next_completed(&mut self) -> Option<usize> {
+        if self.reported == self.completed_count() {
+            return None;
+        }
+        let ready = self.bitmap(WAIT_READY);
+        let reported = self.bitmap(WAIT_REPORTED);
+        for (word, (ready, reported)) in ready.iter().zip(reported).enumerate() {
+            let seen = reported.load(Ordering::Relaxed);
+            let fresh = ready.load(Ordering::Acquire) & !seen;
+            if fresh != 0 {
+                let bit = fresh.trailing_zeros() as usize;
+                reported.store(seen | (1usize << bit), Ordering::Relaxed);
+                self.reported += 1;
+                return Some(word * WAIT_BITS + bit);
+            }
+        }
+        None
+    }
+
+    /// Polls for the next finished operation; `Ready(None)` once all were reported.
+    pub fn poll_next_completed(&mut self, cx: &mut Context<'_>) -> Poll<Option<usize>> {
+        if self.reported == self.ops.len() {
+            return Poll::Ready(None);
+        }
+        if self.reported == self.completed_count() {
+            unsafe { self.core.as_ref() }.waker.register(cx.waker());
+            if self.reported == self.completed_count() {
+                return Poll::Pending;
+            }
+        }
+        // Only a poll that returns a completion is charged, like a fired timer.
+        if crate::executor::poll_proceed(cx).is_pending() {
+            return Poll::Pending;
+        }
+        // The ready bit is set before the count is raised, so this finds it.
+        Poll::Ready(self.try_next_completed())
+    }
+
+    /// Waits for the next finished operation; `None` once all were reported.
+    #[inline]
+    pub fn next_completed(&mut self) -> NextCompleted<'_, 'a, T> {
+        NextCompleted { set: self }
+    }
+
+    /// Blocks until the next operation finishes; `None` once all were reported.
+    ///
+    /// # IRQL
+    /// Kernel builds wait on a KEVENT and must be called at PASSIVE_LEVEL (or APC_LEVEL).
+    /// Host builds spin.
+    pub fn wait_next_completed(&mut self) -> Option<usize> {
+        loop {
+            if self.reported == self.ops.len() {
+                return None;
+            }
+            if let Some(index) = self.try_next_completed() {
+                return Some(index);
+            }
+            self.block();
+        }
+    }
+
+    #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+    #[inline]
+    fn block(&self) {
+        debug_assert!(
+            unsafe { crate::ntddk::KeGetCurrentIrql() } <= crate::ntddk::APC_LEVEL as u8,
+            "AsyncWaitSet blocking waits require IRQL <= APC_LEVEL"
+        );
+        unsafe {
+            let _ = crate::ntddk::KeWaitForSingleObject(
+                (*self.core.as_ptr()).event.get() as *mut c_void,
+                crate::ntddk::_KWAIT_REASON::Executive,
+                crate::ntddk::_MODE::KernelMode as i8,
+                0,
+                core::ptr::null_mut(),
+            );
+        }
+    }
+
+    #[cfg(any(not(all(feature = "driver", feature = "async-com-kernel")), miri))]
+    #[inline]
+    fn block(&self) {
+        core::hint::spin_loop();
+    }
+}
+
+impl<T: AsyncValueType> Drop for AsyncWaitSet<'_, T> {
+    fn drop(&mut self) {
+        // Disarm before freeing: unregister also waits out a callback that is mid-flight.
+        for (word, armed) in self.bitmap(WAIT_ARMED).iter().enumerate() {
+            let mut bits = armed.load(Ordering::Relaxed);
+            while bits != 0 {
+                let bit = bits.trailing_zeros() as usize;
+                bits &= bits - 1;
+                let op = &self.ops[word * WAIT_BITS + bit];
+                unsafe { AsyncOperationRaw::unregister_completion_raw(op.as_ptr()) };
+            }
+        }
+        unsafe {
+            core::ptr::drop_in_place(self.core.as_ptr());
+            GlobalAllocator.dealloc(self.core.as_ptr() as *mut u8, self.layout);
+        }
+    }
+}
+
+/// Future returned by [`AsyncWaitSet::next_completed`].
+pub struct NextCompleted<'s, 'a, T: AsyncValueType> {
+    set: &'s mut AsyncWaitSet<'a, T>,
+}
+
+impl<T: AsyncValueType> Future for NextCompleted<'_, '_, T> {
+    type Output = Option<usize>;
+
+    #[inline]
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
+        self.get_mut().set.poll_next_completed(cx)
+    }
+}
+
+/// Future returned by [`wait_any`]. Resolves to the index of the first finished operation.
+pub struct WaitAny<'a, T: AsyncValueType> {
+    ops: &'a [ComRc<AsyncOperationRaw<T>>],
+    set: Option<AsyncWaitSet<'a, T>>,
+}
+
+impl<'a, T: AsyncValueType> WaitAny<'a, T> {
+    /// Blocks until any operation finishes. See [`AsyncWaitSet::wait_next_completed`].
+    pub fn wait(mut self) -> Result<usize, NTSTATUS> {
+        if self.ops.is_empty() {
+            return Err(crate::iunknown::STATUS_INVALID_PARAMETER);
+        }
+        let set = match self.set.as_mut() {
+            Some(set) => set,
+            None => self.set.insert(AsyncWaitSet::new(self.ops)?),
+        };
+        set.wait_next_completed().ok_or(STATUS_UNSUCCESSFUL)
+    }
+}
+
+impl<T: AsyncValueType> Future for WaitAny<'_, T> {
+    type Output = Result<usize, NTSTATUS>;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
+        let this = self.get_mut();
+        if this.ops.is_empty() {
+            return Poll::Ready(Err(crate::iunknown::STATUS_INVALID_PARAMETER));
+        }
+        let set = match this.set.as_mut() {
+            Some(set) => set,
+            None => match AsyncWaitSet::new(this.ops) {
+                Ok(set) => this.set.insert(set),
+                Err(status) => return Poll::Ready(Err(status)),
+            },
+        };
+        set.poll_next_completed(cx)
+            .map(|index| index.ok_or(STATUS_UNSUCCESSFUL))
+    }
+}
+
+/// Future returned by [`wait_all`]. Resolves once every operation has finished.
+pub struct WaitAll<'a, T: AsyncValueType> {
+    ops: &'a [ComRc<AsyncOperationRaw<T>>],
+    set: Option<AsyncWaitSet<'a, T>>,
+}
+
+impl<'a, T: AsyncValueType> WaitAll<'a, T> {
+    /// Blocks until every operation finishes. See [`AsyncWaitSet::wait_next_completed`].
+    pub fn wait(mut self) -> Result<(), NTSTATUS> {
+        let set = match self.set.as_mut() {
+            Some(set) => set,
+            None => self.set.insert(AsyncWaitSet::new(self.ops)?),
+        };
+        while set.wait_next_completed().is_some() {}
+        Ok(())
+    }
+}
+
+impl<T: AsyncValueType> Future for WaitAll<'_, T> {
+    type Output = Result<(), NTSTATUS>;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
+        let this = self.get_mut();
+        let set = match this.set.as_mut() {
+            Some(set) => set,
+            None => match AsyncWaitSet::new(this.ops) {
+                Ok(set) => this.set.insert(set),
+                Err(status) => return Poll::Ready(Err(status)),
+            },
+        };
+        loop {
+            match set.poll_next_completed(cx) {
+                Poll::Ready(Some(_)) => continue,
+                Poll::Ready(None) => return Poll::Ready(Ok(())),
+                Poll::Pending => return Poll::Pending,
+            }
+        }
+    }
+}
+
+/// Waits until any of `ops` finishes, registering a single waiter on all of them.
+///
+/// Await the result, or call [`WaitAny::wait`] to block at PASSIVE_LEVEL. Use
+/// [`AsyncWaitSet`] directly to keep consuming completions after the first one.
+#[inline]
+pub fn wait_any<T: AsyncValueType>(ops: &[ComRc<AsyncOperationRaw<T>>]) -> WaitAny<'_, T> {
+    WaitAny { ops, set: None }
+}
+
+/// Waits until all of `ops` finish, registering a single waiter on all of them.
+///
+/// Await the result, or call [`WaitAll::wait`] to block at PASSIVE_LEVEL.
+#[inline]
+pub fn wait_all<T: AsyncValueType>(ops: &[ComRc<AsyncOperationRaw<T>>]) -> WaitAll<'_, T> {
+    WaitAll { ops, set: None }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -497,4 +1305,116 @@ mod tests {
             assert_eq!(status, STATUS_UNSUCCESSFUL);
         }
     }
+
+    type ManualTask = AsyncOperationTask<u32, core::future::Ready<u32>>;
+
+    fn manual_operation() -> ComRc<AsyncOperationRaw<u32>> {
+        let ptr = ComObject::<ManualTask, AsyncOperationVtbl<u32>>::new(ManualTask::new_state())
+            .expect("allocate operation");
+        unsafe { ComRc::from_raw_unchecked(ptr as *mut AsyncOperationRaw<u32>) }
+    }
+
+    fn manual_task(op: &ComRc<AsyncOperationRaw<u32>>) -> &ManualTask {
+        unsafe {
+            &ComObject::<ManualTask, AsyncOperationVtbl<u32>>::from_ptr(op.as_ptr() as *mut c_void)
+                .inner
+        }
+    }
+
+    struct CountingWaker(std::sync::atomic::AtomicUsize);
+
+    impl std::task::Wake for CountingWaker {
+        fn wake(self: std::sync::Arc<Self>) {
+            self.0.fetch_add(1, Ordering::Relaxed);
+        }
+    }
+
+    #[test]
+    fn wait_any_returns_finished_index() {
+        let _guard = TEST_LOCK.lock().unwrap();
+        let ops = [manual_operation(), spawn_async_operation(async { 7u32 }).unwrap()];
+        let counter = std::sync::Arc::new(CountingWaker(std::sync::atomic::AtomicUsize::new(0)));
+        let waker = Waker::from(counter);
+        let mut cx = Context::from_waker(&waker);
+
+        let mut any = wait_any(&ops);
+        assert_eq!(Pin::new(&mut any).poll(&mut cx), Poll::Ready(Ok(1)));
+        assert!(matches!(wait_any(&ops).wait(), Err(STATUS_DEVICE_BUSY)));
+        drop(any);
+        assert_eq!(wait_any(&ops).wait(), Ok(1));
+        assert!(matches!(
+            wait_any::<u32>(&[]).wait(),
+            Err(crate::iunknown::STATUS_INVALID_PARAMETER)
+        ));
+    }
+
+    #[test]
+    fn wait_set_reports_completions_once() {
+        let _guard = TEST_LOCK.lock().unwrap();
+        let ops = [manual_operation(), manual_operation(), manual_operation()];
+        let counter = std::sync::Arc::new(CountingWaker(std::sync::atomic::AtomicUsize::new(0)));
+        let waker = Waker::from(counter.clone());
+        let mut cx = Context::from_waker(&waker);
+
+        let mut set = AsyncWaitSet::new(&ops).expect("wait set");
+        assert_eq!(set.poll_next_completed(&mut cx), Poll::Pending);
+
+        manual_task(&ops[1]).store_result(5);
+        assert_eq!(counter.0.load(Ordering::Relaxed), 1);
+        assert!(set.is_completed(1));
+        assert_eq!(set.poll_next_completed(&mut cx), Poll::Ready(Some(1)));
+        assert_eq!(set.try_next_completed(), None);
+
+        manual_task(&ops[2]).store_error(STATUS_UNSUCCESSFUL);
+        manual_task(&ops[0]).store_canceled();
+        assert_eq!(set.completed_count(), 3);
+        assert_eq!(set.wait_next_completed(), Some(0));
+        assert_eq!(set.wait_next_completed(), Some(2));
+        assert_eq!(set.wait_next_completed(), None);
+
+        let mut all = wait_all(&ops);
+        assert_eq!(Pin::new(&mut all).poll(&mut cx), Poll::Ready(Ok(())));
+    }
+
+    #[test]
+    fn wait_set_drop_disarms_operations() {
+        let _guard = TEST_LOCK.lock().unwrap();
+        let ops = [manual_operation()];
+        drop(AsyncWaitSet::new(&ops).expect("wait set"));
+
+        let set = AsyncWaitSet::new(&ops).expect("slot is free again");
+        let dup = [ops[0].clone()];
+        assert!(matches!(AsyncWaitSet::new(&dup), Err(STATUS_DEVICE_BUSY)));
+        drop(set);
+
+        manual_task(&ops[0]).store_result(1);
+        let set = AsyncWaitSet::new(&ops).expect("finished op registers as ready");
+        assert!(set.is_completed(0));
+    }
+
+    #[test]
+    fn pin_init_spawn_constructs_in_place() {
+        let _guard = TEST_LOCK.lock().unwrap();
+        let ptr = spawn_async_operation_raw_pin_init::<u32, _, NTSTATUS>(crate::pin_init!(
+            core::future::ready(9u32)
+        ))
+        .unwrap_or_else(|_| panic!("spawn in place"));
+        let op = unsafe { ComRc::from_raw_unchecked(ptr) };
+        unsafe {
+            assert_eq!(
+                AsyncOperationRaw::<u32>::get_result_raw(op.as_ptr()),
+                Ok(9u32)
+            );
+        }
+    }
+
+    #[test]
+    fn pin_init_failure_reports_init_error() {
+        let _guard = TEST_LOCK.lock().unwrap();
+        ASYNC_OPERATION_DROP_COUNT.store(0, Ordering::Relaxed);
+        let init = PinInitOnce::new(|_ptr: *mut core::future::Ready<u32>| Err(STATUS_CANCELLED));
+        let result = AsyncOperationTask::<u32, core::future::Ready<u32>>::spawn_raw_pin_init(init);
+        assert!(matches!(result, Err(KBoxError::Init(STATUS_CANCELLED))));
+        assert_eq!(ASYNC_OPERATION_DROP_COUNT.load(Ordering::Relaxed), 1);
+    }
 }
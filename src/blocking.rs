@@ -0,0 +1,202 @@
+// blocking.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Running a future to completion from synchronous code.
+
+use core::future::Future;
+use core::pin::pin;
+use core::task::{Context, Poll};
+
+#[cfg(all(feature = "driver", not(miri)))]
+use core::cell::UnsafeCell;
+#[cfg(all(feature = "driver", not(miri)))]
+use core::ffi::c_void;
+#[cfg(all(feature = "driver", not(miri)))]
+use core::ptr::NonNull;
+#[cfg(all(feature = "driver", not(miri)))]
+use core::sync::atomic::{fence, AtomicU32, Ordering};
+#[cfg(all(feature = "driver", not(miri)))]
+use core::task::{RawWaker, RawWakerVTable, Waker};
+
+#[cfg(all(feature = "driver", not(miri)))]
+use crate::allocator::{dealloc_value_in, try_alloc_value_in, GlobalAllocator};
+#[cfg(all(feature = "driver", not(miri)))]
+use crate::ntddk::{
+    KeDelayExecutionThread, KeInitializeEvent, KeSetEvent, KeWaitForSingleObject,
+    SynchronizationEvent, KEVENT, LARGE_INTEGER, _KWAIT_REASON, _MODE,
+};
+#[cfg(all(feature = "driver", not(miri)))]
+use crate::refcount;
+
+/// Polling interval when no parker could be allocated (1 ms, relative).
+#[cfg(all(feature = "driver", not(miri)))]
+const BLOCK_ON_FALLBACK_INTERVAL: i64 = -10_000;
+
+/// Wakes a `block_on` caller by signalling its event. Reference counted, since
+/// a future may keep a clone of its waker after `block_on` returns.
+#[cfg(all(feature = "driver", not(miri)))]
+struct Parker {
+    ref_count: AtomicU32,
+    event: UnsafeCell<KEVENT>,
+}
+
+#[cfg(all(feature = "driver", not(miri)))]
+impl Parker {
+    const WAKER_VTABLE: RawWakerVTable =
+        RawWakerVTable::new(Self::clone, Self::wake, Self::wake_by_ref, Self::drop);
+
+    fn allocate() -> Option<NonNull<Self>> {
+        let parker = try_alloc_value_in(
+            &GlobalAllocator,
+            Parker {
+                ref_count: AtomicU32::new(1),
+                event: UnsafeCell::new(unsafe { core::mem::zeroed() }),
+            },
+        )
+        .ok()?;
+        unsafe {
+            KeInitializeEvent((*parker.as_ptr()).event.get(), SynchronizationEvent, 0);
+        }
+        Some(parker)
+    }
+
+    /// Takes over the allocation's reference.
+    #[inline]
+    unsafe fn into_waker(this: NonNull<Self>) -> Waker {
+        unsafe { Waker::from_raw(RawWaker::new(this.as_ptr() as *const (), &Self::WAKER_VTABLE)) }
+    }
+
+    unsafe fn clone(data: *const ()) -> RawWaker {
+        let _ = refcount::add(&unsafe { &*(data as *const Self) }.ref_count);
+        RawWaker::new(data, &Self::WAKER_VTABLE)
+    }
+
+    unsafe fn wake(data: *const ()) {
+        unsafe {
+            Self::wake_by_ref(data);
+            Self::drop(data);
+        }
+    }
+
+    unsafe fn wake_by_ref(data: *const ()) {
+        let parker = unsafe { &*(data as *const Self) };
+        unsafe { KeSetEvent(parker.event.get(), 0, 0) };
+    }
+
+    unsafe fn drop(data: *const ()) {
+        let parker = data as *mut Self;
+        if refcount::sub(&unsafe { &*parker }.ref_count) == 0 {
+            fence(Ordering::Acquire);
+            unsafe { dealloc_value_in(&GlobalAllocator, NonNull::new_unchecked(parker)) };
+        }
+    }
+
+    /// # Safety
+    /// The caller must hold a reference to `this`.
+    #[inline]
+    unsafe fn park(this: NonNull<Self>) {
+        let parker = this.as_ptr();
+        unsafe {
+            let _ = KeWaitForSingleObject(
+                (*parker).event.get() as *mut c_void,
+                _KWAIT_REASON::Executive,
+                _MODE::KernelMode as i8,
+                0,
+                core::ptr::null_mut(),
+            );
+        }
+    }
+}
+
+/// Runs `future` to completion on the current thread and returns its output.
+///
+/// The future is polled here, and the thread sleeps between polls until its
+/// waker fires: on a KEVENT with `KeWaitForSingleObject` in kernel builds, and
+/// with thread parking on the host. Nothing spins, and no task is allocated.
+/// The kernel parker is one small nonpaged block; if it cannot be allocated,
+/// the future is polled once per millisecond instead.
+///
+/// ```ignore
+/// fn dispatch_device_control(irp: &mut IRP) -> NTSTATUS {
+///     kcom::block_on(device.query_async(irp))
+/// }
+/// ```
+///
+/// # IRQL
+/// Kernel callers must be at PASSIVE_LEVEL (or APC_LEVEL), and the future must
+/// make progress without the calling thread, e.g. through DPCs, work items or
+/// I/O completion. Never block on a future that needs the current thread.
+#[cfg(all(feature = "driver", not(miri)))]
+pub fn block_on<F: Future>(future: F) -> F::Output {
+    debug_assert!(
+        unsafe { crate::ntddk::KeGetCurrentIrql() } <= crate::ntddk::APC_LEVEL as u8,
+        "block_on requires IRQL <= APC_LEVEL"
+    );
+    let mut future = pin!(future);
+    let Some(parker) = Parker::allocate() else {
+        return block_on_polling(future.as_mut());
+    };
+    let waker = unsafe { Parker::into_waker(parker) };
+    let mut cx = Context::from_waker(&waker);
+    loop {
+        if let Poll::Ready(output) = future.as_mut().poll(&mut cx) {
+            return output;
+        }
+        // The event stays signalled if the waker fired during the poll.
+        // `waker` holds the reference.
+        unsafe { Parker::park(parker) };
+    }
+}
+
+#[cfg(all(feature = "driver", not(miri)))]
+#[cold]
+fn block_on_polling<F: Future>(mut future: core::pin::Pin<&mut F>) -> F::Output {
+    let waker = Waker::noop();
+    let mut cx = Context::from_waker(waker);
+    let mut interval = LARGE_INTEGER {
+        QuadPart: BLOCK_ON_FALLBACK_INTERVAL,
+    };
+    loop {
+        if let Poll::Ready(output) = future.as_mut().poll(&mut cx) {
+            return output;
+        }
+        unsafe {
+            let _ = KeDelayExecutionThread(_MODE::KernelMode as i8, 0, &mut interval);
+        }
+    }
+}
+
+/// Runs `future` to completion on the current thread and returns its output.
+///
+/// The thread is parked between polls and unparked by the future's waker.
+/// Host builds need the `std` feature.
+#[cfg(all(feature = "std", any(not(feature = "driver"), miri)))]
+pub fn block_on<F: Future>(future: F) -> F::Output {
+    use crate::alloc::sync::Arc;
+    use crate::alloc::task::Wake;
+
+    struct ThreadWaker(std::thread::Thread);
+
+    impl Wake for ThreadWaker {
+        fn wake(self: Arc<Self>) {
+            self.0.unpark();
+        }
+
+        fn wake_by_ref(self: &Arc<Self>) {
+            self.0.unpark();
+        }
+    }
+
+    let waker = Arc::new(ThreadWaker(std::thread::current())).into();
+    let mut cx = Context::from_waker(&waker);
+    let mut future = pin!(future);
+    loop {
+        if let Poll::Ready(output) = future.as_mut().poll(&mut cx) {
+            return output;
+        }
+        // An unpark during the poll makes this return at once.
+        std::thread::park();
+    }
+}
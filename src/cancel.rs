@@ -0,0 +1,308 @@
+// cancel.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Hierarchical cancellation tokens shared by many tasks.
+
+use core::cell::UnsafeCell;
+use core::ptr::{null_mut, NonNull};
+use core::sync::atomic::{fence, AtomicBool, AtomicPtr, AtomicU32, Ordering};
+
+use crate::allocator::{dealloc_value_in, try_alloc_value_in, GlobalAllocator};
+use crate::iunknown::NTSTATUS;
+use crate::refcount;
+use crate::sync::SpinLock;
+
+/// How a token reaches an object registered with it.
+pub(crate) struct CancelTargetVtbl {
+    /// Takes a reference unless the target is already being destroyed.
+    pub(crate) try_add_ref: unsafe fn(*const ()) -> bool,
+    pub(crate) cancel: unsafe fn(*const ()),
+    pub(crate) release: unsafe fn(*const ()),
+}
+
+/// Entry of one target in a token's list. It is embedded in the target, so
+/// linking never allocates, and it holds a reference to the token it is linked
+/// to. The token holds no reference to the target: the target unlinks itself
+/// with [`unregister`](Self::unregister) before it is freed.
+pub(crate) struct CancelRegistration {
+    token: AtomicPtr<TokenInner>,
+    // `prev`, `next` and `linked` belong to the token's lock.
+    prev: UnsafeCell<*mut CancelRegistration>,
+    next: UnsafeCell<*mut CancelRegistration>,
+    linked: UnsafeCell<bool>,
+    target: *const (),
+    vtbl: &'static CancelTargetVtbl,
+}
+
+impl CancelRegistration {
+    #[inline]
+    pub(crate) const fn new(target: *const (), vtbl: &'static CancelTargetVtbl) -> Self {
+        Self {
+            token: AtomicPtr::new(null_mut()),
+            prev: UnsafeCell::new(null_mut()),
+            next: UnsafeCell::new(null_mut()),
+            linked: UnsafeCell::new(false),
+            target,
+            vtbl,
+        }
+    }
+
+    /// Unlinks the entry from its token and drops the token reference.
+    ///
+    /// # Safety
+    /// Call once, when the target is being destroyed (its count reached zero).
+    pub(crate) unsafe fn unregister(&self) {
+        let Some(token) = NonNull::new(self.token.load(Ordering::Acquire)) else {
+            return;
+        };
+        {
+            let mut list = unsafe { token.as_ref() }.registrations.lock();
+            if unsafe { *self.linked.get() } {
+                unsafe { list.unlink(self as *const Self as *mut Self) };
+            }
+        }
+        unsafe { TokenInner::release(token) };
+    }
+}
+
+/// Intrusive list of the targets a token cancels.
+struct RegistrationList {
+    head: *mut CancelRegistration,
+}
+
+// Only touched under the token's lock.
+unsafe impl Send for RegistrationList {}
+
+impl RegistrationList {
+    unsafe fn push(&mut self, entry: *mut CancelRegistration) {
+        unsafe {
+            *(*entry).prev.get() = null_mut();
+            *(*entry).next.get() = self.head;
+            *(*entry).linked.get() = true;
+            if !self.head.is_null() {
+                *(*self.head).prev.get() = entry;
+            }
+        }
+        self.head = entry;
+    }
+
+    unsafe fn unlink(&mut self, entry: *mut CancelRegistration) {
+        unsafe {
+            let prev = *(*entry).prev.get();
+            let next = *(*entry).next.get();
+            if prev.is_null() {
+                self.head = next;
+            } else {
+                *(*prev).next.get() = next;
+            }
+            if !next.is_null() {
+                *(*next).prev.get() = prev;
+            }
+            *(*entry).linked.get() = false;
+        }
+    }
+}
+
+struct TokenInner {
+    ref_count: AtomicU32,
+    cancelled: AtomicBool,
+    registrations: SpinLock<RegistrationList>,
+    /// This token's entry in its parent's list.
+    parent_link: CancelRegistration,
+}
+
+impl TokenInner {
+    const CHILD_VTBL: CancelTargetVtbl = CancelTargetVtbl {
+        try_add_ref: Self::try_add_ref_target,
+        cancel: Self::cancel_target,
+        release: Self::release_target,
+    };
+
+    fn allocate() -> Result<NonNull<Self>, NTSTATUS> {
+        let ptr = try_alloc_value_in(
+            &GlobalAllocator,
+            TokenInner {
+                ref_count: AtomicU32::new(1),
+                cancelled: AtomicBool::new(false),
+                registrations: SpinLock::new(RegistrationList { head: null_mut() }),
+                parent_link: CancelRegistration::new(core::ptr::null(), &Self::CHILD_VTBL),
+            },
+        )?;
+        unsafe {
+            core::ptr::addr_of_mut!((*ptr.as_ptr()).parent_link.target)
+                .write(ptr.as_ptr() as *const ());
+        }
+        Ok(ptr)
+    }
+
+    /// Links `entry` into this token, or cancels its target at once if the token
+    /// is already cancelled. Returns false if `entry` is linked to a token already.
+    ///
+    /// # Safety
+    /// The caller must keep `entry`'s target alive for the duration of the call.
+    unsafe fn register(this: NonNull<Self>, entry: &CancelRegistration) -> bool {
+        if entry
+            .token
+            .compare_exchange(null_mut(), this.as_ptr(), Ordering::AcqRel, Ordering::Acquire)
+            .is_err()
+        {
+            return false;
+        }
+        let inner = unsafe { this.as_ref() };
+        let _ = refcount::add(&inner.ref_count);
+        {
+            let mut list = inner.registrations.lock();
+            if !inner.cancelled.load(Ordering::Relaxed) {
+                unsafe { list.push(entry as *const CancelRegistration as *mut CancelRegistration) };
+                return true;
+            }
+        }
+        unsafe { (entry.vtbl.cancel)(entry.target) };
+        true
+    }
+
+    unsafe fn cancel(this: NonNull<Self>) {
+        let inner = unsafe { this.as_ref() };
+        // Targets that were still alive, chained through `next`. They are
+        // cancelled after the lock is dropped, since cancelling a child token
+        // takes the child's lock and releasing a target may unregister it.
+        let mut alive: *mut CancelRegistration = null_mut();
+        {
+            let mut list = inner.registrations.lock();
+            if inner.cancelled.swap(true, Ordering::AcqRel) {
+                return;
+            }
+            let mut entry = core::mem::replace(&mut list.head, null_mut());
+            while !entry.is_null() {
+                unsafe {
+                    let next = *(*entry).next.get();
+                    *(*entry).linked.get() = false;
+                    if ((*entry).vtbl.try_add_ref)((*entry).target) {
+                        *(*entry).next.get() = alive;
+                        alive = entry;
+                    }
+                    entry = next;
+                }
+            }
+        }
+        while !alive.is_null() {
+            unsafe {
+                let next = *(*alive).next.get();
+                let (target, vtbl) = ((*alive).target, (*alive).vtbl);
+                (vtbl.cancel)(target);
+                (vtbl.release)(target);
+                alive = next;
+            }
+        }
+    }
+
+    unsafe fn release(this: NonNull<Self>) {
+        if refcount::sub(&unsafe { this.as_ref() }.ref_count) != 0 {
+            return;
+        }
+        fence(Ordering::Acquire);
+        // Every linked entry holds a reference, so the list is empty by now.
+        unsafe { this.as_ref().parent_link.unregister() };
+        unsafe { dealloc_value_in(&GlobalAllocator, this) };
+    }
+
+    unsafe fn try_add_ref_target(target: *const ()) -> bool {
+        refcount::try_add(&unsafe { &*(target as *const Self) }.ref_count)
+    }
+
+    unsafe fn cancel_target(target: *const ()) {
+        unsafe { Self::cancel(NonNull::new_unchecked(target as *mut Self)) };
+    }
+
+    unsafe fn release_target(target: *const ()) {
+        unsafe { Self::release(NonNull::new_unchecked(target as *mut Self)) };
+    }
+}
+
+/// A cancellation signal shared by any number of tasks and child tokens.
+///
+/// Tasks follow a token through
+/// [`CancelHandle::link`](crate::CancelHandle::link) (or the work-item handle's
+/// `link`). Cancelling the token sets each linked task's cancellation request and
+/// wakes it, so the task sees it through `is_cancellation_requested` and
+/// [`Cancellable`](crate::Cancellable) like a request made through its own
+/// handle. Cancelling a token cancels its children, and theirs, in time linear
+/// in the number of entries; it never allocates. Cancelling a child leaves its
+/// parent alone.
+///
+/// Tokens are reference counted: clones share one signal. Checking
+/// [`is_cancelled`](Self::is_cancelled) is a single load. [`cancel`](Self::cancel)
+/// runs at IRQL <= DISPATCH_LEVEL; call it at PASSIVE_LEVEL when work-item tasks
+/// are linked, as for their own handles.
+///
+/// ```ignore
+/// let request = CancellationToken::new()?;
+/// let read = request.child()?;
+/// unsafe { spawn_dpc_task_cancellable(read_part(1)) }?.link(&read);
+/// unsafe { spawn_dpc_task_cancellable(read_part(2)) }?.link(&read);
+/// // Cancels both reads and everything else spawned for the request.
+/// request.cancel();
+/// ```
+pub struct CancellationToken {
+    inner: NonNull<TokenInner>,
+}
+
+unsafe impl Send for CancellationToken {}
+unsafe impl Sync for CancellationToken {}
+
+impl CancellationToken {
+    /// Creates a root token.
+    pub fn new() -> Result<Self, NTSTATUS> {
+        Ok(Self {
+            inner: TokenInner::allocate()?,
+        })
+    }
+
+    /// Creates a token that is cancelled together with `self`. The child keeps
+    /// its parent alive; dropping the last clone of a child unlinks it.
+    pub fn child(&self) -> Result<Self, NTSTATUS> {
+        let child = Self::new()?;
+        let link = unsafe { &child.inner.as_ref().parent_link };
+        let _linked = unsafe { TokenInner::register(self.inner, link) };
+        debug_assert!(_linked);
+        Ok(child)
+    }
+
+    /// Cancels this token and everything linked to it. Later calls do nothing.
+    #[inline]
+    pub fn cancel(&self) {
+        unsafe { TokenInner::cancel(self.inner) };
+    }
+
+    #[inline]
+    pub fn is_cancelled(&self) -> bool {
+        unsafe { self.inner.as_ref() }.cancelled.load(Ordering::Acquire)
+    }
+
+    /// See [`TokenInner::register`].
+    ///
+    /// # Safety
+    /// The caller must keep `entry`'s target alive for the duration of the call.
+    #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+    #[inline]
+    pub(crate) unsafe fn register(&self, entry: &CancelRegistration) -> bool {
+        unsafe { TokenInner::register(self.inner, entry) }
+    }
+}
+
+impl Clone for CancellationToken {
+    #[inline]
+    fn clone(&self) -> Self {
+        let _ = refcount::add(&unsafe { self.inner.as_ref() }.ref_count);
+        Self { inner: self.inner }
+    }
+}
+
+impl Drop for CancellationToken {
+    #[inline]
+    fn drop(&mut self) {
+        unsafe { TokenInner::release(self.inner) };
+    }
+}
@@ -0,0 +1,268 @@
+// epoch.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Epoch-based reclamation for lock-free structures that hand out COM pointers
+// without taking a reference first.
+
+use core::ffi::c_void;
+use core::marker::PhantomData;
+use core::ptr::{null_mut, NonNull};
+use core::sync::atomic::{fence, AtomicPtr, AtomicU64, AtomicUsize, Ordering};
+
+use crate::allocator::{dealloc_value_in, try_alloc_value_in, GlobalAllocator};
+use crate::iunknown::IUnknownVtbl;
+use crate::smart_ptr::{ComRc, ThreadSafeComInterface};
+
+/// Number of per-CPU epoch records. CPUs beyond this share a record.
+const EPOCH_SHARDS: usize = 64;
+
+/// Epochs are tracked modulo three: the current one, the previous one (readers
+/// may still be in it) and the one before (empty, reused by the next epoch).
+const EPOCH_SLOTS: usize = 3;
+
+static GLOBAL_EPOCH: AtomicU64 = AtomicU64::new(0);
+
+/// Per-CPU pin counts and deferred releases.
+#[repr(align(64))]
+struct EpochShard {
+    pinned: [AtomicUsize; EPOCH_SLOTS],
+    deferred: AtomicPtr<DeferredRelease>,
+}
+
+static EPOCH_SHARDS_TABLE: [EpochShard; EPOCH_SHARDS] = [const {
+    EpochShard {
+        pinned: [const { AtomicUsize::new(0) }; EPOCH_SLOTS],
+        deferred: AtomicPtr::new(null_mut()),
+    }
+}; EPOCH_SHARDS];
+
+/// A reference whose final `Release` waits for the readers of its epoch.
+struct DeferredRelease {
+    next: *mut DeferredRelease,
+    epoch: u64,
+    object: *mut c_void,
+}
+
+/// Keeps the current CPU's epoch pinned. Pointers read from a lock-free structure
+/// while the guard lives stay valid until it is dropped, even if they are
+/// unlinked and passed to [`defer_release`] in the meantime.
+///
+/// Pinning is one interlocked increment on a per-CPU line and two loads of the
+/// global epoch, and does not touch the IRQL, so it is usable at `DISPATCH_LEVEL`.
+/// Guards nest. A long-lived guard holds back every deferred release queued after
+/// it was taken.
+#[must_use = "the epoch is unpinned as soon as the guard is dropped"]
+pub struct EpochGuard {
+    shard: usize,
+    slot: usize,
+    // Unpinning must decrement the record this guard incremented.
+    _not_send: PhantomData<*mut ()>,
+}
+
+/// Pins the current epoch.
+pub fn pin() -> EpochGuard {
+    let shard = crate::refcount::current_shard() % EPOCH_SHARDS;
+    let pinned = &EPOCH_SHARDS_TABLE[shard].pinned;
+    loop {
+        let epoch = GLOBAL_EPOCH.load(Ordering::SeqCst);
+        let slot = (epoch % EPOCH_SLOTS as u64) as usize;
+        pinned[slot].fetch_add(1, Ordering::SeqCst);
+        // The epoch advanced before the increment became visible: the advancing
+        // CPU may not have counted us, so pin the new epoch instead.
+        if GLOBAL_EPOCH.load(Ordering::SeqCst) == epoch {
+            return EpochGuard {
+                shard,
+                slot,
+                _not_send: PhantomData,
+            };
+        }
+        pinned[slot].fetch_sub(1, Ordering::Release);
+    }
+}
+
+impl Drop for EpochGuard {
+    #[inline]
+    fn drop(&mut self) {
+        EPOCH_SHARDS_TABLE[self.shard].pinned[self.slot].fetch_sub(1, Ordering::Release);
+    }
+}
+
+/// Returns the current global epoch.
+#[inline]
+pub fn current_epoch() -> u64 {
+    GLOBAL_EPOCH.load(Ordering::Acquire)
+}
+
+/// Returns the epoch a pointer unlinked before this call is retired in.
+#[inline]
+pub(crate) fn retire_epoch() -> u64 {
+    // The caller's unlink must be ordered before the epoch it is stamped with.
+    fence(Ordering::SeqCst);
+    GLOBAL_EPOCH.load(Ordering::SeqCst)
+}
+
+/// Advances the global epoch if no CPU is still pinned in the previous one.
+pub fn try_advance() -> bool {
+    let epoch = GLOBAL_EPOCH.load(Ordering::SeqCst);
+    let previous = ((epoch + EPOCH_SLOTS as u64 - 1) % EPOCH_SLOTS as u64) as usize;
+    if EPOCH_SHARDS_TABLE
+        .iter()
+        .any(|shard| shard.pinned[previous].load(Ordering::SeqCst) != 0)
+    {
+        return false;
+    }
+    GLOBAL_EPOCH
+        .compare_exchange(epoch, epoch + 1, Ordering::SeqCst, Ordering::Relaxed)
+        .is_ok()
+}
+
+/// Returns true if no reader is pinned on any CPU. A pointer unlinked before
+/// the call can then be released at once: a reader that pins later no longer
+/// reaches it.
+pub fn is_quiescent() -> bool {
+    // The caller's unlink must be ordered before the pin counts it reads.
+    fence(Ordering::SeqCst);
+    EPOCH_SHARDS_TABLE.iter().all(|shard| {
+        shard
+            .pinned
+            .iter()
+            .all(|count| count.load(Ordering::SeqCst) == 0)
+    })
+}
+
+/// Releases `rc` once every reader that could still hold its pointer has unpinned.
+///
+/// Call after unlinking the pointer from the shared structure. The release is
+/// queued on the current CPU and performed by [`collect`] (or
+/// [`reclaim_deferred`](crate::reclaim::reclaim_deferred), which calls it) once the
+/// global epoch has advanced twice. The first queued release on an idle CPU runs
+/// the [reclaim hook](crate::reclaim::set_reclaim_hook).
+///
+/// Returns `rc` back if the queue node cannot be allocated. Structures that
+/// cannot undo the unlink take a [`ReleaseSlot`] before it instead.
+pub fn defer_release<T: ThreadSafeComInterface>(rc: ComRc<T>) -> Result<(), ComRc<T>> {
+    match ReleaseSlot::new() {
+        Some(slot) => {
+            slot.defer(rc);
+            Ok(())
+        }
+        None => Err(rc),
+    }
+}
+
+/// The queue node of one deferred release, allocated ahead of the unlink so
+/// that queueing the release afterwards cannot fail. Dropping an unused slot
+/// frees it.
+pub struct ReleaseSlot {
+    node: NonNull<DeferredRelease>,
+}
+
+// The node is owned by the slot until it is queued.
+unsafe impl Send for ReleaseSlot {}
+
+impl ReleaseSlot {
+    /// Allocates the node; `None` if the pool is exhausted.
+    pub fn new() -> Option<Self> {
+        let node = DeferredRelease {
+            next: null_mut(),
+            epoch: 0,
+            object: null_mut(),
+        };
+        try_alloc_value_in(&GlobalAllocator, node)
+            .ok()
+            .map(|node| Self { node })
+    }
+
+    /// Queues the release of `rc` like [`defer_release`].
+    pub fn defer<T: ThreadSafeComInterface>(self, rc: ComRc<T>) {
+        let node = core::mem::ManuallyDrop::new(self).node.as_ptr();
+        unsafe {
+            (*node).object = rc.into_raw() as *mut c_void;
+            (*node).epoch = retire_epoch();
+        }
+
+        let list = &EPOCH_SHARDS_TABLE[crate::refcount::current_shard() % EPOCH_SHARDS].deferred;
+        if unsafe { push_chain(list, node, node) } {
+            crate::reclaim::run_reclaim_hook();
+        }
+    }
+}
+
+impl Drop for ReleaseSlot {
+    fn drop(&mut self) {
+        unsafe { dealloc_value_in(&GlobalAllocator, self.node) };
+    }
+}
+
+/// Pushes the chain `first..=last` onto `list`; returns true if `list` was empty.
+///
+/// # Safety
+/// The chain must be owned by the caller and `last` must be reachable from `first`.
+unsafe fn push_chain(
+    list: &AtomicPtr<DeferredRelease>,
+    first: *mut DeferredRelease,
+    last: *mut DeferredRelease,
+) -> bool {
+    let mut head = list.load(Ordering::Relaxed);
+    loop {
+        unsafe { (*last).next = head };
+        match list.compare_exchange_weak(head, first, Ordering::Release, Ordering::Relaxed) {
+            Ok(_) => return head.is_null(),
+            Err(current) => head = current,
+        }
+    }
+}
+
+/// Returns true when at least one release is waiting for its epoch to expire
+/// (a racy snapshot).
+pub fn has_deferred() -> bool {
+    EPOCH_SHARDS_TABLE
+        .iter()
+        .any(|shard| !shard.deferred.load(Ordering::Relaxed).is_null())
+}
+
+/// Advances the epoch as far as the pinned readers allow and performs every
+/// deferred release whose readers have all left. Returns how many were released.
+///
+/// With no reader pinned, everything queued before the call is released.
+/// Releases that are still protected stay queued for the next call.
+pub fn collect() -> usize {
+    try_advance();
+    try_advance();
+    let epoch = GLOBAL_EPOCH.load(Ordering::SeqCst);
+
+    let mut released = 0;
+    for shard in &EPOCH_SHARDS_TABLE {
+        if shard.deferred.load(Ordering::Relaxed).is_null() {
+            continue;
+        }
+        let mut node = shard.deferred.swap(null_mut(), Ordering::Acquire);
+        let mut kept: *mut DeferredRelease = null_mut();
+        let mut kept_tail: *mut DeferredRelease = null_mut();
+        while !node.is_null() {
+            let next = unsafe { (*node).next };
+            // Every reader pinned at or before `epoch - 2` has unpinned, and later
+            // readers could no longer reach the pointer.
+            if unsafe { (*node).epoch } + 2 <= epoch {
+                let object = unsafe { (*node).object };
+                unsafe { dealloc_value_in(&GlobalAllocator, NonNull::new_unchecked(node)) };
+                let vtbl = unsafe { *(object as *mut *mut IUnknownVtbl) };
+                unsafe { ((*vtbl).Release)(object) };
+                released += 1;
+            } else {
+                unsafe { (*node).next = kept };
+                if kept_tail.is_null() {
+                    kept_tail = node;
+                }
+                kept = node;
+            }
+            node = next;
+        }
+        if !kept.is_null() {
+            unsafe { push_chain(&shard.deferred, kept, kept_tail) };
+        }
+    }
+    released
+}
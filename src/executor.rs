@@ -10,7 +10,6 @@ use core::future::Future;
     miri
 ))]
 use core::pin::Pin;
-#[cfg(any(not(feature = "driver"), feature = "async-com-kernel", miri))]
 use core::task::{Context, Poll};
 #[cfg(any(not(all(feature = "driver", feature = "async-com-kernel")), miri))]
 use core::cell::{Cell, RefCell};
@@ -26,17 +25,19 @@ use crate::iunknown::STATUS_SUCCESS;
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 use core::task::{RawWaker, RawWakerVTable, Waker};
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
-use core::cell::UnsafeCell;
+use core::cell::{Cell, UnsafeCell};
 
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 use core::ffi::c_void;
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 use core::mem::ManuallyDrop;
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+use core::marker::PhantomData;
 
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 use core::ptr::{NonNull, null_mut};
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
-use core::sync::atomic::{AtomicPtr, AtomicU32, AtomicU64, Ordering};
+use core::sync::atomic::{AtomicBool, AtomicPtr, AtomicU32, AtomicU64, Ordering};
 
 #[cfg(all(feature = "driver", feature = "async-com-kernel", driver_model__driver_type = "WDM", not(miri)))]
 use crate::ntddk::{
@@ -70,18 +71,30 @@ fn dummy_waker() -> core::task::Waker {
 }
 
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
-use crate::iunknown::STATUS_INSUFFICIENT_RESOURCES;
+use crate::iunknown::{STATUS_DEVICE_BUSY, STATUS_INSUFFICIENT_RESOURCES};
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
-use crate::allocator::{Allocator, KBox, PoolType, WdkAllocator};
+use crate::admission::{Admission, AdmissionLimits, Reserve};
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+use crate::allocator::{Allocator, KBox, PinInitOnce, PoolType, WdkAllocator, WdkNodeAllocator};
+use crate::allocator::{KBoxError, PinInit};
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 use crate::refcount;
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+use crate::reclaim::{self, RetiredLink};
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+use crate::task_state::TaskState;
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+use crate::cancel::{CancelRegistration, CancelTargetVtbl};
+use crate::cancel::CancellationToken;
 
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 use crate::ntddk::{
-    KeAcquireSpinLockRaiseToDpc, KeCancelTimer, KeInitializeDpc, KeInitializeSpinLock,
-    KeInitializeTimer, KeInsertQueueDpc, KeQueryPerformanceCounter, KeReleaseSpinLock,
-    KeRemoveQueueDpc, KeSetTimer, KDPC, KIRQL, KSPIN_LOCK, LARGE_INTEGER, PKDPC, KTIMER, PKTIMER,
+    KeCancelTimer, KeInitializeDpc, KeInitializeTimer, KeInsertQueueDpc,
+    KeQueryPerformanceCounter, KeRemoveQueueDpc, KeSetTimer, KDPC, LARGE_INTEGER, PKDPC, KTIMER,
+    PKTIMER,
 };
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+use crate::sync::SpinLock;
 
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 type TaskPollFn = for<'a> unsafe fn(*mut TaskHeader, &mut Context<'a>) -> Poll<NTSTATUS>;
@@ -97,19 +110,20 @@ enum DestroyMode {
 struct TaskVTable {
     poll: TaskPollFn,
     destroy: unsafe fn(*mut TaskHeader, DestroyMode),
+    /// Bytes charged to the tracker's admission limits.
+    size: usize,
 }
 
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 #[repr(C)]
 struct TaskHeader {
-    ref_count: AtomicU32,
-    scheduled: AtomicU32,
-    completed: AtomicU32,
-    cancel_requested: AtomicU32,
+    state: TaskState,
     dpc: KDPC,
     vtable: &'static TaskVTable,
     alloc_tag: u32,
     tracker: *const TaskTracker,
+    retired: RetiredLink,
+    cancel_link: CancelRegistration,
 }
 
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
@@ -168,6 +182,21 @@ pub fn set_task_alloc_tag(tag: u32) {
     DEFAULT_TASK_TAG.store(tag, Ordering::Release);
 }
 
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+static DEFER_TASK_RECLAIM: AtomicBool = AtomicBool::new(false);
+
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+/// Defer the teardown of DPC tasks to [`reclaim_deferred`](crate::reclaim::reclaim_deferred).
+///
+/// When enabled, the last `release` of a task only pushes it onto the current CPU's
+/// garbage list, so dropping the future and freeing the task no longer run inside
+/// the DPC that completed it. The task tracker is signalled once the task is
+/// reclaimed, so call `reclaim_deferred` before waiting on it at unload.
+#[inline]
+pub fn set_task_deferred_reclaim(enabled: bool) {
+    DEFER_TASK_RECLAIM.store(enabled, Ordering::Release);
+}
+
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 // NOTE: KeGetCurrentProcessorNumberEx returns a group-relative index.
 // Windows currently supports up to 64 processors per group and 64 groups.
@@ -177,12 +206,85 @@ const MAX_GROUP_COUNT: usize = 64;
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 const MAX_CPU_COUNT: usize = MAX_PROC_PER_GROUP * MAX_GROUP_COUNT;
 
+/// The DPC run in progress on each CPU. Entries point into the DPC routine's
+/// stack; a run never leaves its CPU, so code it polls can use them freely.
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
-static CURRENT_TASKS: [AtomicPtr<TaskHeader>; MAX_CPU_COUNT] =
+static CURRENT_RUNS: [AtomicPtr<DpcRun>; MAX_CPU_COUNT] =
     [const { AtomicPtr::new(null_mut()) }; MAX_CPU_COUNT];
 
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+struct DpcRun {
+    task: NonNull<TaskHeader>,
+    budget: RunBudget,
+}
+
+/// What is left of a DPC run's [`TaskBudget`]. Re-polls after a self-wake and
+/// [`consume_budget`] both charge it.
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+struct RunBudget {
+    mode: u32,
+    polls: Cell<u32>,
+    checks: Cell<u32>,
+    start_ticks: u64,
+    budget_ticks: u64,
+    spent: Cell<bool>,
+}
+
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+impl RunBudget {
+    fn new() -> Self {
+        let mode = TASK_BUDGET_MODE.load(Ordering::Acquire);
+        let (budget_ticks, start_ticks) = if mode == TASK_BUDGET_MODE_TIME_US {
+            let mut freq = LARGE_INTEGER { QuadPart: 0 };
+            let start = unsafe { KeQueryPerformanceCounter(&mut freq) };
+            let freq = if freq.QuadPart <= 0 { 1 } else { freq.QuadPart as u64 };
+            let budget_us = TASK_BUDGET_TIME_US.load(Ordering::Acquire);
+            let ticks = budget_us.saturating_mul(freq) / 1_000_000;
+            (ticks, start.QuadPart as u64)
+        } else {
+            (0, 0)
+        };
+        Self {
+            mode,
+            polls: Cell::new(TASK_BUDGET_POLLS.load(Ordering::Acquire)),
+            checks: Cell::new(0),
+            start_ticks,
+            budget_ticks,
+            spent: Cell::new(false),
+        }
+    }
+
+    /// Charges one unit; returns false once the run's budget is spent.
+    fn charge(&self) -> bool {
+        if self.spent.get() {
+            return false;
+        }
+        if self.mode == TASK_BUDGET_MODE_POLLS {
+            let polls = self.polls.get();
+            if polls == 0 {
+                self.spent.set(true);
+                return false;
+            }
+            self.polls.set(polls - 1);
+            return true;
+        }
+        let checks = self.checks.get().wrapping_add(1);
+        self.checks.set(checks);
+        if checks % TASK_BUDGET_TIME_CHECK_INTERVAL == 0 {
+            let now = unsafe { KeQueryPerformanceCounter(null_mut()) };
+            let elapsed = (now.QuadPart as u64).wrapping_sub(self.start_ticks);
+            if elapsed >= self.budget_ticks {
+                self.spent.set(true);
+                return false;
+            }
+        }
+        true
+    }
+}
+
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 #[repr(C)]
+#[derive(Copy, Clone)]
 #[allow(dead_code, non_camel_case_types, non_snake_case)]
 struct PROCESSOR_NUMBER {
     Group: u16,
@@ -190,9 +292,30 @@ struct PROCESSOR_NUMBER {
     Reserved: u8,
 }
 
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+#[repr(C)]
+#[allow(dead_code, non_camel_case_types, non_snake_case)]
+struct GROUP_AFFINITY {
+    Mask: usize,
+    Group: u16,
+    Reserved: [u16; 3],
+}
+
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+const INVALID_PROCESSOR_INDEX: u32 = 0xffff_ffff;
+/// `MediumHighImportance`: a DPC targeted at another CPU interrupts it right
+/// away instead of waiting for its next clock tick.
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+const MEDIUM_HIGH_IMPORTANCE: i32 = 3;
+
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 extern "system" {
     fn KeGetCurrentProcessorNumberEx(processor: *mut PROCESSOR_NUMBER);
+    fn KeGetProcessorIndexFromNumber(processor: *const PROCESSOR_NUMBER) -> u32;
+    fn KeQueryHighestNodeNumber() -> u16;
+    fn KeQueryNodeActiveAffinity(node: u16, affinity: *mut GROUP_AFFINITY, count: *mut u16);
+    fn KeSetTargetProcessorDpcEx(dpc: PKDPC, processor: *const PROCESSOR_NUMBER) -> NTSTATUS;
+    fn KeSetImportanceDpc(dpc: PKDPC, importance: i32);
 }
 
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
@@ -217,16 +340,130 @@ fn current_cpu_index() -> Option<usize> {
     Some(group * MAX_PROC_PER_GROUP + number)
 }
 
+/// Where a DPC task runs and where its memory comes from.
+///
+/// A task placed on a processor or node is allocated from that node's pool and
+/// its DPC is targeted at its home processor, so the first poll and every re-wake
+/// run there no matter which CPU calls `wake`. Host builds ignore the placement.
+#[derive(Copy, Clone, Debug, Default, PartialEq, Eq)]
+pub enum TaskPlacement {
+    /// Run on the CPU that schedules the task (the default for every other spawn).
+    #[default]
+    Any,
+    /// Run on one processor, allocated from the node it belongs to.
+    Processor { group: u16, number: u8 },
+    /// Run on a processor of a NUMA node, allocated from that node. Tasks spawned
+    /// onto the same node are spread over its active processors in turn.
+    Node(u16),
+}
+
+/// A resolved [`TaskPlacement`].
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+#[derive(Copy, Clone)]
+struct TaskHome {
+    processor: Option<PROCESSOR_NUMBER>,
+    node: Option<u16>,
+}
+
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+static NODE_PLACEMENT_ROTOR: AtomicU32 = AtomicU32::new(0);
+
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+impl TaskHome {
+    const ANY: Self = Self {
+        processor: None,
+        node: None,
+    };
+
+    fn resolve(placement: TaskPlacement) -> Result<Self, NTSTATUS> {
+        match placement {
+            TaskPlacement::Any => Ok(Self::ANY),
+            TaskPlacement::Processor { group, number } => {
+                let processor = PROCESSOR_NUMBER {
+                    Group: group,
+                    Number: number,
+                    Reserved: 0,
+                };
+                if unsafe { KeGetProcessorIndexFromNumber(&processor) } == INVALID_PROCESSOR_INDEX {
+                    return Err(STATUS_INVALID_PARAMETER);
+                }
+                let highest = unsafe { KeQueryHighestNodeNumber() };
+                let node = (0..=highest).find(|&node| {
+                    let affinity = node_affinity(node);
+                    affinity.Group == group
+                        && (number as u32) < usize::BITS
+                        && affinity.Mask & (1usize << number) != 0
+                });
+                Ok(Self {
+                    processor: Some(processor),
+                    node,
+                })
+            }
+            TaskPlacement::Node(node) => {
+                if node > unsafe { KeQueryHighestNodeNumber() } {
+                    return Err(STATUS_INVALID_PARAMETER);
+                }
+                let affinity = node_affinity(node);
+                // A node without active processors still has memory to allocate from.
+                let processor = (affinity.Mask != 0).then(|| {
+                    let pick = NODE_PLACEMENT_ROTOR.fetch_add(1, Ordering::Relaxed)
+                        % affinity.Mask.count_ones();
+                    let mut mask = affinity.Mask;
+                    for _ in 0..pick {
+                        mask &= mask - 1;
+                    }
+                    PROCESSOR_NUMBER {
+                        Group: affinity.Group,
+                        Number: mask.trailing_zeros() as u8,
+                        Reserved: 0,
+                    }
+                });
+                Ok(Self {
+                    processor,
+                    node: Some(node),
+                })
+            }
+        }
+    }
+}
+
+/// Active processors of `node` in its primary group.
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+#[inline]
+fn node_affinity(node: u16) -> GROUP_AFFINITY {
+    let mut affinity = GROUP_AFFINITY {
+        Mask: 0,
+        Group: 0,
+        Reserved: [0; 3],
+    };
+    unsafe { KeQueryNodeActiveAffinity(node, &mut affinity, null_mut()) };
+    affinity
+}
+
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 #[inline]
-unsafe fn set_current_task(cpu_index: usize, ptr: NonNull<TaskHeader>) {
-    CURRENT_TASKS[cpu_index].store(ptr.as_ptr(), Ordering::Release);
+unsafe fn set_current_run(cpu_index: usize, run: &DpcRun) {
+    CURRENT_RUNS[cpu_index].store(run as *const DpcRun as *mut DpcRun, Ordering::Release);
 }
 
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 #[inline]
-unsafe fn clear_current_task(cpu_index: usize) {
-    CURRENT_TASKS[cpu_index].store(null_mut(), Ordering::Release);
+unsafe fn clear_current_run(cpu_index: usize) {
+    CURRENT_RUNS[cpu_index].store(null_mut(), Ordering::Release);
+}
+
+/// Calls `f` with the DPC run polling the caller, if any.
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+#[inline]
+fn with_current_run<R>(f: impl FnOnce(&DpcRun) -> R) -> Option<R> {
+    let irql = unsafe { crate::ntddk::KeGetCurrentIrql() };
+    if irql < crate::ntddk::DISPATCH_LEVEL as u8 {
+        return None;
+    }
+    let cpu_index = current_cpu_index()?;
+    let ptr = CURRENT_RUNS[cpu_index].load(Ordering::Acquire);
+    // The run outlives any poll it makes and cannot migrate at DISPATCH_LEVEL.
+    unsafe { ptr.as_ref() }.map(f)
 }
 
 /// Returns true when the currently running DPC task has a cancellation request.
@@ -235,19 +472,10 @@ unsafe fn clear_current_task(cpu_index: usize) {
 /// tasks may migrate across CPUs, so this helper will not reliably track their state.
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 pub fn is_cancellation_requested() -> bool {
-    let irql = unsafe { crate::ntddk::KeGetCurrentIrql() };
-    if irql < crate::ntddk::DISPATCH_LEVEL as u8 {
-        return false;
-    }
-    let Some(cpu_index) = current_cpu_index() else {
-        return false;
-    };
-    let ptr = CURRENT_TASKS[cpu_index].load(Ordering::Acquire);
-    if ptr.is_null() {
-        return false;
-    }
-
-    unsafe { (*ptr).cancel_requested.load(Ordering::Relaxed) != 0 }
+    with_current_run(|run| {
+        unsafe { run.task.as_ref() }.state.is_cancel_requested()
+    })
+    .unwrap_or(false)
 }
 
 /// Stub for non-kernel builds.
@@ -260,23 +488,7 @@ pub fn is_cancellation_requested() -> bool {
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 #[inline]
 pub(crate) fn take_cancellation_request() -> bool {
-    let irql = unsafe { crate::ntddk::KeGetCurrentIrql() };
-    if irql < crate::ntddk::DISPATCH_LEVEL as u8 {
-        return false;
-    }
-    let Some(cpu_index) = current_cpu_index() else {
-        return false;
-    };
-    let ptr = CURRENT_TASKS[cpu_index].load(Ordering::Acquire);
-    if ptr.is_null() {
-        return false;
-    }
-
-    let header = unsafe { &*ptr };
-    header
-        .cancel_requested
-        .compare_exchange(1, 2, Ordering::AcqRel, Ordering::Acquire)
-        .is_ok()
+    with_current_run(|run| unsafe { run.task.as_ref() }.state.take_cancel()).unwrap_or(false)
 }
 
 /// Stub for non-kernel builds.
@@ -286,83 +498,195 @@ pub(crate) fn take_cancellation_request() -> bool {
     false
 }
 
+/// Charges one unit against the running DPC task's budget; false once it is spent.
+/// Anything but a DPC task runs unbudgeted.
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+#[inline]
+fn charge_current_budget() -> bool {
+    with_current_run(|run| run.budget.charge()).unwrap_or(true)
+}
+
+#[cfg(any(not(all(feature = "driver", feature = "async-com-kernel")), miri))]
+#[inline]
+fn charge_current_budget() -> bool {
+    true
+}
+
+/// Ends the running DPC task's budget, so its next self-wake re-queues the DPC.
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+#[inline]
+fn exhaust_current_budget() {
+    let _ = with_current_run(|run| run.budget.spent.set(true));
+}
+
+#[cfg(any(not(all(feature = "driver", feature = "async-com-kernel")), miri))]
+#[inline]
+fn exhaust_current_budget() {}
+
+/// Budget check for leaf futures (timers, wait sets): charges one unit, and once
+/// the budget is spent wakes the task and returns `Pending` so the executor
+/// re-queues its DPC before the future makes more progress.
+#[inline]
+pub(crate) fn poll_proceed(cx: &mut Context<'_>) -> Poll<()> {
+    if charge_current_budget() {
+        Poll::Ready(())
+    } else {
+        cx.waker().wake_by_ref();
+        Poll::Pending
+    }
+}
+
+/// Charges one unit of work against the running DPC task's [`TaskBudget`].
+///
+/// Resolves at once while budget remains. Once it is spent, the task yields:
+/// its DPC is re-queued and the await completes on the next run, after other
+/// DPCs queued on the CPU had their turn. Call it between chunks of synchronous
+/// work so a single `poll` cannot monopolise the CPU. Kernel timers and
+/// `AsyncWaitSet` completions charge the budget themselves.
+///
+/// Outside a DPC task (work-item tasks, host builds) it always resolves at once.
+#[inline]
+pub fn consume_budget() -> ConsumeBudget {
+    ConsumeBudget { yielded: false }
+}
+
+/// Future returned by [`consume_budget`].
+#[must_use = "futures do nothing unless awaited"]
+pub struct ConsumeBudget {
+    yielded: bool,
+}
+
+impl Future for ConsumeBudget {
+    type Output = ();
+
+    #[inline]
+    fn poll(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<()> {
+        if self.yielded {
+            return Poll::Ready(());
+        }
+        let poll = poll_proceed(cx);
+        self.yielded = poll.is_pending();
+        poll
+    }
+}
+
+/// Yields the running task once.
+///
+/// In a DPC task this ends the current run's budget, so the DPC is re-queued
+/// and other DPCs on the CPU run before the task continues. Elsewhere it
+/// returns `Pending` once after waking the task.
+#[inline]
+pub fn yield_now() -> YieldNow {
+    YieldNow { yielded: false }
+}
+
+/// Future returned by [`yield_now`].
+#[must_use = "futures do nothing unless awaited"]
+pub struct YieldNow {
+    yielded: bool,
+}
+
+impl Future for YieldNow {
+    type Output = ();
+
+    #[inline]
+    fn poll(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<()> {
+        if self.yielded {
+            return Poll::Ready(());
+        }
+        self.yielded = true;
+        exhaust_current_budget();
+        cx.waker().wake_by_ref();
+        Poll::Pending
+    }
+}
+
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 impl TaskHeader {
     #[inline]
     unsafe fn add_ref(ptr: NonNull<Self>) {
-        let header = unsafe { &*ptr.as_ptr() };
-        let _ = refcount::add(&header.ref_count);
+        unsafe { &*ptr.as_ptr() }.state.ref_inc();
     }
 
     unsafe fn release(ptr: NonNull<Self>) {
-        let header = unsafe { &*ptr.as_ptr() };
-        let count = refcount::sub(&header.ref_count);
-        if count != 0 {
+        if !unsafe { &*ptr.as_ptr() }.state.ref_dec() {
             return;
         }
 
         core::sync::atomic::fence(Ordering::Acquire);
+        if DEFER_TASK_RECLAIM.load(Ordering::Relaxed) {
+            let header = ptr.as_ptr();
+            unsafe {
+                reclaim::defer_destroy(
+                    core::ptr::addr_of_mut!((*header).retired),
+                    header as *mut c_void,
+                    Self::destroy_retired,
+                    (*header).alloc_tag,
+                )
+            };
+            return;
+        }
+        unsafe { Self::destroy(ptr) };
+    }
+
+    unsafe fn destroy_retired(object: *mut c_void) {
+        unsafe { Self::destroy(NonNull::new_unchecked(object as *mut Self)) };
+    }
+
+    unsafe fn destroy(ptr: NonNull<Self>) {
         let header = unsafe { &*ptr.as_ptr() };
+        unsafe { header.cancel_link.unregister() };
         let tracker = header.tracker;
-        if header.completed.load(Ordering::Acquire) == 0 {
-            header.completed.store(1, Ordering::Release);
-            unsafe { (header.vtable.destroy)(ptr.as_ptr(), DestroyMode::Drop) };
-            unsafe { (header.vtable.destroy)(ptr.as_ptr(), DestroyMode::Dealloc) };
-            unsafe { task_tracker_complete(tracker) };
+        let vtable = header.vtable;
+        if !header.state.is_complete() {
+            unsafe { (vtable.destroy)(ptr.as_ptr(), DestroyMode::Drop) };
+            unsafe { (vtable.destroy)(ptr.as_ptr(), DestroyMode::Dealloc) };
+            unsafe { task_tracker_complete(tracker, vtable.size) };
             return;
         }
 
-        unsafe { (header.vtable.destroy)(ptr.as_ptr(), DestroyMode::Dealloc) };
-        unsafe { task_tracker_complete(tracker) };
+        unsafe { (vtable.destroy)(ptr.as_ptr(), DestroyMode::Dealloc) };
+        unsafe { task_tracker_complete(tracker, vtable.size) };
     }
 
     #[inline]
     unsafe fn cancel(ptr: NonNull<Self>) {
-        let header = unsafe { &*ptr.as_ptr() };
-        if header
-            .cancel_requested
-            .compare_exchange(0, 1, Ordering::SeqCst, Ordering::Acquire)
-            .is_ok()
-        {
-            unsafe { Self::schedule(ptr) };
+        if let Some(true) = unsafe { &*ptr.as_ptr() }.state.request_cancel() {
+            unsafe { Self::submit(ptr) };
         }
     }
 
-    #[inline]
-    unsafe fn schedule(ptr: NonNull<Self>) {
-        if unsafe { &*ptr.as_ptr() }
-            .completed
-            .load(Ordering::Acquire)
-            != 0
-        {
-            return;
-        }
+    const CANCEL_TARGET_VTBL: CancelTargetVtbl = CancelTargetVtbl {
+        try_add_ref: Self::try_add_ref_target,
+        cancel: Self::cancel_target,
+        release: Self::release_target,
+    };
 
-        if unsafe { &*ptr.as_ptr() }
-            .scheduled
-            .compare_exchange(0, 1, Ordering::AcqRel, Ordering::Acquire)
-            .is_err()
-        {
-            return;
-        }
+    unsafe fn try_add_ref_target(target: *const ()) -> bool {
+        unsafe { &*(target as *const Self) }.state.try_ref_inc()
+    }
 
-        unsafe { Self::add_ref(ptr) };
-        let inserted = unsafe {
-            KeInsertQueueDpc(
-                &mut (*ptr.as_ptr()).dpc as PKDPC,
-                null_mut(),
-                null_mut(),
-            )
-        };
+    unsafe fn cancel_target(target: *const ()) {
+        unsafe { Self::cancel(NonNull::new_unchecked(target as *mut Self)) };
+    }
 
-        if inserted == 0 {
-            unsafe { Self::release(ptr) };
+    unsafe fn release_target(target: *const ()) {
+        unsafe { Self::release(NonNull::new_unchecked(target as *mut Self)) };
+    }
+
+    #[inline]
+    unsafe fn schedule(ptr: NonNull<Self>) {
+        if unsafe { &*ptr.as_ptr() }.state.transition_to_notified() {
+            unsafe { Self::submit(ptr) };
         }
     }
 
+    /// Queues the DPC for a run the state has scheduled; the DPC owns the
+    /// reference taken for it. If it cannot be queued the run is unscheduled
+    /// again, so the next wake submits a new one. Every caller holds another
+    /// reference.
     #[inline]
-    unsafe fn queue_dpc(ptr: NonNull<Self>) {
-        unsafe { Self::add_ref(ptr) };
+    unsafe fn submit(ptr: NonNull<Self>) {
         let inserted = unsafe {
             KeInsertQueueDpc(
                 &mut (*ptr.as_ptr()).dpc as PKDPC,
@@ -372,7 +696,7 @@ impl TaskHeader {
         };
 
         if inserted == 0 {
-            unsafe { Self::release(ptr) };
+            unsafe { &*ptr.as_ptr() }.state.cancel_submit();
         }
     }
 
@@ -387,94 +711,63 @@ impl TaskHeader {
             None => return,
         };
 
-        let cpu_index = current_cpu_index();
-        unsafe { &*ptr.as_ptr() }.scheduled.store(0, Ordering::Release);
-
-        if unsafe { &*ptr.as_ptr() }
-            .completed
-            .load(Ordering::Acquire)
-            != 0
-        {
+        let header = unsafe { &*ptr.as_ptr() };
+        if !header.state.transition_to_running() {
             unsafe { Self::release(ptr) };
             return;
         }
+        let cpu_index = current_cpu_index();
 
-        let waker = unsafe { Waker::from_raw(Self::raw_waker(ptr)) };
+        // The DPC's reference outlives the run, so the waker borrows it.
+        let waker = ManuallyDrop::new(unsafe {
+            Waker::from_raw(RawWaker::new(
+                ptr.as_ptr() as *const (),
+                &Self::RAW_WAKER_VTABLE,
+            ))
+        });
         let mut cx = Context::from_waker(&waker);
 
+        let run = DpcRun {
+            task: ptr,
+            budget: RunBudget::new(),
+        };
         if let Some(cpu_index) = cpu_index {
-            unsafe { set_current_task(cpu_index, ptr) };
+            unsafe { set_current_run(cpu_index, &run) };
         }
-        let budget_mode = TASK_BUDGET_MODE.load(Ordering::Acquire);
-        let mut poll_budget = TASK_BUDGET_POLLS.load(Ordering::Acquire);
-        let (time_budget_ticks, time_start_ticks) = if budget_mode == TASK_BUDGET_MODE_TIME_US {
-            let mut freq = LARGE_INTEGER { QuadPart: 0 };
-            let start = unsafe { KeQueryPerformanceCounter(&mut freq) };
-            let freq = if freq.QuadPart <= 0 { 1 } else { freq.QuadPart as u64 };
-            let budget_us = TASK_BUDGET_TIME_US.load(Ordering::Acquire);
-            let ticks = budget_us.saturating_mul(freq) / 1_000_000;
-            (ticks, start.QuadPart as u64)
-        } else {
-            (0, 0)
-        };
-        let mut time_check_counter: u32 = 0;
 
         loop {
             let poll = unsafe { ((*ptr.as_ptr()).vtable.poll)(ptr.as_ptr(), &mut cx) };
             match poll {
                 Poll::Ready(_status) => {
-                    unsafe { &*ptr.as_ptr() }.completed.store(1, Ordering::Release);
+                    header.state.transition_to_complete();
                     unsafe {
                         ((*ptr.as_ptr()).vtable.destroy)(ptr.as_ptr(), DestroyMode::Drop)
                     };
                     if let Some(cpu_index) = cpu_index {
-                        unsafe { clear_current_task(cpu_index) };
+                        unsafe { clear_current_run(cpu_index) };
                     }
                     unsafe { Self::release(ptr) };
                     return;
                 }
                 Poll::Pending => {
-                    let woken = unsafe { &*ptr.as_ptr() }
-                        .scheduled
-                        .load(Ordering::Acquire)
-                        != 0;
-                    if !woken {
+                    // A wake during the poll left the task running instead of
+                    // queueing another run; poll it again here.
+                    if !header.state.transition_to_idle() {
                         break;
                     }
 
-                    let mut budget_exhausted = false;
-                    if budget_mode == TASK_BUDGET_MODE_POLLS {
-                        if poll_budget == 0 {
-                            budget_exhausted = true;
-                        } else {
-                            poll_budget -= 1;
-                        }
-                    } else {
-                        time_check_counter = time_check_counter.wrapping_add(1);
-                        if time_check_counter % TASK_BUDGET_TIME_CHECK_INTERVAL == 0 {
-                            let now = unsafe { KeQueryPerformanceCounter(null_mut()) };
-                            let elapsed = (now.QuadPart as u64)
-                                .wrapping_sub(time_start_ticks);
-                            if elapsed >= time_budget_ticks {
-                                budget_exhausted = true;
-                            }
-                        }
-                    }
-
-                    if budget_exhausted {
-                        unsafe { Self::queue_dpc(ptr) };
+                    // Spent by this re-poll or by `consume_budget` inside the poll.
+                    if !run.budget.charge() {
+                        header.state.transition_to_requeued();
+                        unsafe { Self::submit(ptr) };
                         break;
                     }
-
-                    unsafe { &*ptr.as_ptr() }
-                        .scheduled
-                        .store(0, Ordering::Release);
                 }
             }
         }
 
         if let Some(cpu_index) = cpu_index {
-            unsafe { clear_current_task(cpu_index) };
+            unsafe { clear_current_run(cpu_index) };
         }
         unsafe { Self::release(ptr) };
     }
@@ -565,42 +858,99 @@ where
     const VTABLE: TaskVTable = TaskVTable {
         poll: Self::poll_shim,
         destroy: Self::destroy_shim,
+        size: core::mem::size_of::<Task<F>>(),
     };
 
     unsafe fn allocate(
         future: F,
         tracker: *const TaskTracker,
+        home: TaskHome,
+        admitted: bool,
     ) -> Result<NonNull<TaskHeader>, NTSTATUS> {
+        let init = PinInitOnce::new(move |slot: *mut F| {
+            unsafe { core::ptr::write(slot, future) };
+            Ok::<(), NTSTATUS>(())
+        });
+        unsafe { Self::allocate_in_place(init, tracker, home, admitted) }
+            .map_err(KBoxError::into_status)
+    }
+
+    /// Allocates the task and runs `init` directly into its future slot.
+    ///
+    /// A tracked task is charged to the tracker's admission limits first, unless
+    /// `admitted` says a [`SpawnPermit`] already paid for it. The charge is
+    /// returned when the task is freed or if it cannot be created.
+    unsafe fn allocate_in_place<E>(
+        init: impl PinInit<F, E>,
+        tracker: *const TaskTracker,
+        home: TaskHome,
+        admitted: bool,
+    ) -> Result<NonNull<TaskHeader>, KBoxError<E>> {
+        if !admitted && !unsafe { task_tracker_admit(tracker, Self::VTABLE.size) } {
+            return Err(KBoxError::Alloc(STATUS_DEVICE_BUSY));
+        }
+        match unsafe { Self::allocate_admitted(init, tracker, home) } {
+            Ok(ptr) => Ok(ptr),
+            Err(err) => {
+                unsafe { task_tracker_refund(tracker, Self::VTABLE.size) };
+                Err(err)
+            }
+        }
+    }
+
+    unsafe fn allocate_admitted<E>(
+        mut init: impl PinInit<F, E>,
+        tracker: *const TaskTracker,
+        home: TaskHome,
+    ) -> Result<NonNull<TaskHeader>, KBoxError<E>> {
         let tag = Self::alloc_tag();
+        // Node-local memory is freed like any other pool block, so `alloc` can
+        // release either.
         let alloc = WdkAllocator::new(PoolType::NonPagedNx, tag);
         let layout = core::alloc::Layout::new::<Task<F>>();
 
-        let ptr = unsafe { alloc.alloc(layout) } as *mut Task<F>;
-        let ptr = NonNull::new(ptr).ok_or(STATUS_INSUFFICIENT_RESOURCES)?;
+        let ptr = match home.node {
+            Some(node) => unsafe {
+                WdkNodeAllocator::new(PoolType::NonPagedNx, tag, node).alloc(layout)
+            },
+            None => unsafe { alloc.alloc(layout) },
+        } as *mut Task<F>;
+        let ptr = NonNull::new(ptr).ok_or(KBoxError::Alloc(STATUS_INSUFFICIENT_RESOURCES))?;
+
+        // `ManuallyDrop<F>` is `repr(transparent)`, so the slot is a plain `F`.
+        let slot = unsafe { core::ptr::addr_of_mut!((*ptr.as_ptr()).future) } as *mut F;
+        if let Err(err) = unsafe { init.init(slot) } {
+            unsafe { alloc.dealloc(ptr.as_ptr() as *mut u8, layout) };
+            return Err(KBoxError::Init(err));
+        }
 
         unsafe {
-            core::ptr::write(
-                ptr.as_ptr(),
-                Task {
-                    header: TaskHeader {
-                        ref_count: AtomicU32::new(1),
-                        scheduled: AtomicU32::new(0),
-                        completed: AtomicU32::new(0),
-                        cancel_requested: AtomicU32::new(0),
-                        dpc: core::mem::zeroed(),
-                        vtable: &Self::VTABLE,
-                        alloc_tag: tag,
-                        tracker,
-                    },
-                    future: ManuallyDrop::new(future),
-                },
-            );
+            core::ptr::addr_of_mut!((*ptr.as_ptr()).header).write(TaskHeader {
+                state: TaskState::new(),
+                dpc: core::mem::zeroed(),
+                vtable: &Self::VTABLE,
+                alloc_tag: tag,
+                tracker,
+                retired: RetiredLink::new(),
+                cancel_link: CancelRegistration::new(
+                    core::ptr::addr_of!((*ptr.as_ptr()).header) as *const (),
+                    &TaskHeader::CANCEL_TARGET_VTBL,
+                ),
+            });
 
             KeInitializeDpc(
                 &mut (*ptr.as_ptr()).header.dpc as PKDPC,
                 Some(TaskHeader::dpc_routine),
                 &mut (*ptr.as_ptr()).header as *mut TaskHeader as *mut c_void,
             );
+
+            if let Some(processor) = home.processor {
+                let dpc = &mut (*ptr.as_ptr()).header.dpc as PKDPC;
+                // The processor was validated by `TaskHome::resolve`.
+                let _status = KeSetTargetProcessorDpcEx(dpc, &processor);
+                debug_assert!(_status == STATUS_SUCCESS);
+                KeSetImportanceDpc(dpc, MEDIUM_HIGH_IMPORTANCE);
+            }
         }
 
         unsafe { task_tracker_begin(tracker) };
@@ -672,7 +1022,25 @@ impl CancelHandle {
             return false;
         };
 
-        unsafe { (*ptr.as_ptr()).cancel_requested.load(Ordering::Relaxed) != 0 }
+        unsafe { (*ptr.as_ptr()).state.is_cancel_requested() }
+    }
+
+    /// Cancel the task when `token` (or one of its ancestors) is cancelled.
+    ///
+    /// A task follows at most one token; linking it again returns
+    /// `STATUS_INVALID_PARAMETER`. If `token` is already cancelled, the task is
+    /// cancelled right away.
+    pub fn link(&self, token: &CancellationToken) -> NTSTATUS {
+        let ptr = self.task.load(Ordering::Acquire);
+        let Some(ptr) = NonNull::new(ptr) else {
+            return STATUS_INVALID_PARAMETER;
+        };
+
+        if unsafe { token.register(&(*ptr.as_ptr()).cancel_link) } {
+            STATUS_SUCCESS
+        } else {
+            STATUS_INVALID_PARAMETER
+        }
     }
 }
 
@@ -713,6 +1081,16 @@ impl CancelHandle {
     pub fn is_cancelled(&self) -> bool {
         self.cancelled.get()
     }
+
+    /// Host stub: tasks finish their only poll before `link` can run, so only a
+    /// token that is already cancelled has an effect.
+    #[inline]
+    pub fn link(&self, token: &CancellationToken) -> NTSTATUS {
+        if token.is_cancelled() {
+            self.cancel();
+        }
+        crate::iunknown::STATUS_SUCCESS
+    }
 }
 
 #[cfg(any(not(all(feature = "driver", feature = "async-com-kernel")), miri))]
@@ -736,70 +1114,6 @@ impl WorkItemTracker {
     pub fn drain(&self) {}
 }
 
-#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
-struct SpinLock<T> {
-    lock: UnsafeCell<KSPIN_LOCK>,
-    value: UnsafeCell<T>,
-}
-
-#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
-unsafe impl<T: Send> Send for SpinLock<T> {}
-#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
-unsafe impl<T: Send> Sync for SpinLock<T> {}
-
-#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
-impl<T> SpinLock<T> {
-    #[inline]
-    fn new(value: T) -> Self {
-        let mut lock = unsafe { core::mem::zeroed() };
-        unsafe { KeInitializeSpinLock(&mut lock) };
-        Self {
-            lock: UnsafeCell::new(lock),
-            value: UnsafeCell::new(value),
-        }
-    }
-
-    #[inline]
-    fn lock(&self) -> SpinLockGuard<'_, T> {
-        let old_irql = unsafe { KeAcquireSpinLockRaiseToDpc(self.lock.get()) };
-        SpinLockGuard {
-            lock: self,
-            old_irql,
-        }
-    }
-}
-
-#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
-struct SpinLockGuard<'a, T> {
-    lock: &'a SpinLock<T>,
-    old_irql: KIRQL,
-}
-
-#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
-impl<T> core::ops::Deref for SpinLockGuard<'_, T> {
-    type Target = T;
-    #[inline]
-    fn deref(&self) -> &Self::Target {
-        unsafe { &*self.lock.value.get() }
-    }
-}
-
-#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
-impl<T> core::ops::DerefMut for SpinLockGuard<'_, T> {
-    #[inline]
-    fn deref_mut(&mut self) -> &mut Self::Target {
-        unsafe { &mut *self.lock.value.get() }
-    }
-}
-
-#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
-impl<T> Drop for SpinLockGuard<'_, T> {
-    #[inline]
-    fn drop(&mut self) {
-        unsafe { KeReleaseSpinLock(self.lock.lock.get(), self.old_irql) };
-    }
-}
-
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 struct KernelTimerInner {
     ref_count: AtomicU32,
@@ -918,6 +1232,9 @@ impl Future for KernelTimerFuture {
         let inner = unsafe { &*this.inner.as_ptr() };
 
         if inner.fired.load(Ordering::Acquire) != 0 {
+            if poll_proceed(cx).is_pending() {
+                return Poll::Pending;
+            }
             return Poll::Ready(STATUS_SUCCESS);
         }
 
@@ -1169,14 +1486,12 @@ where
     C: TaskContext,
     F: Future<Output = NTSTATUS> + Send + 'static,
 {
-    ref_count: AtomicU32,
-    scheduled: AtomicU32,
-    completed: AtomicU32,
-    cancel_requested: AtomicU32,
+    state: TaskState,
     future: ManuallyDrop<F>,
     context: C,
     tracker: *const WorkItemTracker,
     work_item: AtomicPtr<c_void>,
+    cancel_link: CancelRegistration,
 }
 
 /// Handle for requesting cancellation on a work-item task.
@@ -1201,6 +1516,11 @@ impl<F> WorkItemCancelHandle<F> {
     pub fn is_cancelled(&self) -> bool {
         false
     }
+
+    #[inline]
+    pub fn link(&self, _token: &CancellationToken) -> NTSTATUS {
+        STATUS_NOT_SUPPORTED
+    }
 }
 
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
@@ -1253,7 +1573,24 @@ where
             return false;
         };
 
-        unsafe { (*ptr.as_ptr()).cancel_requested.load(Ordering::Relaxed) != 0 }
+        unsafe { (*ptr.as_ptr()).state.is_cancel_requested() }
+    }
+
+    /// Cancel the task when `token` (or one of its ancestors) is cancelled.
+    ///
+    /// Same rules as [`CancelHandle::link`]. Cancelling `token` then queues a work
+    /// item for this task, so cancel it at PASSIVE_LEVEL.
+    pub fn link(&self, token: &CancellationToken) -> NTSTATUS {
+        let ptr = self.task.load(Ordering::Acquire);
+        let Some(ptr) = NonNull::new(ptr) else {
+            return STATUS_INVALID_PARAMETER;
+        };
+
+        if unsafe { token.register(&(*ptr.as_ptr()).cancel_link) } {
+            STATUS_SUCCESS
+        } else {
+            STATUS_INVALID_PARAMETER
+        }
     }
 }
 
@@ -1409,14 +1746,15 @@ where
             core::ptr::write(
                 ptr.as_ptr(),
                 WorkItemTask {
-                    ref_count: AtomicU32::new(1),
-                    scheduled: AtomicU32::new(0),
-                    completed: AtomicU32::new(0),
-                    cancel_requested: AtomicU32::new(0),
+                    state: TaskState::new(),
                     future: ManuallyDrop::new(future),
                     context: C::default(),
                     tracker: core::ptr::null(),
                     work_item: AtomicPtr::new(null_mut()),
+                    cancel_link: CancelRegistration::new(
+                        ptr.as_ptr() as *const (),
+                        &Self::CANCEL_TARGET_VTBL,
+                    ),
                 },
             );
         }
@@ -1426,14 +1764,11 @@ where
 
     #[inline]
     unsafe fn add_ref(ptr: NonNull<Self>) {
-        let task = unsafe { &*ptr.as_ptr() };
-        let _ = refcount::add(&task.ref_count);
+        unsafe { &*ptr.as_ptr() }.state.ref_inc();
     }
 
     unsafe fn release(ptr: NonNull<Self>) {
-        let task = unsafe { &*ptr.as_ptr() };
-        let count = refcount::sub(&task.ref_count);
-        if count != 0 {
+        if !unsafe { &*ptr.as_ptr() }.state.ref_dec() {
             return;
         }
 
@@ -1442,6 +1777,7 @@ where
     }
 
     unsafe fn free(ptr: NonNull<Self>) {
+        unsafe { (*ptr.as_ptr()).cancel_link.unregister() };
         let alloc = WdkAllocator::new(PoolType::NonPagedNx, Self::alloc_tag());
         let context = unsafe { (*ptr.as_ptr()).context };
         unsafe {
@@ -1457,28 +1793,21 @@ where
     }
 
     unsafe fn schedule(ptr: NonNull<Self>) -> NTSTATUS {
-        if unsafe { &*ptr.as_ptr() }
-            .completed
-            .load(Ordering::Acquire)
-            != 0
-        {
-            return STATUS_SUCCESS;
-        }
-
-        if unsafe { &*ptr.as_ptr() }
-            .scheduled
-            .compare_exchange(0, 1, Ordering::AcqRel, Ordering::Acquire)
-            .is_err()
-        {
+        if !unsafe { &*ptr.as_ptr() }.state.transition_to_notified() {
             return STATUS_SUCCESS;
         }
+        unsafe { Self::submit(ptr) }
+    }
 
+    /// Queues a work item for a run the state has scheduled; the work item owns
+    /// the reference taken for it. On failure the run is unscheduled again.
+    unsafe fn submit(ptr: NonNull<Self>) -> NTSTATUS {
         let tracker = unsafe { &*ptr.as_ptr() }.tracker;
         unsafe { tracker_begin(tracker) };
 
         let context = unsafe { &*ptr.as_ptr() }.context;
         if !context.is_valid() {
-            unsafe { &*ptr.as_ptr() }.scheduled.store(0, Ordering::Release);
+            unsafe { &*ptr.as_ptr() }.state.cancel_submit();
             unsafe { tracker_complete(tracker) };
             return STATUS_INVALID_PARAMETER;
         }
@@ -1488,7 +1817,7 @@ where
         let status =
             unsafe { context.create_work_item(ptr.as_ptr() as *mut c_void, callback, &mut work_item) };
         if status != STATUS_SUCCESS {
-            unsafe { &*ptr.as_ptr() }.scheduled.store(0, Ordering::Release);
+            unsafe { &*ptr.as_ptr() }.state.cancel_submit();
             unsafe { tracker_complete(tracker) };
             return status;
         }
@@ -1497,7 +1826,6 @@ where
             .work_item
             .store(work_item, Ordering::Release);
 
-        unsafe { Self::add_ref(ptr) };
         unsafe {
             C::enqueue_work_item(
                 work_item,
@@ -1511,16 +1839,29 @@ where
 
     #[inline]
     unsafe fn cancel(ptr: NonNull<Self>) {
-        let header = unsafe { &*ptr.as_ptr() };
-        if header
-            .cancel_requested
-            .compare_exchange(0, 1, Ordering::SeqCst, Ordering::Acquire)
-            .is_ok()
-        {
-            let _ = unsafe { Self::schedule(ptr) };
+        if let Some(true) = unsafe { &*ptr.as_ptr() }.state.request_cancel() {
+            let _ = unsafe { Self::submit(ptr) };
         }
     }
 
+    const CANCEL_TARGET_VTBL: CancelTargetVtbl = CancelTargetVtbl {
+        try_add_ref: Self::try_add_ref_target,
+        cancel: Self::cancel_target,
+        release: Self::release_target,
+    };
+
+    unsafe fn try_add_ref_target(target: *const ()) -> bool {
+        unsafe { &*(target as *const Self) }.state.try_ref_inc()
+    }
+
+    unsafe fn cancel_target(target: *const ()) {
+        unsafe { Self::cancel(NonNull::new_unchecked(target as *mut Self)) };
+    }
+
+    unsafe fn release_target(target: *const ()) {
+        unsafe { Self::release(NonNull::new_unchecked(target as *mut Self)) };
+    }
+
     #[cfg(all(feature = "driver", feature = "async-com-kernel", driver_model__driver_type = "WDM", not(miri)))]
     unsafe extern "C" fn work_item_routine(
         _device: *mut DEVICE_OBJECT,
@@ -1570,45 +1911,45 @@ where
 
     unsafe fn run(ptr: NonNull<Self>, fallback_work_item: *mut c_void) {
         let tracker = unsafe { &*ptr.as_ptr() }.tracker;
+        // Take the work item before the task can be scheduled again and store
+        // the next one.
+        let work_item = unsafe { &*ptr.as_ptr() }
+            .work_item
+            .swap(null_mut(), Ordering::AcqRel);
+        let mut requeue = false;
 
-        unsafe { &*ptr.as_ptr() }.scheduled.store(0, Ordering::Release);
-
-        if unsafe { &*ptr.as_ptr() }
-            .completed
-            .load(Ordering::Acquire)
-            != 0
-        {
-            unsafe { tracker_complete(tracker) };
-            unsafe { Self::release(ptr) };
-            return;
-        }
-
-        let cancelled = unsafe { &*ptr.as_ptr() }
-            .cancel_requested
-            .load(Ordering::Acquire)
-            != 0;
-        if cancelled {
-            unsafe { &*ptr.as_ptr() }.completed.store(1, Ordering::Release);
-            unsafe { ManuallyDrop::drop(&mut (*ptr.as_ptr()).future) };
-        } else {
-            let waker = unsafe { Waker::from_raw(Self::raw_waker(ptr)) };
-            let mut cx = Context::from_waker(&waker);
-
-            let poll = unsafe {
-                let task = &mut *ptr.as_ptr();
-                let fut = Pin::new_unchecked(&mut *task.future);
-                fut.poll(&mut cx)
-            };
-
-            if let Poll::Ready(_status) = poll {
-                unsafe { &*ptr.as_ptr() }.completed.store(1, Ordering::Release);
+        if unsafe { &*ptr.as_ptr() }.state.transition_to_running() {
+            if unsafe { &*ptr.as_ptr() }.state.is_cancel_requested() {
+                unsafe { &*ptr.as_ptr() }.state.transition_to_complete();
                 unsafe { ManuallyDrop::drop(&mut (*ptr.as_ptr()).future) };
+            } else {
+                // The work item's reference outlives the poll, so the waker
+                // borrows it.
+                let waker = ManuallyDrop::new(unsafe {
+                    Waker::from_raw(RawWaker::new(
+                        ptr.as_ptr() as *const (),
+                        &Self::RAW_WAKER_VTABLE,
+                    ))
+                });
+                let mut cx = Context::from_waker(&waker);
+
+                let poll = unsafe {
+                    let task = &mut *ptr.as_ptr();
+                    let fut = Pin::new_unchecked(&mut *task.future);
+                    fut.poll(&mut cx)
+                };
+
+                if let Poll::Ready(_status) = poll {
+                    unsafe { &*ptr.as_ptr() }.state.transition_to_complete();
+                    unsafe { ManuallyDrop::drop(&mut (*ptr.as_ptr()).future) };
+                } else {
+                    // Woken during the poll: queue the next run once this work
+                    // item is gone.
+                    requeue = unsafe { &*ptr.as_ptr() }.state.transition_to_idle();
+                }
             }
         }
 
-        let work_item = unsafe { &*ptr.as_ptr() }
-            .work_item
-            .swap(null_mut(), Ordering::AcqRel);
         let work_item = if work_item.is_null() {
             fallback_work_item
         } else {
@@ -1618,6 +1959,11 @@ where
             unsafe { C::delete_work_item(work_item) };
         }
 
+        if requeue {
+            unsafe { &*ptr.as_ptr() }.state.transition_to_requeued();
+            let _ = unsafe { Self::submit(ptr) };
+        }
+
         unsafe { tracker_complete(tracker) };
         unsafe { Self::release(ptr) };
     }
@@ -1790,19 +2136,84 @@ where
     Err(STATUS_NOT_SUPPORTED)
 }
 
+/// Spawn a placed DPC task (driver build without async-com-kernel).
+///
+/// # Safety
+/// Same rules as [`spawn_dpc_task_cancellable`].
+#[cfg(all(feature = "driver", not(feature = "async-com-kernel"), not(miri)))]
+pub unsafe fn spawn_dpc_task_cancellable_on<F>(
+    _placement: TaskPlacement,
+    _future: F,
+) -> Result<CancelHandle, NTSTATUS>
+where
+    F: Future<Output = NTSTATUS> + Send + 'static,
+{
+    Err(STATUS_NOT_SUPPORTED)
+}
+
+/// Pin-initialize a task future in place (driver build without async-com-kernel).
+///
+/// # Safety
+/// Same rules as [`spawn_dpc_task_cancellable`].
+#[cfg(all(feature = "driver", not(feature = "async-com-kernel"), not(miri)))]
+pub unsafe fn spawn_dpc_task_cancellable_pin_init<F, E>(
+    _init: impl PinInit<F, E>,
+) -> Result<CancelHandle, KBoxError<E>>
+where
+    F: Future<Output = NTSTATUS> + Send + 'static,
+{
+    Err(KBoxError::Alloc(STATUS_NOT_SUPPORTED))
+}
+
 /// Spawn a future onto the kcom DPC executor (host stub).
 #[cfg(any(not(feature = "driver"), miri))]
 pub unsafe fn spawn_dpc_task_cancellable<F>(future: F) -> Result<CancelHandle, NTSTATUS>
 where
     F: Future<Output = NTSTATUS> + 'static,
 {
+    Ok(poll_host_task(Box::pin(future)))
+}
+
+/// Spawn a placed DPC task (host stub: the placement is ignored).
+///
+/// # Safety
+/// Same rules as [`spawn_dpc_task_cancellable`].
+#[cfg(any(not(feature = "driver"), miri))]
+pub unsafe fn spawn_dpc_task_cancellable_on<F>(
+    _placement: TaskPlacement,
+    future: F,
+) -> Result<CancelHandle, NTSTATUS>
+where
+    F: Future<Output = NTSTATUS> + 'static,
+{
+    Ok(poll_host_task(Box::pin(future)))
+}
+
+/// Pin-initialize a task future in place and spawn it (host stub).
+///
+/// # Safety
+/// Same rules as [`spawn_dpc_task_cancellable`].
+#[cfg(any(not(feature = "driver"), miri))]
+pub unsafe fn spawn_dpc_task_cancellable_pin_init<F, E>(
+    mut init: impl PinInit<F, E>,
+) -> Result<CancelHandle, KBoxError<E>>
+where
+    F: Future<Output = NTSTATUS> + 'static,
+{
+    let mut slot = Box::new(core::mem::MaybeUninit::<F>::uninit());
+    unsafe { init.init(slot.as_mut_ptr()) }.map_err(KBoxError::Init)?;
+    let future = unsafe { Box::from_raw(Box::into_raw(slot) as *mut F) };
+    Ok(poll_host_task(Box::into_pin(future)))
+}
+
+#[cfg(any(not(feature = "driver"), miri))]
+fn poll_host_task(mut future: Pin<Box<dyn Future<Output = NTSTATUS> + 'static>>) -> CancelHandle {
     let waker = dummy_waker();
 
     let mut cx = Context::from_waker(&waker);
-    let mut future: Pin<Box<dyn Future<Output = NTSTATUS> + 'static>> = Box::pin(future);
     match future.as_mut().poll(&mut cx) {
-        Poll::Ready(_) => Ok(CancelHandle::new(None)),
-        Poll::Pending => Ok(CancelHandle::new(Some(future))),
+        Poll::Ready(_) => CancelHandle::new(None),
+        Poll::Pending => CancelHandle::new(Some(future)),
     }
 }
 
@@ -1858,10 +2269,17 @@ where
 }
 
 /// Tracks outstanding DPC tasks so you can drain them before driver unload.
+///
+/// A tracker can also bound how many tasks and bytes of task memory are in
+/// flight (see [`with_limits`](Self::with_limits)). Every spawn through the
+/// tracker is charged the size of its task before it is allocated and fails with
+/// `STATUS_DEVICE_BUSY` when the charge does not fit, so overload is shed before
+/// nonpaged pool runs out. [`reserve`](Self::reserve) waits for capacity instead.
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 pub struct TaskTracker {
     pending: AtomicU32,
     event: UnsafeCell<crate::ntddk::KEVENT>,
+    admission: Admission,
 }
 
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
@@ -1873,6 +2291,13 @@ unsafe impl Sync for TaskTracker {}
 impl TaskTracker {
     #[inline]
     pub fn new() -> Self {
+        Self::with_limits(AdmissionLimits::UNLIMITED)
+    }
+
+    /// Creates a tracker that admits at most `limits.max_tasks` tasks using at
+    /// most `limits.max_bytes` bytes of task memory at a time.
+    #[inline]
+    pub fn with_limits(limits: AdmissionLimits) -> Self {
         let mut event = unsafe { core::mem::zeroed() };
         unsafe {
             crate::ntddk::KeInitializeEvent(
@@ -1884,6 +2309,48 @@ impl TaskTracker {
         Self {
             pending: AtomicU32::new(0),
             event: UnsafeCell::new(event),
+            admission: Admission::new(limits),
+        }
+    }
+
+    /// The limits and in-flight counts of tasks spawned through this tracker.
+    #[inline]
+    pub fn admission(&self) -> &Admission {
+        &self.admission
+    }
+
+    /// Spawns `future` if the tracker has room for it, like [`spawn_dpc_task`].
+    /// Fails at once with `STATUS_DEVICE_BUSY` when a limit is reached.
+    ///
+    /// # Safety
+    /// Same rules as [`spawn_dpc_task`].
+    #[inline]
+    pub unsafe fn try_spawn<F>(&self, future: F) -> NTSTATUS
+    where
+        F: Future<Output = NTSTATUS> + Send + 'static,
+    {
+        unsafe { spawn_dpc_task_on(self, TaskPlacement::Any, future) }
+    }
+
+    /// Waits until a task for `future` fits within the limits and reserves it.
+    /// The future is only used to name its type; spawn it with the returned
+    /// [`SpawnPermit`].
+    ///
+    /// ```ignore
+    /// let request = read_block(lba);
+    /// unsafe { tracker.reserve(&request).await?.spawn(request) };
+    /// ```
+    ///
+    /// Fails with `STATUS_INVALID_PARAMETER` if the task can never fit.
+    #[inline]
+    pub fn reserve<F>(&self, _future: &F) -> ReserveTask<'_, F>
+    where
+        F: Future<Output = NTSTATUS> + Send + 'static,
+    {
+        ReserveTask {
+            tracker: self,
+            reserve: self.admission.acquire(Task::<F>::VTABLE.size),
+            _future: PhantomData,
         }
     }
 
@@ -1942,12 +2409,119 @@ unsafe fn task_tracker_begin(tracker: *const TaskTracker) {
 
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 #[inline]
-unsafe fn task_tracker_complete(tracker: *const TaskTracker) {
+unsafe fn task_tracker_complete(tracker: *const TaskTracker, size: usize) {
     if !tracker.is_null() {
+        unsafe { (*tracker).admission.release(size) };
         unsafe { (*tracker).complete() };
     }
 }
 
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+#[inline]
+unsafe fn task_tracker_admit(tracker: *const TaskTracker, size: usize) -> bool {
+    tracker.is_null() || unsafe { (*tracker).admission.try_charge(size) }
+}
+
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+#[inline]
+unsafe fn task_tracker_refund(tracker: *const TaskTracker, size: usize) {
+    if !tracker.is_null() {
+        unsafe { (*tracker).admission.release(size) };
+    }
+}
+
+/// Future returned by [`TaskTracker::reserve`].
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+#[must_use = "futures do nothing unless awaited"]
+pub struct ReserveTask<'a, F> {
+    tracker: &'a TaskTracker,
+    reserve: Reserve<'a>,
+    _future: PhantomData<fn(F)>,
+}
+
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+impl<'a, F> Future for ReserveTask<'a, F>
+where
+    F: Future<Output = NTSTATUS> + Send + 'static,
+{
+    type Output = Result<SpawnPermit<'a, F>, NTSTATUS>;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
+        // `reserve` is structurally pinned.
+        let this = unsafe { self.get_unchecked_mut() };
+        let reserve = unsafe { Pin::new_unchecked(&mut this.reserve) };
+        match reserve.poll(cx) {
+            Poll::Ready(Ok(permit)) => {
+                let _ = permit.into_charge();
+                Poll::Ready(Ok(SpawnPermit {
+                    tracker: this.tracker,
+                    _future: PhantomData,
+                }))
+            }
+            Poll::Ready(Err(status)) => Poll::Ready(Err(status)),
+            Poll::Pending => Poll::Pending,
+        }
+    }
+}
+
+/// Room for one task of type `F` in a [`TaskTracker`], reserved by
+/// [`TaskTracker::reserve`]. Spawning consumes the permit; dropping it returns
+/// the room.
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+#[must_use = "the reservation is released as soon as the permit is dropped"]
+pub struct SpawnPermit<'a, F>
+where
+    F: Future<Output = NTSTATUS> + Send + 'static,
+{
+    tracker: &'a TaskTracker,
+    _future: PhantomData<fn(F)>,
+}
+
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+impl<F> SpawnPermit<'_, F>
+where
+    F: Future<Output = NTSTATUS> + Send + 'static,
+{
+    /// Spawns `future` in the reserved room. Only pool exhaustion can fail it.
+    ///
+    /// # Safety
+    /// Same rules as [`spawn_dpc_task`].
+    pub unsafe fn spawn(self, future: F) -> NTSTATUS {
+        match unsafe { self.spawn_cancellable(future) } {
+            Ok(_) => STATUS_SUCCESS,
+            Err(status) => status,
+        }
+    }
+
+    /// Like [`spawn`](Self::spawn), returning a cancellation handle.
+    ///
+    /// # Safety
+    /// Same rules as [`spawn_dpc_task_cancellable_tracked`].
+    pub unsafe fn spawn_cancellable(self, future: F) -> Result<CancelHandle, NTSTATUS> {
+        let tracker = self.tracker as *const TaskTracker;
+        // The task owns the charge from here on.
+        core::mem::forget(self);
+        let ptr = unsafe { Task::<F>::allocate(future, tracker, TaskHome::ANY, true) }?;
+
+        let handle = unsafe { CancelHandle::new(ptr) };
+        unsafe { TaskHeader::schedule(ptr) };
+        unsafe { TaskHeader::release(ptr) };
+
+        Ok(handle)
+    }
+}
+
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+impl<F> Drop for SpawnPermit<'_, F>
+where
+    F: Future<Output = NTSTATUS> + Send + 'static,
+{
+    #[inline]
+    fn drop(&mut self) {
+        self.tracker.admission.release(Task::<F>::VTABLE.size);
+    }
+}
+
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 /// Spawn a future onto the kcom DPC executor and return a cancellation handle.
 ///
@@ -1964,7 +2538,28 @@ pub unsafe fn spawn_dpc_task_cancellable<F>(future: F) -> Result<CancelHandle, N
 where
     F: Future<Output = NTSTATUS> + Send + 'static,
 {
-    let ptr = match unsafe { Task::<F>::allocate(future, core::ptr::null()) } {
+    unsafe { spawn_dpc_task_cancellable_on(TaskPlacement::Any, future) }
+}
+
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+/// Spawn a DPC task on a chosen processor or NUMA node and return a cancellation
+/// handle.
+///
+/// The task is allocated from the node's nonpaged pool (any node if that one is
+/// exhausted) and every poll runs on its home processor. Returns
+/// `STATUS_INVALID_PARAMETER` if the processor or node does not exist.
+///
+/// # Safety
+/// Same IRQL and unload rules as [`spawn_dpc_task_cancellable`].
+pub unsafe fn spawn_dpc_task_cancellable_on<F>(
+    placement: TaskPlacement,
+    future: F,
+) -> Result<CancelHandle, NTSTATUS>
+where
+    F: Future<Output = NTSTATUS> + Send + 'static,
+{
+    let home = TaskHome::resolve(placement)?;
+    let ptr = match unsafe { Task::<F>::allocate(future, core::ptr::null(), home, false) } {
         Ok(p) => p,
         Err(s) => return Err(s),
     };
@@ -1976,6 +2571,30 @@ where
     Ok(handle)
 }
 
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+/// Spawn a DPC task whose future is pin-initialized directly inside the task allocation.
+///
+/// Errors mirror [`KBox::try_pin_init`]: `Alloc` when the task cannot be
+/// allocated, `Init` when `init` fails (the allocation is released without
+/// dropping `F`).
+///
+/// # Safety
+/// Same IRQL and unload rules as [`spawn_dpc_task_cancellable`].
+pub unsafe fn spawn_dpc_task_cancellable_pin_init<F, E>(
+    init: impl PinInit<F, E>,
+) -> Result<CancelHandle, KBoxError<E>>
+where
+    F: Future<Output = NTSTATUS> + Send + 'static,
+{
+    let ptr = unsafe { Task::<F>::allocate_in_place(init, core::ptr::null(), TaskHome::ANY, false) }?;
+
+    let handle = unsafe { CancelHandle::new(ptr) };
+    unsafe { TaskHeader::schedule(ptr) };
+    unsafe { TaskHeader::release(ptr) };
+
+    Ok(handle)
+}
+
 /// Spawn a future onto the kcom DPC executor, tracking outstanding tasks.
 ///
 /// # IRQL
@@ -1994,7 +2613,9 @@ pub unsafe fn spawn_dpc_task_cancellable_tracked<F>(
 where
     F: Future<Output = NTSTATUS> + Send + 'static,
 {
-    let ptr = match unsafe { Task::<F>::allocate(future, tracker as *const TaskTracker) } {
+    let ptr = match unsafe {
+        Task::<F>::allocate(future, tracker as *const TaskTracker, TaskHome::ANY, false)
+    } {
         Ok(p) => p,
         Err(s) => return Err(s),
     };
@@ -2030,7 +2651,27 @@ pub unsafe fn spawn_dpc_task_tracked<F>(tracker: &TaskTracker, future: F) -> NTS
 where
     F: Future<Output = NTSTATUS> + Send + 'static,
 {
-    let ptr = match unsafe { Task::<F>::allocate(future, tracker as *const TaskTracker) } {
+    unsafe { spawn_dpc_task_on(tracker, TaskPlacement::Any, future) }
+}
+
+/// Spawn a tracked DPC task on a chosen processor or NUMA node.
+///
+/// See [`spawn_dpc_task_cancellable_on`] for placement and [`spawn_dpc_task`] for
+/// the IRQL and unload rules.
+#[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
+pub unsafe fn spawn_dpc_task_on<F>(
+    tracker: &TaskTracker,
+    placement: TaskPlacement,
+    future: F,
+) -> NTSTATUS
+where
+    F: Future<Output = NTSTATUS> + Send + 'static,
+{
+    let home = match TaskHome::resolve(placement) {
+        Ok(home) => home,
+        Err(s) => return s,
+    };
+    let ptr = match unsafe { Task::<F>::allocate(future, tracker as *const TaskTracker, home, false) } {
         Ok(p) => p,
         Err(s) => return s,
     };
@@ -0,0 +1,418 @@
+// handle_table.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Generational handle table mapping integer handles to COM objects.
+
+use core::alloc::Layout;
+use core::ffi::c_void;
+use core::marker::PhantomData;
+use core::ptr::{null_mut, NonNull};
+use core::sync::atomic::{fence, AtomicPtr, AtomicU32, AtomicU64, Ordering};
+
+use crate::allocator::{dealloc_slice_in, try_alloc_layout, Allocator, GlobalAllocator};
+use crate::epoch::{self, EpochGuard};
+use crate::iunknown::{IUnknownVtbl, NTSTATUS, STATUS_INSUFFICIENT_RESOURCES};
+use crate::smart_ptr::{ComRc, ComRef, ThreadSafeComInterface};
+
+/// Slots in the first chunk. Chunk `k` holds `FIRST_CHUNK << k` slots.
+const FIRST_CHUNK: usize = 64;
+const FIRST_CHUNK_SHIFT: u32 = FIRST_CHUNK.trailing_zeros();
+
+/// Chunk directory size. Indices are biased by `FIRST_CHUNK` before they are
+/// split into chunks, so the top `u32` indices land in chunk `32 - SHIFT`.
+const MAX_CHUNKS: usize = 33 - FIRST_CHUNK_SHIFT as usize;
+
+/// End marker of the free and retired lists (stored as index + 1).
+const NIL: u32 = 0;
+
+/// Integer handle naming one object in a [`HandleTable`].
+///
+/// The low 32 bits are the slot index, the high 32 bits the slot generation at
+/// insertion. A live handle is never zero, so zero can serve as "no handle" in
+/// IOCTL buffers.
+#[repr(transparent)]
+#[derive(Clone, Copy, PartialEq, Eq, Hash, Debug)]
+pub struct ComHandle(u64);
+
+impl ComHandle {
+    /// Rebuilds a handle from the value handed to a client.
+    #[inline]
+    pub const fn from_raw(raw: u64) -> Self {
+        Self(raw)
+    }
+
+    #[inline]
+    pub const fn into_raw(self) -> u64 {
+        self.0
+    }
+
+    #[inline]
+    const fn new(index: u32, generation: u32) -> Self {
+        Self(((generation as u64) << 32) | index as u64)
+    }
+
+    #[inline]
+    const fn index(self) -> u32 {
+        self.0 as u32
+    }
+
+    #[inline]
+    const fn generation(self) -> u32 {
+        (self.0 >> 32) as u32
+    }
+}
+
+/// One table entry. The generation is odd while the slot holds an object and is
+/// bumped on insert and on remove, so a handle goes stale the moment its object
+/// is removed.
+struct Slot<T> {
+    generation: AtomicU32,
+    /// Free- or retired-list link (index + 1).
+    next: AtomicU32,
+    retired_epoch: AtomicU64,
+    ptr: AtomicPtr<T>,
+}
+
+impl<T> Slot<T> {
+    #[inline]
+    const fn empty() -> Self {
+        Self {
+            generation: AtomicU32::new(0),
+            next: AtomicU32::new(NIL),
+            retired_epoch: AtomicU64::new(0),
+            ptr: AtomicPtr::new(null_mut()),
+        }
+    }
+}
+
+/// Table of COM objects addressed by [`ComHandle`].
+///
+/// Lookups take no lock: a handle resolves with one load of the chunk pointer and
+/// a generation check around the load of the object pointer. Readers pin the
+/// epoch ([`epoch::pin`]) for a borrowed [`lookup`](Self::lookup), or call
+/// [`get`](Self::get) to take a reference.
+///
+/// Removed objects keep their slot until every reader that could have resolved
+/// the old handle has unpinned; [`collect`](Self::collect) (also run when
+/// [`insert`](Self::insert) finds no free slot) then releases them and recycles
+/// the slots. Storage grows in chunks of doubling size through `A` and is freed
+/// when the table is dropped. Generations are 32-bit, so a stale handle could
+/// match again only after its slot has been reused 2^31 times.
+pub struct HandleTable<T: ThreadSafeComInterface, A: Allocator = GlobalAllocator> {
+    chunks: [AtomicPtr<Slot<T>>; MAX_CHUNKS],
+    /// Number of slot indices ever handed out.
+    high_water: AtomicU32,
+    /// Free list head: ABA tag in the high 32 bits, index + 1 in the low 32 bits.
+    free: AtomicU64,
+    /// Retired list head (index + 1); only pushed to and detached whole.
+    retired: AtomicU32,
+    alloc: A,
+    _phantom: PhantomData<ComRc<T>>,
+}
+
+unsafe impl<T: ThreadSafeComInterface, A: Allocator + Send> Send for HandleTable<T, A> {}
+unsafe impl<T: ThreadSafeComInterface, A: Allocator + Sync> Sync for HandleTable<T, A> {}
+
+impl<T: ThreadSafeComInterface> HandleTable<T, GlobalAllocator> {
+    #[inline]
+    pub const fn new() -> Self {
+        Self::new_in(GlobalAllocator)
+    }
+}
+
+impl<T: ThreadSafeComInterface> Default for HandleTable<T, GlobalAllocator> {
+    #[inline]
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl<T: ThreadSafeComInterface, A: Allocator> HandleTable<T, A> {
+    /// Creates an empty table that allocates its chunks from `alloc`.
+    #[inline]
+    pub const fn new_in(alloc: A) -> Self {
+        Self {
+            chunks: [const { AtomicPtr::new(null_mut()) }; MAX_CHUNKS],
+            high_water: AtomicU32::new(0),
+            free: AtomicU64::new(0),
+            retired: AtomicU32::new(NIL),
+            alloc,
+            _phantom: PhantomData,
+        }
+    }
+
+    /// Stores `rc` and returns its handle.
+    ///
+    /// Fails with `STATUS_INSUFFICIENT_RESOURCES` (releasing `rc`) when a new
+    /// chunk cannot be allocated or the index space is exhausted.
+    pub fn insert(&self, rc: ComRc<T>) -> Result<ComHandle, NTSTATUS> {
+        let index = match self.pop_free() {
+            Some(index) => index,
+            None => {
+                self.collect();
+                match self.pop_free() {
+                    Some(index) => index,
+                    None => self.grow()?,
+                }
+            }
+        };
+        let slot = unsafe { self.slot(index) };
+        slot.ptr.store(rc.into_raw(), Ordering::Relaxed);
+        let generation = slot.generation.load(Ordering::Relaxed).wrapping_add(1);
+        slot.generation.store(generation, Ordering::Release);
+        Ok(ComHandle::new(index, generation))
+    }
+
+    /// Resolves `handle` to a borrowed pointer that stays valid while `guard` is
+    /// held, even if the handle is removed concurrently. Returns `None` for stale
+    /// or foreign handles.
+    #[inline]
+    pub fn lookup<'a>(&'a self, handle: ComHandle, guard: &'a EpochGuard) -> Option<ComRef<'a, T>> {
+        let _ = guard;
+        let slot = self.find(handle.index())?;
+        let generation = handle.generation();
+        if generation & 1 == 0 || slot.generation.load(Ordering::Acquire) != generation {
+            return None;
+        }
+        let ptr = slot.ptr.load(Ordering::Relaxed);
+        // Re-check that the pointer still belongs to the handle's generation.
+        fence(Ordering::Acquire);
+        if slot.generation.load(Ordering::Relaxed) != generation {
+            return None;
+        }
+        // SAFETY: the slot held `ptr` for this generation while `guard` was pinned,
+        // and its reference is released only after the guard is dropped.
+        unsafe { ComRef::from_raw(ptr) }
+    }
+
+    /// Resolves `handle` and takes a reference to the object.
+    #[inline]
+    pub fn get(&self, handle: ComHandle) -> Option<ComRc<T>> {
+        let guard = epoch::pin();
+        self.lookup(handle, &guard).map(ComRef::upgrade)
+    }
+
+    /// Invalidates `handle`. Returns false if it was already stale.
+    ///
+    /// The table's reference is released by a later [`collect`](Self::collect),
+    /// after readers that may still be using the object have unpinned.
+    pub fn remove(&self, handle: ComHandle) -> bool {
+        let Some(slot) = self.find(handle.index()) else {
+            return false;
+        };
+        let generation = handle.generation();
+        if generation & 1 == 0
+            || slot
+                .generation
+                .compare_exchange(
+                    generation,
+                    generation.wrapping_add(1),
+                    Ordering::AcqRel,
+                    Ordering::Relaxed,
+                )
+                .is_err()
+        {
+            return false;
+        }
+        slot.retired_epoch.store(epoch::retire_epoch(), Ordering::Relaxed);
+        let link = handle.index() + 1;
+        let mut head = self.retired.load(Ordering::Relaxed);
+        loop {
+            slot.next.store(head, Ordering::Relaxed);
+            match self
+                .retired
+                .compare_exchange_weak(head, link, Ordering::Release, Ordering::Relaxed)
+            {
+                Ok(_) => return true,
+                Err(current) => head = current,
+            }
+        }
+    }
+
+    /// Releases removed objects whose readers have unpinned and makes their slots
+    /// reusable. Returns how many were released.
+    pub fn collect(&self) -> usize {
+        if self.retired.load(Ordering::Relaxed) == NIL {
+            return 0;
+        }
+        epoch::try_advance();
+        epoch::try_advance();
+        let current = epoch::current_epoch();
+
+        let mut released = 0;
+        let mut link = self.retired.swap(NIL, Ordering::Acquire);
+        let mut kept = NIL;
+        let mut kept_tail = NIL;
+        while link != NIL {
+            let index = link - 1;
+            let slot = unsafe { self.slot(index) };
+            let next = slot.next.load(Ordering::Relaxed);
+            if slot.retired_epoch.load(Ordering::Relaxed) + 2 <= current {
+                let ptr = slot.ptr.swap(null_mut(), Ordering::Relaxed);
+                unsafe { release(ptr) };
+                self.push_free(index);
+                released += 1;
+            } else {
+                slot.next.store(kept, Ordering::Relaxed);
+                if kept_tail == NIL {
+                    kept_tail = link;
+                }
+                kept = link;
+            }
+            link = next;
+        }
+        if kept != NIL {
+            let tail = unsafe { self.slot(kept_tail - 1) };
+            let mut head = self.retired.load(Ordering::Relaxed);
+            loop {
+                tail.next.store(head, Ordering::Relaxed);
+                match self
+                    .retired
+                    .compare_exchange_weak(head, kept, Ordering::Release, Ordering::Relaxed)
+                {
+                    Ok(_) => break,
+                    Err(current) => head = current,
+                }
+            }
+        }
+        released
+    }
+
+    fn pop_free(&self) -> Option<u32> {
+        let mut head = self.free.load(Ordering::Acquire);
+        loop {
+            let link = head as u32;
+            if link == NIL {
+                return None;
+            }
+            let next = unsafe { self.slot(link - 1) }.next.load(Ordering::Relaxed);
+            let tag = (head >> 32).wrapping_add(1);
+            match self.free.compare_exchange_weak(
+                head,
+                (tag << 32) | next as u64,
+                Ordering::Acquire,
+                Ordering::Acquire,
+            ) {
+                Ok(_) => return Some(link - 1),
+                Err(current) => head = current,
+            }
+        }
+    }
+
+    fn push_free(&self, index: u32) {
+        let slot = unsafe { self.slot(index) };
+        let mut head = self.free.load(Ordering::Relaxed);
+        loop {
+            slot.next.store(head as u32, Ordering::Relaxed);
+            let tag = (head >> 32).wrapping_add(1);
+            match self.free.compare_exchange_weak(
+                head,
+                (tag << 32) | (index + 1) as u64,
+                Ordering::Release,
+                Ordering::Relaxed,
+            ) {
+                Ok(_) => return,
+                Err(current) => head = current,
+            }
+        }
+    }
+
+    /// Hands out a never-used index, allocating its chunk on first use.
+    ///
+    /// The chunk is allocated before the index is claimed, so a failed
+    /// allocation leaves `high_water` alone and the index is handed out by the
+    /// next successful call.
+    fn grow(&self) -> Result<u32, NTSTATUS> {
+        let mut index = self.high_water.load(Ordering::Relaxed);
+        loop {
+            // Links store `index + 1`; keep that below `u32::MAX`.
+            if index >= u32::MAX - 1 {
+                return Err(STATUS_INSUFFICIENT_RESOURCES);
+            }
+            let (chunk, _) = chunk_of(index);
+            if self.chunks[chunk].load(Ordering::Acquire).is_null() {
+                self.alloc_chunk(chunk)?;
+            }
+            match self.high_water.compare_exchange_weak(
+                index,
+                index + 1,
+                Ordering::Relaxed,
+                Ordering::Relaxed,
+            ) {
+                Ok(_) => return Ok(index),
+                Err(current) => index = current,
+            }
+        }
+    }
+
+    fn alloc_chunk(&self, chunk: usize) -> Result<(), NTSTATUS> {
+        let len = FIRST_CHUNK << chunk;
+        let layout = Layout::array::<Slot<T>>(len).map_err(|_| STATUS_INSUFFICIENT_RESOURCES)?;
+        let ptr = try_alloc_layout(&self.alloc, layout)?.as_ptr() as *mut Slot<T>;
+        for offset in 0..len {
+            unsafe { ptr.add(offset).write(Slot::empty()) };
+        }
+        if self.chunks[chunk]
+            .compare_exchange(null_mut(), ptr, Ordering::AcqRel, Ordering::Acquire)
+            .is_err()
+        {
+            unsafe { dealloc_slice_in(&self.alloc, NonNull::new_unchecked(ptr), len) };
+        }
+        Ok(())
+    }
+
+    /// Returns the slot for `index` if its chunk exists.
+    #[inline]
+    fn find(&self, index: u32) -> Option<&Slot<T>> {
+        let (chunk, offset) = chunk_of(index);
+        let base = self.chunks.get(chunk)?.load(Ordering::Acquire);
+        if base.is_null() {
+            return None;
+        }
+        Some(unsafe { &*base.add(offset) })
+    }
+
+    /// # Safety
+    /// `index` must have been handed out by `grow`.
+    #[inline]
+    unsafe fn slot(&self, index: u32) -> &Slot<T> {
+        let (chunk, offset) = chunk_of(index);
+        unsafe { &*self.chunks[chunk].load(Ordering::Acquire).add(offset) }
+    }
+}
+
+impl<T: ThreadSafeComInterface, A: Allocator> Drop for HandleTable<T, A> {
+    fn drop(&mut self) {
+        for (chunk, base) in self.chunks.iter().enumerate() {
+            let base = base.load(Ordering::Acquire);
+            if base.is_null() {
+                continue;
+            }
+            let len = FIRST_CHUNK << chunk;
+            for offset in 0..len {
+                let ptr = unsafe { (*base.add(offset)).ptr.load(Ordering::Relaxed) };
+                if !ptr.is_null() {
+                    unsafe { release(ptr) };
+                }
+            }
+            unsafe { dealloc_slice_in(&self.alloc, NonNull::new_unchecked(base), len) };
+        }
+    }
+}
+
+/// Maps an index to its chunk and the offset within it.
+#[inline]
+fn chunk_of(index: u32) -> (usize, usize) {
+    let biased = index as usize + FIRST_CHUNK;
+    let chunk = (usize::BITS - 1 - biased.leading_zeros() - FIRST_CHUNK_SHIFT) as usize;
+    (chunk, biased - (FIRST_CHUNK << chunk))
+}
+
+#[inline]
+unsafe fn release<T>(ptr: *mut T) {
+    let object = ptr as *mut c_void;
+    let vtbl = unsafe { *(object as *mut *mut IUnknownVtbl) };
+    unsafe { ((*vtbl).Release)(object) };
+}
@@ -5,12 +5,16 @@ use core::ffi::c_void;
 
 use crate::traits::ComImpl;
 use crate::vtable::InterfaceVtable;
-use crate::wrapper::{ComObject, ComObjectN, SecondaryComImpl, SecondaryList, SecondaryVtables};
+use crate::wrapper::{
+    AggregateComImpl, AggregateComObject, ComObject, ComObjectN, LeanComObject, SecondaryComImpl,
+    SecondaryList, SecondaryVtables, StaticComObject,
+};
 
 pub type NTSTATUS = i32;
 
 pub const STATUS_SUCCESS: NTSTATUS = 0;
 pub const STATUS_PENDING: NTSTATUS = 0x0000_0103u32 as i32;
+pub const STATUS_DEVICE_BUSY: NTSTATUS = 0x8000_0011u32 as i32;
 pub const STATUS_UNSUCCESSFUL: NTSTATUS = 0xC000_0001u32 as i32;
 pub const STATUS_INVALID_PARAMETER: NTSTATUS = 0xC000_000Du32 as i32;
 pub const STATUS_NOT_SUPPORTED: NTSTATUS = 0xC000_00BBu32 as i32;
@@ -135,6 +139,21 @@ pub struct GUID {
     pub data4: [u8; 8],
 }
 
+impl GUID {
+    /// Packs the GUID into two `u64` words (`data1..data3`, `data4`).
+    ///
+    /// Two GUIDs are equal exactly when their words are equal. `IidTable` keys
+    /// on the words so a lookup is two word compares instead of four field
+    /// compares.
+    #[inline(always)]
+    pub const fn to_words(&self) -> [u64; 2] {
+        [
+            self.data1 as u64 | (self.data2 as u64) << 32 | (self.data3 as u64) << 48,
+            u64::from_le_bytes(self.data4),
+        ]
+    }
+}
+
 pub const IID_IUNKNOWN: GUID = GUID {
     data1: 0x0000_0000,
     data2: 0x0000,
@@ -157,14 +176,98 @@ unsafe impl InterfaceVtable for IUnknownVtbl {}
 impl IUnknownVtbl {
     /// Compile-time construction of the IUnknown vtable for a given COM type.
     pub const fn new<T, I>() -> Self
+    where
+        T: ComImpl<I>,
+        I: InterfaceVtable,
+    {
+        Self::new_in::<T, I, crate::allocator::GlobalAllocator>()
+    }
+
+    /// Compile-time construction of the IUnknown vtable for a `ComObject` that was
+    /// allocated with `A`.
+    pub const fn new_in<T, I, A>() -> Self
+    where
+        T: ComImpl<I>,
+        I: InterfaceVtable,
+        A: crate::allocator::Allocator + Send + Sync,
+    {
+        Self::new_with_refcount::<T, I, A, crate::wrapper::AtomicRefCount>()
+    }
+
+    /// Compile-time construction of the IUnknown vtable for a `ComObject` that was
+    /// allocated with `A` and counts references with policy `C`.
+    pub const fn new_with_refcount<T, I, A, C>() -> Self
+    where
+        T: ComImpl<I>,
+        I: InterfaceVtable,
+        A: crate::allocator::Allocator + Send + Sync,
+        C: crate::wrapper::RefCountPolicy,
+    {
+        Self {
+            QueryInterface: ComObject::<T, I, A, C>::shim_query_interface,
+            AddRef: ComObject::<T, I, A, C>::shim_add_ref,
+            Release: ComObject::<T, I, A, C>::shim_release,
+        }
+    }
+
+    /// Compile-time construction of the IUnknown vtable for a `LeanComObject`.
+    pub const fn new_lean<T, I, A>() -> Self
+    where
+        T: ComImpl<I>,
+        I: InterfaceVtable,
+        A: crate::allocator::Allocator + Send + Sync,
+    {
+        Self {
+            QueryInterface: LeanComObject::<T, I, A>::shim_query_interface,
+            AddRef: LeanComObject::<T, I, A>::shim_add_ref,
+            Release: LeanComObject::<T, I, A>::shim_release,
+        }
+    }
+
+    /// Compile-time construction of the IUnknown vtable for the outer interface of an
+    /// `AggregateComObject`.
+    pub const fn new_aggregate<O, P, In, Q, A, C>() -> Self
+    where
+        O: AggregateComImpl<P, In, Q>,
+        P: InterfaceVtable,
+        Q: InterfaceVtable,
+        A: crate::allocator::Allocator + Send + Sync,
+        C: crate::wrapper::RefCountPolicy,
+    {
+        Self {
+            QueryInterface: AggregateComObject::<O, P, In, Q, A, C>::shim_query_interface,
+            AddRef: AggregateComObject::<O, P, In, Q, A, C>::shim_add_ref,
+            Release: AggregateComObject::<O, P, In, Q, A, C>::shim_release,
+        }
+    }
+
+    /// Compile-time construction of the IUnknown vtable for the inner interface entry
+    /// of an `AggregateComObject`.
+    pub const fn new_aggregate_inner<O, P, In, Q, A, C>() -> Self
+    where
+        O: AggregateComImpl<P, In, Q>,
+        P: InterfaceVtable,
+        Q: InterfaceVtable,
+        A: crate::allocator::Allocator + Send + Sync,
+        C: crate::wrapper::RefCountPolicy,
+    {
+        Self {
+            QueryInterface: AggregateComObject::<O, P, In, Q, A, C>::shim_inner_query_interface,
+            AddRef: AggregateComObject::<O, P, In, Q, A, C>::shim_inner_add_ref,
+            Release: AggregateComObject::<O, P, In, Q, A, C>::shim_inner_release,
+        }
+    }
+
+    /// Compile-time construction of the no-op IUnknown vtable for a `StaticComObject`.
+    pub const fn new_static<T, I>() -> Self
     where
         T: ComImpl<I>,
         I: InterfaceVtable,
     {
         Self {
-            QueryInterface: ComObject::<T, I>::shim_query_interface,
-            AddRef: ComObject::<T, I>::shim_add_ref,
-            Release: ComObject::<T, I>::shim_release,
+            QueryInterface: StaticComObject::<T, I>::shim_query_interface,
+            AddRef: StaticComObject::<T, I>::shim_add_ref,
+            Release: StaticComObject::<T, I>::shim_release,
         }
     }
 
@@ -176,11 +279,25 @@ impl IUnknownVtbl {
         S: SecondaryVtables,
         S::Entries: SecondaryList,
         A: crate::allocator::Allocator + Send + Sync,
+    {
+        Self::new_primary_with_refcount::<T, P, S, A, crate::wrapper::AtomicRefCount>()
+    }
+
+    /// Compile-time construction of the IUnknown vtable for a ComObjectN primary interface
+    /// that counts references with policy `C`.
+    pub const fn new_primary_with_refcount<T, P, S, A, C>() -> Self
+    where
+        T: ComImpl<P> + SecondaryComImpl<S>,
+        P: InterfaceVtable,
+        S: SecondaryVtables,
+        S::Entries: SecondaryList,
+        A: crate::allocator::Allocator + Send + Sync,
+        C: crate::wrapper::RefCountPolicy,
     {
         Self {
-            QueryInterface: ComObjectN::<T, P, S, A>::shim_query_interface,
-            AddRef: ComObjectN::<T, P, S, A>::shim_add_ref,
-            Release: ComObjectN::<T, P, S, A>::shim_release,
+            QueryInterface: ComObjectN::<T, P, S, A, C>::shim_query_interface,
+            AddRef: ComObjectN::<T, P, S, A, C>::shim_add_ref,
+            Release: ComObjectN::<T, P, S, A, C>::shim_release,
         }
     }
 }
@@ -6,7 +6,7 @@
 #[doc(hidden)]
 pub extern crate alloc;
 
-#[cfg(test)]
+#[cfg(any(test, feature = "std"))]
 extern crate std;
 
 pub mod iunknown;
@@ -18,15 +18,25 @@ pub mod macros;
 pub use macros::*;
 pub mod smart_ptr;
 pub mod task;
+pub mod cancel;
+pub mod admission;
+pub mod apartment;
+#[cfg(any(all(feature = "driver", not(miri)), feature = "std"))]
+pub mod blocking;
 pub mod vtable;
+pub mod reclaim;
+pub mod epoch;
+pub mod handle_table;
+pub mod sync;
 mod refcount;
+mod task_state;
 pub mod trace;
 mod guard_ptr;
 #[cfg(feature = "async-com")]
 pub mod async_com;
 #[cfg(feature = "kernel-unicode")]
 pub mod unicode;
-#[cfg(any(feature = "async-com-kernel", feature = "kernel-unicode"))]
+#[cfg(any(feature = "driver", feature = "async-com-kernel", feature = "kernel-unicode"))]
 pub mod ntddk;
 pub mod traits;
 pub mod wrapper;
@@ -40,10 +50,16 @@ pub use paste;
 pub use async_trait::async_trait as async_impl;
 #[cfg(feature = "kernel-unicode")]
 pub use utf16_lit;
-pub use traits::{ComImpl, IUnknown, IUnknownInterface};
+pub use traits::{ComImpl, ComImplInner, IUnknown, IUnknownInterface};
 pub use vtable::{ComInterfaceInfo, InterfaceVtable, match_interface_ptr};
-pub use smart_ptr::{ComInterface, ComRc, ThreadSafeComInterface};
+pub use smart_ptr::{
+    AtomicComRc, ComInterface, ComRc, ComRef, ThreadAffineComInterface, ThreadSafeComInterface,
+};
 pub use trace::{clear_trace_hook, set_trace_hook, TraceHook};
+pub use reclaim::{clear_reclaim_hook, reclaim_deferred, set_reclaim_hook, ReclaimHook};
+pub use epoch::{defer_release, EpochGuard};
+pub use handle_table::{ComHandle, HandleTable};
+pub use sync::{LockQueueNode, QueuedSpinLock, RwSpinLock, SpinLock};
 pub use allocator::{
     dealloc_slice_in,
     dealloc_value_in,
@@ -53,11 +69,13 @@ pub use allocator::{
     InitBoxTrait,
     KBox,
     KBoxError,
+    ObjectPool,
     PinInit,
     PinInitOnce,
+    PoolAllocator,
 };
 #[cfg(feature = "driver")]
-pub use allocator::{init_box_with_tag, KernelInitBox, PoolType, WdkAllocator};
+pub use allocator::{init_box_with_tag, KernelInitBox, PoolType, WdkAllocator, WdkNodeAllocator};
 #[cfg(all(feature = "driver", not(miri)))]
 pub use allocator::init_ex_allocate_pool2;
 #[cfg(feature = "kernel-unicode")]
@@ -68,9 +86,15 @@ pub use unicode::{
     OwnedUnicodeString,
     UnicodeStringError,
 };
-pub use wrapper::{ComObject, ComObjectN};
+pub use wrapper::{
+    AggregateComImpl, AggregateComObject, AtomicRefCount, ComObject, ComObjectN,
+    DeferredRefCount, LeanComObject, LocalRefCount, PerCpuRefCount, RefCountPolicy,
+    StaticComObject,
+};
 #[doc(hidden)]
 pub use guard_ptr::GuardPtr;
+#[doc(hidden)]
+pub use task_state::TaskState;
 
 #[cfg(feature = "async-com")]
 pub use async_com::{
@@ -79,15 +103,29 @@ pub use async_com::{
     spawn_async_operation_error,
     spawn_async_operation_raw,
     spawn_async_operation_raw_cancellable,
+    spawn_async_operation_raw_pin_init,
     spawn_async_operation_error_raw,
+    wait_all,
+    wait_any,
+    AsyncCompletionCallback,
     AsyncOperationRaw,
     AsyncOperationTask,
     AsyncOperationVtbl,
     AsyncStatus,
     AsyncValueType,
+    AsyncWaitSet,
+    WaitAll,
+    WaitAny,
 };
 
-pub use executor::{spawn_dpc_task_cancellable, CancelHandle};
+pub use executor::{consume_budget, yield_now, ConsumeBudget, YieldNow};
+pub use executor::{
+    spawn_dpc_task_cancellable,
+    spawn_dpc_task_cancellable_on,
+    spawn_dpc_task_cancellable_pin_init,
+    CancelHandle,
+    TaskPlacement,
+};
 #[cfg(any(
     not(feature = "driver"),
     miri,
@@ -98,13 +136,22 @@ pub use executor::spawn_task;
 pub use executor::{
     set_task_alloc_tag,
     set_task_budget,
+    set_task_deferred_reclaim,
     spawn_dpc_task,
     spawn_dpc_task_cancellable_tracked,
+    spawn_dpc_task_on,
     spawn_dpc_task_tracked,
+    ReserveTask,
+    SpawnPermit,
     TaskBudget,
     TaskTracker,
 };
 pub use task::{try_finally, Cancellable};
+pub use cancel::CancellationToken;
+pub use admission::{Admission, AdmissionLimits, AdmissionPermit, Reserve};
+pub use apartment::{Apartment, ApartmentCall, ApartmentRunner};
+#[cfg(any(all(feature = "driver", not(miri)), feature = "std"))]
+pub use blocking::block_on;
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
 pub use executor::KernelTimerFuture;
 #[cfg(all(feature = "driver", feature = "async-com-kernel", not(miri)))]
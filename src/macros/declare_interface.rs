@@ -122,18 +122,63 @@ macro_rules! __kcom_define_interface {
             }
 
             impl [<$trait_name Vtbl>] {
+                #[allow(dead_code)]
                 pub const fn new<T>() -> Self
                 where
                     T: $trait_name
                         + $crate::ComImpl<[<$trait_name Vtbl>]>
                         + $crate::ComImpl<$($parent_vtable)+>,
+                {
+                    Self::new_in::<T, $crate::allocator::GlobalAllocator>()
+                }
+
+                /// Builds the vtable for a `ComObject` allocated with `A`.
+                #[allow(dead_code)]
+                pub const fn new_in<T, A>() -> Self
+                where
+                    T: $trait_name
+                        + $crate::ComImpl<[<$trait_name Vtbl>]>
+                        + $crate::ComImpl<$($parent_vtable)+>,
+                    A: $crate::allocator::Allocator + Send + Sync,
+                {
+                    Self::new_with_refcount::<T, A, $crate::wrapper::AtomicRefCount>()
+                }
+
+                /// Builds the vtable for a `ComObject` allocated with `A` and counted with `C`.
+                #[allow(dead_code)]
+                pub const fn new_with_refcount<T, A, C>() -> Self
+                where
+                    T: $trait_name
+                        + $crate::ComImpl<[<$trait_name Vtbl>]>
+                        + $crate::ComImpl<$($parent_vtable)+>,
+                    A: $crate::allocator::Allocator + Send + Sync,
+                    C: $crate::wrapper::RefCountPolicy,
+                {
+                    Self::new_with_unknown::<
+                        T,
+                        $crate::wrapper::ComObject<T, [<$trait_name Vtbl>], A, C>,
+                    >($crate::IUnknownVtbl::new_with_refcount::<T, [<$trait_name Vtbl>], A, C>())
+                }
+
+                /// Builds the vtable for object layout `L` around its IUnknown shims.
+                ///
+                /// Interface methods locate `inner` through `L`, so `unknown` must come
+                /// from the same wrapper type.
+                #[allow(dead_code)]
+                pub const fn new_with_unknown<T, L>(unknown: $crate::IUnknownVtbl) -> Self
+                where
+                    T: $trait_name
+                        + $crate::ComImpl<[<$trait_name Vtbl>]>
+                        + $crate::ComImpl<$($parent_vtable)+>,
+                    L: $crate::wrapper::ComLayout<T>,
                 {
                     Self {
                         parent: $crate::__kcom_parent_vtbl!(
                             $parent_kind,
                             $($parent_vtable)+,
                             T,
-                            [<$trait_name Vtbl>]
+                            L,
+                            unknown
                         ),
                         $($vtable_inits)*
                     }
@@ -290,12 +335,12 @@ macro_rules! __kcom_define_interface {
             vtable_inits [
                 $($vtable_inits)*
                 #[cfg(feature = "async-com")]
-                $method_name: [<shim_ $trait_name _ $method_name>]::<T>,
+                $method_name: [<shim_ $trait_name _ $method_name>]::<T, L>,
             ],
             vtable_inits_secondary [
                 $($vtable_inits_secondary)*
                 #[cfg(feature = "async-com")]
-                $method_name: [<shim_ $trait_name _ $method_name _secondary>]::<T, P, S, A, INDEX>,
+                $method_name: [<shim_ $trait_name _ $method_name _secondary>]::<T, P, S, A, C, INDEX>,
             ],
             shim_funcs [
                 $($shim_funcs)*
@@ -303,7 +348,7 @@ macro_rules! __kcom_define_interface {
                 compile_error!("async-com feature is required to use async methods in declare_com_interface!");
                 #[cfg(feature = "async-com")]
                 #[allow(non_snake_case)]
-                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name>]<T: $trait_name>(
+                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name>]<T: $trait_name, L: $crate::wrapper::ComLayout<T>>(
                     this: *mut core::ffi::c_void
                     $(, $arg_name: $arg_ty)*
                 ) -> *mut $crate::async_com::AsyncOperationRaw<$ret_ty>
@@ -313,59 +358,32 @@ macro_rules! __kcom_define_interface {
                     if this.is_null() {
                         return core::ptr::null_mut();
                     }
-                    let wrapper = unsafe {
-                        $crate::wrapper::ComObject::<T, [<$trait_name Vtbl>]>::from_ptr(this)
-                    };
+                    let inner = unsafe { L::inner(this) };
+                    // Go through the object's own IUnknown so the release matches the
+                    // layout and allocator the object was created with.
+                    let unknown = unsafe { *(this as *mut *mut $crate::IUnknownVtbl) };
                     unsafe {
-                        $crate::wrapper::ComObject::<T, [<$trait_name Vtbl>]>::shim_add_ref(this);
+                        ((*unknown).AddRef)(this);
                     }
-                    let init = wrapper.inner.$method_name($($arg_name),*);
-                    let mut future = match init.try_pin() {
-                        Ok(future) => future,
-                        Err(err) => {
-                            unsafe {
-                                $crate::wrapper::ComObject::<T, [<$trait_name Vtbl>]>::shim_release(this);
-                            }
-                            let status: $crate::NTSTATUS = err.into();
-                            return match $crate::async_com::spawn_async_operation_error_raw::<
-                                $ret_ty,
-                                <T as $trait_name>::[<$method_name:camel Future>],
-                            >(status) {
-                                Ok(ptr) => ptr,
-                                Err(_status) => core::ptr::null_mut(),
-                            };
-                        }
+                    let init = inner.$method_name($($arg_name),*);
+                    let keep_alive = unsafe {
+                        $crate::async_com::ReleaseOnDrop::new(
+                            $crate::GuardPtr::new(this),
+                            (*unknown).Release,
+                        )
                     };
-                    let release_fn: unsafe extern "system" fn(*mut core::ffi::c_void) -> u32 =
-                        $crate::wrapper::ComObject::<T, [<$trait_name Vtbl>]>::shim_release;
-                    let guard_ptr = $crate::GuardPtr::new(this);
-                    let op = $crate::async_com::spawn_async_operation_raw::<$ret_ty, _>(async move {
-                        struct ReleaseGuard {
-                            ptr: $crate::GuardPtr,
-                            release: unsafe extern "system" fn(*mut core::ffi::c_void) -> u32,
-                        }
-                        impl Drop for ReleaseGuard {
-                            fn drop(&mut self) {
-                                unsafe { (self.release)(self.ptr.as_ptr()) };
-                            }
-                        }
-                        let _guard = ReleaseGuard {
-                            ptr: guard_ptr,
-                            release: release_fn,
-                        };
-                        future.as_mut().await
-                    });
-                    match op {
-                        Ok(ptr) => ptr,
-                        Err(_status) => {
-                            unsafe { (release_fn)(this) };
-                            core::ptr::null_mut()
-                        }
-                    }
+                    // The future is pin-initialized straight into the executor task
+                    // unless the initializer can only be boxed.
+                    $crate::async_com::spawn_init_box_raw::<
+                        $ret_ty,
+                        <T as $trait_name>::[<$method_name:camel Future>],
+                        <T as $trait_name>::Allocator,
+                        _,
+                    >(init, keep_alive)
                 }
                 #[allow(non_snake_case)]
                 #[allow(dead_code)]
-                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name _secondary>]<T, P, S, A, const INDEX: usize>(
+                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name _secondary>]<T, P, S, A, C, const INDEX: usize>(
                     this: *mut core::ffi::c_void
                     $(, $arg_name: $arg_ty)*
                 ) -> *mut $crate::async_com::AsyncOperationRaw<$ret_ty>
@@ -375,60 +393,33 @@ macro_rules! __kcom_define_interface {
                     S: $crate::wrapper::SecondaryVtables,
                     S::Entries: $crate::wrapper::SecondaryEntryAccess<INDEX, [<$trait_name Vtbl>]>,
                     A: $crate::allocator::Allocator + Send + Sync,
+                    C: $crate::wrapper::RefCountPolicy,
                 {
                     if this.is_null() {
                         return core::ptr::null_mut();
                     }
                     let wrapper = unsafe {
-                        $crate::wrapper::ComObjectN::<T, P, S, A>::from_secondary_ptr::<[<$trait_name Vtbl>], INDEX>(this)
+                        $crate::wrapper::ComObjectN::<T, P, S, A, C>::from_secondary_ptr::<[<$trait_name Vtbl>], INDEX>(this)
                     };
                     let primary = wrapper as *const _ as *mut core::ffi::c_void;
                     unsafe {
-                        $crate::wrapper::ComObjectN::<T, P, S, A>::shim_add_ref(primary);
+                        $crate::wrapper::ComObjectN::<T, P, S, A, C>::shim_add_ref(primary);
                     }
                     let init = wrapper.inner.$method_name($($arg_name),*);
-                    let mut future = match init.try_pin() {
-                        Ok(future) => future,
-                        Err(err) => {
-                            unsafe {
-                                $crate::wrapper::ComObjectN::<T, P, S, A>::shim_release(primary);
-                            }
-                            let status: $crate::NTSTATUS = err.into();
-                            return match $crate::async_com::spawn_async_operation_error_raw::<
-                                $ret_ty,
-                                <T as $trait_name>::[<$method_name:camel Future>],
-                            >(status) {
-                                Ok(ptr) => ptr,
-                                Err(_status) => core::ptr::null_mut(),
-                            };
-                        }
+                    let keep_alive = unsafe {
+                        $crate::async_com::ReleaseOnDrop::new(
+                            $crate::GuardPtr::new(primary),
+                            $crate::wrapper::ComObjectN::<T, P, S, A, C>::shim_release,
+                        )
                     };
-                    let release_fn: unsafe extern "system" fn(*mut core::ffi::c_void) -> u32 =
-                        $crate::wrapper::ComObjectN::<T, P, S, A>::shim_release;
-                    let guard_ptr = $crate::GuardPtr::new(primary);
-                    let op = $crate::async_com::spawn_async_operation_raw::<$ret_ty, _>(async move {
-                        struct ReleaseGuard {
-                            ptr: $crate::GuardPtr,
-                            release: unsafe extern "system" fn(*mut core::ffi::c_void) -> u32,
-                        }
-                        impl Drop for ReleaseGuard {
-                            fn drop(&mut self) {
-                                unsafe { (self.release)(self.ptr.as_ptr()) };
-                            }
-                        }
-                        let _guard = ReleaseGuard {
-                            ptr: guard_ptr,
-                            release: release_fn,
-                        };
-                        future.as_mut().await
-                    });
-                    match op {
-                        Ok(ptr) => ptr,
-                        Err(_status) => {
-                            unsafe { (release_fn)(primary) };
-                            core::ptr::null_mut()
-                        }
-                    }
+                    // The future is pin-initialized straight into the executor task
+                    // unless the initializer can only be boxed.
+                    $crate::async_com::spawn_init_box_raw::<
+                        $ret_ty,
+                        <T as $trait_name>::[<$method_name:camel Future>],
+                        <T as $trait_name>::Allocator,
+                        _,
+                    >(init, keep_alive)
                 }
             ],
             ;
@@ -478,29 +469,27 @@ macro_rules! __kcom_define_interface {
             ],
             vtable_inits [
                 $($vtable_inits)*
-                $method_name: [<shim_ $trait_name _ $method_name>]::<T>,
+                $method_name: [<shim_ $trait_name _ $method_name>]::<T, L>,
             ],
             vtable_inits_secondary [
                 $($vtable_inits_secondary)*
-                $method_name: [<shim_ $trait_name _ $method_name _secondary>]::<T, P, S, A, INDEX>,
+                $method_name: [<shim_ $trait_name _ $method_name _secondary>]::<T, P, S, A, C, INDEX>,
             ],
             shim_funcs [
                 $($shim_funcs)*
                 #[allow(non_snake_case)]
-                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name>]<T: $trait_name>(
+                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name>]<T: $trait_name, L: $crate::wrapper::ComLayout<T>>(
                     this: *mut core::ffi::c_void
                     $(, $arg_name: $arg_ty)*
                 ) -> $crate::NTSTATUS
                 where
                     T: $crate::ComImpl<[<$trait_name Vtbl>]>,
                 {
-                    let wrapper = unsafe {
-                        $crate::wrapper::ComObject::<T, [<$trait_name Vtbl>]>::from_ptr(this)
-                    };
-                    $crate::iunknown::IntoNtStatus::into_ntstatus(wrapper.inner.$method_name($($arg_name),*))
+                    let inner = unsafe { L::inner(this) };
+                    $crate::iunknown::IntoNtStatus::into_ntstatus(inner.$method_name($($arg_name),*))
                 }
                 #[allow(non_snake_case)]
-                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name _secondary>]<T, P, S, A, const INDEX: usize>(
+                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name _secondary>]<T, P, S, A, C, const INDEX: usize>(
                     this: *mut core::ffi::c_void
                     $(, $arg_name: $arg_ty)*
                 ) -> $crate::NTSTATUS
@@ -510,9 +499,10 @@ macro_rules! __kcom_define_interface {
                     S: $crate::wrapper::SecondaryVtables,
                     S::Entries: $crate::wrapper::SecondaryEntryAccess<INDEX, [<$trait_name Vtbl>]>,
                     A: $crate::allocator::Allocator + Send + Sync,
+                    C: $crate::wrapper::RefCountPolicy,
                 {
                     let wrapper = unsafe {
-                        $crate::wrapper::ComObjectN::<T, P, S, A>::from_secondary_ptr::<[<$trait_name Vtbl>], INDEX>(this)
+                        $crate::wrapper::ComObjectN::<T, P, S, A, C>::from_secondary_ptr::<[<$trait_name Vtbl>], INDEX>(this)
                     };
                     $crate::iunknown::IntoNtStatus::into_ntstatus(wrapper.inner.$method_name($($arg_name),*))
                 }
@@ -564,29 +554,27 @@ macro_rules! __kcom_define_interface {
             ],
             vtable_inits [
                 $($vtable_inits)*
-                $method_name: [<shim_ $trait_name _ $method_name>]::<T>,
+                $method_name: [<shim_ $trait_name _ $method_name>]::<T, L>,
             ],
             vtable_inits_secondary [
                 $($vtable_inits_secondary)*
-                $method_name: [<shim_ $trait_name _ $method_name _secondary>]::<T, P, S, A, INDEX>,
+                $method_name: [<shim_ $trait_name _ $method_name _secondary>]::<T, P, S, A, C, INDEX>,
             ],
             shim_funcs [
                 $($shim_funcs)*
                 #[allow(non_snake_case)]
-                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name>]<T: $trait_name>(
+                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name>]<T: $trait_name, L: $crate::wrapper::ComLayout<T>>(
                     this: *mut core::ffi::c_void
                     $(, $arg_name: $arg_ty)*
                 ) -> $crate::NTSTATUS
                 where
                     T: $crate::ComImpl<[<$trait_name Vtbl>]>,
                 {
-                    let wrapper = unsafe {
-                        $crate::wrapper::ComObject::<T, [<$trait_name Vtbl>]>::from_ptr(this)
-                    };
-                    $crate::iunknown::IntoNtStatus::into_ntstatus(wrapper.inner.$method_name($($arg_name),*))
+                    let inner = unsafe { L::inner(this) };
+                    $crate::iunknown::IntoNtStatus::into_ntstatus(inner.$method_name($($arg_name),*))
                 }
                 #[allow(non_snake_case)]
-                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name _secondary>]<T, P, S, A, const INDEX: usize>(
+                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name _secondary>]<T, P, S, A, C, const INDEX: usize>(
                     this: *mut core::ffi::c_void
                     $(, $arg_name: $arg_ty)*
                 ) -> $crate::NTSTATUS
@@ -596,9 +584,10 @@ macro_rules! __kcom_define_interface {
                     S: $crate::wrapper::SecondaryVtables,
                     S::Entries: $crate::wrapper::SecondaryEntryAccess<INDEX, [<$trait_name Vtbl>]>,
                     A: $crate::allocator::Allocator + Send + Sync,
+                    C: $crate::wrapper::RefCountPolicy,
                 {
                     let wrapper = unsafe {
-                        $crate::wrapper::ComObjectN::<T, P, S, A>::from_secondary_ptr::<[<$trait_name Vtbl>], INDEX>(this)
+                        $crate::wrapper::ComObjectN::<T, P, S, A, C>::from_secondary_ptr::<[<$trait_name Vtbl>], INDEX>(this)
                     };
                     $crate::iunknown::IntoNtStatus::into_ntstatus(wrapper.inner.$method_name($($arg_name),*))
                 }
@@ -650,29 +639,27 @@ macro_rules! __kcom_define_interface {
             ],
             vtable_inits [
                 $($vtable_inits)*
-                $method_name: [<shim_ $trait_name _ $method_name>]::<T>,
+                $method_name: [<shim_ $trait_name _ $method_name>]::<T, L>,
             ],
             vtable_inits_secondary [
                 $($vtable_inits_secondary)*
-                $method_name: [<shim_ $trait_name _ $method_name _secondary>]::<T, P, S, A, INDEX>,
+                $method_name: [<shim_ $trait_name _ $method_name _secondary>]::<T, P, S, A, C, INDEX>,
             ],
             shim_funcs [
                 $($shim_funcs)*
                 #[allow(non_snake_case)]
-                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name>]<T: $trait_name>(
+                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name>]<T: $trait_name, L: $crate::wrapper::ComLayout<T>>(
                     this: *mut core::ffi::c_void
                     $(, $arg_name: $arg_ty)*
                 ) -> $crate::NTSTATUS
                 where
                     T: $crate::ComImpl<[<$trait_name Vtbl>]>,
                 {
-                    let wrapper = unsafe {
-                        $crate::wrapper::ComObject::<T, [<$trait_name Vtbl>]>::from_ptr(this)
-                    };
-                    $crate::iunknown::IntoNtStatus::into_ntstatus(wrapper.inner.$method_name($($arg_name),*))
+                    let inner = unsafe { L::inner(this) };
+                    $crate::iunknown::IntoNtStatus::into_ntstatus(inner.$method_name($($arg_name),*))
                 }
                 #[allow(non_snake_case)]
-                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name _secondary>]<T, P, S, A, const INDEX: usize>(
+                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name _secondary>]<T, P, S, A, C, const INDEX: usize>(
                     this: *mut core::ffi::c_void
                     $(, $arg_name: $arg_ty)*
                 ) -> $crate::NTSTATUS
@@ -682,9 +669,10 @@ macro_rules! __kcom_define_interface {
                     S: $crate::wrapper::SecondaryVtables,
                     S::Entries: $crate::wrapper::SecondaryEntryAccess<INDEX, [<$trait_name Vtbl>]>,
                     A: $crate::allocator::Allocator + Send + Sync,
+                    C: $crate::wrapper::RefCountPolicy,
                 {
                     let wrapper = unsafe {
-                        $crate::wrapper::ComObjectN::<T, P, S, A>::from_secondary_ptr::<[<$trait_name Vtbl>], INDEX>(this)
+                        $crate::wrapper::ComObjectN::<T, P, S, A, C>::from_secondary_ptr::<[<$trait_name Vtbl>], INDEX>(this)
                     };
                     $crate::iunknown::IntoNtStatus::into_ntstatus(wrapper.inner.$method_name($($arg_name),*))
                 }
@@ -736,30 +724,28 @@ macro_rules! __kcom_define_interface {
             ],
             vtable_inits [
                 $($vtable_inits)*
-                $method_name: [<shim_ $trait_name _ $method_name>]::<T>,
+                $method_name: [<shim_ $trait_name _ $method_name>]::<T, L>,
             ],
             vtable_inits_secondary [
                 $($vtable_inits_secondary)*
-                $method_name: [<shim_ $trait_name _ $method_name _secondary>]::<T, P, S, A, INDEX>,
+                $method_name: [<shim_ $trait_name _ $method_name _secondary>]::<T, P, S, A, C, INDEX>,
             ],
             shim_funcs [
                 $($shim_funcs)*
                 #[allow(non_snake_case)]
-                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name>]<T: $trait_name>(
+                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name>]<T: $trait_name, L: $crate::wrapper::ComLayout<T>>(
                     this: *mut core::ffi::c_void
                     $(, $arg_name: $arg_ty)*
                 ) -> $ret_ty
                 where
                     T: $crate::ComImpl<[<$trait_name Vtbl>]>,
                 {
-                    let wrapper = unsafe {
-                        $crate::wrapper::ComObject::<T, [<$trait_name Vtbl>]>::from_ptr(this)
-                    };
-                    $crate::__kcom_map_return!($ret_ty, wrapper.inner.$method_name($($arg_name),*))
+                    let inner = unsafe { L::inner(this) };
+                    $crate::__kcom_map_return!($ret_ty, inner.$method_name($($arg_name),*))
                 }
                 #[allow(non_snake_case)]
                 #[allow(dead_code)]
-                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name _secondary>]<T, P, S, A, const INDEX: usize>(
+                pub unsafe extern "system" fn [<shim_ $trait_name _ $method_name _secondary>]<T, P, S, A, C, const INDEX: usize>(
                     this: *mut core::ffi::c_void
                     $(, $arg_name: $arg_ty)*
                 ) -> $ret_ty
@@ -769,9 +755,10 @@ macro_rules! __kcom_define_interface {
                     S: $crate::wrapper::SecondaryVtables,
                     S::Entries: $crate::wrapper::SecondaryEntryAccess<INDEX, [<$trait_name Vtbl>]>,
                     A: $crate::allocator::Allocator + Send + Sync,
+                    C: $crate::wrapper::RefCountPolicy,
                 {
                     let wrapper = unsafe {
-                        $crate::wrapper::ComObjectN::<T, P, S, A>::from_secondary_ptr::<[<$trait_name Vtbl>], INDEX>(this)
+                        $crate::wrapper::ComObjectN::<T, P, S, A, C>::from_secondary_ptr::<[<$trait_name Vtbl>], INDEX>(this)
                     };
                     $crate::__kcom_map_return!($ret_ty, wrapper.inner.$method_name($($arg_name),*))
                 }
@@ -785,38 +772,11 @@ macro_rules! __kcom_define_interface {
 #[doc(hidden)]
 #[macro_export]
 macro_rules! __kcom_parent_vtbl {
-    (IUnknown, $parent_vtbl:ty, $ty:ty, $vtbl:ty) => {
-        $crate::IUnknownVtbl::new::<$ty, $vtbl>()
+    (IUnknown, $parent_vtbl:ty, $ty:ty, $layout:ty, $unknown:expr) => {
+        $unknown
     };
-    (Other, $parent_vtbl:ty, $ty:ty, $vtbl:ty) => {
-        <$parent_vtbl>::new::<$ty>()
-    };
-}
-
-#[doc(hidden)]
-#[macro_export]
-macro_rules! __kcom_parent_vtbl_primary {
-    (
-        IUnknown,
-        $parent_vtbl:ty,
-        $ty:ty,
-        $vtbl:ty,
-        $primary:ty,
-        $secondaries:ty,
-        $alloc:ty
-    ) => {
-        $crate::IUnknownVtbl::new_primary::<$ty, $primary, $secondaries, $alloc>()
-    };
-    (
-        Other,
-        $parent_vtbl:ty,
-        $ty:ty,
-        $vtbl:ty,
-        $primary:ty,
-        $secondaries:ty,
-        $alloc:ty
-    ) => {
-        <$parent_vtbl>::new_primary::<$ty, $primary, $secondaries, $alloc>()
+    (Other, $parent_vtbl:ty, $ty:ty, $layout:ty, $unknown:expr) => {
+        <$parent_vtbl>::new_with_unknown::<$ty, $layout>($unknown)
     };
 }
 
@@ -831,12 +791,13 @@ macro_rules! __kcom_parent_vtbl_secondary {
         $primary:ty,
         $secondaries:ty,
         $alloc:ty,
+        $refcount:ty,
         $index:expr
     ) => {{
         $crate::IUnknownVtbl {
-            QueryInterface: $crate::wrapper::ComObjectN::<$ty, $primary, $secondaries, $alloc>::shim_query_interface_secondary::<$vtbl, { $index }>,
-            AddRef: $crate::wrapper::ComObjectN::<$ty, $primary, $secondaries, $alloc>::shim_add_ref_secondary::<$vtbl, { $index }>,
-            Release: $crate::wrapper::ComObjectN::<$ty, $primary, $secondaries, $alloc>::shim_release_secondary::<$vtbl, { $index }>,
+            QueryInterface: $crate::wrapper::ComObjectN::<$ty, $primary, $secondaries, $alloc, $refcount>::shim_query_interface_secondary::<$vtbl, { $index }>,
+            AddRef: $crate::wrapper::ComObjectN::<$ty, $primary, $secondaries, $alloc, $refcount>::shim_add_ref_secondary::<$vtbl, { $index }>,
+            Release: $crate::wrapper::ComObjectN::<$ty, $primary, $secondaries, $alloc, $refcount>::shim_release_secondary::<$vtbl, { $index }>,
         }
     }};
     (
@@ -847,9 +808,10 @@ macro_rules! __kcom_parent_vtbl_secondary {
         $primary:ty,
         $secondaries:ty,
         $alloc:ty,
+        $refcount:ty,
         $index:expr
     ) => {{
-        <$parent_vtbl>::new_secondary::<$ty, $primary, $secondaries, $alloc, { $index }>()
+        <$parent_vtbl>::new_secondary::<$ty, $primary, $secondaries, $alloc, $refcount, { $index }>()
     }};
 }
 
@@ -864,7 +826,7 @@ macro_rules! __kcom_vtbl_impl_secondary {
         { $($vtable_inits_secondary:tt)* }
     ) => {
         #[allow(dead_code)]
-        pub const fn new_secondary<T, P, S, A, const INDEX: usize>() -> Self
+        pub const fn new_secondary<T, P, S, A, C, const INDEX: usize>() -> Self
         where
             T: $trait_name + $crate::ComImpl<P> + $crate::wrapper::SecondaryComImpl<S>,
             T: $crate::ComImpl<$parent_vtbl>,
@@ -872,6 +834,7 @@ macro_rules! __kcom_vtbl_impl_secondary {
             S: $crate::wrapper::SecondaryVtables,
             S::Entries: $crate::wrapper::SecondaryEntryAccess<INDEX, $vtbl_name>,
             A: $crate::allocator::Allocator + Send + Sync,
+            C: $crate::wrapper::RefCountPolicy,
         {
             Self {
                 parent: $crate::__kcom_parent_vtbl_secondary!(
@@ -882,6 +845,7 @@ macro_rules! __kcom_vtbl_impl_secondary {
                     P,
                     S,
                     A,
+                    C,
                     INDEX
                 ),
                 $($vtable_inits_secondary)*
@@ -896,7 +860,7 @@ macro_rules! __kcom_vtbl_impl_secondary {
         { $($vtable_inits_secondary:tt)* }
     ) => {
         #[allow(dead_code)]
-        pub const fn new_secondary<T, P, S, A, const INDEX: usize>() -> Self
+        pub const fn new_secondary<T, P, S, A, C, const INDEX: usize>() -> Self
         where
             T: $trait_name + $crate::ComImpl<P> + $crate::wrapper::SecondaryComImpl<S>,
             T: $crate::ComImpl<$parent_vtbl>,
@@ -905,6 +869,7 @@ macro_rules! __kcom_vtbl_impl_secondary {
             S::Entries: $crate::wrapper::SecondaryEntryAccess<INDEX, $vtbl_name>
                 + $crate::wrapper::SecondaryEntryAccess<INDEX, $parent_vtbl>,
             A: $crate::allocator::Allocator + Send + Sync,
+            C: $crate::wrapper::RefCountPolicy,
         {
             Self {
                 parent: $crate::__kcom_parent_vtbl_secondary!(
@@ -915,6 +880,7 @@ macro_rules! __kcom_vtbl_impl_secondary {
                     P,
                     S,
                     A,
+                    C,
                     INDEX
                 ),
                 $($vtable_inits_secondary)*
@@ -927,14 +893,14 @@ macro_rules! __kcom_vtbl_impl_secondary {
 #[macro_export]
 macro_rules! __kcom_vtbl_impl_primary {
     (
-        IUnknown,
+        $parent_kind:ident,
         $trait_name:ident,
         $vtbl_name:ty,
         $parent_vtbl:ty,
         { $($vtable_inits:tt)* }
     ) => {
         #[allow(dead_code)]
-        pub const fn new_primary<T, P, S, A>() -> Self
+        pub const fn new_primary<T, P, S, A, C>() -> Self
         where
             T: $trait_name
                 + $crate::ComImpl<$vtbl_name>
@@ -945,53 +911,11 @@ macro_rules! __kcom_vtbl_impl_primary {
             S: $crate::wrapper::SecondaryVtables,
             S::Entries: $crate::wrapper::SecondaryList,
             A: $crate::allocator::Allocator + Send + Sync,
+            C: $crate::wrapper::RefCountPolicy,
         {
-            Self {
-                parent: $crate::__kcom_parent_vtbl_primary!(
-                    IUnknown,
-                    $parent_vtbl,
-                    T,
-                    $vtbl_name,
-                    P,
-                    S,
-                    A
-                ),
-                $($vtable_inits)*
-            }
-        }
-    };
-    (
-        Other,
-        $trait_name:ident,
-        $vtbl_name:ty,
-        $parent_vtbl:ty,
-        { $($vtable_inits:tt)* }
-    ) => {
-        #[allow(dead_code)]
-        pub const fn new_primary<T, P, S, A>() -> Self
-        where
-            T: $trait_name
-                + $crate::ComImpl<$vtbl_name>
-                + $crate::ComImpl<$parent_vtbl>
-                + $crate::ComImpl<P>
-                + $crate::wrapper::SecondaryComImpl<S>,
-            P: $crate::vtable::InterfaceVtable,
-            S: $crate::wrapper::SecondaryVtables,
-            S::Entries: $crate::wrapper::SecondaryList,
-            A: $crate::allocator::Allocator + Send + Sync,
-        {
-            Self {
-                parent: $crate::__kcom_parent_vtbl_primary!(
-                    Other,
-                    $parent_vtbl,
-                    T,
-                    $vtbl_name,
-                    P,
-                    S,
-                    A
-                ),
-                $($vtable_inits)*
-            }
+            Self::new_with_unknown::<T, $crate::wrapper::ComObjectN<T, P, S, A, C>>(
+                $crate::IUnknownVtbl::new_primary_with_refcount::<T, P, S, A, C>()
+            )
         }
     };
 }
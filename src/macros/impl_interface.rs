@@ -71,43 +71,29 @@ macro_rules! __kcom_qi_match_secondaries_from_wrapper {
         $primary:ident,
         ($($all:ident),+),
         $alloc:ty,
+        $refcount:ty,
         $wrapper:ident,
-        $riid:ident,
-        ($head:ident $(, $tail:ident)*),
-        $index:expr
+        $riid:ident
     ) => {
         $crate::paste::paste! {
-            if *$riid == <[<$head Interface>] as $crate::vtable::ComInterfaceInfo>::IID {
-                let ptr = unsafe {
-                    $crate::wrapper::ComObjectN::<$ty, [<$primary Vtbl>], $crate::__kcom_vtbl_tuple!(($($all),+)), $alloc>::secondary_ptr::<[<$head Vtbl>], { $index }>($wrapper)
-                };
-                if ptr.is_null() {
-                    return None;
-                }
-                return Some(ptr);
+            const __KCOM_SECONDARY_IIDS: &[$crate::GUID] =
+                &[$(<[<$all Interface>] as $crate::vtable::ComInterfaceInfo>::IID),+];
+            const __KCOM_SECONDARY_TABLE: $crate::vtable::IidTable<
+                { __KCOM_SECONDARY_IIDS.len() },
+                { $crate::vtable::iid_table_slots(__KCOM_SECONDARY_IIDS.len()) },
+            > = $crate::wrapper::ComObjectN::<
+                $ty,
+                [<$primary Vtbl>],
+                $crate::__kcom_vtbl_tuple!(($($all),+)),
+                $alloc,
+                $refcount,
+            >::secondary_iid_table(__KCOM_SECONDARY_IIDS);
+
+            if let Some(offset) = __KCOM_SECONDARY_TABLE.lookup($riid) {
+                return Some(unsafe { ($wrapper as *mut u8).add(offset) } as *mut core::ffi::c_void);
             }
         }
-        $crate::__kcom_qi_match_secondaries_from_wrapper!(
-            $ty,
-            $primary,
-            ($($all),+),
-            $alloc,
-            $wrapper,
-            $riid,
-            ($($tail),*),
-            ($index + 1)
-        );
     };
-    (
-        $ty:ty,
-        $primary:ident,
-        ($($all:ident),+),
-        $alloc:ty,
-        $wrapper:ident,
-        $riid:ident,
-        (),
-        $index:expr
-    ) => {};
 }
 
 #[macro_export]
@@ -115,12 +101,23 @@ macro_rules! __kcom_qi_match_secondaries_from_wrapper {
 ///
 /// When `secondaries` is provided, the primary vtable uses `ComObjectN` shims and
 /// `QueryInterface` is auto-generated for the primary + all secondaries.
+///
+/// `allocator` selects the allocator type the IUnknown shims release through; objects
+/// must then be created with `ComObject::<T, I, A>::new_in` (or `ComObjectN`) using it.
+/// `refcount` selects the reference-count policy (`AtomicRefCount` by default,
+/// `LocalRefCount` for thread-affine objects); it must match the object's `C` parameter,
+/// and every implemented interface must be one the policy admits (`RefCountFor`).
+/// `immortal` builds no-op IUnknown shims for use with `StaticComObject`, and `lean`
+/// builds shims for the non-aggregatable `LeanComObject` layout.
+/// `aggregate = (Inner, IInner)` builds the outer interface of an `AggregateComObject`
+/// that co-allocates `Inner` (which must implement `IInner` with `impl_com_interface!`).
 macro_rules! impl_com_interface {
     (
         impl $ty:ty: $trait_name:ident {
             parent = $parent_vtbl:ty,
             secondaries = ($($sec:ident),+ $(,)?),
-            allocator = $alloc:ty,
+            $(allocator = $alloc:ty,)?
+            $(refcount = $refcount:ty,)?
             methods = [$($method:ident),* $(,)?],
             $(fallback = $fallback:ty,)?
         }
@@ -131,26 +128,70 @@ macro_rules! impl_com_interface {
             $trait_name,
             $parent_vtbl,
             ($($sec),+),
-            $alloc,
+            $crate::impl_com_interface!(@alloc $($alloc)?),
+            $crate::impl_com_interface!(@refcount $($refcount)?),
             [$($method),*],
             $crate::impl_com_interface!(@fallback $parent_vtbl $(, $fallback)?)
         );
+        $crate::impl_com_interface!(
+            @assert_refcount
+            $crate::impl_com_interface!(@refcount $($refcount)?),
+            $trait_name $(, $sec)+
+        );
     };
     (
         impl $ty:ty: $trait_name:ident {
             parent = $parent_vtbl:ty,
-            secondaries = ($($sec:ident),+ $(,)?),
+            lean,
+            $(allocator = $alloc:ty,)?
             methods = [$($method:ident),* $(,)?],
             $(fallback = $fallback:ty,)?
         }
     ) => {
         $crate::impl_com_interface!(
-            @impl_primary
+            @impl_single
             $ty,
             $trait_name,
             $parent_vtbl,
-            ($($sec),+),
-            $crate::allocator::GlobalAllocator,
+            ([<$trait_name Vtbl>]::new_with_unknown::<
+                $ty,
+                $crate::wrapper::LeanComObject<
+                    $ty,
+                    [<$trait_name Vtbl>],
+                    $crate::impl_com_interface!(@alloc $($alloc)?),
+                >,
+            >($crate::IUnknownVtbl::new_lean::<
+                $ty,
+                [<$trait_name Vtbl>],
+                $crate::impl_com_interface!(@alloc $($alloc)?),
+            >())),
+            ($crate::wrapper::LeanComObject<
+                $ty,
+                [<$trait_name Vtbl>],
+                $crate::impl_com_interface!(@alloc $($alloc)?),
+            >),
+            [$($method),*],
+            $crate::impl_com_interface!(@fallback $parent_vtbl $(, $fallback)?)
+        );
+    };
+    (
+        impl $ty:ty: $trait_name:ident {
+            parent = $parent_vtbl:ty,
+            immortal,
+            methods = [$($method:ident),* $(,)?],
+            $(fallback = $fallback:ty,)?
+        }
+    ) => {
+        $crate::impl_com_interface!(
+            @impl_single
+            $ty,
+            $trait_name,
+            $parent_vtbl,
+            ([<$trait_name Vtbl>]::new_with_unknown::<
+                $ty,
+                $crate::wrapper::StaticComObject<$ty, [<$trait_name Vtbl>]>,
+            >($crate::IUnknownVtbl::new_static::<$ty, [<$trait_name Vtbl>]>())),
+            ($crate::wrapper::StaticComObject<$ty, [<$trait_name Vtbl>]>),
             [$($method),*],
             $crate::impl_com_interface!(@fallback $parent_vtbl $(, $fallback)?)
         );
@@ -158,6 +199,34 @@ macro_rules! impl_com_interface {
     (
         impl $ty:ty: $trait_name:ident {
             parent = $parent_vtbl:ty,
+            aggregate = ($inner_ty:ty, $inner_trait:ident $(,)?),
+            $(allocator = $alloc:ty,)?
+            $(refcount = $refcount:ty,)?
+            methods = [$($method:ident),* $(,)?],
+            $(fallback = $fallback:ty,)?
+        }
+    ) => {
+        $crate::impl_com_interface!(
+            @impl_aggregate
+            $ty,
+            $trait_name,
+            $inner_ty,
+            $inner_trait,
+            $crate::impl_com_interface!(@alloc $($alloc)?),
+            $crate::impl_com_interface!(@refcount $($refcount)?),
+            $crate::impl_com_interface!(@fallback $parent_vtbl $(, $fallback)?)
+        );
+        $crate::impl_com_interface!(
+            @assert_refcount
+            $crate::impl_com_interface!(@refcount $($refcount)?),
+            $trait_name
+        );
+    };
+    (
+        impl $ty:ty: $trait_name:ident {
+            parent = $parent_vtbl:ty,
+            $(allocator = $alloc:ty,)?
+            $(refcount = $refcount:ty,)?
             methods = [$($method:ident),* $(,)?],
             $(fallback = $fallback:ty,)?
         }
@@ -167,9 +236,36 @@ macro_rules! impl_com_interface {
             $ty,
             $trait_name,
             $parent_vtbl,
+            ([<$trait_name Vtbl>]::new_with_refcount::<
+                $ty,
+                $crate::impl_com_interface!(@alloc $($alloc)?),
+                $crate::impl_com_interface!(@refcount $($refcount)?),
+            >()),
+            ($crate::wrapper::ComObject<
+                $ty,
+                [<$trait_name Vtbl>],
+                $crate::impl_com_interface!(@alloc $($alloc)?),
+                $crate::impl_com_interface!(@refcount $($refcount)?),
+            >),
             [$($method),*],
             $crate::impl_com_interface!(@fallback $parent_vtbl $(, $fallback)?)
         );
+        $crate::impl_com_interface!(
+            @assert_refcount
+            $crate::impl_com_interface!(@refcount $($refcount)?),
+            $trait_name
+        );
+    };
+    (@alloc) => { $crate::allocator::GlobalAllocator };
+    (@alloc $alloc:ty) => { $alloc };
+    (@refcount) => { $crate::wrapper::AtomicRefCount };
+    (@refcount $refcount:ty) => { $refcount };
+    (@assert_refcount $refcount:ty, $($iface:ident),+) => {
+        $crate::paste::paste! {
+            $(
+                const _: () = $crate::wrapper::assert_refcount_for::<$refcount, [<$iface Raw>]>();
+            )+
+        }
     };
     (@fallback $parent_vtbl:ty) => { $parent_vtbl };
     (@fallback $parent_vtbl:ty, $fallback:ty) => { $fallback };
@@ -177,13 +273,119 @@ macro_rules! impl_com_interface {
         $ty:ty,
         $trait_name:ident,
         $parent_vtbl:ty,
+        ($($vtable:tt)*),
+        ($($layout:tt)*),
         [$($method:ident),*],
         $fallback:ty
     ) => {
         $crate::paste::paste! {
+            unsafe impl $crate::traits::ComImplInner<[<$trait_name Vtbl>]> for $ty {
+                #[inline(always)]
+                unsafe fn inner_from_ptr<'a>(this: *mut core::ffi::c_void) -> &'a Self {
+                    unsafe { <$($layout)* as $crate::wrapper::ComLayout<Self>>::inner(this) }
+                }
+            }
+
+            impl $crate::ComImpl<[<$trait_name Vtbl>]> for $ty {
+                const VTABLE: &'static [<$trait_name Vtbl>] = {
+                    // A static gives the vtable one address, which `downcast_impl` compares.
+                    static VTABLE: [<$trait_name Vtbl>] = $($vtable)*;
+                    &VTABLE
+                };
+
+                #[inline]
+                fn query_interface(
+                    &self,
+                    this: *mut core::ffi::c_void,
+                    riid: &$crate::GUID,
+                ) -> Option<*mut core::ffi::c_void> {
+                    if this.is_null() {
+                        return None;
+                    }
+                    if *riid == <[<$trait_name Interface>] as $crate::vtable::ComInterfaceInfo>::IID {
+                        return Some(this);
+                    }
+                    <Self as $crate::traits::ComImpl<$fallback>>::query_interface(self, this, riid)
+                }
+            }
+        }
+    };
+    (@impl_aggregate
+        $ty:ty,
+        $trait_name:ident,
+        $inner_ty:ty,
+        $inner_trait:ident,
+        $alloc:ty,
+        $refcount:ty,
+        $fallback:ty
+    ) => {
+        $crate::paste::paste! {
+            unsafe impl $crate::wrapper::AggregateComImpl<
+                [<$trait_name Vtbl>],
+                $inner_ty,
+                [<$inner_trait Vtbl>],
+            > for $ty {
+                const INNER_VTABLE: &'static [<$inner_trait Vtbl>] = {
+                    static VTABLE: [<$inner_trait Vtbl>] = [<$inner_trait Vtbl>]::new_with_unknown::<
+                        $inner_ty,
+                        $crate::wrapper::AggregateInner<
+                            $ty,
+                            [<$trait_name Vtbl>],
+                            $inner_ty,
+                            [<$inner_trait Vtbl>],
+                            $alloc,
+                            $refcount,
+                        >,
+                    >($crate::IUnknownVtbl::new_aggregate_inner::<
+                        $ty,
+                        [<$trait_name Vtbl>],
+                        $inner_ty,
+                        [<$inner_trait Vtbl>],
+                        $alloc,
+                        $refcount,
+                    >());
+                    &VTABLE
+                };
+            }
+
+            unsafe impl $crate::traits::ComImplInner<[<$trait_name Vtbl>]> for $ty {
+                #[inline(always)]
+                unsafe fn inner_from_ptr<'a>(this: *mut core::ffi::c_void) -> &'a Self {
+                    unsafe {
+                        <$crate::wrapper::AggregateComObject<
+                            Self,
+                            [<$trait_name Vtbl>],
+                            $inner_ty,
+                            [<$inner_trait Vtbl>],
+                            $alloc,
+                            $refcount,
+                        > as $crate::wrapper::ComLayout<Self>>::inner(this)
+                    }
+                }
+            }
+
             impl $crate::ComImpl<[<$trait_name Vtbl>]> for $ty {
-                const VTABLE: &'static [<$trait_name Vtbl>] =
-                    &[<$trait_name Vtbl>]::new::<Self>();
+                const VTABLE: &'static [<$trait_name Vtbl>] = {
+                    static VTABLE: [<$trait_name Vtbl>] = [<$trait_name Vtbl>]::new_with_unknown::<
+                        $ty,
+                        $crate::wrapper::AggregateComObject<
+                            $ty,
+                            [<$trait_name Vtbl>],
+                            $inner_ty,
+                            [<$inner_trait Vtbl>],
+                            $alloc,
+                            $refcount,
+                        >,
+                    >($crate::IUnknownVtbl::new_aggregate::<
+                        $ty,
+                        [<$trait_name Vtbl>],
+                        $inner_ty,
+                        [<$inner_trait Vtbl>],
+                        $alloc,
+                        $refcount,
+                    >());
+                    &VTABLE
+                };
 
                 #[inline]
                 fn query_interface(
@@ -197,6 +399,16 @@ macro_rules! impl_com_interface {
                     if *riid == <[<$trait_name Interface>] as $crate::vtable::ComInterfaceInfo>::IID {
                         return Some(this);
                     }
+                    if *riid == <[<$inner_trait Interface>] as $crate::vtable::ComInterfaceInfo>::IID {
+                        return Some($crate::wrapper::AggregateComObject::<
+                            $ty,
+                            [<$trait_name Vtbl>],
+                            $inner_ty,
+                            [<$inner_trait Vtbl>],
+                            $alloc,
+                            $refcount,
+                        >::inner_ptr(this));
+                    }
                     <Self as $crate::traits::ComImpl<$fallback>>::query_interface(self, this, riid)
                 }
             }
@@ -208,13 +420,32 @@ macro_rules! impl_com_interface {
         $parent_vtbl:ty,
         ($($sec:ident),+),
         $alloc:ty,
+        $refcount:ty,
         [$($method:ident),*],
         $fallback:ty
     ) => {
         $crate::paste::paste! {
+            unsafe impl $crate::traits::ComImplInner<[<$trait_name Vtbl>]> for $ty {
+                #[inline(always)]
+                unsafe fn inner_from_ptr<'a>(this: *mut core::ffi::c_void) -> &'a Self {
+                    unsafe {
+                        <$crate::wrapper::ComObjectN<
+                            Self,
+                            [<$trait_name Vtbl>],
+                            $crate::__kcom_vtbl_tuple!(($($sec),+)),
+                            $alloc,
+                            $refcount,
+                        > as $crate::wrapper::ComLayout<Self>>::inner(this)
+                    }
+                }
+            }
+
             impl $crate::ComImpl<[<$trait_name Vtbl>]> for $ty {
-                const VTABLE: &'static [<$trait_name Vtbl>] =
-                    &[<$trait_name Vtbl>]::new_primary::<Self, [<$trait_name Vtbl>], $crate::__kcom_vtbl_tuple!(($($sec),+)), $alloc>();
+                const VTABLE: &'static [<$trait_name Vtbl>] = {
+                    static VTABLE: [<$trait_name Vtbl>] =
+                        [<$trait_name Vtbl>]::new_primary::<$ty, [<$trait_name Vtbl>], $crate::__kcom_vtbl_tuple!(($($sec),+)), $alloc, $refcount>();
+                    &VTABLE
+                };
 
                 #[inline]
                 fn query_interface(
@@ -234,6 +465,7 @@ macro_rules! impl_com_interface {
                         [<$trait_name Vtbl>],
                         $crate::__kcom_vtbl_tuple!(($($sec),+)),
                         $alloc,
+                        $refcount,
                     >;
 
                     $crate::__kcom_qi_match_secondaries_from_wrapper!(
@@ -241,10 +473,9 @@ macro_rules! impl_com_interface {
                         $trait_name,
                         ($($sec),+),
                         $alloc,
+                        $refcount,
                         wrapper,
-                        riid,
-                        ($($sec),+),
-                        0usize
+                        riid
                     );
 
                     <Self as $crate::traits::ComImpl<$fallback>>::query_interface(self, this, riid)
@@ -266,7 +497,8 @@ macro_rules! impl_com_interface_multiple {
             primary = $primary:ident,
             $(index = $index:expr,)?
             secondaries = ($($sec:ident),+ $(,)?),
-            allocator = $alloc:ty,
+            $(allocator = $alloc:ty,)?
+            $(refcount = $refcount:ty,)?
             methods = [$($method:ident),* $(,)?],
             $(fallback = $fallback:ty,)?
         }
@@ -279,32 +511,15 @@ macro_rules! impl_com_interface_multiple {
             $primary,
             $crate::impl_com_interface_multiple!(@index $( $index )?),
             ($($sec),+),
-            $alloc,
+            $crate::impl_com_interface!(@alloc $($alloc)?),
+            $crate::impl_com_interface!(@refcount $($refcount)?),
             [$($method),*],
             $crate::impl_com_interface!(@fallback $parent_vtbl $(, $fallback)?)
         );
-    };
-    (
-        impl $ty:ty: $trait_name:ident {
-            parent = $parent_vtbl:ty,
-            primary = $primary:ident,
-            $(index = $index:expr,)?
-            secondaries = ($($sec:ident),+ $(,)?),
-            methods = [$($method:ident),* $(,)?],
-            $(fallback = $fallback:ty,)?
-        }
-    ) => {
-        $crate::impl_com_interface_multiple!(
-            @impl
-            $ty,
-            $trait_name,
-            $parent_vtbl,
-            $primary,
-            $crate::impl_com_interface_multiple!(@index $( $index )?),
-            ($($sec),+),
-            $crate::allocator::GlobalAllocator,
-            [$($method),*],
-            $crate::impl_com_interface!(@fallback $parent_vtbl $(, $fallback)?)
+        $crate::impl_com_interface!(
+            @assert_refcount
+            $crate::impl_com_interface!(@refcount $($refcount)?),
+            $trait_name
         );
     };
     (@index $index:expr) => { $index };
@@ -317,13 +532,33 @@ macro_rules! impl_com_interface_multiple {
         $index:expr,
         ($($sec:ident),+),
         $alloc:ty,
+        $refcount:ty,
         [$($method:ident),*],
         $fallback:ty
     ) => {
         $crate::paste::paste! {
+            unsafe impl $crate::traits::ComImplInner<[<$trait_name Vtbl>]> for $ty {
+                #[inline(always)]
+                unsafe fn inner_from_ptr<'a>(this: *mut core::ffi::c_void) -> &'a Self {
+                    unsafe {
+                        &$crate::wrapper::ComObjectN::<
+                            Self,
+                            [<$primary Vtbl>],
+                            $crate::__kcom_vtbl_tuple!(($($sec),+)),
+                            $alloc,
+                            $refcount,
+                        >::from_secondary_ptr::<[<$trait_name Vtbl>], { $index }>(this)
+                            .inner
+                    }
+                }
+            }
+
             impl $crate::ComImpl<[<$trait_name Vtbl>]> for $ty {
-                const VTABLE: &'static [<$trait_name Vtbl>] =
-                    &[<$trait_name Vtbl>]::new_secondary::<Self, [<$primary Vtbl>], $crate::__kcom_vtbl_tuple!(($($sec),+)), $alloc, { $index }>();
+                const VTABLE: &'static [<$trait_name Vtbl>] = {
+                    static VTABLE: [<$trait_name Vtbl>] =
+                        [<$trait_name Vtbl>]::new_secondary::<$ty, [<$primary Vtbl>], $crate::__kcom_vtbl_tuple!(($($sec),+)), $alloc, $refcount, { $index }>();
+                    &VTABLE
+                };
 
                 #[inline]
                 fn query_interface(
@@ -339,6 +574,7 @@ macro_rules! impl_com_interface_multiple {
                         [<$primary Vtbl>],
                         $crate::__kcom_vtbl_tuple!(($($sec),+)),
                         $alloc,
+                        $refcount,
                     >;
                     let primary_ptr = this;
 
@@ -351,10 +587,9 @@ macro_rules! impl_com_interface_multiple {
                         $primary,
                         ($($sec),+),
                         $alloc,
+                        $refcount,
                         wrapper,
-                        riid,
-                        ($($sec),+),
-                        0usize
+                        riid
                     );
 
                     <Self as $crate::traits::ComImpl<$fallback>>::query_interface(self, this, riid)
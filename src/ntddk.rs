@@ -11,12 +11,15 @@ pub use wdk_sys::{
 #[cfg(all(feature = "driver", not(miri)))]
 pub use wdk_sys::{KDPC, KTIMER, LARGE_INTEGER, PKDPC, PKTIMER};
 #[cfg(all(feature = "driver", not(miri)))]
-pub use wdk_sys::{KIRQL, KSPIN_LOCK};
+pub use wdk_sys::{EX_SPIN_LOCK, KIRQL, KLOCK_QUEUE_HANDLE, KSPIN_LOCK};
 #[cfg(all(feature = "driver", not(miri)))]
 pub use wdk_sys::ntddk::{
-    KeAcquireSpinLockRaiseToDpc, KeBugCheckEx, KeCancelTimer, KeGetCurrentIrql, KeInitializeDpc,
-    KeInitializeEvent, KeInitializeSpinLock, KeInitializeTimer, KeInsertQueueDpc,
-    KeQueryPerformanceCounter, KeReleaseSpinLock, KeRemoveQueueDpc, KeSetEvent, KeSetTimer,
+    ExAcquireSpinLockExclusive, ExAcquireSpinLockShared, ExReleaseSpinLockExclusive,
+    ExReleaseSpinLockShared, KeAcquireInStackQueuedSpinLock, KeAcquireSpinLockRaiseToDpc,
+    KeBugCheckEx, KeCancelTimer, KeDelayExecutionThread, KeGetCurrentIrql, KeInitializeDpc,
+    KeInitializeEvent,
+    KeInitializeSpinLock, KeInitializeTimer, KeInsertQueueDpc, KeQueryPerformanceCounter,
+    KeReleaseInStackQueuedSpinLock, KeReleaseSpinLock, KeRemoveQueueDpc, KeSetEvent, KeSetTimer,
     KeWaitForSingleObject, MmGetSystemRoutineAddress,
 };
 #[cfg(all(feature = "driver", not(miri)))]
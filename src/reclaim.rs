@@ -0,0 +1,209 @@
+// reclaim.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Deferred destruction of objects whose last reference was dropped on a
+// latency-critical path.
+
+use core::cell::UnsafeCell;
+use core::ffi::c_void;
+use core::ptr::null_mut;
+use core::sync::atomic::{AtomicPtr, Ordering};
+
+/// Number of per-CPU garbage lists. CPUs beyond this share a list.
+const RECLAIM_SHARDS: usize = 64;
+
+/// Hook invoked when a garbage list goes from empty to non-empty.
+///
+/// It runs on the releasing thread, possibly at `DISPATCH_LEVEL`, and should only
+/// queue the low-priority work item that calls [`reclaim_deferred`].
+pub type ReclaimHook = fn();
+
+static RECLAIM_HOOK: AtomicPtr<()> = AtomicPtr::new(null_mut());
+
+#[repr(align(64))]
+struct GarbageList(AtomicPtr<RetiredLink>);
+
+static GARBAGE_LISTS: [GarbageList; RECLAIM_SHARDS] =
+    [const { GarbageList(AtomicPtr::new(null_mut())) }; RECLAIM_SHARDS];
+
+/// Intrusive link a retired object carries until it is reclaimed.
+///
+/// The link lives inside the object it describes, so `destroy` frees it too.
+pub struct RetiredLink {
+    next: *mut RetiredLink,
+    object: *mut c_void,
+    destroy: Option<unsafe fn(*mut c_void)>,
+    tag: u32,
+}
+
+impl RetiredLink {
+    #[inline]
+    pub(crate) const fn new() -> Self {
+        Self {
+            next: null_mut(),
+            object: null_mut(),
+            destroy: None,
+            tag: 0,
+        }
+    }
+}
+
+/// Counter of a [`DeferredRefCount`](crate::wrapper::DeferredRefCount) object: the
+/// wrapped policy's counter plus the garbage-list link.
+pub struct DeferredCounter<K> {
+    pub(crate) count: K,
+    link: UnsafeCell<RetiredLink>,
+}
+
+// The link is only written by the thread that dropped the last reference and read
+// by the reclaimer after it has been published through a garbage list.
+unsafe impl<K: Send> Send for DeferredCounter<K> {}
+unsafe impl<K: Sync> Sync for DeferredCounter<K> {}
+
+impl<K> DeferredCounter<K> {
+    #[inline]
+    pub(crate) const fn new(count: K) -> Self {
+        Self {
+            count,
+            link: UnsafeCell::new(RetiredLink::new()),
+        }
+    }
+
+    /// Queues `object` for destruction by the reclaimer.
+    ///
+    /// # Safety
+    /// The count must have just reached zero, `self` must live inside `object`, and
+    /// `destroy(object)` must free it exactly once.
+    #[inline]
+    pub(crate) unsafe fn retire(
+        &self,
+        object: *mut c_void,
+        destroy: unsafe fn(*mut c_void),
+        tag: u32,
+    ) {
+        unsafe { defer_destroy(self.link.get(), object, destroy, tag) };
+    }
+}
+
+/// Registers the hook that schedules [`reclaim_deferred`].
+#[inline]
+pub fn set_reclaim_hook(hook: ReclaimHook) {
+    RECLAIM_HOOK.store(hook as *const () as *mut (), Ordering::Release);
+}
+
+/// Clears the reclaim hook. Retired objects keep accumulating until
+/// [`reclaim_deferred`] is called.
+#[inline]
+pub fn clear_reclaim_hook() {
+    RECLAIM_HOOK.store(null_mut(), Ordering::Release);
+}
+
+/// Pushes a retired object onto the current CPU's garbage list.
+///
+/// # Safety
+/// `link` must stay valid until `destroy(object)` runs, and `destroy` must free the
+/// object (and with it `link`) exactly once.
+pub(crate) unsafe fn defer_destroy(
+    link: *mut RetiredLink,
+    object: *mut c_void,
+    destroy: unsafe fn(*mut c_void),
+    tag: u32,
+) {
+    unsafe {
+        (*link).object = object;
+        (*link).destroy = Some(destroy);
+        (*link).tag = tag;
+    }
+
+    let list = &GARBAGE_LISTS[crate::refcount::current_shard() % RECLAIM_SHARDS].0;
+    let mut head = list.load(Ordering::Relaxed);
+    loop {
+        unsafe { (*link).next = head };
+        match list.compare_exchange_weak(head, link, Ordering::Release, Ordering::Relaxed) {
+            Ok(_) => break,
+            Err(current) => head = current,
+        }
+    }
+
+    if head.is_null() {
+        run_reclaim_hook();
+    }
+}
+
+/// Runs the reclaim hook, if one is registered.
+pub(crate) fn run_reclaim_hook() {
+    let hook = RECLAIM_HOOK.load(Ordering::Acquire);
+    if !hook.is_null() {
+        let hook: ReclaimHook = unsafe { core::mem::transmute(hook) };
+        hook();
+    }
+}
+
+/// Returns true when at least one retired object is waiting for reclamation
+/// (a racy snapshot).
+pub fn has_deferred() -> bool {
+    GARBAGE_LISTS
+        .iter()
+        .any(|list| !list.0.load(Ordering::Relaxed).is_null())
+}
+
+/// Destroys every object retired so far, performs the epoch-deferred releases
+/// whose readers have left ([`epoch::collect`](crate::epoch::collect)), and returns
+/// how many objects were freed or released.
+///
+/// Call from a low-priority context (a `DelayedWorkQueue` work item, or driver
+/// unload). Each per-CPU list is detached with one swap and destroyed as a batch,
+/// grouped by pool tag so that frees to the same pool run back to back. Objects
+/// retired while this runs (for example by destructors releasing other deferred
+/// objects) re-arm the hook and are left for the next call.
+pub fn reclaim_deferred() -> usize {
+    let mut reclaimed = crate::epoch::collect();
+    for list in &GARBAGE_LISTS {
+        if list.0.load(Ordering::Relaxed).is_null() {
+            continue;
+        }
+        let batch = list.0.swap(null_mut(), Ordering::Acquire);
+        reclaimed += unsafe { destroy_batch(batch) };
+    }
+    reclaimed
+}
+
+/// Destroys a detached list, one pool tag at a time.
+///
+/// # Safety
+/// `batch` must be a list detached from a garbage list.
+unsafe fn destroy_batch(mut batch: *mut RetiredLink) -> usize {
+    let mut reclaimed = 0;
+    while !batch.is_null() {
+        let tag = unsafe { (*batch).tag };
+        let mut rest: *mut RetiredLink = null_mut();
+        let mut rest_tail: *mut *mut RetiredLink = &mut rest;
+        let mut node = batch;
+        while !node.is_null() {
+            // `destroy` frees the node, so read the link first.
+            let RetiredLink {
+                next,
+                object,
+                destroy,
+                tag: node_tag,
+            } = unsafe { core::ptr::read(node) };
+            if node_tag == tag {
+                if let Some(destroy) = destroy {
+                    unsafe { destroy(object) };
+                }
+                reclaimed += 1;
+            } else {
+                unsafe {
+                    (*node).next = null_mut();
+                    *rest_tail = node;
+                    rest_tail = core::ptr::addr_of_mut!((*node).next);
+                }
+            }
+            node = next;
+        }
+        batch = rest;
+    }
+    reclaimed
+}
@@ -2,10 +2,10 @@
 //
 // Shared refcount helpers with optional hardening.
 
-use core::sync::atomic::{AtomicU32, Ordering};
+use core::sync::atomic::{AtomicBool, AtomicI64, AtomicU32, Ordering};
 
 #[cfg(feature = "refcount-hardening")]
-const MAX_REFCOUNT: u32 = i32::MAX as u32;
+pub(crate) const MAX_REFCOUNT: u32 = i32::MAX as u32;
 
 #[cfg(feature = "refcount-hardening")]
 use crate::iunknown::STATUS_UNSUCCESSFUL;
@@ -13,7 +13,7 @@ use crate::iunknown::STATUS_UNSUCCESSFUL;
 #[cfg(feature = "refcount-hardening")]
 #[cold]
 #[inline(never)]
-fn refcount_violation() -> ! {
+pub(crate) fn refcount_violation() -> ! {
     #[cfg(debug_assertions)]
     crate::trace::report_error(file!(), line!(), STATUS_UNSUCCESSFUL);
 
@@ -128,3 +128,183 @@ pub(crate) fn sub(ref_count: &AtomicU32) -> u32 {
         Err(_) => MAX_REFCOUNT,
     }
 }
+
+/// Takes a reference only while the object is alive (the count is not zero).
+/// Lets a holder of an unowned pointer race safely with the final release.
+#[inline]
+pub(crate) fn try_add(ref_count: &AtomicU32) -> bool {
+    ref_count
+        .fetch_update(Ordering::Acquire, Ordering::Relaxed, |curr| {
+            #[cfg(feature = "refcount-hardening")]
+            if curr >= MAX_REFCOUNT {
+                #[cfg(not(feature = "leaky-hardening"))]
+                refcount_violation();
+                #[cfg(feature = "leaky-hardening")]
+                return Some(curr);
+            }
+            (curr != 0).then(|| curr + 1)
+        })
+        .is_ok()
+}
+
+/// Thread-affine increment: a plain load/store pair instead of a locked RMW.
+#[inline]
+pub(crate) fn add_local(ref_count: &AtomicU32) -> u32 {
+    let curr = ref_count.load(Ordering::Relaxed);
+
+    #[cfg(feature = "refcount-hardening")]
+    if curr >= MAX_REFCOUNT {
+        #[cfg(not(feature = "leaky-hardening"))]
+        refcount_violation();
+        #[cfg(feature = "leaky-hardening")]
+        return MAX_REFCOUNT;
+    }
+
+    let next = curr.wrapping_add(1);
+    ref_count.store(next, Ordering::Relaxed);
+    next
+}
+
+/// Thread-affine decrement: a plain load/store pair instead of a locked RMW.
+#[inline]
+pub(crate) fn sub_local(ref_count: &AtomicU32) -> u32 {
+    let curr = ref_count.load(Ordering::Relaxed);
+
+    #[cfg(feature = "refcount-hardening")]
+    if curr == 0 {
+        #[cfg(not(feature = "leaky-hardening"))]
+        refcount_violation();
+        #[cfg(feature = "leaky-hardening")]
+        return MAX_REFCOUNT;
+    }
+
+    let next = curr.wrapping_sub(1);
+    ref_count.store(next, Ordering::Relaxed);
+    next
+}
+
+/// Bias kept in the shared count until the per-CPU shards are folded in, so that
+/// releases redirected to it mid-reconciliation can never observe zero.
+const PER_CPU_BIAS: i64 = 1 << 40;
+/// Shard value once it has been folded into the shared count. Stray updates that
+/// race with reconciliation move it by a few counts and stay far below any live
+/// shard value.
+const SHARD_RECONCILED: i64 = i64::MIN / 2;
+const SHARD_LIVE_MIN: i64 = SHARD_RECONCILED / 2;
+
+#[repr(align(64))]
+struct Shard(AtomicI64);
+
+/// Per-CPU reference count.
+///
+/// While sharded, `AddRef`/`Release` adjust the current CPU's cache line only and
+/// report a lower bound, so the count cannot reach zero. `reconcile` folds every
+/// shard into the shared count; from then on updates are exact and the final
+/// release is detected.
+pub struct PerCpuCounter<const N: usize> {
+    shared: AtomicI64,
+    reconciling: AtomicBool,
+    shards: [Shard; N],
+}
+
+impl<const N: usize> PerCpuCounter<N> {
+    pub(crate) fn new(initial: u32) -> Self {
+        Self {
+            shared: AtomicI64::new(PER_CPU_BIAS + initial as i64),
+            reconciling: AtomicBool::new(false),
+            shards: core::array::from_fn(|_| Shard(AtomicI64::new(0))),
+        }
+    }
+
+    #[inline]
+    fn shard(&self) -> &AtomicI64 {
+        &self.shards[current_shard() % N].0
+    }
+
+    #[inline]
+    fn shared_count(count: i64) -> u32 {
+        if count >= PER_CPU_BIAS / 2 {
+            // Not reconciled yet: only a lower bound is known.
+            1
+        } else {
+            count as u32
+        }
+    }
+
+    #[inline]
+    pub(crate) fn add(&self) -> u32 {
+        if self.shard().fetch_add(1, Ordering::Relaxed) > SHARD_LIVE_MIN {
+            // The caller's reference plus the new one.
+            return 2;
+        }
+        Self::shared_count(self.shared.fetch_add(1, Ordering::Relaxed) + 1)
+    }
+
+    #[inline]
+    pub(crate) fn sub(&self) -> u32 {
+        if self.shard().fetch_sub(1, Ordering::Release) > SHARD_LIVE_MIN {
+            return 1;
+        }
+        let count = self.shared.fetch_sub(1, Ordering::Release) - 1;
+        debug_assert!(count >= 0, "per-CPU refcount underflow");
+        Self::shared_count(count)
+    }
+
+    #[inline]
+    pub(crate) fn load(&self) -> u32 {
+        Self::shared_count(self.shared.load(Ordering::Acquire))
+    }
+
+    /// Folds the shards into the shared count and drops the bias. Idempotent.
+    ///
+    /// The caller must hold a reference, so the exact count stays above zero.
+    pub(crate) fn reconcile(&self) {
+        if self.reconciling.swap(true, Ordering::AcqRel) {
+            return;
+        }
+        let mut folded = 0i64;
+        for shard in &self.shards {
+            folded += shard.0.swap(SHARD_RECONCILED, Ordering::AcqRel);
+        }
+        let count = self.shared.fetch_add(folded - PER_CPU_BIAS, Ordering::AcqRel) + folded
+            - PER_CPU_BIAS;
+        debug_assert!(count > 0, "per-CPU refcount reconciled without a held reference");
+    }
+}
+
+#[cfg(all(feature = "driver", not(miri)))]
+#[repr(C)]
+#[allow(dead_code, non_camel_case_types, non_snake_case)]
+struct PROCESSOR_NUMBER {
+    Group: u16,
+    Number: u8,
+    Reserved: u8,
+}
+
+#[cfg(all(feature = "driver", not(miri)))]
+extern "system" {
+    fn KeGetCurrentProcessorNumberEx(processor: *mut PROCESSOR_NUMBER);
+}
+
+/// Index of the current processor, used to pick a shard.
+#[cfg(all(feature = "driver", not(miri)))]
+#[inline]
+pub(crate) fn current_shard() -> usize {
+    let mut processor = PROCESSOR_NUMBER {
+        Group: 0,
+        Number: 0,
+        Reserved: 0,
+    };
+    unsafe { KeGetCurrentProcessorNumberEx(&mut processor) };
+    processor.Group as usize * 64 + processor.Number as usize
+}
+
+/// Host builds have no processor number; hash the stack address, which is
+/// distinct per thread, instead.
+#[cfg(any(not(feature = "driver"), miri))]
+#[inline]
+pub(crate) fn current_shard() -> usize {
+    let marker = 0u8;
+    let addr = core::ptr::addr_of!(marker) as usize;
+    ((addr >> 16).wrapping_mul(0x9E37_79B9) >> 8) & 0xFFFF
+}
@@ -3,9 +3,13 @@
 
 use core::ffi::c_void;
 use core::marker::PhantomData;
-use core::ptr::NonNull;
+use core::ptr::{null_mut, NonNull};
+use core::sync::atomic::{AtomicPtr, Ordering};
 
+use crate::epoch::{self, EpochGuard, ReleaseSlot};
 use crate::iunknown::{IUnknownVtbl, Status, StatusResult};
+use crate::sync::SpinLock;
+use crate::traits::ComImplInner;
 
 /// Marker trait for types that are valid COM interfaces.
 ///
@@ -24,6 +28,18 @@ pub unsafe trait ComInterface: Sized {}
 /// calls from multiple threads and that reference counting is thread-safe.
 pub unsafe trait ThreadSafeComInterface: ComInterface {}
 
+/// Marker trait for COM interfaces whose objects never leave the creating thread.
+///
+/// Only such interfaces can be returned by objects that use
+/// [`LocalRefCount`](crate::wrapper::LocalRefCount).
+///
+/// # Safety
+/// Implementors guarantee that every reference to the underlying object is taken
+/// and released on one thread. The interface must not also implement
+/// [`ThreadSafeComInterface`], and must not expose async methods (their futures
+/// release the object from an executor thread).
+pub unsafe trait ThreadAffineComInterface: ComInterface {}
+
 /// Reference-counted COM interface pointer.
 ///
 /// # Safety
@@ -117,20 +133,32 @@ impl<T: ComInterface> ComRc<T> {
     where
         U: ComInterface + crate::vtable::ComInterfaceInfo,
     {
-        let mut out = core::ptr::null_mut();
-        let vtbl = unsafe { *(self.ptr.as_ptr() as *mut *mut IUnknownVtbl) };
-        let status = unsafe {
-            ((*vtbl).QueryInterface)(
-                self.ptr.as_ptr() as *mut c_void,
-                &U::IID,
-                &mut out,
-            )
-        };
-        let status = Status::from_raw(status);
-        if status.is_error() {
-            return Err(status);
+        unsafe { query_interface(self.ptr.as_ptr()) }
+    }
+
+    /// Returns the Rust implementation behind this pointer when its vtable is
+    /// `T::VTABLE` for this interface.
+    ///
+    /// The returned reference calls `T`'s trait methods directly, so in-driver
+    /// callers skip the vtable and the `extern "system"` shim and the call can be
+    /// inlined. `None` means the object is implemented elsewhere (or through
+    /// another layout); keep calling it through the vtable.
+    #[inline]
+    pub fn downcast_impl<U>(&self) -> Option<&U>
+    where
+        T: crate::vtable::ComInterfaceInfo,
+        U: ComImplInner<T::Vtable>,
+    {
+        unsafe { downcast_impl(self.ptr.as_ptr()) }
+    }
+
+    /// Borrows the interface pointer without touching the reference count.
+    #[inline]
+    pub fn as_com_ref(&self) -> ComRef<'_, T> {
+        ComRef {
+            ptr: self.ptr,
+            _phantom: PhantomData,
         }
-        unsafe { ComRc::<U>::from_raw_or_status(out as *mut U) }
     }
 }
 
@@ -159,6 +187,306 @@ impl<T: ComInterface> Drop for ComRc<T> {
     }
 }
 
+/// Borrowed COM interface pointer that does not own a reference.
+///
+/// `ComRef` is `Copy` and has the layout of a non-null interface pointer, so it
+/// can be passed to helpers and used as an in-parameter of declared interface
+/// methods; the caller's reference keeps the object alive for `'a`, and no
+/// `AddRef`/`Release` is issued. Use [`ComRef::upgrade`] to take a reference when
+/// the pointer must outlive the call. Use `Option<ComRef<T>>` for parameters that
+/// may be null.
+#[repr(transparent)]
+pub struct ComRef<'a, T: ComInterface> {
+    ptr: NonNull<T>,
+    _phantom: PhantomData<&'a T>,
+}
+
+unsafe impl<T: ThreadSafeComInterface> Send for ComRef<'_, T> {}
+unsafe impl<T: ThreadSafeComInterface> Sync for ComRef<'_, T> {}
+
+impl<'a, T: ComInterface> ComRef<'a, T> {
+    /// Borrows a raw COM pointer without calling `AddRef`.
+    ///
+    /// # Safety
+    /// `ptr` must be a valid COM interface pointer when non-null, and a reference
+    /// to it must be held by someone else for `'a`.
+    #[inline]
+    pub unsafe fn from_raw(ptr: *mut T) -> Option<Self> {
+        NonNull::new(ptr).map(|ptr| Self {
+            ptr,
+            _phantom: PhantomData,
+        })
+    }
+
+    #[inline]
+    pub fn as_ptr(self) -> *mut T {
+        self.ptr.as_ptr()
+    }
+
+    /// Calls `AddRef` and returns an owning smart pointer.
+    #[inline]
+    pub fn upgrade(self) -> ComRc<T> {
+        unsafe { add_ref(self.ptr.as_ptr()) };
+        ComRc {
+            ptr: self.ptr,
+            _phantom: PhantomData,
+        }
+    }
+
+    /// Borrowed form of [`ComRc::downcast_impl`].
+    #[inline]
+    pub fn downcast_impl<U>(self) -> Option<&'a U>
+    where
+        T: crate::vtable::ComInterfaceInfo,
+        U: ComImplInner<T::Vtable>,
+    {
+        unsafe { downcast_impl(self.ptr.as_ptr()) }
+    }
+
+    /// Queries for another COM interface and returns a smart pointer on success.
+    pub fn query_interface<U>(self) -> StatusResult<ComRc<U>>
+    where
+        U: ComInterface + crate::vtable::ComInterfaceInfo,
+    {
+        unsafe { query_interface(self.ptr.as_ptr()) }
+    }
+}
+
+impl<T: ComInterface> Clone for ComRef<'_, T> {
+    #[inline]
+    fn clone(&self) -> Self {
+        *self
+    }
+}
+
+impl<T: ComInterface> Copy for ComRef<'_, T> {}
+
+impl<'a, T: ComInterface> From<&'a ComRc<T>> for ComRef<'a, T> {
+    #[inline]
+    fn from(rc: &'a ComRc<T>) -> Self {
+        rc.as_com_ref()
+    }
+}
+
+impl<T: ComInterface> core::ops::Deref for ComRef<'_, T> {
+    type Target = T;
+
+    #[inline]
+    fn deref(&self) -> &Self::Target {
+        unsafe { self.ptr.as_ref() }
+    }
+}
+
+/// Shared, atomically replaceable `Option<ComRc<T>>`.
+///
+/// The read path is [`load_ref`](Self::load_ref): under an epoch guard the
+/// caller already holds ([`epoch::pin`]) it is one load of the pointer, with
+/// no lock and no reference count update, and the borrowed `ComRef` stays
+/// valid until the guard is dropped. Pin once and read as often as needed.
+/// [`load`](Self::load) is the convenience form for a reference that must
+/// outlive the guard: a pin, the `AddRef` and the unpin.
+///
+/// Writers (`store`, `swap`, `compare_exchange`) are serialized by a
+/// [`SpinLock`] and are meant for control paths. They never wait for readers.
+/// If no reader is pinned once the pointer is replaced, the reference the
+/// `AtomicComRc` held on the old value is released at once. Otherwise it goes
+/// to the epoch reclaimer and is released by
+/// [`reclaim_deferred`](crate::reclaim::reclaim_deferred) once no reader can
+/// still see it. The node for that is allocated before the pointer changes:
+/// if it cannot be, the write fails, nothing changes and the new value is
+/// handed back. `swap` and `compare_exchange` return the caller a reference of
+/// its own to the old value.
+pub struct AtomicComRc<T: ThreadSafeComInterface> {
+    ptr: AtomicPtr<T>,
+    writer: SpinLock<()>,
+    _phantom: PhantomData<ComRc<T>>,
+}
+
+unsafe impl<T: ThreadSafeComInterface> Send for AtomicComRc<T> {}
+unsafe impl<T: ThreadSafeComInterface> Sync for AtomicComRc<T> {}
+
+impl<T: ThreadSafeComInterface> AtomicComRc<T> {
+    /// Creates an empty pointer; usable in a `static`.
+    pub const fn empty() -> Self {
+        Self {
+            ptr: AtomicPtr::new(null_mut()),
+            writer: SpinLock::new(()),
+            _phantom: PhantomData,
+        }
+    }
+
+    /// Creates a pointer holding `value`.
+    pub fn new(value: Option<ComRc<T>>) -> Self {
+        Self {
+            ptr: AtomicPtr::new(into_raw_or_null(value)),
+            writer: SpinLock::new(()),
+            _phantom: PhantomData,
+        }
+    }
+
+    /// Borrows the current value. It stays valid while `guard` is held, even if
+    /// the value is replaced meanwhile.
+    #[inline]
+    pub fn load_ref<'a>(&'a self, guard: &'a EpochGuard) -> Option<ComRef<'a, T>> {
+        let _ = guard;
+        // SAFETY: a replaced pointer keeps the reference this `AtomicComRc` held
+        // until every guard pinned before the replacement is dropped. SeqCst
+        // (a plain load on x64) keeps the read after the pin, which the
+        // writer's quiescence check relies on.
+        unsafe { ComRef::from_raw(self.ptr.load(Ordering::SeqCst)) }
+    }
+
+    /// Returns a new reference to the current value.
+    #[inline]
+    pub fn load(&self) -> Option<ComRc<T>> {
+        let guard = epoch::pin();
+        self.load_ref(&guard).map(ComRef::upgrade)
+    }
+
+    /// Replaces the value. Fails, handing `value` back, only if the release of
+    /// the old value cannot be queued.
+    #[inline]
+    pub fn store(&self, value: Option<ComRc<T>>) -> Result<(), Option<ComRc<T>>> {
+        let (old, slot) = self.replace(value, None)?;
+        retire(old, slot);
+        Ok(())
+    }
+
+    /// Replaces the value and returns the previous one. Fails like
+    /// [`store`](Self::store).
+    pub fn swap(&self, value: Option<ComRc<T>>) -> Result<Option<ComRc<T>>, Option<ComRc<T>>> {
+        let (old, slot) = self.replace(value, None)?;
+        Ok(detach(old, slot))
+    }
+
+    /// Stores `new` if the current value is the same interface pointer as
+    /// `current`.
+    ///
+    /// Returns the previous value on success. On failure (another value, or
+    /// no memory to queue the old value's release) `new` is handed back
+    /// unchanged.
+    pub fn compare_exchange(
+        &self,
+        current: Option<&ComRc<T>>,
+        new: Option<ComRc<T>>,
+    ) -> Result<Option<ComRc<T>>, Option<ComRc<T>>> {
+        let expected = current.map_or(null_mut(), ComRc::as_ptr);
+        let (old, slot) = self.replace(new, Some(expected))?;
+        Ok(detach(old, slot))
+    }
+
+    /// Returns the current interface pointer without taking a reference (a racy
+    /// snapshot, only meaningful for identity checks).
+    #[inline]
+    pub fn as_ptr(&self) -> *mut T {
+        self.ptr.load(Ordering::Acquire)
+    }
+
+    /// Swaps `value` in, if the current pointer is `expected` when one is
+    /// given. Returns the old pointer with the slot its release may need.
+    fn replace(
+        &self,
+        value: Option<ComRc<T>>,
+        expected: Option<*mut T>,
+    ) -> Result<(*mut T, Option<ReleaseSlot>), Option<ComRc<T>>> {
+        // Allocated outside the lock unless the pointer was empty.
+        let mut slot = if self.ptr.load(Ordering::Relaxed).is_null() {
+            None
+        } else {
+            ReleaseSlot::new()
+        };
+        let _writer = self.writer.lock();
+        let old = self.ptr.load(Ordering::Relaxed);
+        if expected.is_some_and(|expected| expected != old) {
+            return Err(value);
+        }
+        if !old.is_null() && slot.is_none() {
+            slot = ReleaseSlot::new();
+            if slot.is_none() {
+                #[cfg(debug_assertions)]
+                crate::trace::report_error(
+                    file!(),
+                    line!(),
+                    crate::iunknown::STATUS_INSUFFICIENT_RESOURCES,
+                );
+                return Err(value);
+            }
+        }
+        self.ptr.store(into_raw_or_null(value), Ordering::SeqCst);
+        Ok((old, slot))
+    }
+}
+
+impl<T: ThreadSafeComInterface> Default for AtomicComRc<T> {
+    #[inline]
+    fn default() -> Self {
+        Self::empty()
+    }
+}
+
+impl<T: ThreadSafeComInterface> Drop for AtomicComRc<T> {
+    fn drop(&mut self) {
+        // Readers borrow `self`, so none is left.
+        drop(unsafe { ComRc::from_raw(*self.ptr.get_mut()) });
+    }
+}
+
+/// Releases the reference an `AtomicComRc` held on the replaced `ptr`: at once
+/// if no reader is pinned, otherwise through `slot` once they are gone.
+fn retire<T: ThreadSafeComInterface>(ptr: *mut T, slot: Option<ReleaseSlot>) {
+    let Some(rc) = (unsafe { ComRc::from_raw(ptr) }) else {
+        return;
+    };
+    if epoch::is_quiescent() {
+        return;
+    }
+    match slot {
+        Some(slot) => slot.defer(rc),
+        // `replace` allocates a slot for every non-null pointer.
+        None => unreachable!(),
+    }
+}
+
+/// Returns a new reference to a replaced value and retires the old one.
+fn detach<T: ThreadSafeComInterface>(ptr: *mut T, slot: Option<ReleaseSlot>) -> Option<ComRc<T>> {
+    let rc = unsafe { ComRc::from_raw_addref(ptr) };
+    retire(ptr, slot);
+    rc
+}
+
+#[inline]
+fn into_raw_or_null<T: ComInterface>(value: Option<ComRc<T>>) -> *mut T {
+    value.map_or(null_mut(), ComRc::into_raw)
+}
+
+unsafe fn downcast_impl<'a, T, U>(ptr: *mut T) -> Option<&'a U>
+where
+    T: ComInterface + crate::vtable::ComInterfaceInfo,
+    U: ComImplInner<T::Vtable>,
+{
+    let vtbl = unsafe { *(ptr as *mut *const T::Vtable) };
+    if core::ptr::eq(vtbl, U::VTABLE) {
+        Some(unsafe { U::inner_from_ptr(ptr as *mut c_void) })
+    } else {
+        None
+    }
+}
+
+unsafe fn query_interface<T, U>(ptr: *mut T) -> StatusResult<ComRc<U>>
+where
+    T: ComInterface,
+    U: ComInterface + crate::vtable::ComInterfaceInfo,
+{
+    let mut out = core::ptr::null_mut();
+    let vtbl = unsafe { *(ptr as *mut *mut IUnknownVtbl) };
+    let status = unsafe { ((*vtbl).QueryInterface)(ptr as *mut c_void, &U::IID, &mut out) };
+    let status = Status::from_raw(status);
+    if status.is_error() {
+        return Err(status);
+    }
+    unsafe { ComRc::<U>::from_raw_or_status(out as *mut U) }
+}
+
 unsafe fn add_ref<T: ComInterface>(ptr: *mut T) -> u32 {
     let vtbl = unsafe { *(ptr as *mut *mut IUnknownVtbl) };
     unsafe { ((*vtbl).AddRef)(ptr as *mut c_void) }
@@ -0,0 +1,498 @@
+// sync.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Spin locks with RAII guards: plain, queued (in-stack) and reader/writer.
+
+use core::cell::UnsafeCell;
+use core::marker::PhantomData;
+use core::ops::{Deref, DerefMut};
+#[cfg(any(not(feature = "driver"), miri))]
+use core::ptr::null_mut;
+#[cfg(any(not(feature = "driver"), miri))]
+use core::sync::atomic::{AtomicBool, AtomicPtr, AtomicU32, Ordering};
+
+#[cfg(all(feature = "driver", not(miri)))]
+use crate::ntddk::{
+    ExAcquireSpinLockExclusive, ExAcquireSpinLockShared, ExReleaseSpinLockExclusive,
+    ExReleaseSpinLockShared, KeAcquireInStackQueuedSpinLock, KeAcquireSpinLockRaiseToDpc,
+    KeReleaseInStackQueuedSpinLock, KeReleaseSpinLock, EX_SPIN_LOCK, KIRQL, KLOCK_QUEUE_HANDLE,
+    KSPIN_LOCK,
+};
+
+/// IRQL to restore when a guard is dropped (nothing on host builds).
+#[cfg(all(feature = "driver", not(miri)))]
+type SavedIrql = KIRQL;
+#[cfg(any(not(feature = "driver"), miri))]
+type SavedIrql = ();
+
+/// Guards restore the IRQL of the CPU that acquired the lock, so they must not
+/// move to another thread.
+type NotSend = PhantomData<*mut ()>;
+
+/// Spins until `ready` returns true (host builds).
+#[cfg(any(not(feature = "driver"), miri))]
+#[inline]
+fn spin_until(mut ready: impl FnMut() -> bool) {
+    while !ready() {
+        core::hint::spin_loop();
+    }
+}
+
+/// Test-and-set spin lock (`KeAcquireSpinLockRaiseToDpc`).
+///
+/// Cheapest to acquire when uncontended, but waiters all spin on the lock word
+/// and are not served in order. Prefer [`QueuedSpinLock`] for locks that several
+/// CPUs hit at once, and [`RwSpinLock`] when most holders only read.
+///
+/// Acquiring raises to `DISPATCH_LEVEL` in kernel builds; the guard restores the
+/// previous IRQL.
+pub struct SpinLock<T> {
+    #[cfg(all(feature = "driver", not(miri)))]
+    lock: UnsafeCell<KSPIN_LOCK>,
+    #[cfg(any(not(feature = "driver"), miri))]
+    locked: AtomicBool,
+    value: UnsafeCell<T>,
+}
+
+unsafe impl<T: Send> Send for SpinLock<T> {}
+unsafe impl<T: Send> Sync for SpinLock<T> {}
+
+impl<T> SpinLock<T> {
+    /// Creates an unlocked lock (a zeroed `KSPIN_LOCK`, as `KeInitializeSpinLock`
+    /// leaves it).
+    #[inline]
+    pub const fn new(value: T) -> Self {
+        Self {
+            #[cfg(all(feature = "driver", not(miri)))]
+            lock: UnsafeCell::new(0),
+            #[cfg(any(not(feature = "driver"), miri))]
+            locked: AtomicBool::new(false),
+            value: UnsafeCell::new(value),
+        }
+    }
+
+    #[cfg(all(feature = "driver", not(miri)))]
+    #[inline]
+    pub fn lock(&self) -> SpinLockGuard<'_, T> {
+        let old_irql = unsafe { KeAcquireSpinLockRaiseToDpc(self.lock.get()) };
+        SpinLockGuard {
+            lock: self,
+            old_irql,
+            _not_send: PhantomData,
+        }
+    }
+
+    #[cfg(any(not(feature = "driver"), miri))]
+    #[inline]
+    pub fn lock(&self) -> SpinLockGuard<'_, T> {
+        spin_until(|| {
+            !self.locked.load(Ordering::Relaxed)
+                && self
+                    .locked
+                    .compare_exchange_weak(false, true, Ordering::Acquire, Ordering::Relaxed)
+                    .is_ok()
+        });
+        SpinLockGuard {
+            lock: self,
+            old_irql: (),
+            _not_send: PhantomData,
+        }
+    }
+
+    #[inline]
+    pub fn get_mut(&mut self) -> &mut T {
+        self.value.get_mut()
+    }
+
+    #[inline]
+    pub fn into_inner(self) -> T {
+        self.value.into_inner()
+    }
+}
+
+pub struct SpinLockGuard<'a, T> {
+    lock: &'a SpinLock<T>,
+    old_irql: SavedIrql,
+    _not_send: NotSend,
+}
+
+impl<T> Deref for SpinLockGuard<'_, T> {
+    type Target = T;
+    #[inline]
+    fn deref(&self) -> &Self::Target {
+        unsafe { &*self.lock.value.get() }
+    }
+}
+
+impl<T> DerefMut for SpinLockGuard<'_, T> {
+    #[inline]
+    fn deref_mut(&mut self) -> &mut Self::Target {
+        unsafe { &mut *self.lock.value.get() }
+    }
+}
+
+impl<T> Drop for SpinLockGuard<'_, T> {
+    #[cfg(all(feature = "driver", not(miri)))]
+    #[inline]
+    fn drop(&mut self) {
+        unsafe { KeReleaseSpinLock(self.lock.lock.get(), self.old_irql) };
+    }
+
+    #[cfg(any(not(feature = "driver"), miri))]
+    #[inline]
+    fn drop(&mut self) {
+        let () = self.old_irql;
+        self.lock.locked.store(false, Ordering::Release);
+    }
+}
+
+/// Queue entry of one [`QueuedSpinLock`] acquisition. It lives on the acquiring
+/// thread's stack and is borrowed by the guard, so it cannot move while queued.
+pub struct LockQueueNode {
+    #[cfg(all(feature = "driver", not(miri)))]
+    handle: UnsafeCell<KLOCK_QUEUE_HANDLE>,
+    #[cfg(any(not(feature = "driver"), miri))]
+    next: AtomicPtr<LockQueueNode>,
+    #[cfg(any(not(feature = "driver"), miri))]
+    waiting: AtomicBool,
+}
+
+impl LockQueueNode {
+    #[inline]
+    pub const fn new() -> Self {
+        Self {
+            #[cfg(all(feature = "driver", not(miri)))]
+            handle: UnsafeCell::new(unsafe { core::mem::zeroed() }),
+            #[cfg(any(not(feature = "driver"), miri))]
+            next: AtomicPtr::new(null_mut()),
+            #[cfg(any(not(feature = "driver"), miri))]
+            waiting: AtomicBool::new(false),
+        }
+    }
+}
+
+impl Default for LockQueueNode {
+    #[inline]
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// Queued spin lock (`KeAcquireInStackQueuedSpinLock`).
+///
+/// Waiters form a FIFO queue and each spins on its own [`LockQueueNode`], so the
+/// lock is handed over in arrival order and a release touches one waiter's cache
+/// line instead of every waiter's. An uncontended acquire costs about the same as
+/// [`SpinLock`]. Host builds use an MCS lock with the same behaviour.
+///
+/// ```ignore
+/// let mut node = LockQueueNode::new();
+/// let mut queue = lock.lock(&mut node);
+/// queue.push(item);
+/// ```
+pub struct QueuedSpinLock<T> {
+    #[cfg(all(feature = "driver", not(miri)))]
+    lock: UnsafeCell<KSPIN_LOCK>,
+    #[cfg(any(not(feature = "driver"), miri))]
+    tail: AtomicPtr<LockQueueNode>,
+    value: UnsafeCell<T>,
+}
+
+unsafe impl<T: Send> Send for QueuedSpinLock<T> {}
+unsafe impl<T: Send> Sync for QueuedSpinLock<T> {}
+
+impl<T> QueuedSpinLock<T> {
+    #[inline]
+    pub const fn new(value: T) -> Self {
+        Self {
+            #[cfg(all(feature = "driver", not(miri)))]
+            lock: UnsafeCell::new(0),
+            #[cfg(any(not(feature = "driver"), miri))]
+            tail: AtomicPtr::new(null_mut()),
+            value: UnsafeCell::new(value),
+        }
+    }
+
+    /// Acquires the lock, queueing `node` behind earlier waiters.
+    #[cfg(all(feature = "driver", not(miri)))]
+    #[inline]
+    pub fn lock<'a>(&'a self, node: &'a mut LockQueueNode) -> QueuedSpinLockGuard<'a, T> {
+        unsafe { KeAcquireInStackQueuedSpinLock(self.lock.get(), node.handle.get()) };
+        QueuedSpinLockGuard {
+            lock: self,
+            node,
+            _not_send: PhantomData,
+        }
+    }
+
+    /// Acquires the lock, queueing `node` behind earlier waiters.
+    #[cfg(any(not(feature = "driver"), miri))]
+    pub fn lock<'a>(&'a self, node: &'a mut LockQueueNode) -> QueuedSpinLockGuard<'a, T> {
+        // Other CPUs write the node's fields through `tail` and `next`, so only
+        // share it from here on.
+        let node: &'a LockQueueNode = node;
+        node.next.store(null_mut(), Ordering::Relaxed);
+        node.waiting.store(true, Ordering::Relaxed);
+        let this = node as *const LockQueueNode as *mut LockQueueNode;
+        let previous = self.tail.swap(this, Ordering::AcqRel);
+        if !previous.is_null() {
+            unsafe { (*previous).next.store(this, Ordering::Release) };
+            spin_until(|| !node.waiting.load(Ordering::Acquire));
+        }
+        QueuedSpinLockGuard {
+            lock: self,
+            node,
+            _not_send: PhantomData,
+        }
+    }
+
+    /// Runs `f` under the lock with a queue node on the current stack.
+    #[inline]
+    pub fn with<R>(&self, f: impl FnOnce(&mut T) -> R) -> R {
+        let mut node = LockQueueNode::new();
+        let mut guard = self.lock(&mut node);
+        f(&mut guard)
+    }
+
+    #[inline]
+    pub fn get_mut(&mut self) -> &mut T {
+        self.value.get_mut()
+    }
+
+    #[inline]
+    pub fn into_inner(self) -> T {
+        self.value.into_inner()
+    }
+}
+
+pub struct QueuedSpinLockGuard<'a, T> {
+    lock: &'a QueuedSpinLock<T>,
+    node: &'a LockQueueNode,
+    _not_send: NotSend,
+}
+
+impl<T> Deref for QueuedSpinLockGuard<'_, T> {
+    type Target = T;
+    #[inline]
+    fn deref(&self) -> &Self::Target {
+        unsafe { &*self.lock.value.get() }
+    }
+}
+
+impl<T> DerefMut for QueuedSpinLockGuard<'_, T> {
+    #[inline]
+    fn deref_mut(&mut self) -> &mut Self::Target {
+        unsafe { &mut *self.lock.value.get() }
+    }
+}
+
+impl<T> Drop for QueuedSpinLockGuard<'_, T> {
+    #[cfg(all(feature = "driver", not(miri)))]
+    #[inline]
+    fn drop(&mut self) {
+        unsafe { KeReleaseInStackQueuedSpinLock(self.node.handle.get()) };
+    }
+
+    #[cfg(any(not(feature = "driver"), miri))]
+    fn drop(&mut self) {
+        let this = self.node as *const LockQueueNode as *mut LockQueueNode;
+        let mut next = self.node.next.load(Ordering::Acquire);
+        if next.is_null() {
+            if self
+                .lock
+                .tail
+                .compare_exchange(this, null_mut(), Ordering::Release, Ordering::Relaxed)
+                .is_ok()
+            {
+                return;
+            }
+            // A waiter swapped itself in but has not linked to us yet.
+            spin_until(|| {
+                next = self.node.next.load(Ordering::Acquire);
+                !next.is_null()
+            });
+        }
+        unsafe { (*next).waiting.store(false, Ordering::Release) };
+    }
+}
+
+#[cfg(any(not(feature = "driver"), miri))]
+const RW_WRITER: u32 = 1 << 31;
+#[cfg(any(not(feature = "driver"), miri))]
+const RW_WRITER_WAITING: u32 = 1 << 30;
+#[cfg(any(not(feature = "driver"), miri))]
+const RW_READERS: u32 = RW_WRITER_WAITING - 1;
+
+/// Reader/writer spin lock (`ExAcquireSpinLockShared` / `ExAcquireSpinLockExclusive`).
+///
+/// Any number of readers hold the lock together; a writer holds it alone. A
+/// waiting writer stops new readers from entering, so a steady stream of readers
+/// cannot starve it. Both modes raise to `DISPATCH_LEVEL` in kernel builds.
+pub struct RwSpinLock<T> {
+    #[cfg(all(feature = "driver", not(miri)))]
+    lock: UnsafeCell<EX_SPIN_LOCK>,
+    #[cfg(any(not(feature = "driver"), miri))]
+    state: AtomicU32,
+    value: UnsafeCell<T>,
+}
+
+unsafe impl<T: Send> Send for RwSpinLock<T> {}
+unsafe impl<T: Send + Sync> Sync for RwSpinLock<T> {}
+
+impl<T> RwSpinLock<T> {
+    #[inline]
+    pub const fn new(value: T) -> Self {
+        Self {
+            #[cfg(all(feature = "driver", not(miri)))]
+            lock: UnsafeCell::new(0),
+            #[cfg(any(not(feature = "driver"), miri))]
+            state: AtomicU32::new(0),
+            value: UnsafeCell::new(value),
+        }
+    }
+
+    /// Acquires the lock shared.
+    #[cfg(all(feature = "driver", not(miri)))]
+    #[inline]
+    pub fn read(&self) -> RwSpinLockReadGuard<'_, T> {
+        let old_irql = unsafe { ExAcquireSpinLockShared(self.lock.get()) };
+        RwSpinLockReadGuard {
+            lock: self,
+            old_irql,
+            _not_send: PhantomData,
+        }
+    }
+
+    /// Acquires the lock exclusive.
+    #[cfg(all(feature = "driver", not(miri)))]
+    #[inline]
+    pub fn write(&self) -> RwSpinLockWriteGuard<'_, T> {
+        let old_irql = unsafe { ExAcquireSpinLockExclusive(self.lock.get()) };
+        RwSpinLockWriteGuard {
+            lock: self,
+            old_irql,
+            _not_send: PhantomData,
+        }
+    }
+
+    /// Acquires the lock shared.
+    #[cfg(any(not(feature = "driver"), miri))]
+    #[inline]
+    pub fn read(&self) -> RwSpinLockReadGuard<'_, T> {
+        spin_until(|| {
+            let state = self.state.load(Ordering::Relaxed);
+            state & (RW_WRITER | RW_WRITER_WAITING) == 0
+                && self
+                    .state
+                    .compare_exchange_weak(state, state + 1, Ordering::Acquire, Ordering::Relaxed)
+                    .is_ok()
+        });
+        RwSpinLockReadGuard {
+            lock: self,
+            old_irql: (),
+            _not_send: PhantomData,
+        }
+    }
+
+    /// Acquires the lock exclusive.
+    #[cfg(any(not(feature = "driver"), miri))]
+    #[inline]
+    pub fn write(&self) -> RwSpinLockWriteGuard<'_, T> {
+        spin_until(|| {
+            let state = self.state.load(Ordering::Relaxed);
+            if state & (RW_WRITER | RW_READERS) == 0 {
+                return self
+                    .state
+                    .compare_exchange_weak(state, RW_WRITER, Ordering::Acquire, Ordering::Relaxed)
+                    .is_ok();
+            }
+            if state & RW_WRITER_WAITING == 0 {
+                self.state.fetch_or(RW_WRITER_WAITING, Ordering::Relaxed);
+            }
+            false
+        });
+        RwSpinLockWriteGuard {
+            lock: self,
+            old_irql: (),
+            _not_send: PhantomData,
+        }
+    }
+
+    #[inline]
+    pub fn get_mut(&mut self) -> &mut T {
+        self.value.get_mut()
+    }
+
+    #[inline]
+    pub fn into_inner(self) -> T {
+        self.value.into_inner()
+    }
+}
+
+pub struct RwSpinLockReadGuard<'a, T> {
+    lock: &'a RwSpinLock<T>,
+    old_irql: SavedIrql,
+    _not_send: NotSend,
+}
+
+impl<T> Deref for RwSpinLockReadGuard<'_, T> {
+    type Target = T;
+    #[inline]
+    fn deref(&self) -> &Self::Target {
+        unsafe { &*self.lock.value.get() }
+    }
+}
+
+impl<T> Drop for RwSpinLockReadGuard<'_, T> {
+    #[cfg(all(feature = "driver", not(miri)))]
+    #[inline]
+    fn drop(&mut self) {
+        unsafe { ExReleaseSpinLockShared(self.lock.lock.get(), self.old_irql) };
+    }
+
+    #[cfg(any(not(feature = "driver"), miri))]
+    #[inline]
+    fn drop(&mut self) {
+        let () = self.old_irql;
+        self.lock.state.fetch_sub(1, Ordering::Release);
+    }
+}
+
+pub struct RwSpinLockWriteGuard<'a, T> {
+    lock: &'a RwSpinLock<T>,
+    old_irql: SavedIrql,
+    _not_send: NotSend,
+}
+
+impl<T> Deref for RwSpinLockWriteGuard<'_, T> {
+    type Target = T;
+    #[inline]
+    fn deref(&self) -> &Self::Target {
+        unsafe { &*self.lock.value.get() }
+    }
+}
+
+impl<T> DerefMut for RwSpinLockWriteGuard<'_, T> {
+    #[inline]
+    fn deref_mut(&mut self) -> &mut Self::Target {
+        unsafe { &mut *self.lock.value.get() }
+    }
+}
+
+impl<T> Drop for RwSpinLockWriteGuard<'_, T> {
+    #[cfg(all(feature = "driver", not(miri)))]
+    #[inline]
+    fn drop(&mut self) {
+        unsafe { ExReleaseSpinLockExclusive(self.lock.lock.get(), self.old_irql) };
+    }
+
+    #[cfg(any(not(feature = "driver"), miri))]
+    #[inline]
+    fn drop(&mut self) {
+        let () = self.old_irql;
+        // Keep a waiting-writer bit set by another writer.
+        self.lock.state.fetch_and(!RW_WRITER, Ordering::Release);
+    }
+}
@@ -31,6 +31,26 @@ impl<M, C> Cancellable<M, C> {
             cleanup: ManuallyDrop::new(cleanup),
         }
     }
+
+    /// Builds a `Cancellable` at `slot`, running `init` directly into the main future's storage.
+    ///
+    /// # Safety
+    /// `slot` must be valid for writes and aligned. On error `slot` is left uninitialized.
+    #[cfg(feature = "async-com")]
+    #[inline]
+    pub(crate) unsafe fn init_in_place<E>(
+        slot: *mut Self,
+        cleanup: C,
+        init: impl FnOnce(*mut M) -> Result<(), E>,
+    ) -> Result<(), E> {
+        // `ManuallyDrop<M>` is `repr(transparent)`.
+        init(unsafe { core::ptr::addr_of_mut!((*slot).main) } as *mut M)?;
+        unsafe {
+            core::ptr::addr_of_mut!((*slot).state).write(CancellableState::RunningMain);
+            core::ptr::addr_of_mut!((*slot).cleanup).write(ManuallyDrop::new(cleanup));
+        }
+        Ok(())
+    }
 }
 
 impl<M, C> Future for Cancellable<M, C>
@@ -0,0 +1,249 @@
+// task_state.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Task reference count and scheduling flags packed into one atomic word.
+
+use core::sync::atomic::{AtomicU64, Ordering};
+
+#[cfg(feature = "refcount-hardening")]
+use crate::refcount::MAX_REFCOUNT;
+#[cfg(all(feature = "refcount-hardening", not(feature = "leaky-hardening")))]
+use crate::refcount::refcount_violation;
+
+/// A DPC or work item is queued for the task and holds a reference.
+const SCHEDULED: u64 = 1 << 0;
+/// A run is polling the task.
+const RUNNING: u64 = 1 << 1;
+/// Woken while running: the run polls again (or queues itself) before it ends.
+/// Owned by the run, so wakes leave the task alone while it is set.
+const NOTIFIED: u64 = 1 << 2;
+/// The future has finished or was dropped.
+const COMPLETE: u64 = 1 << 3;
+const CANCEL_REQUESTED: u64 = 1 << 4;
+/// The cancellation request was observed by the task.
+const CANCEL_TAKEN: u64 = 1 << 5;
+
+const REF_SHIFT: u32 = 32;
+const REF_ONE: u64 = 1 << REF_SHIFT;
+
+#[inline]
+fn refs(state: u64) -> u32 {
+    (state >> REF_SHIFT) as u32
+}
+
+#[inline]
+fn with_ref(state: u64) -> u64 {
+    #[cfg(feature = "refcount-hardening")]
+    if refs(state) >= MAX_REFCOUNT {
+        #[cfg(not(feature = "leaky-hardening"))]
+        refcount_violation();
+        #[cfg(feature = "leaky-hardening")]
+        return state;
+    }
+    state + REF_ONE
+}
+
+/// Applies a wake to `state`: an idle task is scheduled with a new reference
+/// for the queued run, a running one is notified. `None` if nothing changes.
+#[inline]
+fn notified(state: u64) -> Option<u64> {
+    if state & (COMPLETE | SCHEDULED | NOTIFIED) != 0 {
+        return None;
+    }
+    if state & RUNNING != 0 {
+        return Some(state | NOTIFIED);
+    }
+    Some(with_ref(state) | SCHEDULED)
+}
+
+/// Reference count, scheduling and cancellation state of an executor task.
+///
+/// The count lives in the high 32 bits and the flags in the low ones, so a
+/// wake is one compare-exchange that checks for completion, claims the queued
+/// run and takes its reference together, and a wake that finds the task
+/// already queued or notified costs a single load. A wake during a poll marks
+/// the running task instead of queueing a second run, so a task never runs on
+/// two CPUs at once.
+///
+/// Transitions that submit a run return true; the caller then queues the DPC
+/// or work item, which owns the reference taken for it.
+pub struct TaskState(AtomicU64);
+
+impl TaskState {
+    /// An idle task with one reference.
+    #[inline]
+    pub const fn new() -> Self {
+        Self(AtomicU64::new(REF_ONE))
+    }
+
+    #[inline]
+    pub fn ref_count(&self) -> u32 {
+        refs(self.0.load(Ordering::Relaxed))
+    }
+
+    #[cfg(not(feature = "refcount-hardening"))]
+    #[inline]
+    pub fn ref_inc(&self) {
+        self.0.fetch_add(REF_ONE, Ordering::Relaxed);
+    }
+
+    #[cfg(feature = "refcount-hardening")]
+    #[inline]
+    pub fn ref_inc(&self) {
+        let _ = self
+            .0
+            .fetch_update(Ordering::Relaxed, Ordering::Relaxed, |state| Some(with_ref(state)));
+    }
+
+    /// Drops a reference; returns true for the last one. The caller issues the
+    /// acquire fence before freeing the task.
+    #[cfg(not(feature = "refcount-hardening"))]
+    #[inline]
+    pub fn ref_dec(&self) -> bool {
+        refs(self.0.fetch_sub(REF_ONE, Ordering::Release)) == 1
+    }
+
+    #[cfg(feature = "refcount-hardening")]
+    #[inline]
+    pub fn ref_dec(&self) -> bool {
+        match self.0.fetch_update(Ordering::Release, Ordering::Relaxed, |state| {
+            (refs(state) != 0).then(|| state - REF_ONE)
+        }) {
+            Ok(prev) => refs(prev) == 1,
+            #[cfg(not(feature = "leaky-hardening"))]
+            Err(_) => refcount_violation(),
+            #[cfg(feature = "leaky-hardening")]
+            Err(_) => false,
+        }
+    }
+
+    /// Takes a reference only while the task is alive (the count is not zero).
+    #[inline]
+    pub fn try_ref_inc(&self) -> bool {
+        self.0
+            .fetch_update(Ordering::Acquire, Ordering::Relaxed, |state| {
+                (refs(state) != 0).then(|| with_ref(state))
+            })
+            .is_ok()
+    }
+
+    /// Wakes the task. Returns true if the caller must submit a run.
+    #[inline]
+    pub fn transition_to_notified(&self) -> bool {
+        let mut state = self.0.load(Ordering::Acquire);
+        loop {
+            let Some(next) = notified(state) else {
+                return false;
+            };
+            match self
+                .0
+                .compare_exchange_weak(state, next, Ordering::AcqRel, Ordering::Acquire)
+            {
+                Ok(_) => return next & SCHEDULED != 0,
+                Err(current) => state = current,
+            }
+        }
+    }
+
+    /// Requests cancellation and wakes the task. `None` if it was requested
+    /// already; otherwise whether the caller must submit a run.
+    #[inline]
+    pub fn request_cancel(&self) -> Option<bool> {
+        let mut state = self.0.load(Ordering::Acquire);
+        loop {
+            if state & CANCEL_REQUESTED != 0 {
+                return None;
+            }
+            let next = notified(state).unwrap_or(state) | CANCEL_REQUESTED;
+            match self
+                .0
+                .compare_exchange_weak(state, next, Ordering::AcqRel, Ordering::Acquire)
+            {
+                Ok(_) => return Some(next & SCHEDULED != 0 && state & SCHEDULED == 0),
+                Err(current) => state = current,
+            }
+        }
+    }
+
+    #[inline]
+    pub fn is_cancel_requested(&self) -> bool {
+        self.0.load(Ordering::Relaxed) & CANCEL_REQUESTED != 0
+    }
+
+    /// Returns true once per cancellation request, then marks it observed.
+    #[inline]
+    pub fn take_cancel(&self) -> bool {
+        self.0
+            .fetch_update(Ordering::AcqRel, Ordering::Acquire, |state| {
+                (state & (CANCEL_REQUESTED | CANCEL_TAKEN) == CANCEL_REQUESTED)
+                    .then_some(state | CANCEL_TAKEN)
+            })
+            .is_ok()
+    }
+
+    #[inline]
+    pub fn is_complete(&self) -> bool {
+        self.0.load(Ordering::Acquire) & COMPLETE != 0
+    }
+
+    /// Starts a queued run. Returns false if the task completed meanwhile; the
+    /// run then only drops its reference.
+    #[inline]
+    pub fn transition_to_running(&self) -> bool {
+        // SCHEDULED is set and RUNNING clear, so the sum moves the bit without
+        // a carry, in one `lock xadd` rather than a compare-exchange loop.
+        let prev = self.0.fetch_add(RUNNING - SCHEDULED, Ordering::AcqRel);
+        debug_assert!(prev & SCHEDULED != 0 && prev & RUNNING == 0);
+        prev & COMPLETE == 0
+    }
+
+    /// Ends a poll that returned `Pending`. Returns true if the task was woken
+    /// during the poll; it then stays running, and the run polls again or calls
+    /// [`transition_to_requeued`](Self::transition_to_requeued).
+    #[inline]
+    pub fn transition_to_idle(&self) -> bool {
+        let prev = self.0.fetch_sub(RUNNING, Ordering::AcqRel);
+        debug_assert!(prev & RUNNING != 0);
+        if prev & NOTIFIED == 0 {
+            return false;
+        }
+        // NOTIFIED kept wakes out after RUNNING was cleared; trade it back.
+        self.0.fetch_sub(NOTIFIED - RUNNING, Ordering::AcqRel);
+        true
+    }
+
+    /// Hands a notified run over to a new queued one, with its own reference.
+    /// The caller submits it.
+    #[inline]
+    pub fn transition_to_requeued(&self) {
+        let _ = self.0.fetch_update(Ordering::AcqRel, Ordering::Acquire, |state| {
+            debug_assert!(state & (RUNNING | SCHEDULED) == RUNNING);
+            Some(with_ref(state) & !RUNNING | SCHEDULED)
+        });
+    }
+
+    /// Ends the run whose poll returned `Ready` (or dropped the future).
+    #[inline]
+    pub fn transition_to_complete(&self) {
+        // RUNNING is set and COMPLETE clear, as above.
+        let prev = self.0.fetch_add(COMPLETE - RUNNING, Ordering::AcqRel);
+        debug_assert!(prev & RUNNING != 0 && prev & COMPLETE == 0);
+    }
+
+    /// Undoes a submission that could not be queued: clears SCHEDULED and drops
+    /// the run's reference. The caller holds another one.
+    #[inline]
+    pub fn cancel_submit(&self) {
+        let _prev = self.0.fetch_sub(SCHEDULED + REF_ONE, Ordering::AcqRel);
+        debug_assert!(_prev & SCHEDULED != 0 && refs(_prev) > 1);
+    }
+}
+
+impl Default for TaskState {
+    #[inline]
+    fn default() -> Self {
+        Self::new()
+    }
+}
@@ -25,6 +25,21 @@ pub trait ComImpl<I: InterfaceVtable>: Sized + Sync + 'static {
     fn query_interface(&self, this: *mut c_void, riid: &GUID) -> Option<*mut c_void>;
 }
 
+/// Maps an interface pointer carrying `VTABLE` back to the implementation.
+///
+/// Generated by `impl_com_interface!` / `impl_com_interface_multiple!` for the object
+/// layout the vtable was built for; [`ComRc::downcast_impl`](crate::ComRc::downcast_impl)
+/// uses it to call `Self` directly instead of through the vtable.
+///
+/// # Safety
+/// `inner_from_ptr` must return the implementation of the object for every live
+/// interface pointer whose vtable is `VTABLE`.
+pub unsafe trait ComImplInner<I: InterfaceVtable>: ComImpl<I> {
+    /// # Safety
+    /// `this` must be a live interface pointer whose vtable is `VTABLE`.
+    unsafe fn inner_from_ptr<'a>(this: *mut c_void) -> &'a Self;
+}
+
 /// Marker trait for any type that can be a COM object inner.
 pub trait IUnknown {}
 impl<T: ?Sized> IUnknown for T {}
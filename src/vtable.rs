@@ -32,3 +32,112 @@ pub fn match_interface_ptr<T: ComInterfaceInfo>(riid: &GUID, ptr: *mut c_void) -
         Some(ptr)
     }
 }
+
+/// Interface sets up to this size are matched by a linear word compare.
+const IID_TABLE_LINEAR_MAX: usize = 4;
+
+const IID_TABLE_SEED_ATTEMPTS: u64 = 256;
+
+/// Number of hash slots used by an [`IidTable`] with `n` entries.
+pub const fn iid_table_slots(n: usize) -> usize {
+    let slots = (n * 8).next_power_of_two();
+    if slots < 8 { 8 } else { slots }
+}
+
+/// Compile-time IID dispatch table mapping an IID to a byte offset.
+///
+/// Built in a `const` by the generated `QueryInterface` of `ComObjectN` objects.
+/// Sets larger than a few entries are resolved through a perfect hash over the
+/// GUID words, so a lookup is one multiply, one slot load and one 16-byte
+/// compare. If no perfect hash is found (e.g. duplicate IIDs) the table falls
+/// back to a linear scan that returns the first match.
+pub struct IidTable<const N: usize, const SLOTS: usize> {
+    keys: [[u64; 2]; N],
+    offsets: [usize; N],
+    slots: [u8; SLOTS],
+    multiplier: u64,
+}
+
+impl<const N: usize, const SLOTS: usize> IidTable<N, SLOTS> {
+    /// Builds the table; entry `i` resolves to `base + offsets[i]`.
+    pub const fn new(iids: &[GUID], base: usize, offsets: &[usize]) -> Self {
+        assert!(iids.len() == N && offsets.len() == N, "IidTable length mismatch");
+        assert!(N < u8::MAX as usize, "IidTable supports at most 254 entries");
+        assert!(SLOTS.is_power_of_two() && SLOTS >= 2, "IidTable slots must be a power of two");
+
+        let mut keys = [[0u64; 2]; N];
+        let mut resolved = [0usize; N];
+        let mut i = 0;
+        while i < N {
+            keys[i] = iids[i].to_words();
+            resolved[i] = base + offsets[i];
+            i += 1;
+        }
+
+        let mut table = Self {
+            keys,
+            offsets: resolved,
+            slots: [0; SLOTS],
+            multiplier: 0,
+        };
+        if N <= IID_TABLE_LINEAR_MAX {
+            return table;
+        }
+
+        let mut seed = 0;
+        while seed < IID_TABLE_SEED_ATTEMPTS {
+            let multiplier = 0x9E37_79B9_7F4A_7C15u64
+                .wrapping_add(seed.wrapping_mul(0xD6E8_FEB8_6659_FD93))
+                | 1;
+            let mut slots = [0u8; SLOTS];
+            let mut i = 0;
+            while i < N {
+                let slot = Self::slot(&table.keys[i], multiplier);
+                if slots[slot] != 0 {
+                    break;
+                }
+                slots[slot] = (i + 1) as u8;
+                i += 1;
+            }
+            if i == N {
+                table.slots = slots;
+                table.multiplier = multiplier;
+                return table;
+            }
+            seed += 1;
+        }
+        table
+    }
+
+    #[inline(always)]
+    const fn slot(key: &[u64; 2], multiplier: u64) -> usize {
+        let mixed = key[0] ^ key[1].rotate_left(29);
+        (mixed.wrapping_mul(multiplier) >> (64 - SLOTS.trailing_zeros())) as usize
+    }
+
+    /// Returns the offset registered for `riid`, if any.
+    #[inline]
+    pub fn lookup(&self, riid: &GUID) -> Option<usize> {
+        let key = riid.to_words();
+        if self.multiplier == 0 {
+            let mut i = 0;
+            while i < N {
+                if self.keys[i] == key {
+                    return Some(self.offsets[i]);
+                }
+                i += 1;
+            }
+            return None;
+        }
+        let index = self.slots[Self::slot(&key, self.multiplier)] as usize;
+        if index == 0 {
+            return None;
+        }
+        let index = index - 1;
+        if self.keys[index] == key {
+            Some(self.offsets[index])
+        } else {
+            None
+        }
+    }
+}
@@ -6,14 +6,15 @@ use core::ffi::c_void;
 use core::mem::ManuallyDrop;
 use core::sync::atomic::{AtomicU32, Ordering};
 
-use crate::allocator::{Allocator, GlobalAllocator};
+use crate::allocator::{Allocator, GlobalAllocator, KBoxError, PinInit};
 use crate::iunknown::{
     GUID, IUnknownVtbl, IID_IUNKNOWN, NTSTATUS, STATUS_INSUFFICIENT_RESOURCES, STATUS_NOINTERFACE,
     STATUS_SUCCESS,
 };
-use crate::smart_ptr::{ComInterface, ComRc};
+use crate::smart_ptr::{ComInterface, ComRc, ThreadAffineComInterface, ThreadSafeComInterface};
 use crate::traits::ComImpl;
-use crate::vtable::{ComInterfaceInfo, InterfaceVtable};
+use crate::vtable::{ComInterfaceInfo, IidTable, InterfaceVtable};
+use crate::reclaim::DeferredCounter;
 use crate::refcount;
 
 #[cold]
@@ -123,9 +124,9 @@ impl Drop for PanicGuard {
 }
 
 #[inline]
-unsafe fn delegating_add_ref(
+unsafe fn delegating_add_ref<C: RefCountPolicy>(
     outer_unknown: Option<*mut c_void>,
-    ref_count: &AtomicU32,
+    ref_count: &C::Counter,
 ) -> u32 {
     if let Some(outer) = outer_unknown {
         if !outer.is_null() {
@@ -133,16 +134,17 @@ unsafe fn delegating_add_ref(
             return unsafe { ((*vtbl).AddRef)(outer) };
         }
     }
-    refcount::add(ref_count)
+    C::add(ref_count)
 }
 
 #[inline]
-unsafe fn delegating_release<F>(
+unsafe fn delegating_release<C, F>(
     outer_unknown: Option<*mut c_void>,
-    ref_count: &AtomicU32,
+    ref_count: &C::Counter,
     release_inner: F,
 ) -> u32
 where
+    C: RefCountPolicy,
     F: FnOnce(),
 {
     if let Some(outer) = outer_unknown {
@@ -152,40 +154,280 @@ where
         }
     }
 
-    let count = refcount::sub(ref_count);
+    let count = C::sub(ref_count);
     if count == 0 {
-        core::sync::atomic::fence(Ordering::Acquire);
+        if C::ATOMIC {
+            core::sync::atomic::fence(Ordering::Acquire);
+        }
         release_inner();
     }
 
     count
 }
 
+/// Object layout that interface method shims use to reach the implementation.
+///
+/// # Safety
+/// `inner` must return the `T` stored in the object whose primary interface pointer
+/// (vtable at offset 0) is `this`.
+pub unsafe trait ComLayout<T> {
+    /// # Safety
+    /// `this` must be a live primary interface pointer of this layout.
+    unsafe fn inner<'a>(this: *mut c_void) -> &'a T;
+}
+
+/// Reference-count update strategy of a `ComObject` / `ComObjectN`.
+///
+/// The policy picks the counter stored in the object and the IUnknown shims that
+/// update it; the vtable slots and the COM ABI are identical for every policy.
+///
+/// # Safety
+/// `sub` must return zero exactly once, for the release that drops the last
+/// reference, and the policy must keep the count consistent for every thread that
+/// can reach an object using it.
+pub unsafe trait RefCountPolicy: Send + Sync + 'static {
+    /// Counter stored in the object.
+    type Counter: Send + Sync;
+
+    /// Whether the final release must synchronize with releases on other threads.
+    const ATOMIC: bool;
+
+    fn counter(initial: u32) -> Self::Counter;
+    fn add(ref_count: &Self::Counter) -> u32;
+    fn sub(ref_count: &Self::Counter) -> u32;
+    /// Current count; only exact once no other thread can update it.
+    fn load(ref_count: &Self::Counter) -> u32;
+
+    /// Disposes of an object after `sub` returned zero. The default destroys it
+    /// inline; a policy may hand it to a reclaimer instead.
+    ///
+    /// # Safety
+    /// Called once per object, after the final release. `ref_count` must point into
+    /// `object`, and `destroy(object)` must drop and free it.
+    #[inline(always)]
+    unsafe fn retire(
+        ref_count: *const Self::Counter,
+        object: *mut c_void,
+        destroy: unsafe fn(*mut c_void),
+        tag: u32,
+    ) {
+        let _ = (ref_count, tag);
+        unsafe { destroy(object) };
+    }
+}
+
+/// Interfaces an object counted with policy `Self` may be handed out as.
+///
+/// # Safety
+/// Implementations must only admit interfaces whose contract keeps every reference
+/// within the guarantees of the policy.
+pub unsafe trait RefCountFor<R: ComInterface>: RefCountPolicy {}
+
+/// Untyped `IUnknown` pointer, as returned by the raw constructors (`new`,
+/// `new_in`, ...).
+///
+/// A raw pointer can be handed to any thread, so those constructors require
+/// `C: RefCountFor<IUnknownRaw>`, which thread-affine policies do not meet; such
+/// objects are created with `new_rc` for a [`ThreadAffineComInterface`].
+#[repr(C)]
+#[allow(non_snake_case)]
+pub struct IUnknownRaw {
+    pub lpVtbl: *mut IUnknownVtbl,
+}
+
+unsafe impl ComInterface for IUnknownRaw {}
+unsafe impl ThreadSafeComInterface for IUnknownRaw {}
+
+/// Emitted by `impl_com_interface!` for every interface an object implements, so
+/// a policy that does not admit one fails to compile.
+#[doc(hidden)]
+pub const fn assert_refcount_for<C: RefCountFor<R>, R: ComInterface>() {}
+
+/// Default policy: atomic read-modify-write updates, safe from any thread.
+pub struct AtomicRefCount;
+
+unsafe impl RefCountPolicy for AtomicRefCount {
+    type Counter = AtomicU32;
+
+    const ATOMIC: bool = true;
+
+    #[inline(always)]
+    fn counter(initial: u32) -> AtomicU32 {
+        AtomicU32::new(initial)
+    }
+
+    #[inline(always)]
+    fn add(ref_count: &AtomicU32) -> u32 {
+        refcount::add(ref_count)
+    }
+
+    #[inline(always)]
+    fn sub(ref_count: &AtomicU32) -> u32 {
+        refcount::sub(ref_count)
+    }
+
+    #[inline(always)]
+    fn load(ref_count: &AtomicU32) -> u32 {
+        ref_count.load(Ordering::Acquire)
+    }
+}
+
+unsafe impl<R: ComInterface> RefCountFor<R> for AtomicRefCount {}
+
+/// Thread-affine policy: plain load/store updates with no locked instructions.
+///
+/// Objects using it can only be returned as a [`ThreadAffineComInterface`], whose
+/// `ComRc` is neither `Send` nor `Sync`.
+pub struct LocalRefCount;
+
+unsafe impl RefCountPolicy for LocalRefCount {
+    type Counter = AtomicU32;
+
+    const ATOMIC: bool = false;
+
+    #[inline(always)]
+    fn counter(initial: u32) -> AtomicU32 {
+        AtomicU32::new(initial)
+    }
+
+    #[inline(always)]
+    fn add(ref_count: &AtomicU32) -> u32 {
+        refcount::add_local(ref_count)
+    }
+
+    #[inline(always)]
+    fn sub(ref_count: &AtomicU32) -> u32 {
+        refcount::sub_local(ref_count)
+    }
+
+    #[inline(always)]
+    fn load(ref_count: &AtomicU32) -> u32 {
+        ref_count.load(Ordering::Acquire)
+    }
+}
+
+unsafe impl<R: ThreadAffineComInterface> RefCountFor<R> for LocalRefCount {}
+
+/// Scalable policy for objects referenced from every CPU at once.
+///
+/// Each of the `N` cache-line-sized shards absorbs `AddRef`/`Release` from the
+/// CPUs that map to it, so the hot path never bounces a shared line. Zero cannot
+/// be observed while sharded: the owner calls `reconcile_ref_count` (while still
+/// holding its reference) when tearing the object down, which folds the shards
+/// into one exact count so that the final `Release` frees it. An object that is
+/// never reconciled is leaked, not freed early. Refcount hardening does not apply
+/// to the sharded path.
+pub struct PerCpuRefCount<const N: usize = 16>;
+
+unsafe impl<const N: usize> RefCountPolicy for PerCpuRefCount<N> {
+    type Counter = refcount::PerCpuCounter<N>;
+
+    const ATOMIC: bool = true;
+
+    #[inline]
+    fn counter(initial: u32) -> Self::Counter {
+        refcount::PerCpuCounter::new(initial)
+    }
+
+    #[inline(always)]
+    fn add(ref_count: &Self::Counter) -> u32 {
+        ref_count.add()
+    }
+
+    #[inline(always)]
+    fn sub(ref_count: &Self::Counter) -> u32 {
+        ref_count.sub()
+    }
+
+    #[inline(always)]
+    fn load(ref_count: &Self::Counter) -> u32 {
+        ref_count.load()
+    }
+}
+
+unsafe impl<R: ComInterface, const N: usize> RefCountFor<R> for PerCpuRefCount<N> {}
+
+/// Deferred-destruction policy: counts like `C`, but the final `Release` only
+/// pushes the object onto the current CPU's garbage list.
+///
+/// `Drop` and the free run later, when the driver calls
+/// [`reclaim_deferred`](crate::reclaim::reclaim_deferred) from a low-priority work
+/// item (see [`set_reclaim_hook`](crate::reclaim::set_reclaim_hook)). Use it for
+/// objects with heavy destructors whose last reference is typically dropped at
+/// `DISPATCH_LEVEL`. The counter grows by one intrusive link.
+pub struct DeferredRefCount<C: RefCountPolicy = AtomicRefCount>(core::marker::PhantomData<C>);
+
+unsafe impl<C: RefCountPolicy> RefCountPolicy for DeferredRefCount<C> {
+    type Counter = DeferredCounter<C::Counter>;
+
+    const ATOMIC: bool = C::ATOMIC;
+
+    #[inline]
+    fn counter(initial: u32) -> Self::Counter {
+        DeferredCounter::new(C::counter(initial))
+    }
+
+    #[inline(always)]
+    fn add(ref_count: &Self::Counter) -> u32 {
+        C::add(&ref_count.count)
+    }
+
+    #[inline(always)]
+    fn sub(ref_count: &Self::Counter) -> u32 {
+        C::sub(&ref_count.count)
+    }
+
+    #[inline(always)]
+    fn load(ref_count: &Self::Counter) -> u32 {
+        C::load(&ref_count.count)
+    }
+
+    #[inline]
+    unsafe fn retire(
+        ref_count: *const Self::Counter,
+        object: *mut c_void,
+        destroy: unsafe fn(*mut c_void),
+        tag: u32,
+    ) {
+        unsafe { (*ref_count).retire(object, destroy, tag) };
+    }
+}
+
+unsafe impl<R: ComInterface, C: RefCountFor<R>> RefCountFor<R> for DeferredRefCount<C> {}
+
 #[repr(C)]
-struct NonDelegatingIUnknown<T, I, A>
+struct NonDelegatingIUnknown<T, I, A, C>
 where
     T: ComImpl<I>,
     I: InterfaceVtable,
     A: Allocator + Send + Sync,
+    C: RefCountPolicy,
 {
     vtable: &'static IUnknownVtbl,
-    parent: *mut ComObject<T, I, A>,
+    parent: *mut ComObject<T, I, A, C>,
 }
 
-impl<T, P, S> ComObjectN<T, P, S, GlobalAllocator>
+impl<T, P, S, C> ComObjectN<T, P, S, GlobalAllocator, C>
 where
     T: ComImpl<P> + SecondaryComImpl<S>,
     P: InterfaceVtable,
     S: SecondaryVtables,
     S::Entries: SecondaryList,
+    C: RefCountPolicy,
 {
     #[inline]
-    pub fn new(inner: T) -> Result<*mut c_void, NTSTATUS> {
+    pub fn new(inner: T) -> Result<*mut c_void, NTSTATUS>
+    where
+        C: RefCountFor<IUnknownRaw>,
+    {
         Self::new_in(inner, GlobalAllocator)
     }
 
     #[inline]
-    pub fn try_new(inner: T) -> Option<*mut c_void> {
+    pub fn try_new(inner: T) -> Option<*mut c_void>
+    where
+        C: RefCountFor<IUnknownRaw>,
+    {
         Self::try_new_in(inner, GlobalAllocator)
     }
 
@@ -194,6 +436,7 @@ where
     pub fn new_rc<R>(inner: T) -> Result<ComRc<R>, NTSTATUS>
     where
         R: ComInterface + ComInterfaceInfo<Vtable = P>,
+        C: RefCountFor<R>,
     {
         Self::new_rc_in(inner, GlobalAllocator)
     }
@@ -203,34 +446,35 @@ where
     pub fn try_new_rc<R>(inner: T) -> Option<ComRc<R>>
     where
         R: ComInterface + ComInterfaceInfo<Vtable = P>,
+        C: RefCountFor<R>,
     {
         Self::try_new_rc_in(inner, GlobalAllocator)
     }
 }
 
+/// Secondary interface pointer of a `ComObjectN`: the vtable only.
+///
+/// Shims find the object by subtracting the entry's compile-time offset, so no
+/// parent pointer is stored or initialized.
 #[repr(C)]
 pub struct InterfaceEntryN<I>
 where
     I: InterfaceVtable,
 {
     vtable: &'static I,
-    parent: *mut c_void,
 }
 
-pub trait SecondaryList {
-    fn init(&mut self, parent: *mut c_void);
-}
+/// Marker for the tuple of secondary entries stored in a `ComObjectN`.
+pub trait SecondaryList {}
 
 pub trait SecondaryEntryAccess<const INDEX: usize, I>
 where
     I: InterfaceVtable,
 {
-    fn entry(&mut self) -> *mut InterfaceEntryN<I>;
+    /// Byte offset of entry `INDEX` within the tuple.
+    const OFFSET: usize;
 
-    #[inline]
-    unsafe fn parent_from_ptr(ptr: *mut c_void) -> *mut c_void {
-        unsafe { (*(ptr as *mut InterfaceEntryN<I>)).parent }
-    }
+    fn entry(&mut self) -> *mut InterfaceEntryN<I>;
 }
 
 pub trait SecondaryComImpl<S>
@@ -246,6 +490,9 @@ where
 {
     type Entries: SecondaryList;
 
+    /// Byte offset of each entry within `Entries`, in declaration order.
+    const ENTRY_OFFSETS: &'static [usize];
+
     fn entries<T>() -> Self::Entries
     where
         T: SecondaryComImpl<Self>,
@@ -254,10 +501,7 @@ where
     }
 }
 
-impl SecondaryList for () {
-    #[inline]
-    fn init(&mut self, _parent: *mut c_void) {}
-}
+impl SecondaryList for () {}
 
 macro_rules! impl_secondary_entry_access {
     ($name:ident, $index:tt, $($all:ident),+) => {
@@ -265,6 +509,8 @@ macro_rules! impl_secondary_entry_access {
         where
             $($all: InterfaceVtable,)+
         {
+            const OFFSET: usize = core::mem::offset_of!(Self, $index);
+
             #[inline]
             fn entry(&mut self) -> *mut InterfaceEntryN<$name> {
                 &mut self.$index
@@ -291,16 +537,15 @@ macro_rules! impl_secondary_tuple {
                 $($name: InterfaceVtable,)+
             {
                 type Entries = ($(InterfaceEntryN<$name>,)+);
+
+                const ENTRY_OFFSETS: &'static [usize] =
+                    &[$(<Self::Entries as SecondaryEntryAccess<$index, $name>>::OFFSET),+];
             }
 
             impl<$($name),+> SecondaryList for ($(InterfaceEntryN<$name>,)+)
             where
                 $($name: InterfaceVtable,)+
             {
-                #[inline]
-                fn init(&mut self, parent: *mut c_void) {
-                    $(self.$index.parent = parent;)+
-                }
             }
 
             impl<T, $($name),+> SecondaryComImpl<($($name,)+)> for T
@@ -313,7 +558,6 @@ macro_rules! impl_secondary_tuple {
                     ($(
                         InterfaceEntryN {
                             vtable: <T as ComImpl<$name>>::VTABLE,
-                            parent: core::ptr::null_mut(),
                         },
                     )+)
                 }
@@ -334,41 +578,44 @@ impl_secondary_tuple!((7, S1: 0, S2: 1, S3: 2, S4: 3, S5: 4, S6: 5, S7: 6));
 impl_secondary_tuple!((8, S1: 0, S2: 1, S3: 2, S4: 3, S5: 4, S6: 5, S7: 6, S8: 7));
 
 #[repr(C)]
-struct NonDelegatingIUnknownN<T, P, S, A>
+struct NonDelegatingIUnknownN<T, P, S, A, C>
 where
     T: ComImpl<P> + SecondaryComImpl<S>,
     P: InterfaceVtable,
     S: SecondaryVtables,
     A: Allocator + Send + Sync,
+    C: RefCountPolicy,
 {
     vtable: &'static IUnknownVtbl,
-    parent: *mut ComObjectN<T, P, S, A>,
+    parent: *mut ComObjectN<T, P, S, A, C>,
 }
 
 #[repr(C)]
-pub struct ComObjectN<T, P, S, A = GlobalAllocator>
+pub struct ComObjectN<T, P, S, A = GlobalAllocator, C = AtomicRefCount>
 where
     T: ComImpl<P> + SecondaryComImpl<S>,
     P: InterfaceVtable,
     S: SecondaryVtables,
     A: Allocator + Send + Sync,
+    C: RefCountPolicy,
 {
     vtable: &'static P,
     secondaries: S::Entries,
-    non_delegating_unknown: NonDelegatingIUnknownN<T, P, S, A>,
-    ref_count: AtomicU32,
+    non_delegating_unknown: NonDelegatingIUnknownN<T, P, S, A, C>,
+    ref_count: C::Counter,
     outer_unknown: Option<*mut c_void>,
     pub inner: T,
     alloc: ManuallyDrop<A>,
 }
 
-impl<T, P, S, A> ComObjectN<T, P, S, A>
+impl<T, P, S, A, C> ComObjectN<T, P, S, A, C>
 where
     T: ComImpl<P> + SecondaryComImpl<S>,
     P: InterfaceVtable,
     S: SecondaryVtables,
     S::Entries: SecondaryList,
     A: Allocator + Send + Sync,
+    C: RefCountPolicy,
 {
     const LAYOUT: Layout = Layout::new::<Self>();
     const NON_DELEGATING_VTABLE: IUnknownVtbl = IUnknownVtbl {
@@ -384,13 +631,6 @@ where
         }
     }
 
-    #[inline]
-    fn init_secondary_ptr(ptr: *mut Self) {
-        unsafe {
-            (*ptr).secondaries.init(ptr as *mut c_void);
-        }
-    }
-
     #[inline]
     pub unsafe fn secondary_ptr<I, const INDEX: usize>(ptr: *mut Self) -> *mut c_void
     where
@@ -423,14 +663,39 @@ where
         I: InterfaceVtable,
         S::Entries: SecondaryEntryAccess<INDEX, I>,
     {
-        let parent = unsafe { <S::Entries as SecondaryEntryAccess<INDEX, I>>::parent_from_ptr(ptr) };
-        unsafe { &*(parent as *const Self) }
+        unsafe { &*(Self::primary_from_secondary::<I, INDEX>(ptr) as *const Self) }
+    }
+
+    #[inline(always)]
+    /// Adjusts a secondary interface pointer back to the primary (`this` at offset 0).
+    ///
+    /// # Safety
+    /// `ptr` must be the secondary entry `INDEX` of a live `ComObjectN` of this type.
+    pub unsafe fn primary_from_secondary<I, const INDEX: usize>(ptr: *mut c_void) -> *mut c_void
+    where
+        I: InterfaceVtable,
+        S::Entries: SecondaryEntryAccess<INDEX, I>,
+    {
+        let offset = core::mem::offset_of!(Self, secondaries)
+            + <S::Entries as SecondaryEntryAccess<INDEX, I>>::OFFSET;
+        unsafe { (ptr as *mut u8).sub(offset) as *mut c_void }
+    }
+
+    /// Builds the `QueryInterface` dispatch table for the secondaries.
+    ///
+    /// `iids[i]` is the IID of secondary `i`; the table resolves it to the byte
+    /// offset of that entry from the primary `this` pointer.
+    pub const fn secondary_iid_table<const N: usize, const SLOTS: usize>(
+        iids: &[GUID],
+    ) -> IidTable<N, SLOTS> {
+        IidTable::new(iids, core::mem::offset_of!(Self, secondaries), S::ENTRY_OFFSETS)
     }
 
     #[inline]
     pub fn new_rc_in<R>(inner: T, alloc: A) -> Result<ComRc<R>, NTSTATUS>
     where
         R: ComInterface + ComInterfaceInfo<Vtable = P>,
+        C: RefCountFor<R>,
     {
         Self::try_new_rc_in(inner, alloc).ok_or(STATUS_INSUFFICIENT_RESOURCES)
     }
@@ -439,18 +704,31 @@ where
     pub fn try_new_rc_in<R>(inner: T, alloc: A) -> Option<ComRc<R>>
     where
         R: ComInterface + ComInterfaceInfo<Vtable = P>,
+        C: RefCountFor<R>,
     {
-        let ptr = Self::try_new_in(inner, alloc)?;
+        let ptr = Self::alloc_in(inner, alloc)?;
         Some(unsafe { ComRc::from_raw_unchecked(ptr as *mut R) })
     }
 
+    /// Returns the raw interface pointer. It may reach any thread, so `C` must admit
+    /// free-threaded interfaces; thread-affine objects use [`new_rc_in`](Self::new_rc_in).
     #[inline]
-    pub fn new_in(inner: T, alloc: A) -> Result<*mut c_void, NTSTATUS> {
+    pub fn new_in(inner: T, alloc: A) -> Result<*mut c_void, NTSTATUS>
+    where
+        C: RefCountFor<IUnknownRaw>,
+    {
         Self::try_new_in(inner, alloc).ok_or(STATUS_INSUFFICIENT_RESOURCES)
     }
 
     #[inline]
-    pub fn try_new_in(inner: T, alloc: A) -> Option<*mut c_void> {
+    pub fn try_new_in(inner: T, alloc: A) -> Option<*mut c_void>
+    where
+        C: RefCountFor<IUnknownRaw>,
+    {
+        Self::alloc_in(inner, alloc)
+    }
+
+    fn alloc_in(inner: T, alloc: A) -> Option<*mut c_void> {
         let ptr = unsafe { alloc.alloc(Self::LAYOUT) } as *mut Self;
         if ptr.is_null() {
             return None;
@@ -463,45 +741,120 @@ where
                     vtable: &Self::NON_DELEGATING_VTABLE,
                     parent: core::ptr::null_mut(),
                 },
-                ref_count: AtomicU32::new(1),
+                ref_count: C::counter(1),
                 outer_unknown: None,
                 inner,
                 alloc: ManuallyDrop::new(alloc),
             });
             Self::init_non_delegating_ptr(ptr);
-            Self::init_secondary_ptr(ptr);
             Some(ptr as *mut c_void)
         }
     }
 
+    /// Creates a COM object whose `inner` is initialized in place by `init`.
+    ///
+    /// `T` is never built on the stack and never moves, so it may hold large
+    /// buffers or pinned state. On failure nothing is dropped and the block is freed.
+    #[inline]
+    pub fn try_pin_init_in<E>(
+        init: impl PinInit<T, E>,
+        alloc: A,
+    ) -> Result<*mut c_void, KBoxError<E>>
+    where
+        C: RefCountFor<IUnknownRaw>,
+    {
+        Self::pin_init_in(init, alloc)
+    }
+
+    fn pin_init_in<E>(
+        mut init: impl PinInit<T, E>,
+        alloc: A,
+    ) -> Result<*mut c_void, KBoxError<E>> {
+        let ptr = unsafe { alloc.alloc(Self::LAYOUT) } as *mut Self;
+        if ptr.is_null() {
+            return Err(KBoxError::Alloc(STATUS_INSUFFICIENT_RESOURCES));
+        }
+        unsafe {
+            if let Err(err) = init.init(core::ptr::addr_of_mut!((*ptr).inner)) {
+                alloc.dealloc(ptr as *mut u8, Self::LAYOUT);
+                return Err(KBoxError::Init(err));
+            }
+            core::ptr::addr_of_mut!((*ptr).vtable).write(<T as ComImpl<P>>::VTABLE);
+            core::ptr::addr_of_mut!((*ptr).secondaries).write(S::entries::<T>());
+            core::ptr::addr_of_mut!((*ptr).non_delegating_unknown).write(NonDelegatingIUnknownN {
+                vtable: &Self::NON_DELEGATING_VTABLE,
+                parent: ptr,
+            });
+            core::ptr::addr_of_mut!((*ptr).ref_count).write(C::counter(1));
+            core::ptr::addr_of_mut!((*ptr).outer_unknown).write(None);
+            core::ptr::addr_of_mut!((*ptr).alloc).write(ManuallyDrop::new(alloc));
+        }
+        Ok(ptr as *mut c_void)
+    }
+
+    /// [`try_pin_init_in`](Self::try_pin_init_in) returning a smart pointer that owns
+    /// the initial reference.
+    #[inline]
+    pub fn try_pin_init_rc_in<R, E>(
+        init: impl PinInit<T, E>,
+        alloc: A,
+    ) -> Result<ComRc<R>, KBoxError<E>>
+    where
+        R: ComInterface + ComInterfaceInfo<Vtable = P>,
+        C: RefCountFor<R>,
+    {
+        let ptr = Self::pin_init_in(init, alloc)?;
+        Ok(unsafe { ComRc::from_raw_unchecked(ptr as *mut R) })
+    }
+
     #[allow(non_snake_case)]
     /// # Safety
     /// `this` must be a valid COM pointer created by `ComObjectN` for `T`.
     pub unsafe extern "system" fn shim_add_ref(this: *mut c_void) -> u32 {
         let guard = PanicGuard::new();
         let wrapper = unsafe { Self::from_ptr(this) };
-        let result = delegating_add_ref(wrapper.outer_unknown, &wrapper.ref_count);
+        let result = delegating_add_ref::<C>(wrapper.outer_unknown, &wrapper.ref_count);
         core::mem::forget(guard);
         result
     }
 
+    /// Hands an object whose count reached zero to the refcount policy.
+    #[inline]
+    unsafe fn retire(ptr: *mut Self) {
+        unsafe {
+            C::retire(
+                core::ptr::addr_of!((*ptr).ref_count),
+                ptr as *mut c_void,
+                Self::destroy,
+                (*ptr).alloc.pool_tag(),
+            )
+        };
+    }
+
+    /// Drops the implementation and frees the object.
+    unsafe fn destroy(object: *mut c_void) {
+        let ptr = object as *mut Self;
+        let alloc = unsafe { core::ptr::read(core::ptr::addr_of!((*ptr).alloc)) };
+        let alloc = ManuallyDrop::into_inner(alloc);
+        unsafe {
+            core::ptr::drop_in_place(core::ptr::addr_of_mut!((*ptr).inner));
+            let resurrected = C::load(&(*ptr).ref_count);
+            if resurrected != 0 {
+                resurrection_violation();
+            }
+            alloc.dealloc(ptr as *mut u8, Self::LAYOUT);
+        }
+        drop(alloc);
+    }
+
     #[allow(non_snake_case)]
     /// # Safety
     /// `this` must be a valid COM pointer created by `ComObjectN` for `T`.
     pub unsafe extern "system" fn shim_release(this: *mut c_void) -> u32 {
         let guard = PanicGuard::new();
         let wrapper = unsafe { &*(this as *const Self) };
-        let result = delegating_release(wrapper.outer_unknown, &wrapper.ref_count, || {
-            let ptr = this as *mut Self;
-            let alloc = core::ptr::read(&(*ptr).alloc);
-            let alloc = ManuallyDrop::into_inner(alloc);
-            core::ptr::drop_in_place(&mut (*ptr).inner);
-            let resurrected = (*ptr).ref_count.load(Ordering::Acquire);
-            if resurrected != 0 {
-                resurrection_violation();
-            }
-            alloc.dealloc(ptr as *mut u8, Self::LAYOUT);
-            drop(alloc);
+        let result = delegating_release::<C, _>(wrapper.outer_unknown, &wrapper.ref_count, || {
+            Self::retire(this as *mut Self);
         });
         core::mem::forget(guard);
         result
@@ -566,7 +919,7 @@ where
     {
         let guard = PanicGuard::new();
         let wrapper = unsafe { Self::from_secondary_ptr::<I, INDEX>(this) };
-        let result = delegating_add_ref(wrapper.outer_unknown, &wrapper.ref_count);
+        let result = delegating_add_ref::<C>(wrapper.outer_unknown, &wrapper.ref_count);
         core::mem::forget(guard);
         result
     }
@@ -583,7 +936,7 @@ where
     {
         let guard = PanicGuard::new();
         let primary =
-            unsafe { <S::Entries as SecondaryEntryAccess<INDEX, I>>::parent_from_ptr(this) };
+            unsafe { Self::primary_from_secondary::<I, INDEX>(this) };
         let result = unsafe { Self::shim_release(primary) };
         core::mem::forget(guard);
         result
@@ -603,7 +956,7 @@ where
     {
         let guard = PanicGuard::new();
         let primary =
-            unsafe { <S::Entries as SecondaryEntryAccess<INDEX, I>>::parent_from_ptr(this) };
+            unsafe { Self::primary_from_secondary::<I, INDEX>(this) };
         let wrapper = unsafe { Self::from_ptr(primary) };
         if let Some(outer) = wrapper.outer_unknown {
             if !outer.is_null() {
@@ -647,7 +1000,7 @@ where
     pub unsafe extern "system" fn shim_non_delegating_add_ref(this: *mut c_void) -> u32 {
         let guard = PanicGuard::new();
         let wrapper = unsafe { Self::from_non_delegating(this) };
-        let result = refcount::add(&wrapper.ref_count);
+        let result = C::add(&wrapper.ref_count);
         core::mem::forget(guard);
         result
     }
@@ -658,21 +1011,13 @@ where
     pub unsafe extern "system" fn shim_non_delegating_release(this: *mut c_void) -> u32 {
         let guard = PanicGuard::new();
         let ptr = unsafe { Self::non_delegating_parent_ptr(this) };
-        let count = refcount::sub(unsafe { &(*ptr).ref_count });
+        let count = C::sub(unsafe { &(*ptr).ref_count });
 
         if count == 0 {
-            core::sync::atomic::fence(Ordering::Acquire);
-            let alloc = unsafe { core::ptr::read(core::ptr::addr_of!((*ptr).alloc)) };
-            let alloc = ManuallyDrop::into_inner(alloc);
-            unsafe {
-                core::ptr::drop_in_place(core::ptr::addr_of_mut!((*ptr).inner));
-                let resurrected = (*ptr).ref_count.load(Ordering::Acquire);
-                if resurrected != 0 {
-                    resurrection_violation();
-                }
-                alloc.dealloc(ptr as *mut u8, Self::LAYOUT);
+            if C::ATOMIC {
+                core::sync::atomic::fence(Ordering::Acquire);
             }
-            drop(alloc);
+            unsafe { Self::retire(ptr) };
         }
 
         core::mem::forget(guard);
@@ -721,7 +1066,7 @@ where
     /// # Safety
     /// `ptr` must be a valid pointer to a non-delegating IUnknown created by this crate.
     unsafe fn from_non_delegating<'a>(ptr: *mut c_void) -> &'a Self {
-        let unknown = unsafe { &*(ptr as *const NonDelegatingIUnknownN<T, P, S, A>) };
+        let unknown = unsafe { &*(ptr as *const NonDelegatingIUnknownN<T, P, S, A, C>) };
         unsafe { &*unknown.parent }
     }
 
@@ -729,31 +1074,64 @@ where
     /// # Safety
     /// `ptr` must be a valid pointer to a non-delegating IUnknown created by this crate.
     unsafe fn non_delegating_parent_ptr(ptr: *mut c_void) -> *mut Self {
-        let unknown = ptr as *mut NonDelegatingIUnknownN<T, P, S, A>;
+        let unknown = ptr as *mut NonDelegatingIUnknownN<T, P, S, A, C>;
         unsafe { (*unknown).parent }
     }
 }
 
+impl<T, P, S, A, const N: usize> ComObjectN<T, P, S, A, PerCpuRefCount<N>>
+where
+    T: ComImpl<P> + SecondaryComImpl<S>,
+    P: InterfaceVtable,
+    S: SecondaryVtables,
+    S::Entries: SecondaryList,
+    A: Allocator + Send + Sync,
+{
+    /// Folds the per-CPU counts into one exact count so the final `Release` frees
+    /// the object. Call while holding a reference; idempotent.
+    #[inline]
+    pub fn reconcile_ref_count(&self) {
+        self.ref_count.reconcile();
+    }
+}
+
+unsafe impl<T, P, S, A, C> ComLayout<T> for ComObjectN<T, P, S, A, C>
+where
+    T: ComImpl<P> + SecondaryComImpl<S>,
+    P: InterfaceVtable,
+    S: SecondaryVtables,
+    S::Entries: SecondaryList,
+    A: Allocator + Send + Sync,
+    C: RefCountPolicy,
+{
+    #[inline(always)]
+    unsafe fn inner<'a>(this: *mut c_void) -> &'a T {
+        unsafe { &*core::ptr::addr_of!((*(this as *const Self)).inner) }
+    }
+}
+
 #[repr(C)]
-pub struct ComObject<T, I, A = GlobalAllocator>
+pub struct ComObject<T, I, A = GlobalAllocator, C = AtomicRefCount>
 where
     T: ComImpl<I>,
     I: InterfaceVtable,
     A: Allocator + Send + Sync,
+    C: RefCountPolicy,
 {
     vtable: &'static I,
-    non_delegating_unknown: NonDelegatingIUnknown<T, I, A>,
-    ref_count: AtomicU32,
+    non_delegating_unknown: NonDelegatingIUnknown<T, I, A, C>,
+    ref_count: C::Counter,
     outer_unknown: Option<*mut c_void>,
     pub inner: T,
     alloc: ManuallyDrop<A>,
 }
 
-impl<T, I, A> ComObject<T, I, A>
+impl<T, I, A, C> ComObject<T, I, A, C>
 where
     T: ComImpl<I>,
     I: InterfaceVtable,
     A: Allocator + Send + Sync,
+    C: RefCountPolicy,
 {
     const LAYOUT: Layout = Layout::new::<Self>();
     const NON_DELEGATING_VTABLE: IUnknownVtbl = IUnknownVtbl {
@@ -774,6 +1152,7 @@ where
     pub fn new_rc_in<R>(inner: T, alloc: A) -> Result<ComRc<R>, NTSTATUS>
     where
         R: ComInterface + ComInterfaceInfo<Vtable = I>,
+        C: RefCountFor<R>,
     {
         Self::try_new_rc_in(inner, alloc).ok_or(STATUS_INSUFFICIENT_RESOURCES)
     }
@@ -783,8 +1162,9 @@ where
     pub fn try_new_rc_in<R>(inner: T, alloc: A) -> Option<ComRc<R>>
     where
         R: ComInterface + ComInterfaceInfo<Vtable = I>,
+        C: RefCountFor<R>,
     {
-        let ptr = Self::try_new_in(inner, alloc)?;
+        let ptr = Self::alloc_in(inner, alloc)?;
         // SAFETY: `ptr` is a freshly created COM pointer with refcount 1.
         Some(unsafe { ComRc::from_raw_unchecked(ptr as *mut R) })
     }
@@ -794,13 +1174,25 @@ where
         unsafe { &mut (*ptr).non_delegating_unknown as *mut _ as *mut c_void }
     }
 
+    /// Returns the raw interface pointer. It may reach any thread, so `C` must admit
+    /// free-threaded interfaces; thread-affine objects use [`new_rc_in`](Self::new_rc_in).
     #[inline]
-    pub fn new_in(inner: T, alloc: A) -> Result<*mut c_void, NTSTATUS> {
+    pub fn new_in(inner: T, alloc: A) -> Result<*mut c_void, NTSTATUS>
+    where
+        C: RefCountFor<IUnknownRaw>,
+    {
         Self::try_new_in(inner, alloc).ok_or(STATUS_INSUFFICIENT_RESOURCES)
     }
 
     #[inline]
-    pub fn try_new_in(inner: T, alloc: A) -> Option<*mut c_void> {
+    pub fn try_new_in(inner: T, alloc: A) -> Option<*mut c_void>
+    where
+        C: RefCountFor<IUnknownRaw>,
+    {
+        Self::alloc_in(inner, alloc)
+    }
+
+    fn alloc_in(inner: T, alloc: A) -> Option<*mut c_void> {
         let ptr = unsafe { alloc.alloc(Self::LAYOUT) } as *mut Self;
         if ptr.is_null() {
             return None;
@@ -812,7 +1204,7 @@ where
                     vtable: &Self::NON_DELEGATING_VTABLE,
                     parent: core::ptr::null_mut(),
                 },
-                ref_count: AtomicU32::new(1),
+                ref_count: C::counter(1),
                 outer_unknown: None,
                 inner,
                 alloc: ManuallyDrop::new(alloc),
@@ -822,8 +1214,66 @@ where
         }
     }
 
+    /// Creates a COM object whose `inner` is initialized in place by `init`.
+    ///
+    /// `T` is never built on the stack and never moves, so it may hold large
+    /// buffers or pinned state. On failure nothing is dropped and the block is freed.
+    #[inline]
+    pub fn try_pin_init_in<E>(
+        init: impl PinInit<T, E>,
+        alloc: A,
+    ) -> Result<*mut c_void, KBoxError<E>>
+    where
+        C: RefCountFor<IUnknownRaw>,
+    {
+        Self::pin_init_in(init, alloc)
+    }
+
+    fn pin_init_in<E>(
+        mut init: impl PinInit<T, E>,
+        alloc: A,
+    ) -> Result<*mut c_void, KBoxError<E>> {
+        let ptr = unsafe { alloc.alloc(Self::LAYOUT) } as *mut Self;
+        if ptr.is_null() {
+            return Err(KBoxError::Alloc(STATUS_INSUFFICIENT_RESOURCES));
+        }
+        unsafe {
+            if let Err(err) = init.init(core::ptr::addr_of_mut!((*ptr).inner)) {
+                alloc.dealloc(ptr as *mut u8, Self::LAYOUT);
+                return Err(KBoxError::Init(err));
+            }
+            core::ptr::addr_of_mut!((*ptr).vtable).write(T::VTABLE);
+            core::ptr::addr_of_mut!((*ptr).non_delegating_unknown).write(NonDelegatingIUnknown {
+                vtable: &Self::NON_DELEGATING_VTABLE,
+                parent: ptr,
+            });
+            core::ptr::addr_of_mut!((*ptr).ref_count).write(C::counter(1));
+            core::ptr::addr_of_mut!((*ptr).outer_unknown).write(None);
+            core::ptr::addr_of_mut!((*ptr).alloc).write(ManuallyDrop::new(alloc));
+        }
+        Ok(ptr as *mut c_void)
+    }
+
+    /// [`try_pin_init_in`](Self::try_pin_init_in) returning a smart pointer that owns
+    /// the initial reference.
+    #[inline]
+    pub fn try_pin_init_rc_in<R, E>(
+        init: impl PinInit<T, E>,
+        alloc: A,
+    ) -> Result<ComRc<R>, KBoxError<E>>
+    where
+        R: ComInterface + ComInterfaceInfo<Vtable = I>,
+        C: RefCountFor<R>,
+    {
+        let ptr = Self::pin_init_in(init, alloc)?;
+        Ok(unsafe { ComRc::from_raw_unchecked(ptr as *mut R) })
+    }
+
     #[inline]
-    pub fn try_new_in_with_layout(inner: T, alloc: A, layout: Layout) -> Option<*mut c_void> {
+    pub fn try_new_in_with_layout(inner: T, alloc: A, layout: Layout) -> Option<*mut c_void>
+    where
+        C: RefCountFor<IUnknownRaw>,
+    {
         if layout != Self::LAYOUT {
             return None;
         }
@@ -865,7 +1315,7 @@ where
                     vtable: &Self::NON_DELEGATING_VTABLE,
                     parent: core::ptr::null_mut(),
                 },
-                ref_count: AtomicU32::new(1),
+                ref_count: C::counter(1),
                 outer_unknown: Some(outer_unknown),
                 inner,
                 alloc: ManuallyDrop::new(alloc),
@@ -904,7 +1354,7 @@ where
     /// `ptr` must be a valid pointer to a non-delegating IUnknown created by this crate.
     /// The returned reference must not outlive the underlying COM object allocation.
     pub unsafe fn from_non_delegating<'a>(ptr: *mut c_void) -> &'a Self {
-        let unknown = unsafe { &*(ptr as *const NonDelegatingIUnknown<T, I, A>) };
+        let unknown = unsafe { &*(ptr as *const NonDelegatingIUnknown<T, I, A, C>) };
         unsafe { &*unknown.parent }
     }
 
@@ -912,7 +1362,7 @@ where
     /// # Safety
     /// `ptr` must be a valid pointer to a non-delegating IUnknown created by this crate.
     unsafe fn non_delegating_parent_ptr(ptr: *mut c_void) -> *mut Self {
-        let unknown = ptr as *mut NonDelegatingIUnknown<T, I, A>;
+        let unknown = ptr as *mut NonDelegatingIUnknown<T, I, A, C>;
         unsafe { (*unknown).parent }
     }
 
@@ -922,28 +1372,48 @@ where
     pub unsafe extern "system" fn shim_add_ref(this: *mut c_void) -> u32 {
         let guard = PanicGuard::new();
         let wrapper = unsafe { Self::from_ptr(this) };
-        let result = delegating_add_ref(wrapper.outer_unknown, &wrapper.ref_count);
+        let result = delegating_add_ref::<C>(wrapper.outer_unknown, &wrapper.ref_count);
         core::mem::forget(guard);
         result
     }
 
-    #[allow(non_snake_case)]
-    /// # Safety
-    /// `this` must be a valid COM pointer created by `ComObject` for `T`.
-    pub unsafe extern "system" fn shim_release(this: *mut c_void) -> u32 {
-        let guard = PanicGuard::new();
-        let wrapper = unsafe { &*(this as *const Self) };
-        let result = delegating_release(wrapper.outer_unknown, &wrapper.ref_count, || {
-            let ptr = this as *mut Self;
-            let alloc = core::ptr::read(&(*ptr).alloc);
-            let alloc = ManuallyDrop::into_inner(alloc);
-            core::ptr::drop_in_place(&mut (*ptr).inner);
-            let resurrected = (*ptr).ref_count.load(Ordering::Acquire);
+    /// Hands an object whose count reached zero to the refcount policy.
+    #[inline]
+    unsafe fn retire(ptr: *mut Self) {
+        unsafe {
+            C::retire(
+                core::ptr::addr_of!((*ptr).ref_count),
+                ptr as *mut c_void,
+                Self::destroy,
+                (*ptr).alloc.pool_tag(),
+            )
+        };
+    }
+
+    /// Drops the implementation and frees the object.
+    unsafe fn destroy(object: *mut c_void) {
+        let ptr = object as *mut Self;
+        let alloc = unsafe { core::ptr::read(core::ptr::addr_of!((*ptr).alloc)) };
+        let alloc = ManuallyDrop::into_inner(alloc);
+        unsafe {
+            core::ptr::drop_in_place(core::ptr::addr_of_mut!((*ptr).inner));
+            let resurrected = C::load(&(*ptr).ref_count);
             if resurrected != 0 {
                 resurrection_violation();
             }
             alloc.dealloc(ptr as *mut u8, Self::LAYOUT);
-            drop(alloc);
+        }
+        drop(alloc);
+    }
+
+    #[allow(non_snake_case)]
+    /// # Safety
+    /// `this` must be a valid COM pointer created by `ComObject` for `T`.
+    pub unsafe extern "system" fn shim_release(this: *mut c_void) -> u32 {
+        let guard = PanicGuard::new();
+        let wrapper = unsafe { &*(this as *const Self) };
+        let result = delegating_release::<C, _>(wrapper.outer_unknown, &wrapper.ref_count, || {
+            Self::retire(this as *mut Self);
         });
         core::mem::forget(guard);
         result
@@ -1002,7 +1472,7 @@ where
     pub unsafe extern "system" fn shim_non_delegating_add_ref(this: *mut c_void) -> u32 {
         let guard = PanicGuard::new();
         let wrapper = unsafe { Self::from_non_delegating(this) };
-        let result = refcount::add(&wrapper.ref_count);
+        let result = C::add(&wrapper.ref_count);
         core::mem::forget(guard);
         result
     }
@@ -1013,21 +1483,13 @@ where
     pub unsafe extern "system" fn shim_non_delegating_release(this: *mut c_void) -> u32 {
         let guard = PanicGuard::new();
         let ptr = unsafe { Self::non_delegating_parent_ptr(this) };
-        let count = refcount::sub(unsafe { &(*ptr).ref_count });
+        let count = C::sub(unsafe { &(*ptr).ref_count });
 
         if count == 0 {
-            core::sync::atomic::fence(Ordering::Acquire);
-            let alloc = unsafe { core::ptr::read(core::ptr::addr_of!((*ptr).alloc)) };
-            let alloc = ManuallyDrop::into_inner(alloc);
-            unsafe {
-                core::ptr::drop_in_place(core::ptr::addr_of_mut!((*ptr).inner));
-                let resurrected = (*ptr).ref_count.load(Ordering::Acquire);
-                if resurrected != 0 {
-                    resurrection_violation();
-                }
-                alloc.dealloc(ptr as *mut u8, Self::LAYOUT);
+            if C::ATOMIC {
+                core::sync::atomic::fence(Ordering::Acquire);
             }
-            drop(alloc);
+            unsafe { Self::retire(ptr) };
         }
 
         core::mem::forget(guard);
@@ -1076,18 +1538,25 @@ where
     }
 }
 
-impl<T, I> ComObject<T, I, GlobalAllocator>
+impl<T, I, C> ComObject<T, I, GlobalAllocator, C>
 where
     T: ComImpl<I>,
     I: InterfaceVtable,
+    C: RefCountPolicy,
 {
     #[inline]
-    pub fn new(inner: T) -> Result<*mut c_void, NTSTATUS> {
+    pub fn new(inner: T) -> Result<*mut c_void, NTSTATUS>
+    where
+        C: RefCountFor<IUnknownRaw>,
+    {
         Self::new_in(inner, GlobalAllocator)
     }
 
     #[inline]
-    pub fn try_new(inner: T) -> Option<*mut c_void> {
+    pub fn try_new(inner: T) -> Option<*mut c_void>
+    where
+        C: RefCountFor<IUnknownRaw>,
+    {
         Self::try_new_in(inner, GlobalAllocator)
     }
 
@@ -1096,6 +1565,7 @@ where
     pub fn new_rc<R>(inner: T) -> Result<ComRc<R>, NTSTATUS>
     where
         R: ComInterface + ComInterfaceInfo<Vtable = I>,
+        C: RefCountFor<R>,
     {
         Self::new_rc_in(inner, GlobalAllocator)
     }
@@ -1105,6 +1575,7 @@ where
     pub fn try_new_rc<R>(inner: T) -> Option<ComRc<R>>
     where
         R: ComInterface + ComInterfaceInfo<Vtable = I>,
+        C: RefCountFor<R>,
     {
         Self::try_new_rc_in(inner, GlobalAllocator)
     }
@@ -1130,6 +1601,715 @@ where
     }
 }
 
+impl<T, I, A, const N: usize> ComObject<T, I, A, PerCpuRefCount<N>>
+where
+    T: ComImpl<I>,
+    I: InterfaceVtable,
+    A: Allocator + Send + Sync,
+{
+    /// Folds the per-CPU counts into one exact count so the final `Release` frees
+    /// the object. Call while holding a reference; idempotent.
+    #[inline]
+    pub fn reconcile_ref_count(&self) {
+        self.ref_count.reconcile();
+    }
+}
+
+unsafe impl<T, I, A, C> ComLayout<T> for ComObject<T, I, A, C>
+where
+    T: ComImpl<I>,
+    I: InterfaceVtable,
+    A: Allocator + Send + Sync,
+    C: RefCountPolicy,
+{
+    #[inline(always)]
+    unsafe fn inner<'a>(this: *mut c_void) -> &'a T {
+        unsafe { &*core::ptr::addr_of!((*(this as *const Self)).inner) }
+    }
+}
+
+/// Non-aggregatable COM object: vtable, refcount, `inner` and allocator only.
+///
+/// Drops the non-delegating IUnknown and outer-unknown fields of `ComObject`
+/// (32 bytes on 64-bit targets) and the aggregation branches from every IUnknown
+/// shim. Implement the interface with `lean` in `impl_com_interface!` so its
+/// IUnknown slots use these shims.
+#[repr(C)]
+pub struct LeanComObject<T, I, A = GlobalAllocator>
+where
+    T: ComImpl<I>,
+    I: InterfaceVtable,
+    A: Allocator + Send + Sync,
+{
+    vtable: &'static I,
+    ref_count: AtomicU32,
+    pub inner: T,
+    alloc: ManuallyDrop<A>,
+}
+
+unsafe impl<T, I, A> ComLayout<T> for LeanComObject<T, I, A>
+where
+    T: ComImpl<I>,
+    I: InterfaceVtable,
+    A: Allocator + Send + Sync,
+{
+    #[inline(always)]
+    unsafe fn inner<'a>(this: *mut c_void) -> &'a T {
+        unsafe { &*core::ptr::addr_of!((*(this as *const Self)).inner) }
+    }
+}
+
+impl<T, I, A> LeanComObject<T, I, A>
+where
+    T: ComImpl<I>,
+    I: InterfaceVtable,
+    A: Allocator + Send + Sync,
+{
+    const LAYOUT: Layout = Layout::new::<Self>();
+
+    #[inline]
+    pub fn new_in(inner: T, alloc: A) -> Result<*mut c_void, NTSTATUS> {
+        Self::try_new_in(inner, alloc).ok_or(STATUS_INSUFFICIENT_RESOURCES)
+    }
+
+    #[inline]
+    pub fn try_new_in(inner: T, alloc: A) -> Option<*mut c_void> {
+        let ptr = unsafe { alloc.alloc(Self::LAYOUT) } as *mut Self;
+        if ptr.is_null() {
+            return None;
+        }
+        unsafe {
+            ptr.write(Self {
+                vtable: T::VTABLE,
+                ref_count: AtomicU32::new(1),
+                inner,
+                alloc: ManuallyDrop::new(alloc),
+            });
+        }
+        Some(ptr as *mut c_void)
+    }
+
+    /// Creates a COM object and returns a smart pointer that owns the initial reference.
+    #[inline]
+    pub fn new_rc_in<R>(inner: T, alloc: A) -> Result<ComRc<R>, NTSTATUS>
+    where
+        R: ComInterface + ComInterfaceInfo<Vtable = I>,
+    {
+        Self::try_new_rc_in(inner, alloc).ok_or(STATUS_INSUFFICIENT_RESOURCES)
+    }
+
+    /// Creates a COM object and returns a smart pointer that owns the initial reference.
+    #[inline]
+    pub fn try_new_rc_in<R>(inner: T, alloc: A) -> Option<ComRc<R>>
+    where
+        R: ComInterface + ComInterfaceInfo<Vtable = I>,
+    {
+        let ptr = Self::try_new_in(inner, alloc)?;
+        // SAFETY: `ptr` is a freshly created COM pointer with refcount 1.
+        Some(unsafe { ComRc::from_raw_unchecked(ptr as *mut R) })
+    }
+
+    #[inline(always)]
+    /// # Safety
+    /// `ptr` must be a valid pointer to a `LeanComObject<T, I, A>` allocated by this crate.
+    /// The returned reference must not outlive the underlying COM object allocation.
+    pub unsafe fn from_ptr<'a>(ptr: *mut c_void) -> &'a Self {
+        unsafe { &*(ptr as *const Self) }
+    }
+
+    #[allow(non_snake_case)]
+    /// # Safety
+    /// `this` must be a valid COM pointer created by `LeanComObject` for `T`.
+    pub unsafe extern "system" fn shim_add_ref(this: *mut c_void) -> u32 {
+        let guard = PanicGuard::new();
+        let wrapper = unsafe { Self::from_ptr(this) };
+        let result = refcount::add(&wrapper.ref_count);
+        core::mem::forget(guard);
+        result
+    }
+
+    #[allow(non_snake_case)]
+    /// # Safety
+    /// `this` must be a valid COM pointer created by `LeanComObject` for `T`.
+    pub unsafe extern "system" fn shim_release(this: *mut c_void) -> u32 {
+        let guard = PanicGuard::new();
+        let ptr = this as *mut Self;
+        let count = refcount::sub(unsafe { &(*ptr).ref_count });
+
+        if count == 0 {
+            core::sync::atomic::fence(Ordering::Acquire);
+            let alloc = unsafe { core::ptr::read(core::ptr::addr_of!((*ptr).alloc)) };
+            let alloc = ManuallyDrop::into_inner(alloc);
+            unsafe {
+                core::ptr::drop_in_place(core::ptr::addr_of_mut!((*ptr).inner));
+                let resurrected = (*ptr).ref_count.load(Ordering::Acquire);
+                if resurrected != 0 {
+                    resurrection_violation();
+                }
+                alloc.dealloc(ptr as *mut u8, Self::LAYOUT);
+            }
+            drop(alloc);
+        }
+
+        core::mem::forget(guard);
+        count
+    }
+
+    #[allow(non_snake_case)]
+    /// # Safety
+    /// `this` must be a valid COM pointer created by `LeanComObject` for `T`.
+    /// `riid` and `ppv` must be valid, non-null pointers.
+    pub unsafe extern "system" fn shim_query_interface(
+        this: *mut c_void,
+        riid: *const GUID,
+        ppv: *mut *mut c_void,
+    ) -> NTSTATUS {
+        let guard = PanicGuard::new();
+        if ppv.is_null() || riid.is_null() {
+            core::mem::forget(guard);
+            return STATUS_NOINTERFACE;
+        }
+
+        let riid = unsafe { &*riid };
+
+        if *riid == IID_IUNKNOWN {
+            unsafe { Self::shim_add_ref(this) };
+            unsafe { *ppv = this };
+            core::mem::forget(guard);
+            return STATUS_SUCCESS;
+        }
+
+        let wrapper = unsafe { Self::from_ptr(this) };
+        if let Some(ptr) = wrapper.inner.query_interface(this, riid) {
+            let vtbl = unsafe { *(ptr as *mut *mut IUnknownVtbl) };
+            unsafe { ((*vtbl).AddRef)(ptr) };
+            unsafe { *ppv = ptr };
+            core::mem::forget(guard);
+            return STATUS_SUCCESS;
+        }
+
+        unsafe { *ppv = core::ptr::null_mut() };
+        core::mem::forget(guard);
+        STATUS_NOINTERFACE
+    }
+}
+
+impl<T, I> LeanComObject<T, I, GlobalAllocator>
+where
+    T: ComImpl<I>,
+    I: InterfaceVtable,
+{
+    /// Returns the raw interface pointer, like [`ComObject::new`].
+    #[allow(clippy::new_ret_no_self)]
+    #[inline]
+    pub fn new(inner: T) -> Result<*mut c_void, NTSTATUS> {
+        Self::new_in(inner, GlobalAllocator)
+    }
+
+    #[inline]
+    pub fn try_new(inner: T) -> Option<*mut c_void> {
+        Self::try_new_in(inner, GlobalAllocator)
+    }
+
+    /// Creates a COM object and returns a smart pointer that owns the initial reference.
+    #[inline]
+    pub fn new_rc<R>(inner: T) -> Result<ComRc<R>, NTSTATUS>
+    where
+        R: ComInterface + ComInterfaceInfo<Vtable = I>,
+    {
+        Self::new_rc_in(inner, GlobalAllocator)
+    }
+}
+
+/// Outer implementation of an [`AggregateComObject`].
+///
+/// Generated by `impl_com_interface!` with `aggregate = (Inner, IInner)`.
+///
+/// # Safety
+/// `INNER_VTABLE` must be built with the IUnknown shims and [`AggregateInner`]
+/// layout of the `AggregateComObject` the object is created as.
+pub unsafe trait AggregateComImpl<P, In, Q>: ComImpl<P>
+where
+    P: InterfaceVtable,
+    Q: InterfaceVtable,
+{
+    /// Vtable of the inner interface entry.
+    const INNER_VTABLE: &'static Q;
+}
+
+/// Outer object and one aggregated inner implementation in a single allocation.
+///
+/// Compile-time alternative to `ComObject::new_aggregated_in`: the outer interface
+/// `P` (offset 0) and the inner interface `Q` share one block and one refcount, and
+/// the inner entry's IUnknown shims adjust `this` by a constant and call the outer
+/// shims directly instead of going through an outer IUnknown pointer. `inner` keeps
+/// its own trait implementation (and may also be used as a standalone `ComObject`).
+///
+/// Implement the outer interface with `aggregate = (Inner, IInner)` in
+/// `impl_com_interface!`; `QueryInterface` for `IInner` then returns the inner entry.
+#[repr(C)]
+pub struct AggregateComObject<O, P, In, Q, A = GlobalAllocator, C = AtomicRefCount>
+where
+    O: AggregateComImpl<P, In, Q>,
+    P: InterfaceVtable,
+    Q: InterfaceVtable,
+    A: Allocator + Send + Sync,
+    C: RefCountPolicy,
+{
+    vtable: &'static P,
+    inner_vtable: &'static Q,
+    ref_count: C::Counter,
+    pub outer: O,
+    pub inner: In,
+    alloc: ManuallyDrop<A>,
+}
+
+unsafe impl<O, P, In, Q, A, C> ComLayout<O> for AggregateComObject<O, P, In, Q, A, C>
+where
+    O: AggregateComImpl<P, In, Q>,
+    P: InterfaceVtable,
+    Q: InterfaceVtable,
+    A: Allocator + Send + Sync,
+    C: RefCountPolicy,
+{
+    #[inline(always)]
+    unsafe fn inner<'a>(this: *mut c_void) -> &'a O {
+        unsafe { &*core::ptr::addr_of!((*(this as *const Self)).outer) }
+    }
+}
+
+/// Layout of the inner interface entry of an [`AggregateComObject`].
+///
+/// `this` is the inner entry pointer; the implementation is the `inner` field.
+pub struct AggregateInner<O, P, In, Q, A = GlobalAllocator, C = AtomicRefCount>(
+    AggregateMarker<O, P, In, Q, A, C>,
+);
+
+type AggregateMarker<O, P, In, Q, A, C> = core::marker::PhantomData<fn() -> (O, P, In, Q, A, C)>;
+
+unsafe impl<O, P, In, Q, A, C> ComLayout<In> for AggregateInner<O, P, In, Q, A, C>
+where
+    O: AggregateComImpl<P, In, Q>,
+    P: InterfaceVtable,
+    Q: InterfaceVtable,
+    A: Allocator + Send + Sync,
+    C: RefCountPolicy,
+{
+    #[inline(always)]
+    unsafe fn inner<'a>(this: *mut c_void) -> &'a In {
+        let object = AggregateComObject::<O, P, In, Q, A, C>::primary_from_inner(this);
+        unsafe {
+            &*core::ptr::addr_of!((*(object as *const AggregateComObject<O, P, In, Q, A, C>)).inner)
+        }
+    }
+}
+
+impl<O, P, In, Q, A, C> AggregateComObject<O, P, In, Q, A, C>
+where
+    O: AggregateComImpl<P, In, Q>,
+    P: InterfaceVtable,
+    Q: InterfaceVtable,
+    A: Allocator + Send + Sync,
+    C: RefCountPolicy,
+{
+    const LAYOUT: Layout = Layout::new::<Self>();
+    const INNER_OFFSET: usize = core::mem::offset_of!(Self, inner_vtable);
+
+    /// Returns the raw interface pointer. It may reach any thread, so `C` must admit
+    /// free-threaded interfaces; thread-affine objects use [`new_rc_in`](Self::new_rc_in).
+    #[inline]
+    pub fn new_in(outer: O, inner: In, alloc: A) -> Result<*mut c_void, NTSTATUS>
+    where
+        C: RefCountFor<IUnknownRaw>,
+    {
+        Self::try_new_in(outer, inner, alloc).ok_or(STATUS_INSUFFICIENT_RESOURCES)
+    }
+
+    #[inline]
+    pub fn try_new_in(outer: O, inner: In, alloc: A) -> Option<*mut c_void>
+    where
+        C: RefCountFor<IUnknownRaw>,
+    {
+        Self::alloc_in(outer, inner, alloc)
+    }
+
+    fn alloc_in(outer: O, inner: In, alloc: A) -> Option<*mut c_void> {
+        let ptr = unsafe { alloc.alloc(Self::LAYOUT) } as *mut Self;
+        if ptr.is_null() {
+            return None;
+        }
+        unsafe {
+            ptr.write(Self {
+                vtable: O::VTABLE,
+                inner_vtable: O::INNER_VTABLE,
+                ref_count: C::counter(1),
+                outer,
+                inner,
+                alloc: ManuallyDrop::new(alloc),
+            });
+        }
+        Some(ptr as *mut c_void)
+    }
+
+    /// Creates the aggregate and returns a smart pointer that owns the initial reference.
+    #[inline]
+    pub fn new_rc_in<R>(outer: O, inner: In, alloc: A) -> Result<ComRc<R>, NTSTATUS>
+    where
+        R: ComInterface + ComInterfaceInfo<Vtable = P>,
+        C: RefCountFor<R>,
+    {
+        Self::try_new_rc_in(outer, inner, alloc).ok_or(STATUS_INSUFFICIENT_RESOURCES)
+    }
+
+    /// Creates the aggregate and returns a smart pointer that owns the initial reference.
+    #[inline]
+    pub fn try_new_rc_in<R>(outer: O, inner: In, alloc: A) -> Option<ComRc<R>>
+    where
+        R: ComInterface + ComInterfaceInfo<Vtable = P>,
+        C: RefCountFor<R>,
+    {
+        let ptr = Self::alloc_in(outer, inner, alloc)?;
+        // SAFETY: `ptr` is a freshly created COM pointer with refcount 1.
+        Some(unsafe { ComRc::from_raw_unchecked(ptr as *mut R) })
+    }
+
+    #[inline(always)]
+    /// # Safety
+    /// `ptr` must be the primary pointer of an `AggregateComObject` of this type.
+    /// The returned reference must not outlive the underlying COM object allocation.
+    pub unsafe fn from_ptr<'a>(ptr: *mut c_void) -> &'a Self {
+        unsafe { &*(ptr as *const Self) }
+    }
+
+    /// Returns the inner interface entry of the aggregate whose primary pointer is `ptr`.
+    #[inline(always)]
+    pub fn inner_ptr(ptr: *mut c_void) -> *mut c_void {
+        (ptr as *mut u8).wrapping_add(Self::INNER_OFFSET) as *mut c_void
+    }
+
+    /// Adjusts the inner interface entry back to the primary pointer.
+    #[inline(always)]
+    pub fn primary_from_inner(ptr: *mut c_void) -> *mut c_void {
+        (ptr as *mut u8).wrapping_sub(Self::INNER_OFFSET) as *mut c_void
+    }
+
+    #[allow(non_snake_case)]
+    /// # Safety
+    /// `this` must be a valid primary pointer created by `AggregateComObject`.
+    pub unsafe extern "system" fn shim_add_ref(this: *mut c_void) -> u32 {
+        let guard = PanicGuard::new();
+        let wrapper = unsafe { Self::from_ptr(this) };
+        let result = C::add(&wrapper.ref_count);
+        core::mem::forget(guard);
+        result
+    }
+
+    /// Hands an object whose count reached zero to the refcount policy.
+    #[inline]
+    unsafe fn retire(ptr: *mut Self) {
+        unsafe {
+            C::retire(
+                core::ptr::addr_of!((*ptr).ref_count),
+                ptr as *mut c_void,
+                Self::destroy,
+                (*ptr).alloc.pool_tag(),
+            )
+        };
+    }
+
+    /// Drops the implementation and frees the object.
+    unsafe fn destroy(object: *mut c_void) {
+        let ptr = object as *mut Self;
+        let alloc = unsafe { core::ptr::read(core::ptr::addr_of!((*ptr).alloc)) };
+        let alloc = ManuallyDrop::into_inner(alloc);
+        unsafe {
+            core::ptr::drop_in_place(core::ptr::addr_of_mut!((*ptr).outer));
+            core::ptr::drop_in_place(core::ptr::addr_of_mut!((*ptr).inner));
+            let resurrected = C::load(&(*ptr).ref_count);
+            if resurrected != 0 {
+                resurrection_violation();
+            }
+            alloc.dealloc(ptr as *mut u8, Self::LAYOUT);
+        }
+        drop(alloc);
+    }
+
+    #[allow(non_snake_case)]
+    /// # Safety
+    /// `this` must be a valid primary pointer created by `AggregateComObject`.
+    pub unsafe extern "system" fn shim_release(this: *mut c_void) -> u32 {
+        let guard = PanicGuard::new();
+        let ptr = this as *mut Self;
+        let count = C::sub(unsafe { &(*ptr).ref_count });
+
+        if count == 0 {
+            if C::ATOMIC {
+                core::sync::atomic::fence(Ordering::Acquire);
+            }
+            unsafe { Self::retire(ptr) };
+        }
+
+        core::mem::forget(guard);
+        count
+    }
+
+    #[allow(non_snake_case)]
+    /// # Safety
+    /// `this` must be a valid primary pointer created by `AggregateComObject`.
+    /// `riid` and `ppv` must be valid, non-null pointers.
+    pub unsafe extern "system" fn shim_query_interface(
+        this: *mut c_void,
+        riid: *const GUID,
+        ppv: *mut *mut c_void,
+    ) -> NTSTATUS {
+        let guard = PanicGuard::new();
+        if ppv.is_null() || riid.is_null() {
+            core::mem::forget(guard);
+            return STATUS_NOINTERFACE;
+        }
+
+        let riid = unsafe { &*riid };
+
+        if *riid == IID_IUNKNOWN {
+            unsafe { Self::shim_add_ref(this) };
+            unsafe { *ppv = this };
+            core::mem::forget(guard);
+            return STATUS_SUCCESS;
+        }
+
+        let wrapper = unsafe { Self::from_ptr(this) };
+        if let Some(ptr) = wrapper.outer.query_interface(this, riid) {
+            let vtbl = unsafe { *(ptr as *mut *mut IUnknownVtbl) };
+            unsafe { ((*vtbl).AddRef)(ptr) };
+            unsafe { *ppv = ptr };
+            core::mem::forget(guard);
+            return STATUS_SUCCESS;
+        }
+
+        unsafe { *ppv = core::ptr::null_mut() };
+        core::mem::forget(guard);
+        STATUS_NOINTERFACE
+    }
+
+    #[allow(non_snake_case)]
+    /// # Safety
+    /// `this` must be the inner entry of a valid `AggregateComObject`.
+    pub unsafe extern "system" fn shim_inner_add_ref(this: *mut c_void) -> u32 {
+        unsafe { Self::shim_add_ref(Self::primary_from_inner(this)) }
+    }
+
+    #[allow(non_snake_case)]
+    /// # Safety
+    /// `this` must be the inner entry of a valid `AggregateComObject`.
+    pub unsafe extern "system" fn shim_inner_release(this: *mut c_void) -> u32 {
+        unsafe { Self::shim_release(Self::primary_from_inner(this)) }
+    }
+
+    #[allow(non_snake_case)]
+    /// # Safety
+    /// `this` must be the inner entry of a valid `AggregateComObject`.
+    /// `riid` and `ppv` must be valid, non-null pointers.
+    pub unsafe extern "system" fn shim_inner_query_interface(
+        this: *mut c_void,
+        riid: *const GUID,
+        ppv: *mut *mut c_void,
+    ) -> NTSTATUS {
+        unsafe { Self::shim_query_interface(Self::primary_from_inner(this), riid, ppv) }
+    }
+}
+
+impl<O, P, In, Q, C> AggregateComObject<O, P, In, Q, GlobalAllocator, C>
+where
+    O: AggregateComImpl<P, In, Q>,
+    P: InterfaceVtable,
+    Q: InterfaceVtable,
+    C: RefCountPolicy,
+{
+    /// Returns the raw interface pointer, like [`ComObject::new`].
+    #[allow(clippy::new_ret_no_self)]
+    #[inline]
+    pub fn new(outer: O, inner: In) -> Result<*mut c_void, NTSTATUS>
+    where
+        C: RefCountFor<IUnknownRaw>,
+    {
+        Self::new_in(outer, inner, GlobalAllocator)
+    }
+
+    #[inline]
+    pub fn try_new(outer: O, inner: In) -> Option<*mut c_void>
+    where
+        C: RefCountFor<IUnknownRaw>,
+    {
+        Self::try_new_in(outer, inner, GlobalAllocator)
+    }
+
+    /// Creates the aggregate and returns a smart pointer that owns the initial reference.
+    #[inline]
+    pub fn new_rc<R>(outer: O, inner: In) -> Result<ComRc<R>, NTSTATUS>
+    where
+        R: ComInterface + ComInterfaceInfo<Vtable = P>,
+        C: RefCountFor<R>,
+    {
+        Self::new_rc_in(outer, inner, GlobalAllocator)
+    }
+}
+
+/// Allocator marker for `ComObject`s that live in a `static` and are never freed.
+#[doc(hidden)]
+pub struct Immortal;
+
+impl Allocator for Immortal {
+    #[inline]
+    unsafe fn alloc(&self, _layout: Layout) -> *mut u8 {
+        core::ptr::null_mut()
+    }
+
+    #[inline]
+    unsafe fn dealloc(&self, _ptr: *mut u8, _layout: Layout) {}
+}
+
+/// A `ComObject` that is const-initialized in a `static` and lives for the whole
+/// program (driver) lifetime.
+///
+/// `AddRef`/`Release` never touch the refcount, so handing out and dropping
+/// references to a busy singleton does not bounce its cache line between CPUs.
+/// `QueryInterface` behaves as for `ComObject`. The interface must be implemented
+/// with `immortal` in `impl_com_interface!` so its IUnknown slots use these shims.
+///
+/// The object cannot be aggregated and `inner` is never dropped.
+#[repr(transparent)]
+pub struct StaticComObject<T, I>
+where
+    T: ComImpl<I>,
+    I: InterfaceVtable,
+{
+    object: ComObject<T, I, Immortal>,
+}
+
+// SAFETY: the raw pointers in the wrapped `ComObject` are never set for static objects
+// (no aggregation), and `ComImpl` already requires `T: Sync`.
+unsafe impl<T, I> Sync for StaticComObject<T, I>
+where
+    T: ComImpl<I>,
+    I: InterfaceVtable,
+{
+}
+
+unsafe impl<T, I> ComLayout<T> for StaticComObject<T, I>
+where
+    T: ComImpl<I>,
+    I: InterfaceVtable,
+{
+    #[inline(always)]
+    unsafe fn inner<'a>(this: *mut c_void) -> &'a T {
+        unsafe { &(*(this as *const Self)).object.inner }
+    }
+}
+
+impl<T, I> StaticComObject<T, I>
+where
+    T: ComImpl<I>,
+    I: InterfaceVtable,
+{
+    /// Value returned by the no-op `AddRef`/`Release`.
+    pub const REF_COUNT: u32 = 1;
+
+    const NON_DELEGATING_VTABLE: &'static IUnknownVtbl = &IUnknownVtbl {
+        QueryInterface: Self::shim_query_interface,
+        AddRef: Self::shim_add_ref,
+        Release: Self::shim_release,
+    };
+
+    pub const fn new(inner: T) -> Self {
+        Self {
+            object: ComObject {
+                vtable: T::VTABLE,
+                non_delegating_unknown: NonDelegatingIUnknown {
+                    vtable: Self::NON_DELEGATING_VTABLE,
+                    parent: core::ptr::null_mut(),
+                },
+                ref_count: AtomicU32::new(Self::REF_COUNT),
+                outer_unknown: None,
+                inner,
+                alloc: ManuallyDrop::new(Immortal),
+            },
+        }
+    }
+
+    #[inline]
+    pub fn inner(&self) -> &T {
+        &self.object.inner
+    }
+
+    /// Returns the primary interface pointer. No reference is taken.
+    #[inline]
+    pub fn as_ptr(&'static self) -> *mut c_void {
+        &self.object as *const ComObject<T, I, Immortal> as *mut c_void
+    }
+
+    /// Returns a smart pointer to the object; cloning and dropping it is free of
+    /// atomic traffic.
+    #[inline]
+    pub fn to_rc<R>(&'static self) -> ComRc<R>
+    where
+        R: ComInterface + ComInterfaceInfo<Vtable = I>,
+    {
+        // SAFETY: the object is valid for `'static` and ignores refcounting.
+        unsafe { ComRc::from_raw_unchecked(self.as_ptr() as *mut R) }
+    }
+
+    #[allow(non_snake_case)]
+    /// # Safety
+    /// `this` must point to a `StaticComObject<T, I>`.
+    pub unsafe extern "system" fn shim_add_ref(_this: *mut c_void) -> u32 {
+        Self::REF_COUNT
+    }
+
+    #[allow(non_snake_case)]
+    /// # Safety
+    /// `this` must point to a `StaticComObject<T, I>`.
+    pub unsafe extern "system" fn shim_release(_this: *mut c_void) -> u32 {
+        Self::REF_COUNT
+    }
+
+    #[allow(non_snake_case)]
+    /// # Safety
+    /// `this` must point to a `StaticComObject<T, I>`.
+    /// `riid` and `ppv` must be valid, non-null pointers.
+    pub unsafe extern "system" fn shim_query_interface(
+        this: *mut c_void,
+        riid: *const GUID,
+        ppv: *mut *mut c_void,
+    ) -> NTSTATUS {
+        let guard = PanicGuard::new();
+        if ppv.is_null() || riid.is_null() {
+            core::mem::forget(guard);
+            return STATUS_NOINTERFACE;
+        }
+
+        let riid = unsafe { &*riid };
+
+        if *riid == IID_IUNKNOWN {
+            unsafe { *ppv = this };
+            core::mem::forget(guard);
+            return STATUS_SUCCESS;
+        }
+
+        let wrapper = unsafe { &*(this as *const ComObject<T, I, Immortal>) };
+        if let Some(ptr) = wrapper.inner.query_interface(this, riid) {
+            let vtbl = unsafe { *(ptr as *mut *mut IUnknownVtbl) };
+            unsafe { ((*vtbl).AddRef)(ptr) };
+            unsafe { *ppv = ptr };
+            core::mem::forget(guard);
+            return STATUS_SUCCESS;
+        }
+
+        unsafe { *ppv = core::ptr::null_mut() };
+        core::mem::forget(guard);
+        STATUS_NOINTERFACE
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
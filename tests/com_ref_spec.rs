@@ -0,0 +1,118 @@
+// tests/com_ref_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Borrowed interface pointer (ComRef) specification tests.
+
+use core::ffi::c_void;
+
+use kcom::*;
+
+declare_com_interface! {
+    pub trait ISource: IUnknown {
+        const IID: GUID = GUID {
+            data1: 0x434f_4d52,
+            data2: 0x0001,
+            data3: 0x0000,
+            data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01],
+        };
+        fn value(&self) -> u32;
+    }
+}
+
+declare_com_interface! {
+    pub trait ISink: IUnknown {
+        const IID: GUID = GUID {
+            data1: 0x434f_4d52,
+            data2: 0x0002,
+            data3: 0x0000,
+            data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02],
+        };
+        fn accept(&self, source: ComRef<'_, ISourceRaw>) -> u32;
+        fn accept_optional(&self, source: Option<ComRef<'_, ISourceRaw>>) -> u32;
+    }
+}
+
+struct Source;
+
+impl ISource for Source {
+    fn value(&self) -> u32 {
+        7
+    }
+}
+
+impl_com_interface! {
+    impl Source: ISource {
+        parent = IUnknownVtbl,
+        methods = [value],
+    }
+}
+
+struct Sink;
+
+impl ISink for Sink {
+    fn accept(&self, source: ComRef<'_, ISourceRaw>) -> u32 {
+        unsafe { ((*source.lpVtbl).value)(source.as_ptr() as *mut c_void) }
+    }
+
+    fn accept_optional(&self, source: Option<ComRef<'_, ISourceRaw>>) -> u32 {
+        source.map_or(0, |source| self.accept(source))
+    }
+}
+
+impl_com_interface! {
+    impl Sink: ISink {
+        parent = IUnknownVtbl,
+        methods = [accept, accept_optional],
+    }
+}
+
+fn ref_count(rc: &ComRc<ISourceRaw>) -> u32 {
+    let this = rc.as_ptr() as *mut c_void;
+    let vtbl = unsafe { *(this as *mut *mut IUnknownVtbl) };
+    unsafe { ((*vtbl).AddRef)(this) };
+    unsafe { ((*vtbl).Release)(this) }
+}
+
+#[test]
+fn com_ref_is_a_plain_pointer() {
+    assert_eq!(
+        core::mem::size_of::<ComRef<'_, ISourceRaw>>(),
+        core::mem::size_of::<*mut c_void>()
+    );
+    assert_eq!(
+        core::mem::size_of::<Option<ComRef<'_, ISourceRaw>>>(),
+        core::mem::size_of::<*mut c_void>()
+    );
+}
+
+#[test]
+fn borrowing_never_touches_the_count() {
+    let source = ComObject::<Source, ISourceVtbl>::new_rc::<ISourceRaw>(Source).unwrap();
+    let sink = ComObject::<Sink, ISinkVtbl>::new_rc::<ISinkRaw>(Sink).unwrap();
+    assert_eq!(ref_count(&source), 1);
+
+    let borrowed = source.as_com_ref();
+    let copy = borrowed;
+    let this = sink.as_ptr() as *mut c_void;
+    assert_eq!(unsafe { ((*sink.lpVtbl).accept)(this, copy) }, 7);
+    assert_eq!(unsafe { ((*sink.lpVtbl).accept)(this, ComRef::from(&source)) }, 7);
+    assert_eq!(unsafe { ((*sink.lpVtbl).accept_optional)(this, Some(borrowed)) }, 7);
+    assert_eq!(unsafe { ((*sink.lpVtbl).accept_optional)(this, None) }, 0);
+    assert_eq!(ref_count(&source), 1);
+    assert_eq!(borrowed.as_ptr(), source.as_ptr());
+}
+
+#[test]
+fn upgrade_takes_a_reference() {
+    let source = ComObject::<Source, ISourceVtbl>::new_rc::<ISourceRaw>(Source).unwrap();
+    let owned = source.as_com_ref().upgrade();
+    assert_eq!(ref_count(&source), 2);
+    drop(owned);
+    assert_eq!(ref_count(&source), 1);
+
+    let queried = source.as_com_ref().query_interface::<ISourceRaw>().unwrap();
+    assert_eq!(ref_count(&source), 2);
+    drop(queried);
+}
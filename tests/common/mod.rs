@@ -0,0 +1,94 @@
+// tests/common/mod.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// Fixtures shared by the specification tests. Each test binary gets its own
+// copy of the statics below.
+
+#![allow(dead_code)]
+
+use core::ffi::c_void;
+use std::sync::atomic::{AtomicBool, AtomicU32, AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex};
+use std::task::{Wake, Waker};
+
+use kcom::*;
+
+declare_com_interface! {
+    pub trait ITestNode: IUnknown {
+        const IID: GUID = GUID {
+            data1: 0x4e4f_4445,
+            data2: 0x0001,
+            data3: 0x0000,
+            data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01],
+        };
+        fn id(&self) -> u32;
+    }
+}
+
+unsafe impl ThreadSafeComInterface for ITestNodeRaw {}
+
+/// Serializes the tests of one binary that share the counters below.
+pub static TEST_LOCK: Mutex<()> = Mutex::new(());
+pub static CREATED: AtomicU32 = AtomicU32::new(0);
+pub static DROPPED: AtomicU32 = AtomicU32::new(0);
+
+/// Object that panics if it is released twice or called after release.
+pub struct TestNode {
+    id: u32,
+    alive: AtomicBool,
+}
+
+impl Drop for TestNode {
+    fn drop(&mut self) {
+        assert!(self.alive.swap(false, Ordering::Relaxed), "node dropped twice");
+        DROPPED.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+impl ITestNode for TestNode {
+    fn id(&self) -> u32 {
+        assert!(self.alive.load(Ordering::Relaxed), "call on a dropped node");
+        self.id
+    }
+}
+
+impl_com_interface! {
+    impl TestNode: ITestNode {
+        parent = IUnknownVtbl,
+        methods = [id],
+    }
+}
+
+pub fn node(id: u32) -> ComRc<ITestNodeRaw> {
+    CREATED.fetch_add(1, Ordering::Relaxed);
+    ComObject::<TestNode, ITestNodeVtbl>::new_rc(TestNode {
+        id,
+        alive: AtomicBool::new(true),
+    })
+    .unwrap()
+}
+
+pub fn id_of(ptr: *mut ITestNodeRaw) -> u32 {
+    unsafe { ((*(*ptr).lpVtbl).id)(ptr as *mut c_void) }
+}
+
+pub fn reset_counts() {
+    CREATED.store(0, Ordering::Relaxed);
+    DROPPED.store(0, Ordering::Relaxed);
+}
+
+/// Waker that counts its wake-ups.
+pub struct CountWaker(pub AtomicUsize);
+
+impl Wake for CountWaker {
+    fn wake(self: Arc<Self>) {
+        self.0.fetch_add(1, Ordering::SeqCst);
+    }
+}
+
+pub fn count_waker() -> (Arc<CountWaker>, Waker) {
+    let count = Arc::new(CountWaker(AtomicUsize::new(0)));
+    (count.clone(), Waker::from(count))
+}
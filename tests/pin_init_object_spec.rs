@@ -0,0 +1,178 @@
+// tests/pin_init_object_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// In-place (PinInit) construction of ComObject / ComObjectN specification tests.
+
+use core::ffi::c_void;
+use core::marker::PhantomPinned;
+use core::sync::atomic::{AtomicU32, Ordering};
+
+use kcom::*;
+
+declare_com_interface! {
+    pub trait IBuffer: IUnknown {
+        const IID: GUID = GUID {
+            data1: 0x5049_4e49,
+            data2: 0x0001,
+            data3: 0x0000,
+            data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01],
+        };
+        fn checksum(&self) -> u32;
+        fn is_anchored(&self) -> bool;
+    }
+}
+
+declare_com_interface! {
+    pub trait IBufferLen: IUnknown {
+        const IID: GUID = GUID {
+            data1: 0x5049_4e49,
+            data2: 0x0002,
+            data3: 0x0000,
+            data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02],
+        };
+        fn len(&self) -> u32;
+    }
+}
+
+const BUFFER_LEN: usize = 64 * 1024;
+
+static DROP_COUNT: AtomicU32 = AtomicU32::new(0);
+
+struct Buffer {
+    data: [u8; BUFFER_LEN],
+    // Points at `data`; only valid because the object never moves.
+    anchor: *const u8,
+    _pin: PhantomPinned,
+}
+
+unsafe impl Sync for Buffer {}
+
+impl Drop for Buffer {
+    fn drop(&mut self) {
+        DROP_COUNT.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+impl IBuffer for Buffer {
+    fn checksum(&self) -> u32 {
+        self.data.iter().map(|byte| *byte as u32).sum()
+    }
+
+    fn is_anchored(&self) -> bool {
+        core::ptr::eq(self.anchor, self.data.as_ptr())
+    }
+}
+
+impl IBufferLen for Buffer {
+    fn len(&self) -> u32 {
+        self.data.len() as u32
+    }
+}
+
+impl_com_interface! {
+    impl Buffer: IBuffer {
+        parent = IUnknownVtbl,
+        methods = [checksum, is_anchored],
+    }
+}
+
+struct BufferN(Buffer);
+
+impl IBuffer for BufferN {
+    fn checksum(&self) -> u32 {
+        self.0.checksum()
+    }
+
+    fn is_anchored(&self) -> bool {
+        self.0.is_anchored()
+    }
+}
+
+impl IBufferLen for BufferN {
+    fn len(&self) -> u32 {
+        self.0.len()
+    }
+}
+
+impl_com_interface! {
+    impl BufferN: IBuffer {
+        parent = IUnknownVtbl,
+        secondaries = (IBufferLen),
+        methods = [checksum, is_anchored],
+    }
+}
+
+impl_com_interface_multiple! {
+    impl BufferN: IBufferLen {
+        parent = IUnknownVtbl,
+        primary = IBuffer,
+        index = 0,
+        secondaries = (IBufferLen),
+        methods = [len],
+    }
+}
+
+/// Fills `buffer` in place: nothing of `BUFFER_LEN` size touches the stack.
+unsafe fn init_buffer(buffer: *mut Buffer) {
+    unsafe {
+        let data = core::ptr::addr_of_mut!((*buffer).data);
+        core::ptr::write_bytes(data as *mut u8, 1, BUFFER_LEN);
+        core::ptr::addr_of_mut!((*buffer).anchor).write(data as *const u8);
+    }
+}
+
+#[test]
+fn pin_init_builds_inner_in_place() {
+    DROP_COUNT.store(0, Ordering::Relaxed);
+
+    let Ok(rc) = ComObject::<Buffer, IBufferVtbl>::try_pin_init_rc_in::<IBufferRaw, NTSTATUS>(
+        PinInitOnce::new(|ptr: *mut Buffer| {
+            unsafe { init_buffer(ptr) };
+            Ok(())
+        }),
+        GlobalAllocator,
+    ) else {
+        panic!("in-place construction failed");
+    };
+
+    let this = rc.as_ptr() as *mut c_void;
+    assert!(unsafe { ((*rc.lpVtbl).is_anchored)(this) });
+    assert_eq!(unsafe { ((*rc.lpVtbl).checksum)(this) }, BUFFER_LEN as u32);
+    let again = rc.query_interface::<IBufferRaw>().unwrap();
+    drop(again);
+    drop(rc);
+    assert_eq!(DROP_COUNT.load(Ordering::Relaxed), 1);
+}
+
+#[test]
+fn pin_init_failure_frees_without_drop() {
+    DROP_COUNT.store(0, Ordering::Relaxed);
+
+    let result = ComObject::<Buffer, IBufferVtbl>::try_pin_init_in::<NTSTATUS>(
+        PinInitOnce::new(|_ptr: *mut Buffer| Err(STATUS_INVALID_PARAMETER)),
+        GlobalAllocator,
+    );
+    assert!(matches!(result, Err(KBoxError::Init(STATUS_INVALID_PARAMETER))));
+    assert_eq!(DROP_COUNT.load(Ordering::Relaxed), 0);
+}
+
+#[test]
+fn pin_init_multi_object_exposes_secondaries() {
+    type BufferObjectN = ComObjectN<BufferN, IBufferVtbl, (IBufferLenVtbl,)>;
+
+    let Ok(rc) = BufferObjectN::try_pin_init_rc_in::<IBufferRaw, NTSTATUS>(
+        PinInitOnce::new(|ptr: *mut BufferN| {
+            unsafe { init_buffer(core::ptr::addr_of_mut!((*ptr).0)) };
+            Ok(())
+        }),
+        GlobalAllocator,
+    ) else {
+        panic!("in-place construction failed");
+    };
+
+    assert!(unsafe { ((*rc.lpVtbl).is_anchored)(rc.as_ptr() as *mut c_void) });
+    let len = rc.query_interface::<IBufferLenRaw>().unwrap();
+    assert_eq!(unsafe { ((*len.lpVtbl).len)(len.as_ptr() as *mut c_void) }, BUFFER_LEN as u32);
+}
@@ -0,0 +1,141 @@
+// tests/pool_allocator_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// ObjectPool / PoolAllocator specification tests.
+
+use core::alloc::Layout;
+use core::sync::atomic::{AtomicU32, Ordering};
+use std::sync::Mutex;
+
+use kcom::*;
+
+declare_com_interface! {
+    pub trait IPooled: IUnknown {
+        const IID: GUID = GUID {
+            data1: 0x5050_4f4c,
+            data2: 0x0001,
+            data3: 0x0000,
+            data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01],
+        };
+        fn value(&self) -> u32;
+    }
+}
+
+static DROP_COUNT: AtomicU32 = AtomicU32::new(0);
+static TEST_LOCK: Mutex<()> = Mutex::new(());
+
+struct Pooled {
+    value: u32,
+}
+
+impl Drop for Pooled {
+    fn drop(&mut self) {
+        DROP_COUNT.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+impl IPooled for Pooled {
+    fn value(&self) -> u32 {
+        self.value
+    }
+}
+
+type PooledAlloc = PoolAllocator<4>;
+type PooledObject = ComObject<Pooled, IPooledVtbl, PooledAlloc>;
+
+impl_com_interface! {
+    impl Pooled: IPooled {
+        parent = IUnknownVtbl,
+        allocator = PooledAlloc,
+        methods = [value],
+    }
+}
+
+static POOL: ObjectPool<4> =
+    ObjectPool::new(Layout::new::<PooledObject>()).with_water_marks(1, 2);
+
+#[test]
+fn released_object_block_is_reused_by_next_new() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    POOL.drain();
+    DROP_COUNT.store(0, Ordering::Relaxed);
+
+    let first = PooledObject::new_rc_in::<IPooledRaw>(
+        Pooled { value: 7 },
+        PoolAllocator::new(&POOL),
+    )
+    .unwrap();
+    assert_eq!(unsafe { ((*first.lpVtbl).value)(first.as_ptr().cast()) }, 7);
+    let first_addr = first.as_ptr() as usize;
+    drop(first);
+
+    assert_eq!(DROP_COUNT.load(Ordering::Relaxed), 1);
+    assert_eq!(POOL.cached(), 1);
+
+    let second = PooledObject::new_rc_in::<IPooledRaw>(
+        Pooled { value: 9 },
+        PoolAllocator::new(&POOL),
+    )
+    .unwrap();
+    assert_eq!(second.as_ptr() as usize, first_addr);
+    assert_eq!(POOL.cached(), 0);
+    drop(second);
+
+    assert_eq!(DROP_COUNT.load(Ordering::Relaxed), 2);
+    POOL.drain();
+}
+
+#[test]
+fn high_water_mark_bounds_cached_blocks() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    POOL.drain();
+
+    let objects: Vec<_> = (0..4)
+        .map(|value| {
+            PooledObject::new_rc_in::<IPooledRaw>(Pooled { value }, PoolAllocator::new(&POOL))
+                .unwrap()
+        })
+        .collect();
+    drop(objects);
+
+    assert_eq!(POOL.cached(), POOL.high_water());
+    POOL.drain();
+}
+
+#[test]
+fn trim_and_prefill_follow_low_water_mark() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    POOL.drain();
+
+    assert_eq!(POOL.prefill(), 1);
+    assert_eq!(POOL.cached(), POOL.low_water());
+
+    let layout = POOL.layout();
+    let a = unsafe { POOL.alloc(layout) };
+    let b = unsafe { POOL.alloc(layout) };
+    assert!(!a.is_null() && !b.is_null());
+    unsafe {
+        POOL.dealloc(a, layout);
+        POOL.dealloc(b, layout);
+    }
+    assert_eq!(POOL.cached(), 2);
+
+    assert_eq!(POOL.trim(), 1);
+    assert_eq!(POOL.cached(), 1);
+    assert_eq!(POOL.drain(), 1);
+    assert_eq!(POOL.cached(), 0);
+}
+
+#[test]
+fn oversized_requests_bypass_the_cache() {
+    let _guard = TEST_LOCK.lock().unwrap();
+    POOL.drain();
+
+    let layout = Layout::from_size_align(POOL.layout().size() * 2, 8).unwrap();
+    let ptr = unsafe { POOL.alloc(layout) };
+    assert!(!ptr.is_null());
+    unsafe { POOL.dealloc(ptr, layout) };
+    assert_eq!(POOL.cached(), 0);
+}
@@ -54,7 +54,12 @@ struct MyDriver {
 
 impl ISmartFoo for MyDriver {
     fn foo(&self) -> NTSTATUS {
-        STATUS_SUCCESS
+        // プライマリのメソッドも ComObjectN のレイアウトで inner を解決できること
+        if self.magic == 0xDEAD_BEEF {
+            STATUS_SUCCESS
+        } else {
+            kcom::iunknown::STATUS_UNSUCCESSFUL
+        }
     }
 }
 
@@ -163,6 +168,30 @@ fn secondary_interface_adjusts_this_pointer_correctly() {
     }
 }
 
+#[test]
+fn secondary_entry_is_a_single_vtable_pointer() {
+    // this 調整はコンパイル時オフセットで行うため、親ポインタは保持しない
+    assert_eq!(
+        mem::size_of::<kcom::wrapper::InterfaceEntryN<ISmartBarVtbl>>(),
+        mem::size_of::<usize>()
+    );
+
+    let raw_ptr =
+        ComObjectN::<MyDriver, ISmartFooVtbl, (ISmartBarVtbl,)>::new(MyDriver { magic: 7 }).unwrap();
+    let bar_ptr = unsafe {
+        ComObjectN::<MyDriver, ISmartFooVtbl, (ISmartBarVtbl,)>::secondary_ptr::<ISmartBarVtbl, 0>(
+            raw_ptr as *mut _,
+        )
+    };
+    let bar_vtbl = unsafe { (*(bar_ptr as *mut ISmartBarRaw)).lpVtbl };
+    unsafe {
+        assert_eq!(((*bar_vtbl).parent.AddRef)(bar_ptr), 2);
+        assert_eq!(((*bar_vtbl).bar)(bar_ptr, 1), 8);
+        assert_eq!(((*bar_vtbl).parent.Release)(bar_ptr), 1);
+        assert_eq!(((*bar_vtbl).parent.Release)(bar_ptr), 0);
+    }
+}
+
 /// 📏 TEST 3: ABI Layout Consistency Check
 /// 生成された VTable 構造体が、C言語のメモリレイアウトと一致しているか検証する。
 #[test]
@@ -0,0 +1,88 @@
+// tests/static_object_spec.rs
+//
+// Copyright (c) 2026 Exveria
+// SPDX-License-Identifier: MIT OR Apache-2.0
+//
+// StaticComObject (immortal singleton) specification tests.
+
+use core::ffi::c_void;
+use core::sync::atomic::{AtomicU32, Ordering};
+
+use kcom::vtable::ComInterfaceInfo;
+use kcom::*;
+
+declare_com_interface! {
+    pub trait IService: IUnknown {
+        const IID: GUID = GUID {
+            data1: 0x5354_4154,
+            data2: 0x0001,
+            data3: 0x0000,
+            data4: [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01],
+        };
+        fn call(&self) -> u32;
+    }
+}
+
+struct Service {
+    calls: AtomicU32,
+}
+
+impl IService for Service {
+    fn call(&self) -> u32 {
+        self.calls.fetch_add(1, Ordering::Relaxed) + 1
+    }
+}
+
+impl_com_interface! {
+    impl Service: IService {
+        parent = IUnknownVtbl,
+        immortal,
+        methods = [call],
+    }
+}
+
+static SERVICE: StaticComObject<Service, IServiceVtbl> = StaticComObject::new(Service {
+    calls: AtomicU32::new(0),
+});
+
+#[test]
+fn static_object_dispatches_and_ignores_refcounting() {
+    let rc = SERVICE.to_rc::<IServiceRaw>();
+    let clones: Vec<_> = (0..16).map(|_| rc.clone()).collect();
+    drop(clones);
+
+    let this = SERVICE.as_ptr();
+    let vtbl = unsafe { *(this as *mut *mut IUnknownVtbl) };
+    assert_eq!(unsafe { ((*vtbl).AddRef)(this) }, StaticComObject::<Service, IServiceVtbl>::REF_COUNT);
+    assert_eq!(unsafe { ((*vtbl).Release)(this) }, StaticComObject::<Service, IServiceVtbl>::REF_COUNT);
+    assert_eq!(unsafe { ((*vtbl).Release)(this) }, StaticComObject::<Service, IServiceVtbl>::REF_COUNT);
+
+    let before = SERVICE.inner().calls.load(Ordering::Relaxed);
+    let result = unsafe { ((*rc.lpVtbl).call)(rc.as_ptr() as *mut c_void) };
+    assert_eq!(result, before + 1);
+}
+
+#[test]
+fn static_object_query_interface_works() {
+    let rc = SERVICE.to_rc::<IServiceRaw>();
+    let again = rc.query_interface::<IServiceRaw>().unwrap();
+    assert_eq!(again.as_ptr(), rc.as_ptr());
+
+    let this = SERVICE.as_ptr();
+    let vtbl = unsafe { *(this as *mut *mut IUnknownVtbl) };
+    let mut out = core::ptr::null_mut();
+    let status = unsafe { ((*vtbl).QueryInterface)(this, &IID_IUNKNOWN, &mut out) };
+    assert_eq!(status, STATUS_SUCCESS);
+    assert_eq!(out, this);
+
+    let unknown_iid = GUID {
+        data1: 0xdead_beef,
+        data2: 0,
+        data3: 0,
+        data4: [0; 8],
+    };
+    assert_ne!(unknown_iid, <IServiceInterface as ComInterfaceInfo>::IID);
+    let status = unsafe { ((*vtbl).QueryInterface)(this, &unknown_iid, &mut out) };
+    assert_eq!(status, STATUS_NOINTERFACE);
+    assert!(out.is_null());
+}